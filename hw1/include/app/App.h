@@ -9,6 +9,9 @@
 
 #include "app/Window.h"
 #include "shape/Pixel.h"
+#include "util/FrameCapture.h"
+#include "util/OffscreenFramebuffer.h"
+#include "util/RegressionCheck.h"
 
 
 class Shader;
@@ -19,9 +22,50 @@ class Renderable;
 class App : private Window
 {
 public:
-    static App & getInstance();
+    /// How to run, from the command line (see main.cpp).
+    struct Options
+    {
+        // Render into an OffscreenFramebuffer behind a hidden window, without waiting for vsync.
+        bool offscreen {false};
+
+        // Frames to render before run() returns; 0 renders until the window closes.
+        // With a frame count, every frame advances the scene by kFixedTimeStep, so runs are reproducible.
+        int numFrames {0};
+
+        // Save every frame to this directory as 000000.png, 000001.png, ...; empty saves nothing.
+        std::string captureDirectory;
+
+        // Save PPM instead of PNG files.
+        bool ppm {false};
+
+        // Draw the shapes listed in this file (see loadScene) instead of the curve of etc/config.txt;
+        // empty draws only the curve.
+        std::string scenePath;
 
-    void run();
+        // Compare every frame with the reference PPM of the same name in this directory instead of saving it;
+        // empty compares nothing. See RegressionCheck.
+        std::string referenceDirectory;
+        RegressionCheck::Budget budget;
+
+        // Write a timeline of the zones of all threads to this file as Chrome trace JSON (see Timeline);
+        // empty records nothing.
+        std::string timelinePath;
+
+        // Report the counters of FrameCounters once per second: to stdout, and/or as CSV to this file if not empty.
+        bool printCounters {false};
+        std::string countersPath;
+
+        // Fail the run if a steady-state frame allocates inside App::render or the per-frame input handling
+        // (see AllocationTracker; needs the TRACK_ALLOCATIONS CMake option).
+        bool checkAllocations {false};
+    };
+
+public:
+    /// options only take effect on the first call.
+    static App & getInstance(const Options & options);
+
+    /// Returns false if the frames or their performance regressed (see Options::referenceDirectory).
+    bool run();
 
 private:
     // GLFW callbacks.
@@ -39,6 +83,12 @@ private:
     static constexpr int kWindowWidth {1000};
     static constexpr int kWindowHeight {1000};
 
+    // Seconds per frame of runs with a fixed frame count.
+    static constexpr double kFixedTimeStep {1.0 / 60.0};
+
+    // Frames before the steady state, in which caches and buffers grow to their working sizes (see AllocationTracker).
+    static constexpr int kWarmupFrames {10};
+
 private:
     /// Bresenham line-drawing algorithm for line (x0, y0) -> (x1, y1) in screen space,
     /// given that its slope m satisfies 0.0 <= m <= 1.0 and that (x0, y0) is the start position.
@@ -74,10 +124,20 @@ private:
         }
     }
 
-    App();
+    explicit App(const Options & options);
 
     void render();
 
+    Options options;
+
+    // Set in offscreen mode, where it replaces the window's framebuffer.
+    std::unique_ptr<OffscreenFramebuffer> pOffscreenFramebuffer;
+
+    // Set if options.captureDirectory or options.referenceDirectory is given.
+    std::unique_ptr<FrameCapture> pFrameCapture;
+    std::unique_ptr<RegressionCheck> pRegressionCheck;
+    int numRenderedFrames {0};
+
     // Shaders.
     // In principle, a shader could be reused across multiple objects.
     // Thus, these shaders are not designed as members of object classes.
@@ -115,6 +175,21 @@ private:
 
     static bool loadCurveConfig(const std::string& path, int& typeOut, std::vector<double>& paramsOut);
 
+    /// Adds one shape per line of a scene file: a kind, then its parameters.
+    /// Lines, polylines, polygons, circles and ellipses are in screen space, as drawn with the mouse:
+    ///   line x0 y0 x1 y1
+    ///   polyline x0 y0 x1 y1 ...
+    ///   polygon x0 y0 x1 y1 x2 y2 ...
+    ///   circle cx cy r
+    ///   ellipse cx cy a b
+    /// Curves are in world space, with the parameters of etc/config.txt:
+    ///   cubic a3 a2 a1 a0
+    ///   quadratic a2 a1 a0
+    ///   superquadric a b n
+    /// Empty lines and lines starting with # are skipped. Throws std::runtime_error if the file
+    /// cannot be read or a line is malformed.
+    void loadScene(const std::string & path);
+
 
     // Note lastMouseLeftClickPos is different from lastMouseLeftPressPos.
     // If you press left button (and hold it there) and move the mouse,
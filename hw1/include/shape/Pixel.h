@@ -25,11 +25,17 @@ public:
 
     void render() override;
 
+    [[nodiscard]] Memory getMemory() const override;
+
     // `path` stores all pixels (in screen-space coodinates) to draw.
     // `dirty` should be set to true when path is updated
     // (otherwise the update won't happen on the screen.)
     bool dirty {false};
     std::vector<Vertex> path;
+
+private:
+    // Size of the buffer as of the last upload.
+    std::size_t uploadedBytes {0UL};
 };
 
 
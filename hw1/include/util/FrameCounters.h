@@ -0,0 +1,116 @@
+#ifndef FRAMECOUNTERS_H
+#define FRAMECOUNTERS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+
+class GLShape;
+
+
+/// Counts the work each frame hands to OpenGL: draw calls, the vertices and primitives they submit,
+/// tessellation patches, program switches, vertex array binds, and buffer uploads;
+/// the frame's heap allocations (see AllocationTracker);
+/// and the CPU and GPU memory held by the live GLShapes (see GLShape::getMemory()).
+///
+/// Draw and upload sites count themselves (countDraw(), countUpload()); GLState counts the binds it issues;
+/// the application adds the allocations.
+/// endFrame() publishes the frame's counts (getLastFrame()); once report() is called,
+/// the means per frame are also printed and/or appended to a CSV file about once per second.
+/// Must only be used from the thread that owns the context.
+class FrameCounters
+{
+public:
+    enum Counter : std::size_t
+    {
+        kDrawCalls,
+        kVertices,
+        kPrimitives,
+        kPatches,
+        kProgramSwitches,
+        kVertexArrayBinds,
+        kUploads,
+        kUploadedBytes,
+        kAllocations,
+        kAllocatedBytes,
+        kNumCounters
+    };
+
+    using Counts = std::array<std::uint64_t, kNumCounters>;
+
+    /// Memory of the live GLShapes.
+    struct ShapeMemory
+    {
+        std::size_t numShapes {0UL};
+        std::size_t cpuBytes {0UL};
+        std::size_t gpuBytes {0UL};
+    };
+
+public:
+    static FrameCounters & getInstance();
+
+    FrameCounters(const FrameCounters &) = delete;
+    FrameCounters(FrameCounters &&) = delete;
+    FrameCounters & operator=(const FrameCounters &) = delete;
+    FrameCounters & operator=(FrameCounters &&) = delete;
+
+    ~FrameCounters() noexcept = default;
+
+    /// Column name in the CSV file, e.g. "draw_calls".
+    static const char * getName(Counter counter);
+
+    void add(Counter counter, std::uint64_t n = 1UL) { current[counter] += n; }
+
+    /// One draw call of numVertices vertices (or indices) per instance.
+    /// Patches are counted instead of primitives, which only exist after tessellation;
+    /// glDrawTransformFeedback has no vertex count on the CPU side: pass 0.
+    void countDraw(GLenum mode, std::size_t numVertices, std::size_t numInstances = 1UL);
+
+    /// One glBufferData, glBufferSubData or glTex(Sub)Image call sending numBytes.
+    void countUpload(std::size_t numBytes);
+
+    /// Prints the means per frame about once per second if toStdout, and appends them to csvPath if not empty.
+    /// Throws std::runtime_error if csvPath cannot be written.
+    void report(bool toStdout, const std::string & csvPath);
+
+    /// Ends the frame; now is the time in seconds.
+    void endFrame(double now);
+
+    [[nodiscard]] const Counts & getLastFrame() const { return lastFrame; }
+
+    [[nodiscard]] std::uint64_t getLastFrame(Counter counter) const { return lastFrame[counter]; }
+
+    [[nodiscard]] ShapeMemory getShapeMemory() const;
+
+    /// Called by GLShape.
+    void addShape(const GLShape * shape);
+    void removeShape(const GLShape * shape);
+
+private:
+    FrameCounters() = default;
+
+    void writeReport(double seconds);
+
+    Counts current {};
+    Counts lastFrame {};
+
+    // Sums since the last report.
+    Counts sinceReport {};
+    std::size_t framesSinceReport {0UL};
+    double lastReportTimeStamp {-1.0};
+
+    bool print {false};
+    std::ofstream csv;
+    double startTimeStamp {-1.0};
+
+    std::vector<const GLShape *> shapes;
+};
+
+
+#endif  // FRAMECOUNTERS_H
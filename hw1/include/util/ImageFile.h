@@ -0,0 +1,29 @@
+#ifndef IMAGEFILE_H
+#define IMAGEFILE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/// Writes RGBA8 images (top row first) to disk, and reads PPMs back; alpha is dropped.
+/// Needs no image library: PNGs are written with uncompressed deflate blocks,
+/// which is fast to encode at the price of file size.
+class ImageFile
+{
+public:
+    /// PNG if path ends in ".png", binary PPM (P6) otherwise.
+    /// Returns false if the file cannot be written.
+    static bool write(const std::string & path, const std::vector<std::uint8_t> & rgba, int width, int height);
+
+    static bool writePpm(const std::string & path, const std::vector<std::uint8_t> & rgba, int width, int height);
+
+    static bool writePng(const std::string & path, const std::vector<std::uint8_t> & rgba, int width, int height);
+
+    /// Reads a binary PPM (P6, maxval 255) as written by writePpm, with alpha 255.
+    /// Returns false, leaving the outputs untouched, if the file cannot be read or is malformed.
+    static bool readPpm(const std::string & path, std::vector<std::uint8_t> & rgbaOut, int & widthOut, int & heightOut);
+};
+
+
+#endif  // IMAGEFILE_H
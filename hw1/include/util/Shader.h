@@ -11,6 +11,9 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include "util/GLState.h"
+#include "util/Timeline.h"
+
 
 class Shader
 {
@@ -24,6 +27,8 @@ public:
 
     Shader(const char * vertShaderPath, const char * fragShaderPath)
     {
+        Timeline::Zone zone {"Shader::Shader"};
+
         // 1. retrieve the vertexShader/fragmentShader source code from filePath
 
         std::string vertShaderCode;
@@ -82,6 +87,8 @@ public:
 
     Shader(const char * vertShaderPath, const char * tescShaderPath, const char * teseShaderPath, const char * fragShaderPath)
     {
+        Timeline::Zone zone {"Shader::Shader"};
+
         // 1. retrieve the vertShader/fragShader source code from filePath
 
         std::string vertShaderCode;
@@ -200,12 +207,12 @@ public:
 
     ~Shader()
     {
-        glDeleteProgram(shaderProgram);
+        GLState::getInstance().deleteProgram(shaderProgram);
     }
 
     void use() const
     {
-        glUseProgram(shaderProgram);
+        GLState::getInstance().useProgram(shaderProgram);
     }
 
     void setBool(const std::string & name, bool value) const
@@ -0,0 +1,77 @@
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+/// Records named zones of all threads (input, uniform updates, draws, buffer swaps, loads, shader compiles)
+/// into a timeline for chrome://tracing or https://ui.perfetto.dev, to see where frames overlap and stall.
+///
+/// Each thread appends its zones to a buffer of its own without locking; write() exports them as Chrome trace JSON.
+/// On the thread that called start(), with KHR_debug, zones also become OpenGL debug groups,
+/// so GPU debuggers and profilers show the same names.
+/// While stopped, a zone costs one relaxed atomic load.
+class Timeline
+{
+public:
+    /// Scope to time. name must outlive the Timeline: use a string literal.
+    class Zone
+    {
+    public:
+        explicit Zone(const char * name)
+        {
+            if (enabled.load(std::memory_order_relaxed))
+            {
+                begin(name);
+            }
+        }
+
+        ~Zone() noexcept
+        {
+            if (pName)
+            {
+                end();
+            }
+        }
+
+        Zone(const Zone &) = delete;
+        Zone(Zone &&) = delete;
+        Zone & operator=(const Zone &) = delete;
+        Zone & operator=(Zone &&) = delete;
+
+    private:
+        void begin(const char * name);
+        void end() noexcept;
+
+        const char * pName {nullptr};
+        std::uint64_t beginNanoseconds {0UL};
+        bool debugGroup {false};
+    };
+
+public:
+    /// Starts recording. Call from the thread that owns the OpenGL context.
+    static void start();
+
+    static void stop();
+
+    [[nodiscard]] static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    /// Names the calling thread in the timeline. name must be a string literal.
+    /// Cheap while stopped: a thread's buffer is only created with the first zone it records.
+    static void setThreadName(const char * name);
+
+    /// Writes the zones recorded so far to path as Chrome trace JSON. Returns false if the file cannot be written.
+    static bool write(const std::string & path);
+
+    /// Zones recorded so far.
+    [[nodiscard]] static std::size_t size();
+
+private:
+    static inline std::atomic<bool> enabled {false};
+};
+
+
+#endif  // TIMELINE_H
@@ -3,24 +3,42 @@
 
 #include "app/App.h"
 #include "shape/Pixel.h"
+#include "util/AllocationTracker.h"
+#include "util/FrameCounters.h"
+#include "util/GLState.h"
+#include "util/NullGL.h"
 #include "util/Shader.h"
+#include "util/Timeline.h"
 
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <cmath>
+#include <filesystem>
+#include <iomanip>
+#include <stdexcept>
+#include <string>
 
-App & App::getInstance()
+App & App::getInstance(const Options & options)
 {
-    static App instance;
+    static App instance(options);
     return instance;
 }
 
 
-void App::run()
+bool App::run()
 {
-    while (!glfwWindowShouldClose(pWindow))
+    double startTimeStamp = glfwGetTime();
+
+#ifdef NULL_GL
+    NullGL::resetCallCounts();
+#endif
+
+    while (!glfwWindowShouldClose(pWindow) && (options.numFrames == 0 || numRenderedFrames < options.numFrames))
     {
+        Timeline::Zone frameZone {"frame"};
+
         // Per-frame logic
         perFrameTimeLogic(pWindow);
         processKeyInput(pWindow);
@@ -30,16 +48,97 @@ void App::run()
         glClear(GL_COLOR_BUFFER_BIT);
 
         render();
+        AllocationTracker::Counts allocations = AllocationTracker::endFrame();
+        FrameCounters::getInstance().add(FrameCounters::kAllocations, allocations.numAllocations);
+        FrameCounters::getInstance().add(FrameCounters::kAllocatedBytes, allocations.numBytes);
+        FrameCounters::getInstance().endFrame(glfwGetTime());
+
+        if (pFrameCapture)
+        {
+            std::ostringstream name;
+            name << std::setw(6) << std::setfill('0') << numRenderedFrames
+                 << (options.ppm || pRegressionCheck ? ".ppm" : ".png");
+            pFrameCapture->capture((std::filesystem::path(options.captureDirectory) / name.str()).string());
+        }
+
+        ++numRenderedFrames;
+
+        if (numRenderedFrames == kWarmupFrames)
+        {
+            AllocationTracker::startSteadyState();
+        }
 
         // Check and call events and swap the buffers
-        glfwSwapBuffers(pWindow);
+        // (offscreen, nothing is shown, so there is nothing to swap)
+        if (!options.offscreen)
+        {
+            Timeline::Zone zone {"glfwSwapBuffers"};
+            glfwSwapBuffers(pWindow);
+        }
+
         glfwPollEvents();
     }
+
+    // Frame times include the GPU's work.
+    glFinish();
+    double seconds = glfwGetTime() - startTimeStamp;
+
+    if (Timeline::isEnabled())
+    {
+        Timeline::stop();
+
+        if (Timeline::write(options.timelinePath))
+        {
+            std::cout << "[timeline] " << Timeline::size() << " zones written to " << options.timelinePath << '\n';
+        }
+        else
+        {
+            std::cout << "[timeline] failed to write " << options.timelinePath << '\n';
+        }
+    }
+
+#ifdef NULL_GL
+    NullGL::printCallCounts(static_cast<std::size_t>(numRenderedFrames), seconds);
+#endif
+
+    bool allocationFree = true;
+
+    if (AllocationTracker::isEnabled())
+    {
+        AllocationTracker::printReport(static_cast<std::size_t>(std::max(numRenderedFrames - kWarmupFrames, 0)));
+        allocationFree = !options.checkAllocations || AllocationTracker::getNumChecked() == 0UL;
+    }
+    else if (options.checkAllocations)
+    {
+        std::cout << "[alloc] --check-allocations needs a build with the TRACK_ALLOCATIONS CMake option\n";
+        allocationFree = false;
+    }
+
+    if (pFrameCapture)
+    {
+        pFrameCapture->finish();
+    }
+
+    if (pRegressionCheck)
+    {
+        return pRegressionCheck->finish(static_cast<std::size_t>(numRenderedFrames), seconds) && allocationFree;
+    }
+
+    if (pFrameCapture)
+    {
+        FrameCapture::Stats stats = pFrameCapture->getStats();
+        std::cout << "[capture] " << stats.numHandled << " of " << stats.numCaptured << " frames written to "
+                  << options.captureDirectory << ", " << stats.numStalls << " readback stalls\n";
+    }
+
+    return allocationFree;
 }
 
 
 void App::cursorPosCallback(GLFWwindow * window, double xpos, double ypos)
 {
+    AllocationTracker::CheckedScope allocationScope {"App::cursorPosCallback"};
+
     App & app = *reinterpret_cast<App *>(glfwGetWindowUserPointer(window));
 
     app.mousePos.x = xpos;
@@ -355,14 +454,15 @@ void App::perFrameTimeLogic(GLFWwindow * window)
     App & app = *reinterpret_cast<App *>(glfwGetWindowUserPointer(window));
 
     double currentFrame = glfwGetTime();
-    app.timeElapsedSinceLastFrame = currentFrame - app.lastFrameTimeStamp;
+    app.timeElapsedSinceLastFrame = app.options.numFrames ? kFixedTimeStep : currentFrame - app.lastFrameTimeStamp;
     app.lastFrameTimeStamp = currentFrame;
 }
 
 
 void App::processKeyInput(GLFWwindow * window)
 {
-
+    Timeline::Zone zone {"processKeyInput"};
+    AllocationTracker::CheckedScope allocationScope {"App::processKeyInput"};
 }
 
 void App::bresenhamLine(std::vector<Pixel::Vertex>& path, int x0, int y0, int x1, int y1)
@@ -437,8 +537,19 @@ void App::midpointCircle(std::vector<Pixel::Vertex>& path, int cx, int cy, int r
 }
 
 
-App::App() : Window(kWindowWidth, kWindowHeight, kWindowName, nullptr, nullptr)
+App::App(const Options & options)
+        : Window(kWindowWidth, kWindowHeight, kWindowName, nullptr, nullptr, !options.offscreen),
+          options(options)
 {
+    // Before loading anything, so the timeline shows the shader compiles.
+    if (!options.timelinePath.empty())
+    {
+        Timeline::setThreadName("main");
+        Timeline::start();
+    }
+
+    FrameCounters::getInstance().report(options.printCounters, options.countersPath);
+
     // GLFW boilerplate.
     glfwSetWindowUserPointer(pWindow, this);
     glfwSetCursorPosCallback(pWindow, cursorPosCallback);
@@ -447,8 +558,8 @@ App::App() : Window(kWindowWidth, kWindowHeight, kWindowName, nullptr, nullptr)
     glfwSetMouseButtonCallback(pWindow, mouseButtonCallback);
     glfwSetScrollCallback(pWindow, scrollCallback);
 
-    // Read bonus curve config
-    hasCurveConfig = loadCurveConfig("etc/config.txt", curveType, curveParams);
+    // Read bonus curve config (a scene file replaces it)
+    hasCurveConfig = options.scenePath.empty() && loadCurveConfig("etc/config.txt", curveType, curveParams);
 
     std::cout << "[config] loaded=" << hasCurveConfig
               << " type=" << curveType
@@ -460,7 +571,37 @@ App::App() : Window(kWindowWidth, kWindowHeight, kWindowName, nullptr, nullptr)
 
     // Global OpenGL pipeline settings
     glViewport(0, 0, kWindowWidth, kWindowHeight);
-    glPolygonMode(GL_FRONT_AND_BACK, GL_POINT);
+
+    if (options.offscreen)
+    {
+        // The hidden window's framebuffer is never shown; render at full speed into one of our own.
+        pOffscreenFramebuffer = std::make_unique<OffscreenFramebuffer>(kWindowWidth, kWindowHeight);
+        pOffscreenFramebuffer->bind();
+        glfwSwapInterval(0);
+    }
+
+    if (!options.referenceDirectory.empty())
+    {
+        pRegressionCheck = std::make_unique<RegressionCheck>(options.referenceDirectory, options.budget);
+        pFrameCapture = std::make_unique<FrameCapture>(
+                kWindowWidth,
+                kWindowHeight,
+                [check = pRegressionCheck.get()](const std::string & path,
+                                                 const std::vector<std::uint8_t> & rgba,
+                                                 int width,
+                                                 int height)
+                {
+                    return check->compareFrame(path, rgba, width, height);
+                }
+        );
+    }
+    else if (!options.captureDirectory.empty())
+    {
+        std::filesystem::create_directories(options.captureDirectory);
+        pFrameCapture = std::make_unique<FrameCapture>(kWindowWidth, kWindowHeight);
+    }
+
+    GLState::getInstance().setPolygonMode(GL_POINT);
     glLineWidth(1.0f);
     glPointSize(1.0f);
 
@@ -492,6 +633,11 @@ App::App() : Window(kWindowWidth, kWindowHeight, kWindowName, nullptr, nullptr)
         shapes.emplace_back(std::move(curve));
     }
 
+    if (!options.scenePath.empty())
+    {
+        loadScene(options.scenePath);
+    }
+
 
 }
 
@@ -579,14 +725,21 @@ void App::midpointEllipse(std::vector<Pixel::Vertex>& path, int cx, int cy, int
 
 void App::render()
 {
+    AllocationTracker::CheckedScope allocationScope {"App::render"};
+
     // Update all shader uniforms.
-    pPixelShader->use();
-    pPixelShader->setFloat("windowWidth", kWindowWidth);
-    pPixelShader->setFloat("windowHeight", kWindowHeight);
+    {
+        Timeline::Zone zone {"uniforms"};
+
+        pPixelShader->use();
+        pPixelShader->setFloat("windowWidth", kWindowWidth);
+        pPixelShader->setFloat("windowHeight", kWindowHeight);
+    }
 
     // Render all shapes.
     for (auto & s : shapes)
     {
+        Timeline::Zone zone {"Renderable::render"};
         s->render();
     }
 }
@@ -613,6 +766,88 @@ bool App::loadCurveConfig(const std::string& path, int& typeOut, std::vector<dou
     return true;
 }
 
+void App::loadScene(const std::string & path)
+{
+    std::ifstream fin(path);
+
+    if (!fin.is_open())
+    {
+        throw std::runtime_error("App: failed to open scene " + path);
+    }
+
+    std::string line;
+    int lineNumber = 0;
+
+    while (std::getline(fin, line))
+    {
+        ++lineNumber;
+
+        std::istringstream iss(line);
+        std::string kind;
+
+        if (!(iss >> kind) || kind.front() == '#')
+        {
+            continue;
+        }
+
+        std::vector<double> p;
+        double value;
+
+        while (iss >> value)
+        {
+            p.emplace_back(value);
+        }
+
+        auto shape = std::make_unique<Pixel>(pPixelShader.get());
+        auto at = [&p](std::size_t i) { return static_cast<int>(std::lround(p[i])); };
+        bool valid = iss.eof();
+
+        if (valid && kind == "line" && p.size() == 4UL)
+        {
+            bresenhamLine(shape->path, at(0), at(1), at(2), at(3));
+        }
+        else if (valid && (kind == "polyline" || kind == "polygon") && 4UL <= p.size() && p.size() % 2UL == 0UL)
+        {
+            for (std::size_t i = 2UL; i != p.size(); i += 2UL)
+            {
+                bresenhamLine(shape->path, at(i - 2UL), at(i - 1UL), at(i), at(i + 1UL));
+            }
+
+            if (kind == "polygon")
+            {
+                bresenhamLine(shape->path, at(p.size() - 2UL), at(p.size() - 1UL), at(0), at(1));
+            }
+        }
+        else if (valid && kind == "circle" && p.size() == 3UL)
+        {
+            midpointCircle(shape->path, at(0), at(1), at(2));
+        }
+        else if (valid && kind == "ellipse" && p.size() == 4UL)
+        {
+            midpointEllipse(shape->path, at(0), at(1), at(2), at(3));
+        }
+        else if (valid && kind == "cubic" && p.size() == 4UL)
+        {
+            drawCubic(shape->path, p[0], p[1], p[2], p[3]);
+        }
+        else if (valid && kind == "quadratic" && p.size() == 3UL)
+        {
+            drawQuadratic(shape->path, p[0], p[1], p[2]);
+        }
+        else if (valid && kind == "superquadric" && p.size() == 3UL)
+        {
+            drawSuperquadric(shape->path, p[0], p[1], p[2]);
+        }
+        else
+        {
+            throw std::runtime_error("App: " + path + ':' + std::to_string(lineNumber) + ": malformed " + kind);
+        }
+
+        shape->dirty = true;
+        shapes.emplace_back(std::move(shape));
+    }
+}
+
 void App::drawQuadratic(std::vector<Pixel::Vertex>& path, double a2, double a1, double a0)
 {
     path.clear();
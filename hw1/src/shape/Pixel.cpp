@@ -1,4 +1,6 @@
 #include "shape/Pixel.h"
+#include "util/FrameCounters.h"
+#include "util/GLState.h"
 #include "util/Shader.h"
 
 
@@ -11,8 +13,8 @@ Pixel::Vertex::Vertex(int x, int y, float r, float g, float b):
 
 Pixel::Pixel(Shader * shader) : GLShape(shader)
 {
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    GLState::getInstance().bindVertexArray(vao);
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, vbo);
 
     // Vertex coordinate attribute array "layout (position = 0) in vec2 aPosition"
     glEnableVertexAttribArray(0);
@@ -32,8 +34,8 @@ Pixel::Pixel(Shader * shader) : GLShape(shader)
                           sizeof(Vertex),
                           reinterpret_cast<void *>(sizeof(Vertex::position)));
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::getInstance().bindVertexArray(0);
 }
 
 
@@ -41,8 +43,8 @@ void Pixel::render()
 {
     pShader->use();
 
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    GLState::getInstance().bindVertexArray(vao);
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, vbo);
 
     if (dirty)
     {
@@ -50,14 +52,20 @@ void Pixel::render()
                      static_cast<GLsizei>(path.size() * sizeof(Vertex)),
                      path.data(),
                      GL_DYNAMIC_DRAW);
+        FrameCounters::getInstance().countUpload(path.size() * sizeof(Vertex));
 
+        uploadedBytes = path.size() * sizeof(Vertex);
         dirty = false;
     }
 
     glDrawArrays(GL_POINTS,
                  0,                                       // start from index 0 in current VBO
                  static_cast<GLsizei>(path.size()));  // draw these number of elements
+    FrameCounters::getInstance().countDraw(GL_POINTS, path.size());
+}
+
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+GLShape::Memory Pixel::getMemory() const
+{
+    return {path.capacity() * sizeof(Vertex), uploadedBytes};
 }
@@ -0,0 +1,231 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+#include "util/FrameCapture.h"
+#include "util/GLState.h"
+#include "util/ImageFile.h"
+#include "util/Timeline.h"
+
+
+namespace
+{
+
+bool writeImageFile(const std::string & path, const std::vector<std::uint8_t> & rgba, int width, int height)
+{
+    if (!ImageFile::write(path, rgba, width, height))
+    {
+        std::cout << "[capture] failed to write " << path << '\n';
+        return false;
+    }
+
+    return true;
+}
+
+}  // namespace anonymous
+
+
+FrameCapture::FrameCapture(int width, int height) : FrameCapture(width, height, writeImageFile)
+{
+
+}
+
+
+FrameCapture::FrameCapture(int width, int height, Handler handler)
+        : width(width), height(height), handler(std::move(handler))
+{
+    auto size = static_cast<GLsizeiptr>(width) * static_cast<GLsizeiptr>(height) * 4;
+
+    for (Slot & slot : slots)
+    {
+        glGenBuffers(1, &slot.pbo);
+        GLState::getInstance().bindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+    }
+
+    GLState::getInstance().bindBuffer(GL_PIXEL_PACK_BUFFER, 0U);
+
+    writer = std::thread(&FrameCapture::writerLoop, this);
+}
+
+
+FrameCapture::~FrameCapture() noexcept
+{
+    finish();
+
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+
+    frameQueued.notify_one();
+    writer.join();
+
+    for (Slot & slot : slots)
+    {
+        GLState::getInstance().deleteBuffer(slot.pbo);
+        slot.pbo = 0U;
+    }
+}
+
+
+void FrameCapture::capture(const std::string & path)
+{
+    Timeline::Zone zone {"FrameCapture::capture"};
+
+    Slot & slot = slots[next];
+
+    // All buffers are in flight: the oldest read has to finish now.
+    if (slot.fence)
+    {
+        retire(slot, true);
+    }
+
+    // Rows are tightly packed.
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+    // With a pixel pack buffer bound, glReadPixels only queues the copy and returns.
+    GLState::getInstance().bindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, reinterpret_cast<void *>(0));
+    GLState::getInstance().bindBuffer(GL_PIXEL_PACK_BUFFER, 0U);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0U);
+    slot.path = path;
+
+    // Without a buffer swap, nothing else submits the fence to the GPU.
+    glFlush();
+
+    next = (next + 1) % kNumBuffers;
+    ++stats.numCaptured;
+
+    // Hand over every read that has finished by now, oldest first.
+    for (int i = 0; i != kNumBuffers; ++i)
+    {
+        Slot & s = slots[(next + i) % kNumBuffers];
+
+        if (s.fence && !retire(s, false))
+        {
+            break;
+        }
+    }
+}
+
+
+void FrameCapture::finish()
+{
+    for (int i = 0; i != kNumBuffers; ++i)
+    {
+        Slot & slot = slots[(next + i) % kNumBuffers];
+
+        if (slot.fence)
+        {
+            retire(slot, true);
+        }
+    }
+
+    std::unique_lock lock(mutex);
+    frameWritten.wait(lock, [this] { return queue.empty() && !writing; });
+}
+
+
+FrameCapture::Stats FrameCapture::getStats() const
+{
+    std::lock_guard lock(mutex);
+    return stats;
+}
+
+
+bool FrameCapture::retire(Slot & slot, bool wait)
+{
+    GLenum status = glClientWaitSync(slot.fence, 0U, 0U);
+
+    if (status == GL_TIMEOUT_EXPIRED)
+    {
+        if (!wait)
+        {
+            return false;
+        }
+
+        ++stats.numStalls;
+
+        do
+        {
+            // One second at a time.
+            status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000U);
+        }
+        while (status == GL_TIMEOUT_EXPIRED);
+    }
+
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    auto rowSize = static_cast<std::size_t>(width) * 4UL;
+    auto size = rowSize * static_cast<std::size_t>(height);
+
+    Frame frame {std::move(slot.path), std::vector<std::uint8_t>(size)};
+
+    GLState::getInstance().bindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+
+    if (const auto * mapped = static_cast<const std::uint8_t *>(
+            glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(size), GL_MAP_READ_BIT)))
+    {
+        // OpenGL's first row is the bottom one; image files start at the top.
+        for (std::size_t y = 0UL; y != static_cast<std::size_t>(height); ++y)
+        {
+            std::memcpy(frame.pixels.data() + y * rowSize,
+                        mapped + (static_cast<std::size_t>(height) - 1UL - y) * rowSize,
+                        rowSize);
+        }
+
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+
+    GLState::getInstance().bindBuffer(GL_PIXEL_PACK_BUFFER, 0U);
+
+    std::unique_lock lock(mutex);
+    frameWritten.wait(lock, [this] { return queue.size() < kMaxQueuedFrames; });
+    queue.emplace_back(std::move(frame));
+    lock.unlock();
+
+    frameQueued.notify_one();
+
+    return true;
+}
+
+
+void FrameCapture::writerLoop()
+{
+    Timeline::setThreadName("capture");
+
+    std::unique_lock lock(mutex);
+
+    while (true)
+    {
+        frameQueued.wait(lock, [this] { return stopping || !queue.empty(); });
+
+        if (queue.empty())
+        {
+            return;
+        }
+
+        Frame frame = std::move(queue.front());
+        queue.pop_front();
+        writing = true;
+
+        lock.unlock();
+        bool handled {false};
+
+        {
+            Timeline::Zone zone {"FrameCapture::handler"};
+            handled = handler(frame.path, frame.pixels, width, height);
+        }
+
+        lock.lock();
+
+        writing = false;
+        ++(handled ? stats.numHandled : stats.numFailed);
+
+        frameWritten.notify_all();
+    }
+}
@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <fstream>
+#include <limits>
+#include <utility>
+
+#include "util/ImageFile.h"
+
+
+namespace
+{
+
+std::uint32_t crc32(const std::uint8_t * data, std::size_t size, std::uint32_t crc = 0U)
+{
+    static const std::array<std::uint32_t, 256> kTable = []
+    {
+        std::array<std::uint32_t, 256> table {};
+
+        for (std::uint32_t n = 0U; n != 256U; ++n)
+        {
+            std::uint32_t c = n;
+
+            for (int k = 0; k != 8; ++k)
+            {
+                c = (c & 1U) ? 0xEDB88320U ^ (c >> 1U) : c >> 1U;
+            }
+
+            table[n] = c;
+        }
+
+        return table;
+    }();
+
+    crc = ~crc;
+
+    for (std::size_t i = 0UL; i != size; ++i)
+    {
+        crc = kTable[(crc ^ data[i]) & 0xFFU] ^ (crc >> 8U);
+    }
+
+    return ~crc;
+}
+
+
+std::uint32_t adler32(const std::uint8_t * data, std::size_t size)
+{
+    std::uint32_t a = 1U;
+    std::uint32_t b = 0U;
+
+    for (std::size_t i = 0UL; i != size; ++i)
+    {
+        a = (a + data[i]) % 65521U;
+        b = (b + a) % 65521U;
+    }
+
+    return (b << 16U) | a;
+}
+
+
+void appendBigEndian(std::vector<std::uint8_t> & out, std::uint32_t v)
+{
+    out.push_back(static_cast<std::uint8_t>(v >> 24U));
+    out.push_back(static_cast<std::uint8_t>(v >> 16U));
+    out.push_back(static_cast<std::uint8_t>(v >> 8U));
+    out.push_back(static_cast<std::uint8_t>(v));
+}
+
+
+/// Length, type, data and CRC of the type and data.
+void appendChunk(std::vector<std::uint8_t> & out, const char (& type)[5], const std::vector<std::uint8_t> & data)
+{
+    appendBigEndian(out, static_cast<std::uint32_t>(data.size()));
+
+    std::size_t typeOffset = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.cbegin(), data.cend());
+
+    appendBigEndian(out, crc32(out.data() + typeOffset, out.size() - typeOffset));
+}
+
+
+bool endsWith(const std::string & s, const std::string & suffix)
+{
+    return suffix.size() <= s.size() && std::equal(suffix.crbegin(), suffix.crend(), s.crbegin());
+}
+
+}  // namespace anonymous
+
+
+bool ImageFile::write(const std::string & path, const std::vector<std::uint8_t> & rgba, int width, int height)
+{
+    return endsWith(path, ".png") ? writePng(path, rgba, width, height) : writePpm(path, rgba, width, height);
+}
+
+
+bool ImageFile::writePpm(const std::string & path, const std::vector<std::uint8_t> & rgba, int width, int height)
+{
+    std::ofstream fout(path, std::ios::binary);
+
+    if (!fout)
+    {
+        return false;
+    }
+
+    fout << "P6\n" << width << ' ' << height << "\n255\n";
+
+    for (std::size_t i = 0UL; i + 3UL < rgba.size(); i += 4UL)
+    {
+        fout.write(reinterpret_cast<const char *>(rgba.data() + i), 3);
+    }
+
+    return static_cast<bool>(fout);
+}
+
+
+bool ImageFile::readPpm(const std::string & path, std::vector<std::uint8_t> & rgbaOut, int & widthOut, int & heightOut)
+{
+    std::ifstream fin(path, std::ios::binary);
+
+    std::string magic;
+    int width = 0;
+    int height = 0;
+    int maxValue = 0;
+
+    if (!(fin >> magic) || magic != "P6")
+    {
+        return false;
+    }
+
+    // Header fields may be preceded by comments.
+    for (int * field : {&width, &height, &maxValue})
+    {
+        while ((fin >> std::ws).peek() == '#')
+        {
+            fin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        }
+
+        if (!(fin >> *field) || *field <= 0)
+        {
+            return false;
+        }
+    }
+
+    // A single whitespace character separates the header from the pixels.
+    if (maxValue != 255 || !std::isspace(fin.get()))
+    {
+        return false;
+    }
+
+    auto numPixels = static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+    std::vector<std::uint8_t> rgb(numPixels * 3UL);
+
+    if (!fin.read(reinterpret_cast<char *>(rgb.data()), static_cast<std::streamsize>(rgb.size())))
+    {
+        return false;
+    }
+
+    std::vector<std::uint8_t> rgba(numPixels * 4UL);
+
+    for (std::size_t i = 0UL; i != numPixels; ++i)
+    {
+        std::copy_n(rgb.data() + i * 3UL, 3, rgba.data() + i * 4UL);
+        rgba[i * 4UL + 3UL] = 255U;
+    }
+
+    rgbaOut = std::move(rgba);
+    widthOut = width;
+    heightOut = height;
+
+    return true;
+}
+
+
+bool ImageFile::writePng(const std::string & path, const std::vector<std::uint8_t> & rgba, int width, int height)
+{
+    auto w = static_cast<std::size_t>(width);
+    auto h = static_cast<std::size_t>(height);
+
+    if (rgba.size() < w * h * 4UL)
+    {
+        return false;
+    }
+
+    // Scanlines of RGB8, each after filter type 0 (none).
+    std::vector<std::uint8_t> raw;
+    raw.reserve(h * (1UL + w * 3UL));
+
+    for (std::size_t y = 0UL; y != h; ++y)
+    {
+        raw.push_back(0U);
+
+        for (std::size_t x = 0UL; x != w; ++x)
+        {
+            const std::uint8_t * pixel = rgba.data() + (y * w + x) * 4UL;
+            raw.insert(raw.end(), pixel, pixel + 3);
+        }
+    }
+
+    // zlib stream of stored deflate blocks (at most 65535 bytes each).
+    constexpr std::size_t kMaxBlock {65535UL};
+
+    std::vector<std::uint8_t> zlib {0x78U, 0x01U};
+    zlib.reserve(raw.size() + raw.size() / kMaxBlock * 5UL + 16UL);
+
+    std::size_t offset = 0UL;
+
+    do
+    {
+        std::size_t size = std::min(kMaxBlock, raw.size() - offset);
+        bool last = offset + size == raw.size();
+
+        zlib.push_back(last ? 1U : 0U);
+        zlib.push_back(static_cast<std::uint8_t>(size));
+        zlib.push_back(static_cast<std::uint8_t>(size >> 8U));
+        zlib.push_back(static_cast<std::uint8_t>(~size));
+        zlib.push_back(static_cast<std::uint8_t>(~size >> 8U));
+        zlib.insert(zlib.end(), raw.cbegin() + static_cast<std::ptrdiff_t>(offset),
+                    raw.cbegin() + static_cast<std::ptrdiff_t>(offset + size));
+
+        offset += size;
+    }
+    while (offset != raw.size());
+
+    appendBigEndian(zlib, adler32(raw.data(), raw.size()));
+
+    // 8-bit RGB, no interlacing.
+    std::vector<std::uint8_t> header;
+    appendBigEndian(header, static_cast<std::uint32_t>(width));
+    appendBigEndian(header, static_cast<std::uint32_t>(height));
+    header.insert(header.end(), {8U, 2U, 0U, 0U, 0U});
+
+    std::vector<std::uint8_t> png {0x89U, 'P', 'N', 'G', '\r', '\n', 0x1AU, '\n'};
+    appendChunk(png, "IHDR", header);
+    appendChunk(png, "IDAT", zlib);
+    appendChunk(png, "IEND", {});
+
+    std::ofstream fout(path, std::ios::binary);
+    fout.write(reinterpret_cast<const char *>(png.data()), static_cast<std::streamsize>(png.size()));
+
+    return static_cast<bool>(fout);
+}
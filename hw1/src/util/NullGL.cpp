@@ -0,0 +1,380 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <glad/glad.h>
+
+#include "util/NullGL.h"
+
+
+namespace
+{
+
+// Counter slots of the entry points with an implementation of their own; generic stubs take the ones after.
+enum Slot : std::size_t
+{
+    kCheckFramebufferStatus,
+    kClientWaitSync,
+    kCreateProgram,
+    kCreateShader,
+    kFenceSync,
+    kGenBuffers,
+    kGenFramebuffers,
+    kGenQueries,
+    kGenRenderbuffers,
+    kGenTextures,
+    kGenTransformFeedbacks,
+    kGenVertexArrays,
+    kGetIntegerv,
+    kGetProgramInfoLog,
+    kGetProgramiv,
+    kGetQueryObjecti64v,
+    kGetQueryObjectiv,
+    kGetQueryObjectui64v,
+    kGetQueryObjectuiv,
+    kGetShaderInfoLog,
+    kGetShaderiv,
+    kGetString,
+    kGetStringi,
+    kGetUniformLocation,
+    kMapBufferRange,
+    kUnmapBuffer,
+    kNumOwnSlots
+};
+
+constexpr std::size_t kNumGenericStubs {NullGL::kMaxEntryPoints - kNumOwnSlots};
+
+// Beyond glad's core loader, which stops at OpenGL 3.3.
+constexpr std::array<const char *, 5> kExtensions {
+        "GL_ARB_draw_indirect",
+        "GL_ARB_multi_draw_indirect",
+        "GL_ARB_tessellation_shader",
+        "GL_ARB_transform_feedback2",
+        "GL_ARB_transform_feedback3"
+};
+
+std::array<std::string, NullGL::kMaxEntryPoints> names;
+std::array<std::uint64_t, NullGL::kMaxEntryPoints> counts {};
+std::unordered_map<std::string, std::size_t> slots;
+std::size_t numGenericStubs {0UL};
+
+GLuint nextName {1U};
+GLint nextLocation {0};
+std::uintptr_t nextSync {1UL};
+
+// Storage for glMapBufferRange.
+std::vector<std::uint8_t> scratch;
+
+
+template <std::size_t I>
+std::uintptr_t APIENTRY genericStub()
+{
+    ++counts[kNumOwnSlots + I];
+    return 0UL;
+}
+
+
+template <std::size_t ... Is>
+constexpr std::array<std::uintptr_t (APIENTRYP)(), sizeof...(Is)> makeGenericStubs(std::index_sequence<Is ...>)
+{
+    return {&genericStub<Is> ...};
+}
+
+
+constexpr std::array<std::uintptr_t (APIENTRYP)(), kNumGenericStubs> kGenericStubs =
+        makeGenericStubs(std::make_index_sequence<kNumGenericStubs>());
+
+
+GLenum APIENTRY checkFramebufferStatus(GLenum)
+{
+    ++counts[kCheckFramebufferStatus];
+    return GL_FRAMEBUFFER_COMPLETE;
+}
+
+
+GLenum APIENTRY clientWaitSync(GLsync, GLbitfield, GLuint64)
+{
+    ++counts[kClientWaitSync];
+    return GL_ALREADY_SIGNALED;
+}
+
+
+GLuint APIENTRY createProgram()
+{
+    ++counts[kCreateProgram];
+    return nextName++;
+}
+
+
+GLuint APIENTRY createShader(GLenum)
+{
+    ++counts[kCreateShader];
+    return nextName++;
+}
+
+
+GLsync APIENTRY fenceSync(GLenum, GLbitfield)
+{
+    ++counts[kFenceSync];
+    return reinterpret_cast<GLsync>(nextSync++);
+}
+
+
+template <std::size_t S>
+void APIENTRY genNames(GLsizei n, GLuint * out)
+{
+    ++counts[S];
+
+    for (GLsizei i = 0; i < n; ++i)
+    {
+        out[i] = nextName++;
+    }
+}
+
+
+void APIENTRY getIntegerv(GLenum pname, GLint * data)
+{
+    ++counts[kGetIntegerv];
+
+    switch (pname)
+    {
+        case GL_MAJOR_VERSION:
+            *data = 4;
+            break;
+        case GL_MINOR_VERSION:
+            *data = 1;
+            break;
+        case GL_NUM_EXTENSIONS:
+            *data = static_cast<GLint>(kExtensions.size());
+            break;
+        case GL_MAX_TESS_GEN_LEVEL:
+            // The least an implementation may support.
+            *data = 64;
+            break;
+        default:
+            *data = 0;
+            break;
+    }
+}
+
+
+template <std::size_t S>
+void APIENTRY getInfoLog(GLuint, GLsizei bufSize, GLsizei * length, GLchar * infoLog)
+{
+    ++counts[S];
+
+    if (length)
+    {
+        *length = 0;
+    }
+
+    if (0 < bufSize)
+    {
+        infoLog[0] = '\0';
+    }
+}
+
+
+template <std::size_t S>
+void APIENTRY getObjectiv(GLuint, GLenum pname, GLint * params)
+{
+    ++counts[S];
+    *params = (pname == GL_COMPILE_STATUS || pname == GL_LINK_STATUS || pname == GL_VALIDATE_STATUS) ? GL_TRUE : 0;
+}
+
+
+template <std::size_t S, typename T>
+void APIENTRY getQueryObject(GLuint, GLenum pname, T * params)
+{
+    ++counts[S];
+    *params = pname == GL_QUERY_RESULT_AVAILABLE ? 1 : 0;
+}
+
+
+const GLubyte * APIENTRY getString(GLenum name)
+{
+    ++counts[kGetString];
+
+    switch (name)
+    {
+        case GL_VERSION:
+            return reinterpret_cast<const GLubyte *>("4.1 NullGL");
+        case GL_SHADING_LANGUAGE_VERSION:
+            return reinterpret_cast<const GLubyte *>("4.10");
+        default:
+            return reinterpret_cast<const GLubyte *>("NullGL");
+    }
+}
+
+
+const GLubyte * APIENTRY getStringi(GLenum name, GLuint index)
+{
+    ++counts[kGetStringi];
+
+    if (name != GL_EXTENSIONS || kExtensions.size() <= index)
+    {
+        return nullptr;
+    }
+
+    return reinterpret_cast<const GLubyte *>(kExtensions[index]);
+}
+
+
+GLint APIENTRY getUniformLocation(GLuint, const GLchar *)
+{
+    ++counts[kGetUniformLocation];
+    return nextLocation++;
+}
+
+
+void * APIENTRY mapBufferRange(GLenum, GLintptr, GLsizeiptr length, GLbitfield)
+{
+    ++counts[kMapBufferRange];
+    scratch.resize(std::max(scratch.size(), static_cast<std::size_t>(length)));
+    return scratch.data();
+}
+
+
+GLboolean APIENTRY unmapBuffer(GLenum)
+{
+    ++counts[kUnmapBuffer];
+    return GL_TRUE;
+}
+
+
+template <typename F>
+void * toProc(F f)
+{
+    return reinterpret_cast<void *>(f);
+}
+
+
+struct OwnEntryPoint
+{
+    const char * name;
+    Slot slot;
+    void * proc;
+};
+
+
+const std::array<OwnEntryPoint, kNumOwnSlots> & ownEntryPoints()
+{
+    static const std::array<OwnEntryPoint, kNumOwnSlots> kEntryPoints {{
+            {"glCheckFramebufferStatus", kCheckFramebufferStatus, toProc(&checkFramebufferStatus)},
+            {"glClientWaitSync", kClientWaitSync, toProc(&clientWaitSync)},
+            {"glCreateProgram", kCreateProgram, toProc(&createProgram)},
+            {"glCreateShader", kCreateShader, toProc(&createShader)},
+            {"glFenceSync", kFenceSync, toProc(&fenceSync)},
+            {"glGenBuffers", kGenBuffers, toProc(&genNames<kGenBuffers>)},
+            {"glGenFramebuffers", kGenFramebuffers, toProc(&genNames<kGenFramebuffers>)},
+            {"glGenQueries", kGenQueries, toProc(&genNames<kGenQueries>)},
+            {"glGenRenderbuffers", kGenRenderbuffers, toProc(&genNames<kGenRenderbuffers>)},
+            {"glGenTextures", kGenTextures, toProc(&genNames<kGenTextures>)},
+            {"glGenTransformFeedbacks", kGenTransformFeedbacks, toProc(&genNames<kGenTransformFeedbacks>)},
+            {"glGenVertexArrays", kGenVertexArrays, toProc(&genNames<kGenVertexArrays>)},
+            {"glGetIntegerv", kGetIntegerv, toProc(&getIntegerv)},
+            {"glGetProgramInfoLog", kGetProgramInfoLog, toProc(&getInfoLog<kGetProgramInfoLog>)},
+            {"glGetProgramiv", kGetProgramiv, toProc(&getObjectiv<kGetProgramiv>)},
+            {"glGetQueryObjecti64v", kGetQueryObjecti64v, toProc(&getQueryObject<kGetQueryObjecti64v, GLint64>)},
+            {"glGetQueryObjectiv", kGetQueryObjectiv, toProc(&getQueryObject<kGetQueryObjectiv, GLint>)},
+            {"glGetQueryObjectui64v", kGetQueryObjectui64v, toProc(&getQueryObject<kGetQueryObjectui64v, GLuint64>)},
+            {"glGetQueryObjectuiv", kGetQueryObjectuiv, toProc(&getQueryObject<kGetQueryObjectuiv, GLuint>)},
+            {"glGetShaderInfoLog", kGetShaderInfoLog, toProc(&getInfoLog<kGetShaderInfoLog>)},
+            {"glGetShaderiv", kGetShaderiv, toProc(&getObjectiv<kGetShaderiv>)},
+            {"glGetString", kGetString, toProc(&getString)},
+            {"glGetStringi", kGetStringi, toProc(&getStringi)},
+            {"glGetUniformLocation", kGetUniformLocation, toProc(&getUniformLocation)},
+            {"glMapBufferRange", kMapBufferRange, toProc(&mapBufferRange)},
+            {"glUnmapBuffer", kUnmapBuffer, toProc(&unmapBuffer)}
+    }};
+
+    return kEntryPoints;
+}
+
+}  // namespace anonymous
+
+
+void * NullGL::getProcAddress(const char * name)
+{
+    for (const OwnEntryPoint & entryPoint : ownEntryPoints())
+    {
+        if (std::strcmp(entryPoint.name, name) == 0)
+        {
+            names[entryPoint.slot] = name;
+            return entryPoint.proc;
+        }
+    }
+
+    // glad asks again for functions that extensions share with the core.
+    std::size_t & slot = slots.try_emplace(name, kMaxEntryPoints).first->second;
+
+    if (slot == kMaxEntryPoints)
+    {
+        if (numGenericStubs == kNumGenericStubs)
+        {
+            slots.erase(name);
+            return nullptr;
+        }
+
+        slot = kNumOwnSlots + numGenericStubs++;
+        names[slot] = name;
+    }
+
+    return toProc(kGenericStubs[slot - kNumOwnSlots]);
+}
+
+
+std::vector<NullGL::CallCount> NullGL::getCallCounts()
+{
+    std::vector<CallCount> callCounts;
+
+    for (std::size_t i = 0UL; i != kMaxEntryPoints; ++i)
+    {
+        if (counts[i])
+        {
+            callCounts.push_back({names[i], counts[i]});
+        }
+    }
+
+    std::sort(callCounts.begin(), callCounts.end(), [](const CallCount & a, const CallCount & b)
+    {
+        return a.numCalls > b.numCalls;
+    });
+
+    return callCounts;
+}
+
+
+void NullGL::printCallCounts(std::size_t numFrames, double seconds, std::size_t numEntryPoints)
+{
+    std::vector<CallCount> callCounts = getCallCounts();
+
+    std::uint64_t numCalls = 0UL;
+
+    for (const CallCount & callCount : callCounts)
+    {
+        numCalls += callCount.numCalls;
+    }
+
+    double frames = std::max(1.0, static_cast<double>(numFrames));
+
+    std::cout << "[nullgl] " << numCalls << " calls in " << numFrames << " frames, "
+              << static_cast<double>(numCalls) / frames << " per frame, "
+              << (0.0 < seconds ? static_cast<double>(numCalls) / seconds : 0.0) << " per second\n";
+
+    for (std::size_t i = 0UL; i != std::min(numEntryPoints, callCounts.size()); ++i)
+    {
+        std::cout << "[nullgl]   " << callCounts[i].name << ' ' << static_cast<double>(callCounts[i].numCalls) / frames
+                  << " per frame\n";
+    }
+}
+
+
+void NullGL::resetCallCounts()
+{
+    counts.fill(0UL);
+}
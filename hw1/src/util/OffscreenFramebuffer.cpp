@@ -0,0 +1,55 @@
+#include <stdexcept>
+#include <string>
+
+#include "util/OffscreenFramebuffer.h"
+
+
+OffscreenFramebuffer::OffscreenFramebuffer(int width, int height) : width(width), height(height)
+{
+    glGenFramebuffers(1, &fbo);
+    glGenRenderbuffers(1, &colorBuffer);
+    glGenRenderbuffers(1, &depthStencilBuffer);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, depthStencilBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, 0U);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthStencilBuffer);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0U);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteRenderbuffers(1, &colorBuffer);
+        glDeleteRenderbuffers(1, &depthStencilBuffer);
+        throw std::runtime_error("OffscreenFramebuffer: incomplete framebuffer, status " + std::to_string(status));
+    }
+}
+
+
+OffscreenFramebuffer::~OffscreenFramebuffer() noexcept
+{
+    glDeleteFramebuffers(1, &fbo);
+    fbo = 0U;
+
+    glDeleteRenderbuffers(1, &colorBuffer);
+    colorBuffer = 0U;
+
+    glDeleteRenderbuffers(1, &depthStencilBuffer);
+    depthStencilBuffer = 0U;
+}
+
+
+void OffscreenFramebuffer::bind() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, width, height);
+}
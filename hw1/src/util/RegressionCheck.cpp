@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <utility>
+
+#include <sys/resource.h>
+
+#include "util/ImageFile.h"
+#include "util/RegressionCheck.h"
+
+
+RegressionCheck::RegressionCheck(std::string referenceDirectory, const Budget & budget)
+        : referenceDirectory(std::move(referenceDirectory)), budget(budget)
+{
+
+}
+
+
+bool RegressionCheck::compareFrame(const std::string & path,
+                                   const std::vector<std::uint8_t> & rgba,
+                                   int width,
+                                   int height)
+{
+    std::string name = std::filesystem::path(path).filename().string();
+
+    std::vector<std::uint8_t> reference;
+    int referenceWidth = 0;
+    int referenceHeight = 0;
+
+    if (!ImageFile::readPpm((std::filesystem::path(referenceDirectory) / name).string(),
+                            reference,
+                            referenceWidth,
+                            referenceHeight))
+    {
+        ++numMissing;
+        std::cout << "[regression] " << name << ": no reference in " << referenceDirectory << '\n';
+        return false;
+    }
+
+    ++numCompared;
+
+    if (referenceWidth != width || referenceHeight != height)
+    {
+        ++numMismatched;
+        std::cout << "[regression] " << name << ": " << width << 'x' << height << ", reference is "
+                  << referenceWidth << 'x' << referenceHeight << '\n';
+        return false;
+    }
+
+    double sumOfSquares = 0.0;
+
+    for (std::size_t i = 0UL; i != rgba.size(); i += 4UL)
+    {
+        for (std::size_t c = 0UL; c != 3UL; ++c)
+        {
+            double d = static_cast<double>(rgba[i + c]) - static_cast<double>(reference[i + c]);
+            sumOfSquares += d * d;
+        }
+    }
+
+    double error = std::sqrt(sumOfSquares / static_cast<double>(rgba.size() / 4UL * 3UL));
+    maxError = std::max(maxError, error);
+
+    if (budget.tolerance < error)
+    {
+        ++numMismatched;
+        std::cout << "[regression] " << name << ": rms error " << error << " exceeds " << budget.tolerance << '\n';
+        return false;
+    }
+
+    return true;
+}
+
+
+bool RegressionCheck::finish(std::size_t numFrames, double seconds) const
+{
+    bool passed = numMismatched == 0UL && numMissing == 0UL;
+
+    if (numCompared == 0UL)
+    {
+        passed = false;
+        std::cout << "[regression] no reference images in " << referenceDirectory << '\n';
+    }
+
+    double frameMilliseconds = numFrames ? seconds * 1000.0 / static_cast<double>(numFrames) : 0.0;
+    double memoryMegabytes = static_cast<double>(peakResidentBytes()) / (1024.0 * 1024.0);
+
+    if (0.0 < budget.frameMilliseconds && budget.frameMilliseconds < frameMilliseconds)
+    {
+        passed = false;
+        std::cout << "[regression] " << frameMilliseconds << " ms per frame exceeds the budget of "
+                  << budget.frameMilliseconds << " ms\n";
+    }
+
+    if (0.0 < budget.memoryMegabytes && budget.memoryMegabytes < memoryMegabytes)
+    {
+        passed = false;
+        std::cout << "[regression] peak memory " << memoryMegabytes << " MB exceeds the budget of "
+                  << budget.memoryMegabytes << " MB\n";
+    }
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "[regression] " << (passed ? "passed" : "FAILED") << ": "
+              << numCompared - numMismatched << " of " << numCompared + numMissing << " frames match (max rms error " << maxError << "), "
+              << frameMilliseconds << " ms per frame, " << memoryMegabytes << " MB peak memory\n"
+              << std::defaultfloat;
+
+    return passed;
+}
+
+
+std::size_t RegressionCheck::peakResidentBytes()
+{
+    rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+
+#ifdef __APPLE__
+    return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+    // Kilobytes on Linux.
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024UL;
+#endif
+}
@@ -2,11 +2,15 @@
 #define APP_H
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include <glm/glm.hpp>
 
 #include "app/Window.h"
+#include "util/FrameCapture.h"
+#include "util/OffscreenFramebuffer.h"
+#include "util/RegressionCheck.h"
 
 
 class Shader;
@@ -16,9 +20,46 @@ class Renderable;
 class App : private Window
 {
 public:
-    static App & getInstance();
+    /// How to run, from the command line (see main.cpp).
+    struct Options
+    {
+        // Render into an OffscreenFramebuffer behind a hidden window, without waiting for vsync.
+        bool offscreen {false};
 
-    void run();
+        // Frames to render before run() returns; 0 renders until the window closes.
+        // With a frame count, every frame advances the scene by kFixedTimeStep, so runs are reproducible.
+        int numFrames {0};
+
+        // Save every frame to this directory as 000000.png, 000001.png, ...; empty saves nothing.
+        std::string captureDirectory;
+
+        // Save PPM instead of PNG files.
+        bool ppm {false};
+
+        // Compare every frame with the reference PPM of the same name in this directory instead of saving it;
+        // empty compares nothing. See RegressionCheck.
+        std::string referenceDirectory;
+        RegressionCheck::Budget budget;
+
+        // Write a timeline of the zones of all threads to this file as Chrome trace JSON (see Timeline);
+        // empty records nothing.
+        std::string timelinePath;
+
+        // Report the counters of FrameCounters once per second: to stdout, and/or as CSV to this file if not empty.
+        bool printCounters {false};
+        std::string countersPath;
+
+        // Fail the run if a steady-state frame allocates inside App::render or the per-frame input handling
+        // (see AllocationTracker; needs the TRACK_ALLOCATIONS CMake option).
+        bool checkAllocations {false};
+    };
+
+public:
+    /// options only take effect on the first call.
+    static App & getInstance(const Options & options);
+
+    /// Returns false if the frames or their performance regressed (see Options::referenceDirectory).
+    bool run();
 
 private:
     static void cursorPosCallback(GLFWwindow *, double, double);
@@ -35,16 +76,33 @@ private:
     static constexpr int kWindowWidth {1000};
     static constexpr int kWindowHeight {1000};
 
+    // Seconds per frame of runs with a fixed frame count.
+    static constexpr double kFixedTimeStep {1.0 / 60.0};
+
+    // Frames before the steady state, in which caches and buffers grow to their working sizes (see AllocationTracker).
+    static constexpr int kWarmupFrames {10};
+
 private:
-    App();
+    explicit App(const Options & options);
 
     void render();
 
+    Options options;
+
+    // Set in offscreen mode, where it replaces the window's framebuffer.
+    std::unique_ptr<OffscreenFramebuffer> pOffscreenFramebuffer;
+
+    // Set if options.captureDirectory or options.referenceDirectory is given.
+    std::unique_ptr<FrameCapture> pFrameCapture;
+    std::unique_ptr<RegressionCheck> pRegressionCheck;
+    int numRenderedFrames {0};
+
     // Shaders.
     // In principle, a shader could be reused across multiple objects.
     // Thus, these shaders are not designed as members of object classes.
     std::unique_ptr<Shader> pTriangleShader {nullptr};
     std::unique_ptr<Shader> pCircleShader {nullptr};
+    std::unique_ptr<Shader> pCircleReplayShader {nullptr};
 
     // Objects to render.
     std::vector<std::unique_ptr<Renderable>> shapes;
@@ -18,7 +18,8 @@ public:
     Window & operator=(Window &&) = delete;
 
 protected:
-    Window(int width, int height, const char * title, GLFWmonitor * monitor, GLFWwindow * share);
+    /// A hidden window (!visible) still provides the OpenGL context, e.g. to render into framebuffer objects.
+    Window(int width, int height, const char * title, GLFWmonitor * monitor, GLFWwindow * share, bool visible = true);
     ~Window() noexcept;
 
     GLFWwindow * pWindow {nullptr};
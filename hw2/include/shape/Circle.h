@@ -14,17 +14,44 @@ class Shader;
 
 
 // Circle[s] class, this class represents MULTIPLE circles.
+// If pReplayShader is given (replay.vert.glsl), the tessellated outlines are captured once by transform feedback,
+// without model, and every frame redraws that buffer with replay.vert.glsl applying model to the captured centers.
 class Circle : public Renderable, public GLShape
 {
 public:
-    Circle(Shader * shader, const std::vector<glm::vec3> & parameters);
+    Circle(Shader * shader, const std::vector<glm::vec3> & parameters, Shader * pReplayShader = nullptr);
 
-    ~Circle() noexcept override = default;
+    ~Circle() noexcept override;
 
     void render(float timeElapsedSinceLastFrame, bool animate) override;
 
+    /// The circle parameters, and the capture buffer.
+    [[nodiscard]] Memory getMemory() const override;
+
 private:
+    // Interleaved "gl_Position" and "center" outputs of circle.tese.glsl.
+    struct CapturedVertex
+    {
+        glm::vec4 position;
+        glm::vec2 center;
+    };
+
+    void drawPatches(const glm::mat3 & patchModel);
+
+    // Tessellates with an identity model and records the result into captureVbo, without drawing.
+    void capture();
+
+    void replay();
+
     std::vector<glm::vec3> parameters;
+
+    // Transform feedback cache, unused if pReplayShader is nullptr.
+    Shader * pReplayShader {nullptr};
+    GLuint feedback {0U};
+    GLuint captureVao {0U};
+    GLuint captureVbo {0U};
+    GLsizeiptr captureCapacity {0};
+    bool captured {false};
 };
 
 
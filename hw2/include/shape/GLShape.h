@@ -3,6 +3,7 @@
 #ifndef GLSHAPE_H
 #define GLSHAPE_H
 
+#include <cstddef>
 #include <vector>
 
 #include <glad/glad.h>
@@ -19,6 +20,14 @@ class Shader;
 /// should public-inherit this class.
 class GLShape
 {
+public:
+    /// Bytes held on either side, for FrameCounters.
+    struct Memory
+    {
+        std::size_t cpuBytes {0UL};
+        std::size_t gpuBytes {0UL};
+    };
+
 public:
     GLShape() = delete;
     GLShape(const GLShape &) = delete;
@@ -26,6 +35,9 @@ public:
 
     virtual ~GLShape() noexcept = 0;
 
+    /// Vertex data kept in memory and the buffers allocated for this shape.
+    [[nodiscard]] virtual Memory getMemory() const = 0;
+
 protected:
     explicit GLShape(Shader * shader, const glm::mat3 & model = glm::mat3(1.0f));
 
@@ -31,6 +31,8 @@ public:
 
     void render(float timeElapsedSinceLastFrame, bool animate) override;
 
+    [[nodiscard]] Memory getMemory() const override;
+
 private:
     std::vector<Vertex> vertices;
 };
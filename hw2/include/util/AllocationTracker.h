@@ -0,0 +1,97 @@
+#ifndef ALLOCATIONTRACKER_H
+#define ALLOCATIONTRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/// Counts heap allocations, to drive steady-state frames to zero of them.
+///
+/// With the TRACK_ALLOCATIONS CMake option, the global operator new and delete count every allocation and free
+/// of every thread; without it, all counts stay zero (see isEnabled()).
+/// Scope counts the allocations of the calling thread in a scope; endFrame() those of all threads in a frame.
+///
+/// Code that should not allocate once the program reaches a steady state (e.g. App::render)
+/// runs inside a CheckedScope. After startSteadyState(), allocations inside one are flagged,
+/// and every allocation records its call site, so getCallSites() shows what is left to remove.
+class AllocationTracker
+{
+public:
+    struct Counts
+    {
+        std::uint64_t numAllocations {0UL};
+        std::uint64_t numBytes {0UL};
+        std::uint64_t numFrees {0UL};
+    };
+
+    /// Allocations since startSteadyState() that share a call stack.
+    struct CallSite
+    {
+        // Innermost function outside the allocator and the standard library, as symbol+offset or file+offset.
+        std::string location;
+
+        std::uint64_t numAllocations {0UL};
+        std::uint64_t numBytes {0UL};
+
+        // Those inside a CheckedScope, and the name of that scope.
+        std::uint64_t numChecked {0UL};
+        const char * pScope {nullptr};
+    };
+
+    /// Counts the allocations of the calling thread from construction on.
+    class Scope
+    {
+    public:
+        Scope();
+
+        [[nodiscard]] Counts getCounts() const;
+
+    private:
+        Counts begin;
+    };
+
+    /// Scope that must not allocate in the steady state. Scopes nest; the outermost one names the allocations.
+    class CheckedScope
+    {
+    public:
+        /// name must be a string literal.
+        explicit CheckedScope(const char * name);
+
+        ~CheckedScope() noexcept;
+
+        CheckedScope(const CheckedScope &) = delete;
+        CheckedScope(CheckedScope &&) = delete;
+        CheckedScope & operator=(const CheckedScope &) = delete;
+        CheckedScope & operator=(CheckedScope &&) = delete;
+
+    private:
+        const char * pOuter {nullptr};
+    };
+
+public:
+    /// Whether this build counts allocations (the TRACK_ALLOCATIONS CMake option).
+    [[nodiscard]] static bool isEnabled();
+
+    /// Starts flagging allocations inside checked scopes and recording call sites.
+    static void startSteadyState();
+
+    /// Counts of all threads since the previous call.
+    static Counts endFrame();
+
+    /// Counts of all threads since the program started.
+    [[nodiscard]] static Counts getTotal();
+
+    /// Allocations inside checked scopes since startSteadyState().
+    [[nodiscard]] static std::uint64_t getNumChecked();
+
+    /// The maxSites call sites that allocated the most bytes since startSteadyState().
+    [[nodiscard]] static std::vector<CallSite> getCallSites(std::size_t maxSites);
+
+    /// Prints the allocations per steady-state frame, those inside checked scopes, and the top call sites by bytes.
+    static void printReport(std::size_t numSteadyFrames, std::size_t maxSites = 10UL);
+};
+
+
+#endif  // ALLOCATIONTRACKER_H
@@ -0,0 +1,115 @@
+#ifndef GLSTATE_H
+#define GLSTATE_H
+
+#include <cstddef>
+
+#include <glad/glad.h>
+
+
+/// Shadow copy of the OpenGL state the shapes change most often:
+/// the current program, vertex array, array and element array buffers, patch size, polygon mode and depth state.
+/// A call that would set the value the context already holds is dropped.
+///
+/// Only state changed through this class is known; after changing any of it directly,
+/// call invalidate() (the next call of each kind is then issued unconditionally).
+/// Must only be used from the thread that owns the context.
+class GLState
+{
+public:
+    /// Calls forwarded to OpenGL and calls dropped since the last resetStats().
+    struct Stats
+    {
+        std::size_t numIssued {0UL};
+        std::size_t numFiltered {0UL};
+    };
+
+public:
+    static GLState & getInstance();
+
+    GLState(const GLState &) = delete;
+    GLState(GLState &&) = delete;
+    GLState & operator=(const GLState &) = delete;
+    GLState & operator=(GLState &&) = delete;
+
+    ~GLState() noexcept = default;
+
+    void useProgram(GLuint program);
+
+    void bindVertexArray(GLuint vao);
+
+    /// GL_ARRAY_BUFFER and GL_ELEMENT_ARRAY_BUFFER are filtered; other targets are always issued.
+    void bindBuffer(GLenum target, GLuint buffer);
+
+    /// glPatchParameteri(GL_PATCH_VERTICES, count).
+    void setPatchVertices(GLint count);
+
+    /// Vertices per patch; the OpenGL default of 3 until set.
+    [[nodiscard]] GLint getPatchVertices() const { return patchVertices.known ? patchVertices.value : 3; }
+
+    /// glPolygonMode(GL_FRONT_AND_BACK, mode).
+    void setPolygonMode(GLenum mode);
+
+    void setDepthTest(bool enabled);
+
+    void setDepthFunc(GLenum func);
+
+    void setDepthMask(bool enabled);
+
+    /// Delete the object, and forget it if it is bound (deleting a bound object unbinds it).
+    void deleteProgram(GLuint program);
+    void deleteVertexArray(GLuint vao);
+    void deleteBuffer(GLuint buffer);
+
+    /// Forgets all shadowed state.
+    void invalidate();
+
+    [[nodiscard]] const Stats & getStats() const { return stats; }
+
+    void resetStats() { stats = Stats(); }
+
+private:
+    /// A shadowed value, unknown until first set.
+    template <typename T>
+    struct Slot
+    {
+        T value {};
+        bool known {false};
+    };
+
+private:
+    GLState() = default;
+
+    /// Whether setting slot to value changes anything; records value and counts the call either way.
+    template <typename T>
+    bool changes(Slot<T> & slot, T value)
+    {
+        if (slot.known && slot.value == value)
+        {
+            ++stats.numFiltered;
+            return false;
+        }
+
+        slot.value = value;
+        slot.known = true;
+        ++stats.numIssued;
+        return true;
+    }
+
+    Slot<GLuint> program;
+    Slot<GLuint> vertexArray;
+    Slot<GLuint> arrayBuffer;
+
+    // Part of the vertex array state: unknown again whenever another vertex array is bound.
+    Slot<GLuint> elementArrayBuffer;
+
+    Slot<GLint> patchVertices;
+    Slot<GLenum> polygonMode;
+    Slot<bool> depthTest;
+    Slot<GLenum> depthFunc;
+    Slot<bool> depthMask;
+
+    Stats stats;
+};
+
+
+#endif  // GLSTATE_H
@@ -0,0 +1,36 @@
+#ifndef OFFSCREENFRAMEBUFFER_H
+#define OFFSCREENFRAMEBUFFER_H
+
+#include <glad/glad.h>
+
+
+/// Framebuffer object with an RGBA8 color and a 24-bit depth / 8-bit stencil renderbuffer,
+/// standing in for the window's default framebuffer when nothing is shown on screen.
+class OffscreenFramebuffer
+{
+public:
+    /// Throws std::runtime_error if the framebuffer is incomplete.
+    OffscreenFramebuffer(int width, int height);
+
+    OffscreenFramebuffer(const OffscreenFramebuffer &) = delete;
+    OffscreenFramebuffer & operator=(const OffscreenFramebuffer &) = delete;
+
+    ~OffscreenFramebuffer() noexcept;
+
+    /// Draws and reads go to this framebuffer from now on.
+    void bind() const;
+
+    [[nodiscard]] int getWidth() const { return width; }
+    [[nodiscard]] int getHeight() const { return height; }
+
+private:
+    int width {0};
+    int height {0};
+
+    GLuint fbo {0U};
+    GLuint colorBuffer {0U};
+    GLuint depthStencilBuffer {0U};
+};
+
+
+#endif  // OFFSCREENFRAMEBUFFER_H
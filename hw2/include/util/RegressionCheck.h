@@ -0,0 +1,53 @@
+#ifndef REGRESSIONCHECK_H
+#define REGRESSIONCHECK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/// Golden-image and performance check for batch runs (see main.cpp, --compare).
+///
+/// Frames are compared with reference PPMs of the same name captured earlier from a known-good build
+/// (--capture DIR --ppm, same --frames), by root-mean-square error over the RGB channels in 0..255.
+/// The run fails if any frame exceeds the tolerance or has no reference,
+/// or if the mean frame time or the peak resident memory exceeds its budget.
+class RegressionCheck
+{
+public:
+    /// Zero budgets are not checked.
+    struct Budget
+    {
+        double tolerance {1.0};
+        double frameMilliseconds {0.0};
+        double memoryMegabytes {0.0};
+    };
+
+public:
+    RegressionCheck(std::string referenceDirectory, const Budget & budget);
+
+    /// FrameCapture handler: compares rgba with the reference named as path's file name.
+    /// Returns false if there is no such reference or the frame exceeds the tolerance.
+    /// Runs on the capture's writer thread; call finish() only after FrameCapture::finish().
+    bool compareFrame(const std::string & path, const std::vector<std::uint8_t> & rgba, int width, int height);
+
+    /// Checks the budgets against numFrames rendered in seconds and prints a summary.
+    /// Returns false if anything regressed.
+    bool finish(std::size_t numFrames, double seconds) const;
+
+    /// Peak resident set size of this process.
+    static std::size_t peakResidentBytes();
+
+private:
+    std::string referenceDirectory;
+    Budget budget;
+
+    std::size_t numCompared {0UL};
+    std::size_t numMismatched {0UL};
+    std::size_t numMissing {0UL};
+    double maxError {0.0};
+};
+
+
+#endif  // REGRESSIONCHECK_H
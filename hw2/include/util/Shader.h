@@ -7,10 +7,14 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include "util/GLState.h"
+#include "util/Timeline.h"
+
 
 class Shader
 {
@@ -24,6 +28,8 @@ public:
 
     Shader(const char * vertShaderPath, const char * fragShaderPath)
     {
+        Timeline::Zone zone {"Shader::Shader"};
+
         // 1. retrieve the vertexShader/fragmentShader source code from filePath
 
         std::string vertShaderCode;
@@ -82,6 +88,8 @@ public:
 
     Shader(const char * vertShaderPath, const char * tescShaderPath, const char * teseShaderPath, const char * fragShaderPath)
     {
+        Timeline::Zone zone {"Shader::Shader"};
+
         // 1. retrieve the vertShader/fragShader source code from filePath
 
         std::string vertShaderCode;
@@ -200,12 +208,24 @@ public:
 
     ~Shader()
     {
-        glDeleteProgram(shaderProgram);
+        GLState::getInstance().deleteProgram(shaderProgram);
     }
 
     void use() const
     {
-        glUseProgram(shaderProgram);
+        GLState::getInstance().useProgram(shaderProgram);
+    }
+
+    /// Records the named outputs of the last pre-rasterization stage, interleaved in this order,
+    /// into transform feedback buffer 0, and relinks the program (which resets its uniforms).
+    void setTransformFeedbackVaryings(const std::vector<const char *> & varyings) const
+    {
+        glTransformFeedbackVaryings(shaderProgram,
+                                    static_cast<GLsizei>(varyings.size()),
+                                    varyings.data(),
+                                    GL_INTERLEAVED_ATTRIBS);
+        glLinkProgram(shaderProgram);
+        checkCompileErrors(shaderProgram, "PROGRAM");
     }
 
     void setBool(const std::string & name, bool value) const
@@ -1,23 +1,42 @@
+#include <algorithm>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
 #include "app/App.h"
 #include "shape/Circle.h"
 #include "shape/Triangle.h"
+#include "util/AllocationTracker.h"
+#include "util/FrameCounters.h"
+#include "util/GLState.h"
+#include "util/NullGL.h"
 #include "util/Shader.h"
+#include "util/Timeline.h"
 
 
-App & App::getInstance()
+App & App::getInstance(const Options & options)
 {
-    static App instance;
+    static App instance(options);
     return instance;
 }
 
 
-void App::run()
+bool App::run()
 {
-    while (!glfwWindowShouldClose(pWindow))
+    double startTimeStamp = glfwGetTime();
+
+#ifdef NULL_GL
+    NullGL::resetCallCounts();
+#endif
+
+    while (!glfwWindowShouldClose(pWindow) && (options.numFrames == 0 || numRenderedFrames < options.numFrames))
     {
+        Timeline::Zone frameZone {"frame"};
+
         // Per-frame logic
         perFrameTimeLogic(pWindow);
         processKeyInput(pWindow);
@@ -27,16 +46,97 @@ void App::run()
         glClear(GL_COLOR_BUFFER_BIT);
 
         render();
+        AllocationTracker::Counts allocations = AllocationTracker::endFrame();
+        FrameCounters::getInstance().add(FrameCounters::kAllocations, allocations.numAllocations);
+        FrameCounters::getInstance().add(FrameCounters::kAllocatedBytes, allocations.numBytes);
+        FrameCounters::getInstance().endFrame(glfwGetTime());
+
+        if (pFrameCapture)
+        {
+            std::ostringstream name;
+            name << std::setw(6) << std::setfill('0') << numRenderedFrames
+                 << (options.ppm || pRegressionCheck ? ".ppm" : ".png");
+            pFrameCapture->capture((std::filesystem::path(options.captureDirectory) / name.str()).string());
+        }
+
+        ++numRenderedFrames;
+
+        if (numRenderedFrames == kWarmupFrames)
+        {
+            AllocationTracker::startSteadyState();
+        }
 
         // Check and call events and swap the buffers
-        glfwSwapBuffers(pWindow);
+        // (offscreen, nothing is shown, so there is nothing to swap)
+        if (!options.offscreen)
+        {
+            Timeline::Zone zone {"glfwSwapBuffers"};
+            glfwSwapBuffers(pWindow);
+        }
+
         glfwPollEvents();
     }
+
+    // Frame times include the GPU's work.
+    glFinish();
+    double seconds = glfwGetTime() - startTimeStamp;
+
+    if (Timeline::isEnabled())
+    {
+        Timeline::stop();
+
+        if (Timeline::write(options.timelinePath))
+        {
+            std::cout << "[timeline] " << Timeline::size() << " zones written to " << options.timelinePath << '\n';
+        }
+        else
+        {
+            std::cout << "[timeline] failed to write " << options.timelinePath << '\n';
+        }
+    }
+
+#ifdef NULL_GL
+    NullGL::printCallCounts(static_cast<std::size_t>(numRenderedFrames), seconds);
+#endif
+
+    bool allocationFree = true;
+
+    if (AllocationTracker::isEnabled())
+    {
+        AllocationTracker::printReport(static_cast<std::size_t>(std::max(numRenderedFrames - kWarmupFrames, 0)));
+        allocationFree = !options.checkAllocations || AllocationTracker::getNumChecked() == 0UL;
+    }
+    else if (options.checkAllocations)
+    {
+        std::cout << "[alloc] --check-allocations needs a build with the TRACK_ALLOCATIONS CMake option\n";
+        allocationFree = false;
+    }
+
+    if (pFrameCapture)
+    {
+        pFrameCapture->finish();
+    }
+
+    if (pRegressionCheck)
+    {
+        return pRegressionCheck->finish(static_cast<std::size_t>(numRenderedFrames), seconds) && allocationFree;
+    }
+
+    if (pFrameCapture)
+    {
+        FrameCapture::Stats stats = pFrameCapture->getStats();
+        std::cout << "[capture] " << stats.numHandled << " of " << stats.numCaptured << " frames written to "
+                  << options.captureDirectory << ", " << stats.numStalls << " readback stalls\n";
+    }
+
+    return allocationFree;
 }
 
 
 void App::cursorPosCallback(GLFWwindow * window, double xpos, double ypos)
 {
+    AllocationTracker::CheckedScope allocationScope {"App::cursorPosCallback"};
+
     App & app = *reinterpret_cast<App *>(glfwGetWindowUserPointer(window));
 
     app.mousePos.x = xpos;
@@ -103,19 +203,31 @@ void App::perFrameTimeLogic(GLFWwindow * window)
     App & app = *reinterpret_cast<App *>(glfwGetWindowUserPointer(window));
 
     double currentFrame = glfwGetTime();
-    app.timeElapsedSinceLastFrame = currentFrame - app.lastFrameTimeStamp;
+    app.timeElapsedSinceLastFrame = app.options.numFrames ? kFixedTimeStep : currentFrame - app.lastFrameTimeStamp;
     app.lastFrameTimeStamp = currentFrame;
 }
 
 
 void App::processKeyInput(GLFWwindow * window)
 {
-
+    Timeline::Zone zone {"processKeyInput"};
+    AllocationTracker::CheckedScope allocationScope {"App::processKeyInput"};
 }
 
 
-App::App() : Window(kWindowWidth, kWindowHeight, kWindowName, nullptr, nullptr)
+App::App(const Options & options)
+        : Window(kWindowWidth, kWindowHeight, kWindowName, nullptr, nullptr, !options.offscreen),
+          options(options)
 {
+    // Before loading anything, so the timeline shows the shader compiles.
+    if (!options.timelinePath.empty())
+    {
+        Timeline::setThreadName("main");
+        Timeline::start();
+    }
+
+    FrameCounters::getInstance().report(options.printCounters, options.countersPath);
+
     // GLFW boilerplate.
     glfwSetWindowUserPointer(pWindow, this);
     glfwSetCursorPosCallback(pWindow, cursorPosCallback);
@@ -126,7 +238,37 @@ App::App() : Window(kWindowWidth, kWindowHeight, kWindowName, nullptr, nullptr)
 
     // Global OpenGL pipeline settings
     glViewport(0, 0, kWindowWidth, kWindowHeight);
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+    if (options.offscreen)
+    {
+        // The hidden window's framebuffer is never shown; render at full speed into one of our own.
+        pOffscreenFramebuffer = std::make_unique<OffscreenFramebuffer>(kWindowWidth, kWindowHeight);
+        pOffscreenFramebuffer->bind();
+        glfwSwapInterval(0);
+    }
+
+    if (!options.referenceDirectory.empty())
+    {
+        pRegressionCheck = std::make_unique<RegressionCheck>(options.referenceDirectory, options.budget);
+        pFrameCapture = std::make_unique<FrameCapture>(
+                kWindowWidth,
+                kWindowHeight,
+                [check = pRegressionCheck.get()](const std::string & path,
+                                                 const std::vector<std::uint8_t> & rgba,
+                                                 int width,
+                                                 int height)
+                {
+                    return check->compareFrame(path, rgba, width, height);
+                }
+        );
+    }
+    else if (!options.captureDirectory.empty())
+    {
+        std::filesystem::create_directories(options.captureDirectory);
+        pFrameCapture = std::make_unique<FrameCapture>(kWindowWidth, kWindowHeight);
+    }
+
+    GLState::getInstance().setPolygonMode(GL_FILL);
     glLineWidth(1.0f);
     glPointSize(1.0f);
 
@@ -137,6 +279,8 @@ App::App() : Window(kWindowWidth, kWindowHeight, kWindowName, nullptr, nullptr)
                                              "src/shader/circle.tesc.glsl",
                                              "src/shader/circle.tese.glsl",
                                              "src/shader/circle.frag.glsl");
+    pCircleReplayShader = std::make_unique<Shader>("src/shader/replay.vert.glsl",
+                                                   "src/shader/circle.frag.glsl");
 
     shapes.emplace_back(
             std::make_unique<Triangle>(
@@ -158,7 +302,8 @@ App::App() : Window(kWindowWidth, kWindowHeight, kWindowName, nullptr, nullptr)
                             {200.0f, 326.8f, 200.0f},
                             {800.0f, 326.8f, 300.0f},
                             {500.0f, 846.4f, 400.0f}
-                    }
+                    },
+                    pCircleReplayShader.get()
             )
     );
 }
@@ -166,20 +311,27 @@ App::App() : Window(kWindowWidth, kWindowHeight, kWindowName, nullptr, nullptr)
 
 void App::render()
 {
+    AllocationTracker::CheckedScope allocationScope {"App::render"};
+
     auto t = static_cast<float>(timeElapsedSinceLastFrame);
 
     // Update all shader uniforms.
-    pTriangleShader->use();
-    pTriangleShader->setFloat("windowWidth", kWindowWidth);
-    pTriangleShader->setFloat("windowHeight", kWindowHeight);
+    {
+        Timeline::Zone zone {"uniforms"};
+
+        pTriangleShader->use();
+        pTriangleShader->setFloat("windowWidth", kWindowWidth);
+        pTriangleShader->setFloat("windowHeight", kWindowHeight);
 
-    pCircleShader->use();
-    pCircleShader->setFloat("windowWidth", kWindowWidth);
-    pCircleShader->setFloat("windowHeight", kWindowHeight);
+        pCircleShader->use();
+        pCircleShader->setFloat("windowWidth", kWindowWidth);
+        pCircleShader->setFloat("windowHeight", kWindowHeight);
+    }
 
     // Render all shapes.
     for (auto & s : shapes)
     {
+        Timeline::Zone zone {"Renderable::render"};
         s->render(t, animationEnabled);
     }
 }
@@ -9,6 +9,9 @@ uniform mat3 model;
 uniform float windowWidth;
 uniform float windowHeight;
 
+// For transform feedback (see Circle): replay.vert.glsl moves the captured outline with its center.
+out vec2 center;
+
 void main()
 {
     vec4 params = gl_in[0].gl_Position;
@@ -17,6 +20,7 @@ void main()
                           2.0f * params.y / windowHeight - 1.0f,
                           1.0f);
     c.z = 0.0f;
+    center = c.xy;
 
     // A circle is scaled into an oval when the viewport is not a perfect square.
     float a = 2.0f * params.z / windowWidth;
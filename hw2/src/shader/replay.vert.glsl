@@ -0,0 +1,14 @@
+#version 410 core
+
+// Clip-space positions and circle centers captured by transform feedback with an identity model (see Circle).
+layout (location = 0) in vec4 aPosition;
+layout (location = 1) in vec2 aCenter;
+
+uniform mat3 model;
+
+void main()
+{
+    // As in circle.tese.glsl, model moves the center only; the outline keeps its shape around it.
+    vec3 c = model * vec3(aCenter, 1.0f);
+    gl_Position = vec4(aPosition.xy - aCenter + c.xy, 0.0f, 1.0f);
+}
@@ -1,14 +1,19 @@
+#include <cstddef>
+
 #include <glm/glm.hpp>
 #include <glm/gtx/matrix_transform_2d.hpp>
 
 #include "shape/Circle.h"
+#include "util/FrameCounters.h"
+#include "util/GLState.h"
 #include "util/Shader.h"
 
 
-Circle::Circle(Shader * shader, const std::vector<glm::vec3> & parameters) : GLShape(shader), parameters(parameters)
+Circle::Circle(Shader * shader, const std::vector<glm::vec3> & parameters, Shader * pReplayShader)
+        : GLShape(shader), parameters(parameters), pReplayShader(pReplayShader)
 {
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    GLState::getInstance().bindVertexArray(vao);
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, vbo);
 
     // Vertex coordinate attribute array "layout (position = 0) in vec3 aPos"
     glEnableVertexAttribArray(0);
@@ -23,9 +28,63 @@ Circle::Circle(Shader * shader, const std::vector<glm::vec3> & parameters) : GLS
                  static_cast<GLsizei>(parameters.size() * sizeof(glm::vec3)),
                  parameters.data(),
                  GL_STATIC_DRAW);
+    FrameCounters::getInstance().countUpload(parameters.size() * sizeof(glm::vec3));
+
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::getInstance().bindVertexArray(0);
+
+    if (!pReplayShader)
+    {
+        return;
+    }
+
+    pShader->setTransformFeedbackVaryings({"gl_Position", "center"});
+
+    // Each circle is one isoline of at most GL_MAX_TESS_GEN_LEVEL segments, i.e., twice as many line vertices.
+    GLint maxLevel {64};
+    glGetIntegerv(GL_MAX_TESS_GEN_LEVEL, &maxLevel);
+
+    captureCapacity = static_cast<GLsizeiptr>(parameters.size() * 2UL * maxLevel * sizeof(CapturedVertex));
+
+    glGenBuffers(1, &captureVbo);
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, captureVbo);
+    glBufferData(GL_ARRAY_BUFFER, captureCapacity, nullptr, GL_STATIC_DRAW);
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // The capture buffer stays attached to the transform feedback object,
+    // which also remembers how many vertices were written (see glDrawTransformFeedback).
+    glGenTransformFeedbacks(1, &feedback);
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, feedback);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, captureVbo);
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    // "layout (location = 0) in vec4 aPosition" and "layout (location = 1) in vec2 aCenter" in replay.vert.glsl
+    glGenVertexArrays(1, &captureVao);
+    GLState::getInstance().bindVertexArray(captureVao);
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, captureVbo);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(CapturedVertex),
+                          reinterpret_cast<void *>(offsetof(CapturedVertex, position)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(CapturedVertex),
+                          reinterpret_cast<void *>(offsetof(CapturedVertex, center)));
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::getInstance().bindVertexArray(0);
+}
+
+
+Circle::~Circle() noexcept
+{
+    glDeleteTransformFeedbacks(1, &feedback);
+    GLState::getInstance().deleteVertexArray(captureVao);
+    GLState::getInstance().deleteBuffer(captureVbo);
+}
+
+
+GLShape::Memory Circle::getMemory() const
+{
+    std::size_t parameterBytes = parameters.size() * sizeof(glm::vec3);
+    return {parameters.capacity() * sizeof(glm::vec3), parameterBytes + static_cast<std::size_t>(captureCapacity)};
 }
 
 
@@ -36,17 +95,62 @@ void Circle::render(float timeElapsedSinceLastFrame, bool animate)
         model = glm::rotate(model, timeElapsedSinceLastFrame);
     }
 
+    if (!pReplayShader)
+    {
+        drawPatches(model);
+        return;
+    }
+
+    // The capture does not depend on model, so one serves every later frame, animated or not.
+    if (!captured)
+    {
+        capture();
+        captured = true;
+    }
+
+    replay();
+}
+
+
+void Circle::drawPatches(const glm::mat3 & patchModel)
+{
     pShader->use();
-    pShader->setMat3("model", model);
+    pShader->setMat3("model", patchModel);
 
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    GLState::getInstance().bindVertexArray(vao);
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, vbo);
 
-    glPatchParameteri(GL_PATCH_VERTICES, 1);
+    GLState::getInstance().setPatchVertices(1);
     glDrawArrays(GL_PATCHES,
                  0,                                          // start from index 0 in current VBO
                  static_cast<GLsizei>(parameters.size()));  // draw these number of elements
+    FrameCounters::getInstance().countDraw(GL_PATCHES, parameters.size());
+}
+
+
+void Circle::capture()
+{
+    // Record only; replay() draws the outlines with the current model.
+    glEnable(GL_RASTERIZER_DISCARD);
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, feedback);
+    glBeginTransformFeedback(GL_LINES);
+
+    drawPatches(glm::mat3(1.0f));
+
+    glEndTransformFeedback();
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
+    glDisable(GL_RASTERIZER_DISCARD);
+}
+
+
+void Circle::replay()
+{
+    pReplayShader->use();
+    pReplayShader->setMat3("model", model);
+
+    GLState::getInstance().bindVertexArray(captureVao);
+    glDrawTransformFeedback(GL_LINES, feedback);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    // The vertex count stays on the GPU.
+    FrameCounters::getInstance().countDraw(GL_LINES, 0UL);
 }
@@ -1,20 +1,26 @@
 /// STOP. You should not modify this file unless you KNOW what you are doing.
 
 #include "shape/GLShape.h"
+#include "util/FrameCounters.h"
+#include "util/GLState.h"
 
 
 GLShape::~GLShape() noexcept
 {
-    glDeleteVertexArrays(1, &vao);
+    FrameCounters::getInstance().removeShape(this);
+
+    GLState::getInstance().deleteVertexArray(vao);
     vao = 0U;
 
-    glDeleteBuffers(1, &vbo);
+    GLState::getInstance().deleteBuffer(vbo);
     vbo = 0U;
 }
 
 
 GLShape::GLShape(Shader * shader, const glm::mat3 & model) : pShader(shader), model(model)
 {
+    FrameCounters::getInstance().addShape(this);
+
     glGenVertexArrays(1, &vao);
     glGenBuffers(1, &vbo);
 }
@@ -22,6 +28,7 @@ GLShape::GLShape(Shader * shader, const glm::mat3 & model) : pShader(shader), mo
 
 GLShape::GLShape(GLShape && rhs) noexcept
 {
+    FrameCounters::getInstance().addShape(this);
     *this = std::move(rhs);
 }
 
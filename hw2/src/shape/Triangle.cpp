@@ -2,6 +2,8 @@
 #include <glm/gtx/matrix_transform_2d.hpp>
 
 #include "shape/Triangle.h"
+#include "util/FrameCounters.h"
+#include "util/GLState.h"
 #include "util/Shader.h"
 
 
@@ -13,8 +15,8 @@ Triangle::Triangle(
         : GLShape(shader, model),
           vertices(vertices)
 {
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    GLState::getInstance().bindVertexArray(vao);
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, vbo);
 
     // Vertex coordinate attribute array "layout (position = 0) in vec2 aPosition"
     glEnableVertexAttribArray(0);
@@ -38,9 +40,10 @@ Triangle::Triangle(
                  static_cast<GLsizei>(vertices.size() * sizeof(Vertex)),
                  vertices.data(),
                  GL_STATIC_DRAW);
+    FrameCounters::getInstance().countUpload(vertices.size() * sizeof(Vertex));
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::getInstance().bindVertexArray(0);
 }
 
 
@@ -54,13 +57,17 @@ void Triangle::render(float timeElapsedSinceLastFrame, bool animate)
     pShader->use();
     pShader->setMat3("model", model);
 
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    GLState::getInstance().bindVertexArray(vao);
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, vbo);
 
     glDrawArrays(GL_TRIANGLES,
                  0,                                       // start from index 0 in current VBO
                  static_cast<GLsizei>(vertices.size()));  // draw these number of elements
+    FrameCounters::getInstance().countDraw(GL_TRIANGLES, vertices.size());
+}
+
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+GLShape::Memory Triangle::getMemory() const
+{
+    return {vertices.capacity() * sizeof(Vertex), vertices.size() * sizeof(Vertex)};
 }
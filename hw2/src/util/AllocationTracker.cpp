@@ -0,0 +1,543 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <new>
+#include <sstream>
+
+#if __has_include(<execinfo.h>)
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#define ALLOCATION_TRACKER_BACKTRACE
+#endif
+
+#include "util/AllocationTracker.h"
+
+
+namespace
+{
+
+// Frames kept per call site, from the caller of operator new outwards.
+constexpr int kStackDepth {8};
+
+// Call sites kept; allocations from further ones are only counted. A power of two.
+constexpr std::size_t kMaxSites {4096UL};
+
+
+struct Site
+{
+    std::array<void *, kStackDepth> stack;
+    int depth;
+
+    std::uint64_t numAllocations;
+    std::uint64_t numBytes;
+    std::uint64_t numChecked;
+    const char * pScope;
+};
+
+
+// All of these are constant-initialized, so operator new may use them before main and during static destruction.
+std::atomic<std::uint64_t> numAllocations {0UL};
+std::atomic<std::uint64_t> numBytes {0UL};
+std::atomic<std::uint64_t> numFrees {0UL};
+std::atomic<std::uint64_t> numChecked {0UL};
+std::atomic<bool> steadyState {false};
+
+// Totals as of the previous endFrame() and as of startSteadyState().
+AllocationTracker::Counts frameBegin;
+AllocationTracker::Counts steadyBegin;
+
+std::mutex sitesMutex;
+std::array<Site, kMaxSites> sites {};
+std::size_t numSites {0UL};
+std::uint64_t numUnlisted {0UL};
+
+thread_local std::uint64_t tNumAllocations {0UL};
+thread_local std::uint64_t tNumBytes {0UL};
+thread_local std::uint64_t tNumFrees {0UL};
+thread_local const char * tScope {nullptr};
+
+// Set while the tracker allocates for itself (backtraces, symbols, reports); those allocations are not counted.
+thread_local bool tInsideTracker {false};
+
+
+struct Untracked
+{
+    Untracked() : wasInside(tInsideTracker)
+    {
+        tInsideTracker = true;
+    }
+
+    ~Untracked() noexcept
+    {
+        tInsideTracker = wasInside;
+    }
+
+    bool wasInside;
+};
+
+
+[[maybe_unused]] void recordSite(std::size_t size, void * caller, const char * pScope)
+{
+    Untracked untracked;
+
+    std::array<void *, kStackDepth> stack {};
+    int depth = 1;
+    stack[0] = caller;
+
+#ifdef ALLOCATION_TRACKER_BACKTRACE
+    // A few more frames for the tracker and operator new themselves, which start the backtrace.
+    std::array<void *, kStackDepth + 4> frames {};
+    int numFrames = backtrace(frames.data(), static_cast<int>(frames.size()));
+    int first = 0;
+
+    while (first != numFrames && frames[first] != caller)
+    {
+        ++first;
+    }
+
+    if (first != numFrames)
+    {
+        depth = std::min(numFrames - first, kStackDepth);
+        std::copy_n(frames.begin() + first, depth, stack.begin());
+    }
+#endif
+
+    std::size_t hash = 14695981039346656037UL;
+
+    for (int i = 0; i != depth; ++i)
+    {
+        hash = (hash ^ reinterpret_cast<std::uintptr_t>(stack[i])) * 1099511628211UL;
+    }
+
+    std::lock_guard lock(sitesMutex);
+
+    for (std::size_t probe = 0UL; probe != kMaxSites; ++probe)
+    {
+        Site & site = sites[(hash + probe) & (kMaxSites - 1UL)];
+
+        if (site.depth == 0)
+        {
+            // Keep the table at most three quarters full, so probes stay short.
+            if (4UL * numSites >= 3UL * kMaxSites)
+            {
+                break;
+            }
+
+            site.stack = stack;
+            site.depth = depth;
+            ++numSites;
+        }
+        else if (site.depth != depth || !std::equal(stack.begin(), stack.begin() + depth, site.stack.begin()))
+        {
+            continue;
+        }
+
+        ++site.numAllocations;
+        site.numBytes += size;
+
+        if (pScope)
+        {
+            ++site.numChecked;
+            site.pScope = pScope;
+        }
+
+        return;
+    }
+
+    ++numUnlisted;
+}
+
+
+[[maybe_unused]] void countAllocation(std::size_t size, void * caller)
+{
+    if (tInsideTracker)
+    {
+        return;
+    }
+
+    numAllocations.fetch_add(1UL, std::memory_order_relaxed);
+    numBytes.fetch_add(size, std::memory_order_relaxed);
+    ++tNumAllocations;
+    tNumBytes += size;
+
+    if (!steadyState.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    if (tScope)
+    {
+        numChecked.fetch_add(1UL, std::memory_order_relaxed);
+    }
+
+    recordSite(size, caller, tScope);
+}
+
+
+#ifdef ALLOCATION_TRACKER_BACKTRACE
+/// Whether name (demangled) is a function of the standard library or operator new.
+bool isLibraryFunction(const std::string & name)
+{
+    for (const char * prefix : {"std::", "__gnu_cxx::", "operator new"})
+    {
+        if (name.rfind(prefix, 0UL) == 0UL)
+        {
+            return true;
+        }
+    }
+
+    // With a return type, e.g. "void std::vector<...>::_M_realloc_insert<...>(...)".
+    std::size_t qualified = name.find(" std::");
+    return qualified < name.find('(') && name.find('<') > qualified;
+}
+#endif
+
+
+/// The innermost frame of site's stack outside operator new and the standard library.
+std::string describe(const Site & site)
+{
+    std::ostringstream out;
+    out << std::hex;
+
+#ifdef ALLOCATION_TRACKER_BACKTRACE
+    std::string fallback;
+
+    for (int i = 0; i != site.depth; ++i)
+    {
+        Dl_info info {};
+
+        if (!dladdr(site.stack[i], &info))
+        {
+            continue;
+        }
+
+        auto address = reinterpret_cast<std::uintptr_t>(site.stack[i]);
+
+        if (info.dli_sname)
+        {
+            int status = 0;
+            char * demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+            std::string name = status == 0 ? demangled : info.dli_sname;
+            std::free(demangled);
+
+            out << name << "+0x" << address - reinterpret_cast<std::uintptr_t>(info.dli_saddr);
+
+            if (!isLibraryFunction(name))
+            {
+                return out.str();
+            }
+        }
+        else if (info.dli_fname)
+        {
+            // Not exported: give the offset into the binary, for addr2line.
+            out << info.dli_fname << "+0x" << address - reinterpret_cast<std::uintptr_t>(info.dli_fbase);
+
+            if (std::string(info.dli_fname).find("libstdc++") == std::string::npos)
+            {
+                return out.str();
+            }
+        }
+
+        if (fallback.empty())
+        {
+            fallback = out.str();
+        }
+
+        out.str({});
+    }
+
+    if (!fallback.empty())
+    {
+        return fallback;
+    }
+#endif
+
+    out << "0x" << reinterpret_cast<std::uintptr_t>(site.stack[0]);
+    return out.str();
+}
+
+
+AllocationTracker::Counts difference(const AllocationTracker::Counts & a, const AllocationTracker::Counts & b)
+{
+    return {a.numAllocations - b.numAllocations, a.numBytes - b.numBytes, a.numFrees - b.numFrees};
+}
+
+
+#ifdef TRACK_ALLOCATIONS
+void * allocate(std::size_t size, std::size_t alignment, void * caller)
+{
+    countAllocation(size, caller);
+
+    if (size == 0UL)
+    {
+        size = 1UL;
+    }
+
+    while (true)
+    {
+        void * p = alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__
+                   ? std::malloc(size)
+                   : std::aligned_alloc(alignment, (size + alignment - 1UL) / alignment * alignment);
+
+        if (p)
+        {
+            return p;
+        }
+
+        std::new_handler handler = std::get_new_handler();
+
+        if (!handler)
+        {
+            throw std::bad_alloc();
+        }
+
+        handler();
+    }
+}
+
+
+void * allocateNoThrow(std::size_t size, std::size_t alignment, void * caller) noexcept
+{
+    try
+    {
+        return allocate(size, alignment, caller);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+
+void deallocate(void * p) noexcept
+{
+    if (!p)
+    {
+        return;
+    }
+
+    if (!tInsideTracker)
+    {
+        numFrees.fetch_add(1UL, std::memory_order_relaxed);
+        ++tNumFrees;
+    }
+
+    std::free(p);
+}
+#endif  // TRACK_ALLOCATIONS
+
+}  // namespace anonymous
+
+
+#ifdef TRACK_ALLOCATIONS
+void * operator new(std::size_t size)
+{
+    return allocate(size, 0UL, __builtin_return_address(0));
+}
+
+
+void * operator new[](std::size_t size)
+{
+    return allocate(size, 0UL, __builtin_return_address(0));
+}
+
+
+void * operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return allocateNoThrow(size, 0UL, __builtin_return_address(0));
+}
+
+
+void * operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return allocateNoThrow(size, 0UL, __builtin_return_address(0));
+}
+
+
+void * operator new(std::size_t size, std::align_val_t alignment)
+{
+    return allocate(size, static_cast<std::size_t>(alignment), __builtin_return_address(0));
+}
+
+
+void * operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return allocate(size, static_cast<std::size_t>(alignment), __builtin_return_address(0));
+}
+
+
+void * operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return allocateNoThrow(size, static_cast<std::size_t>(alignment), __builtin_return_address(0));
+}
+
+
+void * operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return allocateNoThrow(size, static_cast<std::size_t>(alignment), __builtin_return_address(0));
+}
+
+
+void operator delete(void * p) noexcept { deallocate(p); }
+void operator delete[](void * p) noexcept { deallocate(p); }
+void operator delete(void * p, std::size_t) noexcept { deallocate(p); }
+void operator delete[](void * p, std::size_t) noexcept { deallocate(p); }
+void operator delete(void * p, const std::nothrow_t &) noexcept { deallocate(p); }
+void operator delete[](void * p, const std::nothrow_t &) noexcept { deallocate(p); }
+void operator delete(void * p, std::align_val_t) noexcept { deallocate(p); }
+void operator delete[](void * p, std::align_val_t) noexcept { deallocate(p); }
+void operator delete(void * p, std::size_t, std::align_val_t) noexcept { deallocate(p); }
+void operator delete[](void * p, std::size_t, std::align_val_t) noexcept { deallocate(p); }
+void operator delete(void * p, std::align_val_t, const std::nothrow_t &) noexcept { deallocate(p); }
+void operator delete[](void * p, std::align_val_t, const std::nothrow_t &) noexcept { deallocate(p); }
+#endif  // TRACK_ALLOCATIONS
+
+
+AllocationTracker::Scope::Scope() : begin {tNumAllocations, tNumBytes, tNumFrees}
+{
+
+}
+
+
+AllocationTracker::Counts AllocationTracker::Scope::getCounts() const
+{
+    return difference({tNumAllocations, tNumBytes, tNumFrees}, begin);
+}
+
+
+AllocationTracker::CheckedScope::CheckedScope(const char * name) : pOuter(tScope)
+{
+    tScope = pOuter ? pOuter : name;
+}
+
+
+AllocationTracker::CheckedScope::~CheckedScope() noexcept
+{
+    tScope = pOuter;
+}
+
+
+bool AllocationTracker::isEnabled()
+{
+#ifdef TRACK_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+void AllocationTracker::startSteadyState()
+{
+    steadyBegin = getTotal();
+    steadyState.store(true, std::memory_order_relaxed);
+}
+
+
+AllocationTracker::Counts AllocationTracker::endFrame()
+{
+    Counts total = getTotal();
+    Counts frame = difference(total, frameBegin);
+    frameBegin = total;
+    return frame;
+}
+
+
+AllocationTracker::Counts AllocationTracker::getTotal()
+{
+    return {numAllocations.load(std::memory_order_relaxed),
+            numBytes.load(std::memory_order_relaxed),
+            numFrees.load(std::memory_order_relaxed)};
+}
+
+
+std::uint64_t AllocationTracker::getNumChecked()
+{
+    return numChecked.load(std::memory_order_relaxed);
+}
+
+
+std::vector<AllocationTracker::CallSite> AllocationTracker::getCallSites(std::size_t maxSites)
+{
+    Untracked untracked;
+
+    std::vector<Site> copies;
+
+    {
+        std::lock_guard lock(sitesMutex);
+        std::copy_if(sites.cbegin(), sites.cend(), std::back_inserter(copies), [](const Site & s) { return s.depth != 0; });
+    }
+
+    // Stacks that differ only outside the reported frame are one call site.
+    std::map<std::string, CallSite> merged;
+
+    for (const Site & s : copies)
+    {
+        std::string location = describe(s);
+        CallSite & site = merged[location];
+        site.location = location;
+        site.numAllocations += s.numAllocations;
+        site.numBytes += s.numBytes;
+        site.numChecked += s.numChecked;
+        site.pScope = s.pScope ? s.pScope : site.pScope;
+    }
+
+    std::vector<CallSite> callSites;
+    callSites.reserve(merged.size());
+
+    for (auto & entry : merged)
+    {
+        callSites.emplace_back(std::move(entry.second));
+    }
+
+    std::sort(callSites.begin(), callSites.end(), [](const CallSite & a, const CallSite & b)
+    {
+        return a.numBytes > b.numBytes;
+    });
+
+    callSites.resize(std::min(callSites.size(), maxSites));
+
+    return callSites;
+}
+
+
+void AllocationTracker::printReport(std::size_t numSteadyFrames, std::size_t maxSites)
+{
+    Untracked untracked;
+
+    Counts steady = difference(getTotal(), steadyBegin);
+    auto frames = static_cast<double>(std::max(numSteadyFrames, 1UL));
+
+    std::cout << "[alloc] " << static_cast<double>(steady.numAllocations) / frames << " allocations of "
+              << static_cast<double>(steady.numBytes) / frames << " bytes and "
+              << static_cast<double>(steady.numFrees) / frames << " frees per steady-state frame, "
+              << getNumChecked() << " allocations inside checked scopes\n";
+
+    for (const CallSite & site : getCallSites(maxSites))
+    {
+        std::cout << "[alloc] " << std::setw(12) << site.numBytes << " bytes in "
+                  << std::setw(8) << site.numAllocations << " allocations: " << site.location;
+
+        if (site.numChecked != 0UL)
+        {
+            std::cout << " (" << site.numChecked << " inside " << site.pScope << ')';
+        }
+
+        std::cout << '\n';
+    }
+
+    std::lock_guard lock(sitesMutex);
+
+    if (numUnlisted != 0UL)
+    {
+        std::cout << "[alloc] " << numUnlisted << " allocations from call sites past the first " << kMaxSites
+                  << " are not listed\n";
+    }
+}
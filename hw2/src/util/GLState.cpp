@@ -0,0 +1,163 @@
+#include "util/FrameCounters.h"
+#include "util/GLState.h"
+
+
+GLState & GLState::getInstance()
+{
+    static GLState instance;
+    return instance;
+}
+
+
+void GLState::useProgram(GLuint p)
+{
+    if (changes(program, p))
+    {
+        FrameCounters::getInstance().add(FrameCounters::kProgramSwitches);
+        glUseProgram(p);
+    }
+}
+
+
+void GLState::bindVertexArray(GLuint vao)
+{
+    if (changes(vertexArray, vao))
+    {
+        FrameCounters::getInstance().add(FrameCounters::kVertexArrayBinds);
+        glBindVertexArray(vao);
+        elementArrayBuffer.known = false;
+    }
+}
+
+
+void GLState::bindBuffer(GLenum target, GLuint buffer)
+{
+    switch (target)
+    {
+        case GL_ARRAY_BUFFER:
+            if (changes(arrayBuffer, buffer))
+            {
+                glBindBuffer(target, buffer);
+            }
+            break;
+
+        case GL_ELEMENT_ARRAY_BUFFER:
+            if (changes(elementArrayBuffer, buffer))
+            {
+                glBindBuffer(target, buffer);
+            }
+            break;
+
+        default:
+            ++stats.numIssued;
+            glBindBuffer(target, buffer);
+            break;
+    }
+}
+
+
+void GLState::setPatchVertices(GLint count)
+{
+    if (changes(patchVertices, count))
+    {
+        glPatchParameteri(GL_PATCH_VERTICES, count);
+    }
+}
+
+
+void GLState::setPolygonMode(GLenum mode)
+{
+    if (changes(polygonMode, mode))
+    {
+        glPolygonMode(GL_FRONT_AND_BACK, mode);
+    }
+}
+
+
+void GLState::setDepthTest(bool enabled)
+{
+    if (!changes(depthTest, enabled))
+    {
+        return;
+    }
+
+    if (enabled)
+    {
+        glEnable(GL_DEPTH_TEST);
+    }
+    else
+    {
+        glDisable(GL_DEPTH_TEST);
+    }
+}
+
+
+void GLState::setDepthFunc(GLenum func)
+{
+    if (changes(depthFunc, func))
+    {
+        glDepthFunc(func);
+    }
+}
+
+
+void GLState::setDepthMask(bool enabled)
+{
+    if (changes(depthMask, enabled))
+    {
+        glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+    }
+}
+
+
+void GLState::deleteProgram(GLuint p)
+{
+    if (program.known && program.value == p)
+    {
+        program.known = false;
+    }
+
+    glDeleteProgram(p);
+}
+
+
+void GLState::deleteVertexArray(GLuint vao)
+{
+    if (vertexArray.known && vertexArray.value == vao)
+    {
+        vertexArray.value = 0U;
+        elementArrayBuffer.known = false;
+    }
+
+    glDeleteVertexArrays(1, &vao);
+}
+
+
+void GLState::deleteBuffer(GLuint buffer)
+{
+    if (arrayBuffer.known && arrayBuffer.value == buffer)
+    {
+        arrayBuffer.value = 0U;
+    }
+
+    if (elementArrayBuffer.known && elementArrayBuffer.value == buffer)
+    {
+        elementArrayBuffer.value = 0U;
+    }
+
+    glDeleteBuffers(1, &buffer);
+}
+
+
+void GLState::invalidate()
+{
+    program.known = false;
+    vertexArray.known = false;
+    arrayBuffer.known = false;
+    elementArrayBuffer.known = false;
+    patchVertices.known = false;
+    polygonMode.known = false;
+    depthTest.known = false;
+    depthFunc.known = false;
+    depthMask.known = false;
+}
@@ -2,23 +2,87 @@
 #define APP_H
 
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <glm/glm.hpp>
 
 #include "app/Window.h"
+#include "mesh/ParametricSurface.h"
+#include "util/Bvh.h"
 #include "util/Camera.h"
+#include "util/FileWatcher.h"
+#include "util/FrameCapture.h"
+#include "util/ImagePresenter.h"
+#include "util/OcclusionCuller.h"
+#include "util/OffscreenFramebuffer.h"
+#include "util/RegressionCheck.h"
+#include "util/PrimitiveCounter.h"
+#include "util/RayTracer.h"
+#include "util/RenderQueue.h"
+#include "util/SoftwareRasterizer.h"
 
 
 class Shader;
-class Renderable;
+class Drawable;
+class Sphere;
+class SubdivisionMesh;
+class Superquadric;
 
 
 class App : private Window
 {
 public:
-    static App & getInstance();
+    /// How to run, from the command line (see main.cpp).
+    struct Options
+    {
+        // Render into an OffscreenFramebuffer behind a hidden window, without waiting for vsync.
+        bool offscreen {false};
 
-    void run();
+        // Frames to render before run() returns; 0 renders until the window closes.
+        // With a frame count, every frame advances the scene by kFixedTimeStep, so runs are reproducible.
+        int numFrames {0};
+
+        // Save every frame to this directory as 000000.png, 000001.png, ...; empty saves nothing.
+        std::string captureDirectory;
+
+        // Save PPM instead of PNG files.
+        bool ppm {false};
+
+        // Superquadrics to show, one per line; saving the file updates the running program.
+        std::string configPath {"etc/config.txt"};
+
+        // Compare every frame with the reference PPM of the same name in this directory instead of saving it;
+        // empty compares nothing. See RegressionCheck.
+        std::string referenceDirectory;
+        RegressionCheck::Budget budget;
+
+        // Record the OpenGL calls into this trace for hw3-replay (see GLTraceRecorder); empty records nothing.
+        // Stops after glTraceFrames frames, or with the run if 0.
+        std::string glTracePath;
+        int glTraceFrames {0};
+
+        // Write a timeline of the zones of all threads to this file as Chrome trace JSON (see Timeline);
+        // empty records nothing.
+        std::string timelinePath;
+
+        // Report the counters of FrameCounters once per second: to stdout (with App::printStats),
+        // and/or as CSV to this file if not empty.
+        bool printCounters {false};
+        std::string countersPath;
+
+        // Fail the run if a steady-state frame allocates inside App::render or the per-frame input handling
+        // (see AllocationTracker; needs the TRACK_ALLOCATIONS CMake option).
+        bool checkAllocations {false};
+    };
+
+public:
+    /// options only take effect on the first call.
+    static App & getInstance(const Options & options);
+
+    /// Returns false if the frames or their performance regressed (see Options::referenceDirectory).
+    bool run();
 
 private:
     static void cursorPosCallback(GLFWwindow *, double, double);
@@ -30,30 +94,124 @@ private:
     static void perFrameTimeLogic(GLFWwindow *);
     static void processKeyInput(GLFWwindow *);
 
+    /// Reads superquadrics from path, one "a b c e1 e2" per line (blank lines and lines starting with # are skipped).
+    /// Returns false, leaving parametersOut untouched, if the file cannot be read or any line is malformed.
+    static bool loadSuperquadricConfig(const std::string & path, std::vector<ParametricSurface::Parameters> & parametersOut);
+
     // from CMakeLists.txt, compile definition
     static constexpr char kWindowName[] {WINDOW_NAME};
     static constexpr int kWindowWidth {1000};
     static constexpr int kWindowHeight {1000};
 
+    // Seconds per frame of runs with a fixed frame count.
+    static constexpr double kFixedTimeStep {1.0 / 60.0};
+
+    // Frames before the steady state, in which caches and buffers grow to their working sizes (see AllocationTracker).
+    static constexpr int kWarmupFrames {10};
+
+    // Where the P key saves the software-rendered frame.
+    static constexpr char kSoftwareFramePath[] {"software.ppm"};
+
+    // Where the T key saves the ray-traced reference frame.
+    static constexpr char kRayTracedFramePath[] {"raytraced.ppm"};
+
 private:
-    App();
+    explicit App(const Options & options);
 
     void initializeShadersAndObjects();
 
+    /// Takes ownership of shape, records its world-space bounds for culling, and returns it.
+    /// Call sceneBvh.build(shapeBounds) once all shapes are added.
+    template <typename Shape>
+    Shape * addShape(std::unique_ptr<Shape> shape)
+    {
+        Shape * pShape = shape.get();
+        shapeBounds.emplace_back(pShape->getWorldBounds());
+        shapes.emplace_back(std::move(shape));
+        return pShape;
+    }
+
+    void reloadConfig();
+
     void render();
 
+    /// Renders visibleShapes (indices into shapes) with softwareRasterizer, which then holds the frame.
+    void rasterizeVisibleShapes(const FrameVector<std::size_t> & visibleShapes);
+
+    /// Re-rasterizes the last software frame with 1, 2, 4, ... threads up to the ThreadPool size
+    /// and prints the throughput of each.
+    void benchmarkSoftwareRasterizer();
+
+    /// Ray traces every shape (culled or not) from the current camera with 1, 2, 4, ... threads
+    /// up to the ThreadPool size, prints rays per second for each, and saves the frame to kRayTracedFramePath.
+    void traceReferenceFrame();
+
+    /// With --counters, prints about once per second what FrameCounters does not count:
+    /// frame rate, primitives the GPU generated, culling, filtered state changes and tessellation levels.
+    void printStats();
+
+    Options options;
+
+    // Set in offscreen mode, where it replaces the window's framebuffer.
+    std::unique_ptr<OffscreenFramebuffer> pOffscreenFramebuffer;
+
+    // Set if options.captureDirectory or options.referenceDirectory is given.
+    std::unique_ptr<FrameCapture> pFrameCapture;
+    std::unique_ptr<RegressionCheck> pRegressionCheck;
+    int numRenderedFrames {0};
+
     // Shaders.
+    std::unique_ptr<Shader> pInstancedShader;
     std::unique_ptr<Shader> pLineShader;
     std::unique_ptr<Shader> pMeshShader;
+    std::unique_ptr<Shader> pPoolShader;
+    std::unique_ptr<Shader> pPresentShader;
     std::unique_ptr<Shader> pSphereShader;
 
     // Objects to render.
-    std::vector<std::unique_ptr<Renderable>> shapes;
+    std::vector<std::unique_ptr<Drawable>> shapes;
+
+    // Draws of the visible shapes, sorted to keep program and vertex array switches down.
+    RenderQueue renderQueue;
+
+    // CPU backend, toggled with the R key: shapes are rasterized into softwareRasterizer,
+    // whose color buffer imagePresenter then copies to the window.
+    SoftwareRasterizer softwareRasterizer {kWindowWidth, kWindowHeight};
+    std::unique_ptr<ImagePresenter> pImagePresenter;
+    bool softwareRendering {false};
+
+    // Reference renderer, run on demand with the T key.
+    RayTracer rayTracer {kWindowWidth, kWindowHeight};
+
+    // World-space boxes of shapes (same order), and the hierarchy over them that render() culls with.
+    std::vector<Aabb> shapeBounds;
+    Bvh sceneBvh;
+
+    // Occluders for the shapes that pass frustum culling.
+    OcclusionCuller occlusionCuller;
+
+    // Culling results of the last frame.
+    std::size_t numDrawnShapes {0UL};
+    std::size_t numCulledShapes {0UL};
+    std::size_t numOccludedShapes {0UL};
+
+    // Non-owning views into shapes whose subdivision level follows the keyboard.
+    std::vector<SubdivisionMesh *> subdivisionMeshes;
+    int subdivisionLevel {0};
+
+    // Non-owning views into shapes whose tessellation follows the view.
+    std::vector<Sphere *> spheres;
+
+    // Non-owning views into shapes whose parameters follow options.configPath.
+    std::vector<Superquadric *> superquadrics;
+    std::vector<std::size_t> superquadricShapes;
+    FileWatcher configWatcher;
 
     // Viewing
     Camera camera {{0.0f, 0.0f, 10.0f}};
     glm::mat4 view = glm::mat4(1.0f);
     glm::mat4 projection = glm::mat4(1.0f);
+    glm::ivec2 framebufferSize {kWindowWidth, kWindowHeight};
 
     glm::vec3 lightColor {1.0f, 1.0f, 1.0f};
     glm::vec3 lightPos {10.0f, -10.0f, 10.0f};
@@ -62,6 +220,11 @@ private:
     double timeElapsedSinceLastFrame {0.0};
     double lastFrameTimeStamp {0.0};
 
+    // Stats, printed about once per second with --counters.
+    PrimitiveCounter primitiveCounter;
+    double lastStatsTimeStamp {0.0};
+    int framesSinceLastStats {0};
+
     bool mousePressed {false};
     glm::dvec2 mousePos {0.0, 0.0};
 
@@ -0,0 +1,84 @@
+#ifndef HALFEDGEMESH_H
+#define HALFEDGEMESH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "mesh/MeshData.h"
+
+
+/// Compact half-edge structure for triangle meshes.
+///
+/// Half-edges are implicit in the index buffer: half-edge h is the corner indices[h],
+/// runs from vertex indices[h] to vertex indices[next(h)], and belongs to face h / 3.
+/// Only the twin (opposite) half-edges and the undirected edge ids are stored explicitly,
+/// plus a CSR vertex-to-edge adjacency for one-ring queries.
+///
+/// Edges shared by exactly two faces have twins; boundary edges do not (twin == kInvalid).
+/// For non-manifold edges (more than two faces), the first two half-edges are paired.
+class HalfEdgeMesh
+{
+public:
+    static constexpr std::uint32_t kInvalid {0xFFFFFFFFU};
+
+    static std::uint32_t next(std::uint32_t h) { return h % 3U == 2U ? h - 2U : h + 1U; }
+    static std::uint32_t prev(std::uint32_t h) { return h % 3U == 0U ? h + 2U : h - 1U; }
+
+public:
+    HalfEdgeMesh() = default;
+
+    /// Builds adjacency for a welded triangle mesh (see MeshData::welded).
+    explicit HalfEdgeMesh(const MeshData & data);
+
+    HalfEdgeMesh(std::vector<glm::vec3> && positions, std::vector<std::uint32_t> && indices);
+
+    [[nodiscard]] std::size_t numVertices() const { return positions.size(); }
+    [[nodiscard]] std::size_t numFaces() const { return indices.size() / 3UL; }
+    [[nodiscard]] std::size_t numHalfEdges() const { return indices.size(); }
+    [[nodiscard]] std::size_t numEdges() const { return edgeHalfEdge.size(); }
+
+    [[nodiscard]] std::uint32_t origin(std::uint32_t h) const { return indices[h]; }
+    [[nodiscard]] std::uint32_t target(std::uint32_t h) const { return indices[next(h)]; }
+    [[nodiscard]] std::uint32_t twin(std::uint32_t h) const { return twins[h]; }
+    [[nodiscard]] std::uint32_t edge(std::uint32_t h) const { return edgeOfHalfEdge[h]; }
+
+    /// One half-edge of edge e.
+    [[nodiscard]] std::uint32_t halfEdgeOf(std::uint32_t e) const { return edgeHalfEdge[e]; }
+
+    [[nodiscard]] bool isBoundaryEdge(std::uint32_t e) const { return twins[edgeHalfEdge[e]] == kInvalid; }
+
+    /// Edges incident to vertex v are vertexEdges[vertexEdgeOffsets[v] .. vertexEdgeOffsets[v + 1]).
+    [[nodiscard]] const std::uint32_t * beginVertexEdges(std::uint32_t v) const { return vertexEdges.data() + vertexEdgeOffsets[v]; }
+    [[nodiscard]] const std::uint32_t * endVertexEdges(std::uint32_t v) const { return vertexEdges.data() + vertexEdgeOffsets[v + 1U]; }
+
+    /// The endpoint of edge e that is not v.
+    [[nodiscard]] std::uint32_t otherEnd(std::uint32_t e, std::uint32_t v) const
+    {
+        std::uint32_t h = edgeHalfEdge[e];
+        return origin(h) == v ? target(h) : origin(h);
+    }
+
+    [[nodiscard]] MeshData toMeshData() const;
+
+    std::vector<glm::vec3> positions;
+    std::vector<std::uint32_t> indices;
+
+private:
+    // Pairs twins and assigns edge ids through a hash-partitioned parallel edge table.
+    void buildEdges();
+
+    void buildVertexEdges();
+
+    std::vector<std::uint32_t> twins;
+    std::vector<std::uint32_t> edgeOfHalfEdge;
+    std::vector<std::uint32_t> edgeHalfEdge;
+
+    std::vector<std::uint32_t> vertexEdgeOffsets;
+    std::vector<std::uint32_t> vertexEdges;
+};
+
+
+#endif  // HALFEDGEMESH_H
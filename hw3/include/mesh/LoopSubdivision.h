@@ -0,0 +1,40 @@
+#ifndef LOOPSUBDIVISION_H
+#define LOOPSUBDIVISION_H
+
+#include <deque>
+
+#include "mesh/HalfEdgeMesh.h"
+
+
+/// Loop subdivision (Loop 1987) with a cache of all levels computed so far.
+/// Level k + 1 is always computed from the cached level k,
+/// so stepping up one level costs one subdivision pass, and stepping down is free.
+///
+/// Odd (edge) vertices:  3/8 (a + b) + 1/8 (c + d), or (a + b) / 2 on boundaries;
+/// even (old) vertices:  (1 - n beta) v + beta * sum(neighbors), or 3/4 v + 1/8 (b0 + b1) on boundaries.
+///
+/// Not thread-safe: one thread at a time may call level().
+class LoopSubdivision
+{
+public:
+    static constexpr int kMaxLevel {7};
+
+public:
+    explicit LoopSubdivision(HalfEdgeMesh && base);
+
+    /// Returns level k (clamped to [0, kMaxLevel]), computing and caching the missing levels.
+    const HalfEdgeMesh & level(int k);
+
+    /// Highest level computed so far.
+    [[nodiscard]] int highestCachedLevel() const { return static_cast<int>(levels.size()) - 1; }
+
+    /// One subdivision pass; vertex and face loops run in parallel.
+    static HalfEdgeMesh subdivide(const HalfEdgeMesh & mesh);
+
+private:
+    // std::deque keeps references to earlier levels valid while appending.
+    std::deque<HalfEdgeMesh> levels;
+};
+
+
+#endif  // LOOPSUBDIVISION_H
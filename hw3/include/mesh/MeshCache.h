@@ -0,0 +1,94 @@
+#ifndef MESHCACHE_H
+#define MESHCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "shape/Mesh.h"
+#include "util/MappedFile.h"
+
+
+/// Versioned binary container for the GPU-ready form of a Mesh.
+///
+/// Layout (native byte order; offsets are 16-byte aligned):
+///   Header | index buffer (GLuint) | interleaved vertex buffer.
+///
+/// The vertex buffer is either full precision (Mesh::Vertex, 36 bytes)
+/// or quantized (PackedVertex, 20 bytes: float position,
+/// GL_INT_2_10_10_10_REV normal and RGBA8 color).
+/// Both are consumed as-is by glBufferData, so loading a cache is a page-in, not a parse.
+/// A cache is stale when the hash of its source file changes.
+class MeshCache
+{
+public:
+    static constexpr char kMagic[8] {'H', 'W', '3', 'M', 'E', 'S', 'H', '\0'};
+    static constexpr std::uint32_t kVersion {1U};
+
+    enum Flags : std::uint32_t
+    {
+        kQuantized = 1U << 0U
+    };
+
+    struct Header
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t flags;
+        std::uint64_t sourceHash;
+        std::uint32_t numVertices;
+        std::uint32_t numIndices;
+        std::uint32_t vertexStride;
+        std::uint32_t reserved;
+        float aabbMin[3];
+        float aabbMax[3];
+        std::uint64_t indexOffset;
+        std::uint64_t vertexOffset;
+    };
+
+    struct PackedVertex
+    {
+        glm::vec3 position;
+        std::uint32_t normal;
+        std::uint32_t color;
+    };
+
+public:
+    /// Default cache location for a source file.
+    static std::string pathFor(const std::string & sourcePath);
+
+    /// 64-bit content hash of a file. Throws std::runtime_error if the file cannot be read.
+    static std::uint64_t hashFile(const std::string & path);
+
+    /// Writes a cache for the given vertices. If indices is empty,
+    /// bitwise-identical vertices are welded and an index buffer is generated.
+    /// Returns false (without throwing) if the file cannot be written.
+    static bool write(const std::string & path,
+                      std::uint64_t sourceHash,
+                      const std::vector<Mesh::Vertex> & vertices,
+                      const std::vector<GLuint> & indices,
+                      bool quantize);
+
+    /// Maps the cache at path. A missing or unreadable file yields an invalid cache.
+    explicit MeshCache(const std::string & path);
+
+    /// True iff the file is a well-formed cache of this version built from a source with this hash.
+    [[nodiscard]] bool isValid(std::uint64_t sourceHash) const;
+
+    [[nodiscard]] const Header & header() const;
+    [[nodiscard]] const void * indexData() const;
+    [[nodiscard]] const void * vertexData() const;
+
+    /// Copies of the buffers for CPU use, quantized normals and colors expanded to floats.
+    /// Only meaningful for a valid cache.
+    [[nodiscard]] std::vector<Mesh::Vertex> decodeVertices() const;
+    [[nodiscard]] std::vector<GLuint> decodeIndices() const;
+
+private:
+    std::optional<MappedFile> file;
+};
+
+
+#endif  // MESHCACHE_H
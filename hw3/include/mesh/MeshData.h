@@ -0,0 +1,32 @@
+#ifndef MESHDATA_H
+#define MESHDATA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+
+/// CPU-side indexed triangle mesh, as produced by importers and generators
+/// and consumed by Mesh (see shape/Mesh.h).
+struct MeshData
+{
+    [[nodiscard]] std::size_t numTriangles() const { return indices.size() / 3UL; }
+
+    /// Copy in which bitwise-equal positions share one vertex (normals are dropped).
+    /// Triangle soups such as the files in ./var/ must be welded before
+    /// adjacency-based processing (subdivision, smooth normals).
+    [[nodiscard]] MeshData welded() const;
+
+    std::vector<glm::vec3> positions;
+
+    // Either empty or one normal per position.
+    std::vector<glm::vec3> normals;
+
+    // Triangle list, three indices into positions per facet.
+    std::vector<std::uint32_t> indices;
+};
+
+
+#endif  // MESHDATA_H
@@ -0,0 +1,62 @@
+#ifndef MESHIMPORTER_H
+#define MESHIMPORTER_H
+
+#include <cstddef>
+#include <string>
+
+#include "mesh/MeshData.h"
+
+
+/// Loads triangle meshes from disk.
+/// Files are memory-mapped and parsed with std::from_chars (locale-independent);
+/// large text files are split at line boundaries and the pieces are parsed in parallel.
+/// Supported formats:
+///   - var: the format of the files in ./var/, whitespace-separated floats,
+///     three per vertex, nine per triangular facet (no index sharing);
+///   - Wavefront OBJ: v, vn and f records (polygons are fan-triangulated,
+///     negative indices are supported, texture coordinates are ignored);
+///   - binary PLY (little or big endian): vertex x/y/z (and nx/ny/nz if present)
+///     plus a face element with a vertex_indices list.
+class MeshImporter
+{
+public:
+    enum Format : int
+    {
+        kAuto,
+        kVar,
+        kObj,
+        kPly
+    };
+
+    struct Stats
+    {
+        [[nodiscard]] double megabytesPerSecond() const
+        {
+            return 0.0 < seconds ? static_cast<double>(numBytes) / (1024.0 * 1024.0) / seconds : 0.0;
+        }
+
+        std::size_t numBytes {0UL};
+        std::size_t numTriangles {0UL};
+        std::size_t numThreads {1UL};
+        double seconds {0.0};
+    };
+
+public:
+    MeshImporter() = delete;
+
+    /// Loads the mesh at path; if stats is not nullptr, it receives the size, time and threads taken.
+    /// Nothing is printed: callers that want the throughput report it themselves.
+    /// kAuto picks the format by extension (.obj, .ply; anything else is var).
+    /// Throws std::runtime_error if the file is missing or malformed.
+    static MeshData load(const std::string & path, Format format = kAuto, Stats * stats = nullptr);
+
+    static Format formatFromExtension(const std::string & path);
+
+private:
+    static MeshData parseVar(const char * begin, const char * end);
+    static MeshData parseObj(const char * begin, const char * end);
+    static MeshData parsePly(const char * begin, const char * end);
+};
+
+
+#endif  // MESHIMPORTER_H
@@ -0,0 +1,46 @@
+#ifndef NORMALGENERATOR_H
+#define NORMALGENERATOR_H
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "mesh/MeshData.h"
+
+
+/// Vertex normals for indexed triangle meshes.
+///
+/// Each face normal is weighted by its area or by the face's interior angle at the vertex
+/// (Thürmer and Wüthrich 1998; insensitive to how a surface happens to be triangulated).
+/// Faces are split across the shared ThreadPool; every task accumulates into its own buffer,
+/// and the buffers are summed per vertex afterwards, so no atomics are needed.
+///
+/// Smoothing only happens across shared vertex indices,
+/// so triangle soups (e.g. the files in ./var/) must be welded first (see MeshData::welded).
+class NormalGenerator
+{
+public:
+    enum Weighting : int
+    {
+        kArea,
+        kAngle
+    };
+
+    /// Crease angle (in degrees) at which no edge is hard.
+    static constexpr float kSmooth {180.0f};
+
+    /// Crease angle at which every edge is hard (flat shading).
+    static constexpr float kFlat {0.0f};
+
+    /// One normal per position; vertices are never split.
+    /// Vertices without any non-degenerate face get (0, 0, 1).
+    static std::vector<glm::vec3> vertexNormals(const MeshData & mesh, Weighting weighting = kAngle);
+
+    /// Copy of mesh with normals. Where two faces at a vertex meet at more than
+    /// creaseAngleDegrees, the vertex is split so that the edge shades hard.
+    /// 0 gives flat shading, kSmooth (or more) never splits.
+    static MeshData generate(const MeshData & mesh, float creaseAngleDegrees = kSmooth, Weighting weighting = kAngle);
+};
+
+
+#endif  // NORMALGENERATOR_H
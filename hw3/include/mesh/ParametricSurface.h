@@ -0,0 +1,95 @@
+#ifndef PARAMETRICSURFACE_H
+#define PARAMETRICSURFACE_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "mesh/MeshData.h"
+
+
+/// CPU tessellation of parametric surfaces into indexed triangle meshes with analytic normals.
+/// Needs no tessellation shaders; the result renders with mesh.vert.glsl like any other mesh.
+///
+/// All supported surfaces are separable in (u, v): u runs around the z axis,
+/// and every vertex is a per-column term (from u) scaled by a per-row term (from v).
+/// Per-column and per-row terms come from sin/cos tables shared by all surfaces
+/// of the same resolution; rows are evaluated four columns at a time with SSE
+/// (scalar elsewhere) and split across the shared ThreadPool.
+///
+/// Surfaces are closed: the seam column is duplicated, and cylinders and cones get flat caps.
+class ParametricSurface
+{
+public:
+    enum Shape : int
+    {
+        kEllipsoid,
+        kCylinder,
+        kCone,
+        kTorus,
+        kSuperquadric
+    };
+
+    /// Use the factories below; the meaning of a, b and c depends on the shape.
+    struct Parameters
+    {
+        Shape shape {kEllipsoid};
+        float a {1.0f};
+        float b {1.0f};
+        float c {1.0f};
+        float e1 {1.0f};
+        float e2 {1.0f};
+    };
+
+    /// sin and cos at count + 1 evenly spaced angles from begin to end (inclusive).
+    struct TrigTable
+    {
+        std::vector<float> sin;
+        std::vector<float> cos;
+    };
+
+    struct Stats
+    {
+        [[nodiscard]] double megaverticesPerSecond() const
+        {
+            return 0.0 < seconds ? static_cast<double>(numVertices) * 1e-6 / seconds : 0.0;
+        }
+
+        std::size_t numVertices {0UL};
+        std::size_t numTriangles {0UL};
+        double seconds {0.0};
+    };
+
+public:
+    ParametricSurface() = delete;
+
+    /// E.g. "torus", for reports.
+    static const char * name(Shape shape);
+
+    /// Semi-axes a, b, c along x, y, z.
+    static Parameters ellipsoid(float a, float b, float c);
+
+    /// Along z, centered at the origin.
+    static Parameters cylinder(float radius, float height);
+
+    /// Base at z = -height / 2, apex at z = height / 2.
+    static Parameters cone(float radius, float height);
+
+    /// Around the z axis.
+    static Parameters torus(float majorRadius, float minorRadius);
+
+    /// Barr's superellipsoid: semi-axes a, b, c; e1 shapes the profile along z, e2 the cross section.
+    /// e = 1 is round, e -> 0 is square, e = 2 is a diamond.
+    static Parameters superquadric(float a, float b, float c, float e1, float e2);
+
+    /// Tessellates with slices columns around the z axis and stacks rows along the profile.
+    /// Throws std::invalid_argument if slices < 3 or stacks < 1.
+    /// If stats is not nullptr, it receives the size of the result and the time taken; nothing is printed.
+    static MeshData generate(const Parameters & parameters, int slices, int stacks, Stats * stats = nullptr);
+
+    /// Shared table for count steps over [begin, end]; built on first use, thread-safe.
+    static std::shared_ptr<const TrigTable> trigTable(int count, float begin, float end);
+};
+
+
+#endif  // PARAMETRICSURFACE_H
@@ -0,0 +1,38 @@
+#ifndef DRAWABLE_H
+#define DRAWABLE_H
+
+#include "shape/Renderable.h"
+#include "util/RenderQueue.h"
+
+
+class RayTracer;
+class SoftwareRasterizer;
+
+/// Renderable that draws through a RenderQueue (see util/RenderQueue.h):
+/// submit queues its draws, and the queue calls draw for each of them
+/// in sorted order, with the packet's program and vertex array already bound.
+class Drawable : public Renderable
+{
+public:
+    ~Drawable() noexcept override = default;
+
+    /// Per-frame work (e.g. swapping in new buffers), then one RenderQueue::submit per draw.
+    virtual void submit(RenderQueue & queue, float timeElapsedSinceLastFrame) = 0;
+
+    /// Sets per-draw uniforms and issues the draw call. Must not unbind the program or vertex array.
+    virtual void draw(const RenderQueue::Packet & packet) = 0;
+
+    /// Adds this shape's primitives to a CPU frame (see util/SoftwareRasterizer.h), in place of submit.
+    /// Shapes without a CPU path add nothing.
+    virtual void rasterize(SoftwareRasterizer & rasterizer);
+
+    /// Adds this shape's primitives to a ray-traced frame (see util/RayTracer.h).
+    /// Shapes without a CPU path add nothing.
+    virtual void trace(RayTracer & tracer);
+
+    /// Draws right away through a queue of its own; prefer submitting to a shared queue.
+    void render(float timeElapsedSinceLastFrame) override;
+};
+
+
+#endif  // DRAWABLE_H
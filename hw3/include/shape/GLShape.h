@@ -3,6 +3,7 @@
 #ifndef GLSHAPE_H
 #define GLSHAPE_H
 
+#include <cstddef>
 #include <vector>
 
 #include <glad/glad.h>
@@ -19,6 +20,14 @@ class Shader;
 /// should public-inherit this class.
 class GLShape
 {
+public:
+    /// Bytes held on either side, for FrameCounters.
+    struct Memory
+    {
+        std::size_t cpuBytes {0UL};
+        std::size_t gpuBytes {0UL};
+    };
+
 public:
     GLShape() = delete;
     GLShape(const GLShape &) = delete;
@@ -26,18 +35,28 @@ public:
 
     virtual ~GLShape() noexcept = 0;
 
+    /// Vertex data kept in memory and the buffers allocated for this shape.
+    [[nodiscard]] virtual Memory getMemory() const = 0;
+
 protected:
     GLShape(Shader * pShader, const glm::mat4 & model);
 
     GLShape(GLShape &&) noexcept;
     GLShape & operator=(GLShape &&) noexcept;
 
+    /// Sets model and recomputes normalMatrix.
+    void setModel(const glm::mat4 & m);
+
     Shader * pShader {nullptr};
 
     GLuint vao {0U};
     GLuint vbo {0U};
 
     glm::mat4 model {glm::mat4(1.0f)};
+
+    // Inverse transpose of the upper 3x3 of model, uploaded as the "normalMatrix" uniform
+    // so that shaders do not invert model per vertex.
+    glm::mat3 normalMatrix {glm::mat3(1.0f)};
 };
 
 
@@ -0,0 +1,153 @@
+#ifndef INSTANCEDMESH_H
+#define INSTANCEDMESH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "shape/Drawable.h"
+#include "shape/GLShape.h"
+#include "util/Aabb.h"
+#include "util/SoftwareRasterizer.h"
+
+
+class Shader;
+struct MeshData;
+
+
+/// One mesh drawn many times (e.g. the buildings of a city) with a single instanced draw call.
+/// Renders with instanced.vert.glsl: the model matrix, normal matrix and color of every instance
+/// live in an instance buffer (vertex attributes with divisor 1) instead of in uniforms.
+///
+/// Instances are packed densely; removing one moves the last instance into its slot.
+/// Changes are uploaded on the next render, only over the range of slots that changed,
+/// and the instance buffer grows geometrically, so adding instances one by one stays cheap.
+class InstancedMesh : public Drawable, public GLShape
+{
+public:
+    /// Identifies an instance for its whole lifetime (slots move on removal, handles do not).
+    using Handle = std::uint32_t;
+
+    /// Geometry from data (indexed or not). If data carries no normals, smooth normals are generated.
+    InstancedMesh(Shader * pShader, const MeshData & data);
+
+    ~InstancedMesh() noexcept override;
+
+    void submit(RenderQueue & queue, float timeElapsedSinceLastFrame) override;
+
+    void draw(const RenderQueue::Packet & packet) override;
+
+    /// Adds the shared triangles once per instance, with that instance's model and color.
+    void rasterize(SoftwareRasterizer & rasterizer) override;
+
+    /// As rasterize.
+    void trace(RayTracer & tracer) override;
+
+    /// The instances and the shared geometry on both sides.
+    [[nodiscard]] Memory getMemory() const override;
+
+    Handle addInstance(const glm::mat4 & model, const glm::vec3 & color);
+
+    /// Throws std::out_of_range if handle was removed or never added.
+    void updateInstance(Handle handle, const glm::mat4 & model, const glm::vec3 & color);
+
+    /// Throws std::out_of_range if handle was removed or never added.
+    void removeInstance(Handle handle);
+
+    /// Reserves CPU and GPU storage for numInstances, e.g. before adding a known number of instances.
+    void reserve(std::size_t numInstances);
+
+    [[nodiscard]] std::size_t size() const { return instances.size(); }
+
+    /// Object-space bounding box of the shared geometry.
+    [[nodiscard]] const Aabb & getBounds() const { return bounds; }
+
+    /// World-space bounding box of all instances (empty without instances). Linear in size().
+    [[nodiscard]] Aabb getWorldBounds() const;
+
+private:
+    struct Vertex
+    {
+        glm::vec3 position;
+        glm::vec3 normal;
+    };
+
+    /// Per-instance attributes, tightly packed as in the instance buffer.
+    struct Instance
+    {
+        glm::mat4 model;
+        glm::mat3 normalMatrix;
+        glm::vec3 color;
+    };
+
+    static_assert(sizeof(Instance) == sizeof(glm::mat4) + sizeof(glm::mat3) + sizeof(glm::vec3),
+                  "Instance must match the instance buffer layout");
+
+    static constexpr std::uint32_t kNoSlot {0xffffffffU};
+
+    static Instance makeInstance(const glm::mat4 & model, const glm::vec3 & color);
+
+    std::uint32_t slotOf(Handle handle) const;
+
+    void markDirty(std::size_t slot);
+
+    /// Grows the instance buffer to at least numInstances; contents are not kept.
+    void reallocate(std::size_t numInstances);
+
+    void upload();
+
+    /// Calls f(vertices, indices, model) for each instance, the vertices colored with that instance's color.
+    template <typename F>
+    void forEachInstance(F f)
+    {
+        coloredVertices.resize(vertices.size());
+
+        for (const Instance & instance : instances)
+        {
+            for (std::size_t i = 0UL; i != vertices.size(); ++i)
+            {
+                coloredVertices[i] = {vertices[i].position, vertices[i].normal, instance.color};
+            }
+
+            f(coloredVertices, indices, instance.model);
+        }
+    }
+
+    GLuint ebo {0U};
+    GLuint instanceVbo {0U};
+
+    GLsizei vertexCount {0};
+    GLsizei indexCount {0};
+
+    Aabb bounds;
+
+    // The shared geometry on the CPU, for rasterize and trace.
+    std::vector<Vertex> vertices;
+    std::vector<GLuint> indices;
+
+    // vertices with one instance's color, refilled per instance; kept so that later frames do not allocate.
+    std::vector<SoftwareRasterizer::Vertex> coloredVertices;
+
+    std::vector<Instance> instances;
+
+    // handleOfSlot[slot] and slotOfHandle[handle] are inverse; freed handles map to kNoSlot.
+    std::vector<Handle> handleOfSlot;
+    std::vector<std::uint32_t> slotOfHandle;
+    std::vector<Handle> freeHandles;
+
+    // Slots [dirtyBegin, dirtyEnd) differ from the instance buffer.
+    std::size_t dirtyBegin {0UL};
+    std::size_t dirtyEnd {0UL};
+
+    // Instances the instance buffer has room for.
+    std::size_t capacity {0UL};
+
+    // Center of getWorldBounds() for the render queue, recomputed only after instances change.
+    glm::vec3 worldCenter {0.0f};
+    bool worldBoundsChanged {false};
+};
+
+
+#endif  // INSTANCEDMESH_H
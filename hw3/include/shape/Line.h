@@ -4,13 +4,15 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include "shape/Drawable.h"
 #include "shape/GLShape.h"
+#include "util/Aabb.h"
 
 
 class Shader;
 
 
-class Line : public Renderable, public GLShape
+class Line : public Drawable, public GLShape
 {
 public:
     struct Vertex
@@ -23,7 +25,16 @@ public:
 
     ~Line() noexcept override = default;
 
-    void render(float timeElapsedSinceLastFrame) override;
+    void submit(RenderQueue & queue, float timeElapsedSinceLastFrame) override;
+
+    void draw(const RenderQueue::Packet & packet) override;
+
+    [[nodiscard]] Memory getMemory() const override;
+
+    void rasterize(SoftwareRasterizer & rasterizer) override;
+
+    /// World-space bounding box.
+    [[nodiscard]] Aabb getWorldBounds() const;
 
 private:
     std::vector<Vertex> vertices;
@@ -1,18 +1,23 @@
 #ifndef MESH_H
 #define MESH_H
 
+#include <cstdint>
+#include <string>
 #include <vector>
 
 #include <glm/glm.hpp>
 
+#include "shape/Drawable.h"
 #include "shape/GLShape.h"
+#include "util/Aabb.h"
 
 
 class Shader;
+struct MeshData;
 
 
 /// Generic triangular mesh object.
-class Mesh : public Renderable, public GLShape
+class Mesh : public Drawable, public GLShape
 {
 public:
     struct Vertex
@@ -30,15 +35,85 @@ public:
         const glm::mat4 & model
     );
 
-    ~Mesh() noexcept override = default;
+    /// Indexed mesh from imported or generated data (see mesh/MeshData.h).
+    /// If data carries no normals, smooth vertex normals are generated (see mesh/NormalGenerator.h).
+    Mesh(
+        Shader * pShader,
+        const MeshData & data,
+        const glm::vec3 & color,
+        const glm::mat4 & model
+    );
+
+    ~Mesh() noexcept override;
+
+    void submit(RenderQueue & queue, float timeElapsedSinceLastFrame) override;
 
-    void render(float timeElapsedSinceLastFrame) override;
+    void draw(const RenderQueue::Packet & packet) override;
+
+    [[nodiscard]] Memory getMemory() const override;
+
+    /// Meshes loaded from a cache are decoded into this->vertices and this->indices on the first call.
+    void rasterize(SoftwareRasterizer & rasterizer) override;
+
+    /// As rasterize.
+    void trace(RayTracer & tracer) override;
+
+    /// Object-space bounding box.
+    [[nodiscard]] const Aabb & getBounds() const { return bounds; }
+
+    /// World-space bounding box.
+    [[nodiscard]] Aabb getWorldBounds() const { return bounds.transformed(model); }
 
 protected:
     // Used for children inheriting this class, e.g., Tetrahedron
     Mesh(Shader * shader, const glm::mat4 & model);
 
+    /// Interleaved vertices for data; generates smooth normals if data has none.
+    /// Touches no OpenGL state, so it may run on worker threads.
+    static std::vector<Vertex> makeVertices(const MeshData & data, const glm::vec3 & color);
+
+    /// Uploads this->vertices (and this->indices, if any and if uploadIndices) to the GPU.
+    /// The existing buffer objects are reused; storage is only reallocated when it must grow.
+    /// Pass uploadIndices = false when only the vertices changed since the last upload.
+    void upload(bool uploadIndices = true);
+
+    /// Uploads the vertex and index buffers straight from a mapped cache file (see mesh/MeshCache.h).
+    /// Returns false if the cache is missing or was not built from a source with this hash.
+    /// this->vertices and this->indices stay empty on success (until loadCpuGeometry).
+    bool uploadFromCache(const std::string & cachePath, std::uint64_t sourceHash);
+
+    /// Decodes this->vertices and this->indices from the cache, if uploadFromCache left them empty.
+    /// If the cache no longer matches what was uploaded, reloads them with loadSourceGeometry and uploads again.
+    void loadCpuGeometry();
+
+    /// Fills this->vertices and this->indices from the source the cache was built from.
+    /// Subclasses calling uploadFromCache override it; the default throws std::runtime_error.
+    virtual void loadSourceGeometry();
+
     std::vector<Vertex> vertices;
+
+    // Empty for non-indexed meshes (drawn with glDrawArrays).
+    std::vector<GLuint> indices;
+
+    GLuint ebo {0U};
+
+    // What the GPU buffers hold (the CPU arrays above may be empty for cached meshes).
+    GLsizei vertexCount {0};
+    GLsizei indexCount {0};
+
+    // Allocated sizes of vbo and ebo storage.
+    GLsizeiptr vboCapacity {0};
+    GLsizeiptr eboCapacity {0};
+
+    Aabb bounds;
+
+    // Set by uploadFromCache, for loadCpuGeometry.
+    std::string cachePath;
+    std::uint64_t cacheHash {0UL};
+
+private:
+    // Attribute pointers for the bound vao/vbo, full-precision or quantized (MeshCache::PackedVertex).
+    static void setVertexLayout(bool packed);
 };
 
 
@@ -0,0 +1,82 @@
+#ifndef PARAMETRICSHAPE_H
+#define PARAMETRICSHAPE_H
+
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "mesh/ParametricSurface.h"
+#include "shape/Drawable.h"
+#include "shape/GLShape.h"
+#include "util/Aabb.h"
+#include "util/SoftwareRasterizer.h"
+
+
+class Shader;
+
+
+/// Parametric surface (see mesh/ParametricSurface.h) tessellated on the CPU and drawn with mesh.vert.glsl.
+///
+/// GPU buffers are shared: shapes with the same parameters and resolution
+/// reuse one vertex and index buffer, which lives as long as any of them does.
+/// The buffers hold positions and normals only; the color is a constant vertex attribute,
+/// so shapes that differ only in color or model still share them.
+/// A CPU copy of the surface, shared the same way, feeds rasterize and trace.
+class ParametricShape : public Drawable, public GLShape
+{
+public:
+    /// If generated is not nullptr, it receives the tessellation's stats (all zero if the buffers were shared).
+    ParametricShape(
+            Shader * pShader,
+            const ParametricSurface::Parameters & parameters,
+            int slices,
+            int stacks,
+            const glm::vec3 & color,
+            const glm::mat4 & model,
+            ParametricSurface::Stats * generated = nullptr
+    );
+
+    ~ParametricShape() noexcept override = default;
+
+    void submit(RenderQueue & queue, float timeElapsedSinceLastFrame) override;
+
+    void draw(const RenderQueue::Packet & packet) override;
+
+    /// Adds the shared surface with this shape's model and color.
+    void rasterize(SoftwareRasterizer & rasterizer) override;
+
+    /// As rasterize.
+    void trace(RayTracer & tracer) override;
+
+    /// Shared buffers and CPU copies are split evenly among the shapes using them.
+    [[nodiscard]] Memory getMemory() const override;
+
+    /// Object-space bounding box.
+    [[nodiscard]] const Aabb & getBounds() const;
+
+    /// World-space bounding box.
+    [[nodiscard]] Aabb getWorldBounds() const { return getBounds().transformed(model); }
+
+private:
+    struct Buffers;
+
+    /// Cached buffers for this surface, generated and uploaded on a miss.
+    static std::shared_ptr<const Buffers> acquire(const ParametricSurface::Parameters & parameters,
+                                                  int slices,
+                                                  int stacks,
+                                                  ParametricSurface::Stats * generated);
+
+    /// The shared surface with this shape's color, built on the first call.
+    const std::vector<SoftwareRasterizer::Vertex> & getCpuVertices();
+
+    std::shared_ptr<const Buffers> buffers;
+
+    glm::vec3 color;
+
+    // Filled by getCpuVertices, for the CPU backends only.
+    std::vector<SoftwareRasterizer::Vertex> cpuVertices;
+};
+
+
+#endif  // PARAMETRICSHAPE_H
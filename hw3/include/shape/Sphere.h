@@ -1,15 +1,27 @@
 #ifndef SPHERE_H
 #define SPHERE_H
 
+#include <cstdint>
+#include <vector>
+
 #include <glm/glm.hpp>
 
+#include "shape/Drawable.h"
 #include "shape/GLShape.h"
+#include "util/Aabb.h"
+#include "util/SoftwareRasterizer.h"
 
 
 class Shader;
 
 
-class Sphere : public Renderable, public GLShape
+/// Sphere generated by tessellation shaders.
+///
+/// If pReplayShader is given, each tessellated surface is also captured by transform feedback
+/// (world-space position, normal and color, interleaved like Mesh::Vertex),
+/// and later frames redraw the captured triangles with pReplayShader (e.g., mesh.vert.glsl)
+/// instead of re-tessellating, until model, the sphere parameters or the tessellation levels change.
+class Sphere : public Drawable, public GLShape
 {
 public:
     Sphere(
@@ -17,20 +29,99 @@ public:
             const glm::vec3 & center,
             float radius,
             const glm::vec3 & color,
-            const glm::mat4 & model
+            const glm::mat4 & model,
+            Shader * pReplayShader = nullptr
     );
 
-    ~Sphere() noexcept override = default;
+    ~Sphere() noexcept override;
+
+    void submit(RenderQueue & queue, float timeElapsedSinceLastFrame) override;
+
+    void draw(const RenderQueue::Packet & packet) override;
+
+    /// The CPU tessellation for rasterize, and the capture buffer.
+    [[nodiscard]] Memory getMemory() const override;
+
+    /// Tessellated on the CPU (see mesh/ParametricSurface.h) at the current tessellation levels.
+    void rasterize(SoftwareRasterizer & rasterizer) override;
+
+    /// An analytic sphere, independent of the tessellation levels.
+    void trace(RayTracer & tracer) override;
 
-    void render(float timeElapsedSinceLastFrame) override;
+    /// Picks tessellation levels from the sphere's projected radius in pixels.
+    /// Call once per frame, before render().
+    void setView(const glm::mat4 & view, const glm::mat4 & projection, int viewportHeight);
+
+    /// Current tessellation levels along longitude and latitude.
+    [[nodiscard]] const glm::vec2 & getTessLevel() const { return tessLevel; }
+
+    /// Object-space bounding box.
+    [[nodiscard]] Aabb getBounds() const;
+
+    /// World-space bounding box.
+    [[nodiscard]] Aabb getWorldBounds() const { return getBounds().transformed(model); }
 
 private:
+    // Everything the tessellated surface depends on. Plain floats only, so it compares with memcmp.
+    struct CaptureKey
+    {
+        glm::mat4 model;
+        glm::vec3 center;
+        float radius;
+        glm::vec3 color;
+        glm::vec2 tessLevel;
+    };
+
     static constexpr float kNull {0.0f};
 
+    // Packet tags: tessellate, tessellate and capture, or redraw the capture.
+    enum DrawTag : int
+    {
+        kPatch,
+        kCapture,
+        kReplay
+    };
+
+    // ourFragPos, ourNormal and ourColor in sphere.tese.glsl.
+    static constexpr GLsizeiptr kCapturedVertexSize {3 * sizeof(glm::vec3)};
+
+    void drawPatch();
+
+    // Tessellates (drawing at the same time) and records the result into captureVbo.
+    void capture();
+
+    void replay();
+
+    // Target length of one tessellated edge on screen.
+    static constexpr float kPixelsPerSegment {8.0f};
+
+    // Coarsest tessellation along latitude (longitude gets twice as many segments).
+    static constexpr float kMinTessLevel {4.0f};
+
 private:
     glm::vec3 center {0.0f, 0.0f, 0.0f};
     float radius {1.0f};
     glm::vec3 color {1.0f, 0.5f, 0.31f};
+
+    // GL_MAX_TESS_GEN_LEVEL, at least 64.
+    float maxTessLevel {64.0f};
+
+    // Segments around the equator (phi) and from pole to pole (theta).
+    glm::vec2 tessLevel {64.0f, 64.0f};
+
+    // Transform feedback cache, unused if pReplayShader is nullptr.
+    Shader * pReplayShader {nullptr};
+    GLuint feedback {0U};
+    GLuint captureVao {0U};
+    GLuint captureVbo {0U};
+    GLsizeiptr captureCapacity {0};
+    bool captured {false};
+    CaptureKey capturedKey {};
+
+    // CPU tessellation for rasterize, regenerated when tessLevel changes.
+    std::vector<SoftwareRasterizer::Vertex> cpuVertices;
+    std::vector<std::uint32_t> cpuIndices;
+    glm::vec2 cpuTessLevel {0.0f, 0.0f};
 };
 
 
@@ -0,0 +1,139 @@
+#ifndef STATICMESHPOOL_H
+#define STATICMESHPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "shape/Drawable.h"
+#include "shape/GLShape.h"
+#include "util/Aabb.h"
+
+
+class Shader;
+struct MeshData;
+
+
+/// Many static meshes packed into one vertex buffer and one index buffer,
+/// drawn with a single multi-draw call however many meshes there are.
+/// Renders with pool.vert.glsl: every vertex carries the index of its mesh,
+/// which the shader uses to fetch that mesh's model and normal matrices from a buffer texture.
+///
+/// With GL_ARB_multi_draw_indirect, the draw commands live in an indirect buffer and
+/// are issued by glMultiDrawElementsIndirect; otherwise by glMultiDrawElementsBaseVertex (OpenGL 3.2).
+///
+/// Meshes cannot be removed. Geometry and transforms are uploaded on the first submit after they change.
+class StaticMeshPool : public Drawable, public GLShape
+{
+public:
+    /// Identifies a mesh in its pool.
+    using Handle = std::uint32_t;
+
+    explicit StaticMeshPool(Shader * pShader);
+
+    ~StaticMeshPool() noexcept override;
+
+    void submit(RenderQueue & queue, float timeElapsedSinceLastFrame) override;
+
+    void draw(const RenderQueue::Packet & packet) override;
+
+    [[nodiscard]] Memory getMemory() const override;
+
+    /// One SoftwareRasterizer::addTriangles per mesh.
+    void rasterize(SoftwareRasterizer & rasterizer) override;
+
+    /// As rasterize.
+    void trace(RayTracer & tracer) override;
+
+    /// Adds indexed data in one color. If data carries no normals, smooth normals are generated.
+    Handle add(const MeshData & data, const glm::vec3 & color, const glm::mat4 & model);
+
+    /// Throws std::out_of_range if handle was never added.
+    void setModel(Handle handle, const glm::mat4 & model);
+
+    [[nodiscard]] std::size_t size() const { return models.size(); }
+
+    /// World-space bounding box of all meshes (empty without meshes). Linear in size().
+    [[nodiscard]] Aabb getWorldBounds() const;
+
+private:
+    struct Vertex
+    {
+        glm::vec3 position;
+        glm::vec3 normal;
+        glm::vec3 color;
+        GLuint mesh;
+    };
+
+    /// One glMultiDrawElementsIndirect command, as laid out in the indirect buffer.
+    struct DrawCommand
+    {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+
+    // Buffer texture texels per mesh: the model matrix columns, then the normal matrix columns.
+    static constexpr std::size_t kTexelsPerMesh {7UL};
+
+    /// Calls f(vertices, numVertices, indices, numIndices, model) for each mesh, straight from the pool's arrays.
+    template <typename F>
+    void forEachMesh(F f) const
+    {
+        for (std::size_t i = 0UL; i != commands.size(); ++i)
+        {
+            // Meshes are packed in order, so each one's vertices end where the next one's begin.
+            auto firstVertex = static_cast<std::size_t>(commands[i].baseVertex);
+            std::size_t endVertex = i + 1UL == commands.size()
+                                    ? vertices.size()
+                                    : static_cast<std::size_t>(commands[i + 1UL].baseVertex);
+
+            f(vertices.data() + firstVertex,
+              endVertex - firstVertex,
+              indices.data() + commands[i].firstIndex,
+              static_cast<std::size_t>(commands[i].count),
+              models[i]);
+        }
+    }
+
+    void uploadGeometry();
+
+    void uploadTransforms();
+
+    GLuint ebo {0U};
+    GLuint indirectBuffer {0U};
+    GLuint transformBuffer {0U};
+    GLuint transformTexture {0U};
+
+    bool indirect {false};
+
+    // Kept after upload: adding a mesh re-sends the whole pool.
+    std::vector<Vertex> vertices;
+    std::vector<GLuint> indices;
+
+    std::vector<DrawCommand> commands;
+
+    // glMultiDrawElementsBaseVertex arguments, derived from commands.
+    std::vector<GLsizei> counts;
+    std::vector<const void *> offsets;
+    std::vector<GLint> baseVertices;
+
+    std::vector<glm::mat4> models;
+
+    // Object-space bounding box of each mesh.
+    std::vector<Aabb> bounds;
+
+    bool geometryDirty {false};
+    bool transformsDirty {false};
+
+    // Center of getWorldBounds() for the render queue, recomputed only after meshes change.
+    glm::vec3 worldCenter {0.0f};
+    bool worldBoundsChanged {false};
+};
+
+
+#endif  // STATICMESHPOOL_H
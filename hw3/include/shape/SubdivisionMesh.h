@@ -0,0 +1,66 @@
+#ifndef SUBDIVISIONMESH_H
+#define SUBDIVISIONMESH_H
+
+#include <future>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "mesh/LoopSubdivision.h"
+#include "shape/Mesh.h"
+
+
+class Shader;
+
+
+/// Smooth-shaded polyhedron with adjustable Loop subdivision level.
+/// Levels are computed on a worker thread (see mesh/LoopSubdivision.h);
+/// the previous level keeps rendering until the new one is ready,
+/// then it is swapped into the existing vertex and index buffers.
+class SubdivisionMesh : public Mesh
+{
+public:
+    SubdivisionMesh(Shader * pShader, const std::string & vertexFile, const glm::vec3 & color, const glm::mat4 & model);
+
+    // The std::async future blocks until an in-flight level is finished.
+    ~SubdivisionMesh() noexcept override = default;
+
+    void submit(RenderQueue & queue, float timeElapsedSinceLastFrame) override;
+
+    void rasterize(SoftwareRasterizer & rasterizer) override;
+
+    void trace(RayTracer & tracer) override;
+
+    /// Requests a subdivision level (clamped to [0, LoopSubdivision::kMaxLevel]). Does not block.
+    void setLevel(int level);
+
+    /// The most recently requested level (which may still be computing).
+    [[nodiscard]] int getLevel() const { return requestedLevel; }
+
+private:
+    struct Level
+    {
+        int level {0};
+        std::vector<Vertex> vertices;
+        std::vector<GLuint> indices;
+    };
+
+    // Only the worker touches subdivision while pending is valid.
+    void launch(int level);
+
+    /// Swaps in a finished background result, if any. Called once per frame.
+    void poll();
+
+    glm::vec3 color;
+
+    LoopSubdivision subdivision;
+
+    std::future<Level> pending;
+
+    int requestedLevel {0};
+    int displayedLevel {0};
+};
+
+
+#endif  // SUBDIVISIONMESH_H
@@ -0,0 +1,75 @@
+#ifndef SUPERQUADRIC_H
+#define SUPERQUADRIC_H
+
+#include <future>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "mesh/ParametricSurface.h"
+#include "shape/Mesh.h"
+
+
+class Shader;
+
+
+/// Superquadric whose parameters can change at runtime (e.g. when etc/config.txt is edited).
+/// Unlike ParametricShape, it owns its buffers. New parameters are tessellated on a worker thread
+/// while the previous surface keeps rendering; the resolution is fixed, so the new vertices
+/// are the same size and go into the existing vertex buffer with glBufferSubData.
+class Superquadric : public Mesh
+{
+public:
+    Superquadric(
+            Shader * pShader,
+            const ParametricSurface::Parameters & parameters,
+            int slices,
+            int stacks,
+            const glm::vec3 & color,
+            const glm::mat4 & model
+    );
+
+    // The std::async future blocks until an in-flight tessellation is finished.
+    ~Superquadric() noexcept override = default;
+
+    void submit(RenderQueue & queue, float timeElapsedSinceLastFrame) override;
+
+    void rasterize(SoftwareRasterizer & rasterizer) override;
+
+    void trace(RayTracer & tracer) override;
+
+    /// Requests new parameters (a ParametricSurface::superquadric). Does nothing if they are unchanged;
+    /// otherwise the surface is regenerated in the background. Does not block.
+    void setParameters(const ParametricSurface::Parameters & parameters);
+
+    /// World-space bounding box of the displayed surface and of the requested one,
+    /// so it stays valid until the requested surface is displayed.
+    [[nodiscard]] Aabb getWorldBounds() const;
+
+private:
+    struct Surface
+    {
+        ParametricSurface::Parameters parameters;
+        std::vector<Vertex> vertices;
+    };
+
+    static bool sameParameters(const ParametricSurface::Parameters & a, const ParametricSurface::Parameters & b);
+
+    void launch(const ParametricSurface::Parameters & parameters);
+
+    /// Swaps in a finished background result, if any. Called once per frame.
+    void poll();
+
+    glm::vec3 color;
+
+    int slices;
+    int stacks;
+
+    std::future<Surface> pending;
+
+    ParametricSurface::Parameters requested;
+    ParametricSurface::Parameters displayed;
+};
+
+
+#endif  // SUPERQUADRIC_H
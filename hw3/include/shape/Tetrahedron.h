@@ -5,6 +5,7 @@
 
 #include <glm/glm.hpp>
 
+#include "mesh/NormalGenerator.h"
 #include "shape/Mesh.h"
 
 
@@ -14,14 +15,25 @@ class Shader;
 class Tetrahedron : public Mesh
 {
 public:
-    Tetrahedron(Shader * pShader, const std::string & vertexFile, const glm::mat4 & model);
+    /// Loads the facets in vertexFile. Edges whose faces meet at more than creaseAngleDegrees
+    /// are shaded hard; NormalGenerator::kSmooth shades the whole surface smooth, NormalGenerator::kFlat every face flat.
+    /// The GPU-ready result is cached next to the source (see mesh/MeshCache.h)
+    /// and reused on later launches until the source file or the crease angle changes.
+    Tetrahedron(Shader * pShader, const std::string & vertexFile, const glm::mat4 & model, float creaseAngleDegrees = NormalGenerator::kFlat);
 
     ~Tetrahedron() noexcept override = default;
 
-    void render(float timeElapsedSinceLastFrame) override;
+protected:
+    void loadSourceGeometry() override;
 
 private:
     static constexpr glm::vec3 kColor {0.31f, 0.5f, 1.0f};
+
+    // Store normals and colors as 10:10:10:2 and RGBA8 in the cache.
+    static constexpr bool kQuantizeCache {true};
+
+    std::string vertexFile;
+    float creaseAngleDegrees {NormalGenerator::kFlat};
 };
 
 
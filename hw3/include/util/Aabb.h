@@ -0,0 +1,62 @@
+#ifndef AABB_H
+#define AABB_H
+
+#include <limits>
+
+#include <glm/glm.hpp>
+
+
+/// Axis-aligned bounding box. Default-constructed boxes are empty.
+struct Aabb
+{
+    [[nodiscard]] bool empty() const
+    {
+        return max.x < min.x || max.y < min.y || max.z < min.z;
+    }
+
+    [[nodiscard]] glm::vec3 center() const
+    {
+        return 0.5f * (min + max);
+    }
+
+    [[nodiscard]] glm::vec3 extent() const
+    {
+        return max - min;
+    }
+
+    void expand(const glm::vec3 & p)
+    {
+        min = glm::min(min, p);
+        max = glm::max(max, p);
+    }
+
+    void expand(const Aabb & rhs)
+    {
+        min = glm::min(min, rhs.min);
+        max = glm::max(max, rhs.max);
+    }
+
+    /// Smallest box around this box transformed by m (Arvo 1990).
+    [[nodiscard]] Aabb transformed(const glm::mat4 & m) const
+    {
+        if (empty())
+        {
+            return *this;
+        }
+
+        glm::vec3 c = glm::vec3(m * glm::vec4(center(), 1.0f));
+        glm::vec3 h = 0.5f * extent();
+        glm::vec3 r = glm::abs(glm::vec3(m[0])) * h.x + glm::abs(glm::vec3(m[1])) * h.y + glm::abs(glm::vec3(m[2])) * h.z;
+
+        Aabb box;
+        box.min = c - r;
+        box.max = c + r;
+        return box;
+    }
+
+    glm::vec3 min {std::numeric_limits<float>::max()};
+    glm::vec3 max {std::numeric_limits<float>::lowest()};
+};
+
+
+#endif  // AABB_H
@@ -0,0 +1,58 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <cstddef>
+#include <vector>
+
+#include "util/Aabb.h"
+#include "util/FrameArena.h"
+#include "util/Frustum.h"
+
+
+/// Bounding volume hierarchy over the world-space boxes of scene objects.
+///
+/// Built top-down, splitting the box centers at the median along their widest axis;
+/// one object per leaf. Moving an object only refits the boxes on its path to the root
+/// (the topology is kept, so many large moves slowly degrade culling until the next build).
+class Bvh
+{
+public:
+    /// Object i is the one with boxes[i]. Replaces any previous hierarchy.
+    void build(const std::vector<Aabb> & boxes);
+
+    /// Sets the box of object and refits its ancestors.
+    void refit(std::size_t object, const Aabb & box);
+
+    /// Appends to visible (in no particular order) every object whose box is not entirely outside frustum.
+    /// Subtrees entirely inside are appended without further tests.
+    /// The traversal stack is allocated from the calling thread's FrameArena, so call it only from a thread
+    /// that calls FrameArena::current().beginFrame() every frame (the main thread does); elsewhere the arena never resets.
+    void query(const Frustum & frustum, FrameVector<std::size_t> & visible) const;
+
+    [[nodiscard]] std::size_t size() const { return leafOfObject.size(); }
+
+private:
+    static constexpr int kNone {-1};
+
+    struct Node
+    {
+        Aabb bounds;
+        int parent {kNone};
+
+        // Children of internal nodes; for leaves, left is the object and right is kNone.
+        int left {kNone};
+        int right {kNone};
+    };
+
+    /// Builds the subtree over objects[first, last) and returns its node.
+    int build(const std::vector<Aabb> & boxes, std::vector<int> & objects, std::size_t first, std::size_t last, int parent);
+
+    /// Appends the objects of every leaf below node.
+    void collect(int node, FrameVector<std::size_t> & visible) const;
+
+    std::vector<Node> nodes;
+    std::vector<int> leafOfObject;
+};
+
+
+#endif  // BVH_H
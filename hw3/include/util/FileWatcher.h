@@ -0,0 +1,41 @@
+#ifndef FILEWATCHER_H
+#define FILEWATCHER_H
+
+#include <ctime>
+#include <string>
+
+
+/// Reports when a file has been rewritten; meant to be polled once per frame and never blocks.
+/// On Linux it uses inotify on the parent directory, so it also catches editors
+/// that save by writing a temporary file and renaming it over the original.
+/// Elsewhere it compares modification times.
+class FileWatcher
+{
+public:
+    FileWatcher() = delete;
+    FileWatcher(const FileWatcher &) = delete;
+    FileWatcher & operator=(const FileWatcher &) = delete;
+
+    /// Throws std::runtime_error if the watch cannot be set up (e.g. the directory does not exist).
+    explicit FileWatcher(const std::string & path);
+
+    ~FileWatcher() noexcept;
+
+    /// True if the file has been written (and closed) or replaced since the last call.
+    bool poll();
+
+    [[nodiscard]] const std::string & getPath() const { return path; }
+
+private:
+    std::string path;
+
+#ifdef __linux__
+    std::string fileName;
+    int fd {-1};
+#else
+    std::timespec lastModified {};
+#endif
+};
+
+
+#endif  // FILEWATCHER_H
@@ -0,0 +1,160 @@
+#ifndef FRAMEARENA_H
+#define FRAMEARENA_H
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+
+/// Bump allocator for transient render data (culling stacks, sort keys, staging arrays),
+/// so per-frame temporaries cost a pointer increment instead of a heap allocation each.
+///
+/// Each thread has its own arena (current()); the thread using it calls beginFrame() once per frame
+/// (App::run does, for the main thread). Memory is never freed individually:
+/// kThisFrame allocations stay valid until the next beginFrame(),
+/// kNextFrame ones until the one after, for data one frame produces and the next consumes (double-buffered).
+///
+/// Storage grows in chunks while a frame needs more than the arena holds; at the next beginFrame()
+/// the chunks are merged into one of the high-water size, so the steady state allocates nothing.
+class FrameArena
+{
+public:
+    enum Lifetime : std::size_t
+    {
+        kThisFrame,
+        kNextFrame
+    };
+
+    struct Stats
+    {
+        // Most bytes one frame allocated, per lifetime (padding included).
+        std::array<std::size_t, 2> highWaterBytes {};
+
+        // Bytes held by the arena.
+        std::size_t capacityBytes {0UL};
+
+        // Chunks allocated from the heap since the thread started.
+        std::size_t numChunks {0UL};
+    };
+
+public:
+    /// The calling thread's arena.
+    static FrameArena & current();
+
+    FrameArena(const FrameArena &) = delete;
+    FrameArena(FrameArena &&) = delete;
+    FrameArena & operator=(const FrameArena &) = delete;
+    FrameArena & operator=(FrameArena &&) = delete;
+
+    ~FrameArena() noexcept = default;
+
+    /// Frees the kThisFrame allocations of the previous frame and the kNextFrame ones of the frame before.
+    void beginFrame();
+
+    /// size bytes aligned to alignment (a power of two).
+    void * allocate(std::size_t size, std::size_t alignment, Lifetime lifetime = kThisFrame);
+
+    [[nodiscard]] Stats getStats() const;
+
+private:
+    /// Chunked bump allocator, reset as a whole.
+    class Buffer
+    {
+    public:
+        void * allocate(std::size_t size, std::size_t alignment, std::size_t & numChunks);
+
+        void reset(std::size_t & numChunks);
+
+        [[nodiscard]] std::size_t getHighWaterBytes() const { return highWaterBytes; }
+
+        [[nodiscard]] std::size_t getCapacityBytes() const;
+
+    private:
+        struct Chunk
+        {
+            std::unique_ptr<std::byte[]> data;
+            std::size_t size {0UL};
+        };
+
+        std::vector<Chunk> chunks;
+
+        // Bytes used of chunks.back(), and in all chunks this frame.
+        std::size_t used {0UL};
+        std::size_t frameBytes {0UL};
+
+        std::size_t highWaterBytes {0UL};
+    };
+
+    // Bytes of the first chunk of a buffer.
+    static constexpr std::size_t kMinChunkSize {64UL * 1024UL};
+
+    FrameArena() = default;
+
+    // thisFrame, then the two halves of the kNextFrame double buffer; next is the one being filled.
+    Buffer thisFrame;
+    std::array<Buffer, 2> nextFrame;
+    std::size_t next {0UL};
+
+    std::size_t numChunks {0UL};
+};
+
+
+/// Allocator for standard containers in a FrameArena (by default the calling thread's, for this frame).
+/// Deallocation is a no-op: the container must not outlive its lifetime,
+/// and growth leaves the old storage in the arena until the frame ends, so reserve() what is known.
+template <typename T>
+class FrameAllocator
+{
+public:
+    using value_type = T;
+
+    explicit FrameAllocator(FrameArena::Lifetime lifetime = FrameArena::kThisFrame)
+            : pArena(&FrameArena::current()), lifetime(lifetime)
+    {
+
+    }
+
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U> & other) noexcept : pArena(other.pArena), lifetime(other.lifetime)
+    {
+
+    }
+
+    T * allocate(std::size_t n)
+    {
+        return static_cast<T *>(pArena->allocate(n * sizeof(T), alignof(T), lifetime));
+    }
+
+    void deallocate(T *, std::size_t) noexcept
+    {
+
+    }
+
+    template <typename U>
+    bool operator==(const FrameAllocator<U> & rhs) const noexcept
+    {
+        return pArena == rhs.pArena && lifetime == rhs.lifetime;
+    }
+
+    template <typename U>
+    bool operator!=(const FrameAllocator<U> & rhs) const noexcept
+    {
+        return !(*this == rhs);
+    }
+
+private:
+    template <typename U>
+    friend class FrameAllocator;
+
+    FrameArena * pArena {nullptr};
+    FrameArena::Lifetime lifetime {FrameArena::kThisFrame};
+};
+
+
+/// std::vector in a FrameArena, e.g. FrameVector<Pixel::Vertex>.
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+
+#endif  // FRAMEARENA_H
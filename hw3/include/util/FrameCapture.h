@@ -0,0 +1,114 @@
+#ifndef FRAMECAPTURE_H
+#define FRAMECAPTURE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glad/glad.h>
+
+
+/// Saves rendered frames to image files (see util/ImageFile.h), or hands them to another handler,
+/// without stalling the GPU.
+///
+/// capture() starts an asynchronous glReadPixels into one of kNumBuffers pixel buffer objects
+/// and fences it; a buffer is only mapped once its fence has signaled, kNumBuffers - 1 frames later at the latest,
+/// so the readback overlaps with rendering the following frames. The handler (encoding and writing the files
+/// by default) runs on a writer thread of its own.
+class FrameCapture
+{
+public:
+    static constexpr int kNumBuffers {3};
+
+    // Frames waiting for the writer before capture() blocks, bounding memory when the disk falls behind.
+    static constexpr std::size_t kMaxQueuedFrames {8UL};
+
+    /// Called on the writer thread with the path passed to capture() and the frame as RGBA8, top row first.
+    /// Returns false on failure.
+    using Handler = std::function<bool(const std::string & path, const std::vector<std::uint8_t> & rgba, int width, int height)>;
+
+    struct Stats
+    {
+        std::size_t numCaptured {0UL};
+
+        // Frames the handler succeeded and failed on.
+        std::size_t numHandled {0UL};
+        std::size_t numFailed {0UL};
+
+        // Reads that were still in flight when their buffer was needed again.
+        std::size_t numStalls {0UL};
+    };
+
+public:
+    /// Frames are width x height pixels from the lower left corner of the read framebuffer.
+    /// Frames are written to image files.
+    FrameCapture(int width, int height);
+
+    FrameCapture(int width, int height, Handler handler);
+
+    FrameCapture(const FrameCapture &) = delete;
+    FrameCapture & operator=(const FrameCapture &) = delete;
+
+    /// Handles every captured frame before returning.
+    ~FrameCapture() noexcept;
+
+    /// Reads the current read framebuffer and hands it to the handler later on,
+    /// by default saving it to path (PNG or PPM by extension).
+    void capture(const std::string & path);
+
+    /// Blocks until every captured frame has been handled.
+    void finish();
+
+    /// Counters of the writer thread are current as of the last finish().
+    [[nodiscard]] Stats getStats() const;
+
+private:
+    struct Slot
+    {
+        GLuint pbo {0U};
+        GLsync fence {nullptr};
+        std::string path;
+    };
+
+    struct Frame
+    {
+        std::string path;
+        std::vector<std::uint8_t> pixels;
+    };
+
+    /// Maps the slot's buffer (waiting for its fence if wait) and queues its frame for the writer.
+    /// Returns false, leaving the slot alone, if !wait and the read has not finished.
+    bool retire(Slot & slot, bool wait);
+
+    void writerLoop();
+
+    int width {0};
+    int height {0};
+
+    Handler handler;
+
+    Slot slots[kNumBuffers];
+
+    // The slot the next capture reads into; also the oldest one in flight.
+    int next {0};
+
+    std::thread writer;
+
+    mutable std::mutex mutex;
+    std::condition_variable frameQueued;
+    std::condition_variable frameWritten;
+    std::deque<Frame> queue;
+    bool writing {false};
+    bool stopping {false};
+
+    Stats stats;
+};
+
+
+#endif  // FRAMECAPTURE_H
@@ -0,0 +1,79 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+#include "util/Aabb.h"
+
+
+/// View frustum as six inward-facing planes, extracted from a view-projection matrix
+/// (Gribb and Hartmann 2001). Planes are in the space the matrix maps from,
+/// i.e. world space for projection * view.
+class Frustum
+{
+public:
+    enum Result : int
+    {
+        kOutside,
+        kIntersecting,
+        kInside
+    };
+
+public:
+    explicit Frustum(const glm::mat4 & viewProjection)
+    {
+        // Rows of the matrix (glm is column-major).
+        glm::vec4 row[4];
+
+        for (int i = 0; i != 4; ++i)
+        {
+            row[i] = {viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]};
+        }
+
+        // Left, right, bottom, top, near, far.
+        planes[0] = row[3] + row[0];
+        planes[1] = row[3] - row[0];
+        planes[2] = row[3] + row[1];
+        planes[3] = row[3] - row[1];
+        planes[4] = row[3] + row[2];
+        planes[5] = row[3] - row[2];
+    }
+
+    /// Conservative: boxes near the frustum's edges may report kIntersecting while outside.
+    [[nodiscard]] Result test(const Aabb & box) const
+    {
+        Result result = kInside;
+
+        for (const glm::vec4 & p : planes)
+        {
+            glm::vec3 n(p);
+
+            // The box corners farthest along and against the plane normal.
+            glm::vec3 positive {0.0f <= n.x ? box.max.x : box.min.x,
+                                0.0f <= n.y ? box.max.y : box.min.y,
+                                0.0f <= n.z ? box.max.z : box.min.z};
+
+            glm::vec3 negative {0.0f <= n.x ? box.min.x : box.max.x,
+                                0.0f <= n.y ? box.min.y : box.max.y,
+                                0.0f <= n.z ? box.min.z : box.max.z};
+
+            if (glm::dot(n, positive) + p.w < 0.0f)
+            {
+                return kOutside;
+            }
+
+            if (glm::dot(n, negative) + p.w < 0.0f)
+            {
+                result = kIntersecting;
+            }
+        }
+
+        return result;
+    }
+
+private:
+    glm::vec4 planes[6];
+};
+
+
+#endif  // FRUSTUM_H
@@ -0,0 +1,162 @@
+#ifndef GLTRACE_H
+#define GLTRACE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <glad/glad.h>
+
+
+/// Records the OpenGL command stream into a compact binary trace, for replaying slow frames elsewhere
+/// (GLTraceReplayer, src/replay.cpp).
+///
+/// start() swaps glad's function pointers for the entry points this program uses with wrappers that call the driver,
+/// then append the call: its entry point, its arguments, the memory its pointer arguments read
+/// (buffer and texture data, uniform values, shader sources) or write (generated names, query results),
+/// and its return value. Pointers into bound buffers (vertex attribute offsets, indices, indirect commands,
+/// pixel pack buffers) are offsets and recorded as such. The trace is handed to a writer thread in blocks,
+/// so the calls themselves only pay for copying their arguments.
+///
+/// Start before the first OpenGL call of the program (object creation is part of the trace),
+/// and only call OpenGL from the thread that owns the context.
+class GLTraceRecorder
+{
+public:
+    static GLTraceRecorder & getInstance();
+
+    GLTraceRecorder(const GLTraceRecorder &) = delete;
+    GLTraceRecorder(GLTraceRecorder &&) = delete;
+    GLTraceRecorder & operator=(const GLTraceRecorder &) = delete;
+    GLTraceRecorder & operator=(GLTraceRecorder &&) = delete;
+
+    /// Stops recording.
+    ~GLTraceRecorder() noexcept;
+
+    /// Installs the wrappers and starts a trace at path. Throws std::runtime_error if path cannot be written.
+    void start(const std::string & path);
+
+    /// Marks the end of a frame.
+    void endFrame();
+
+    /// Restores glad's function pointers and waits until the whole trace is on disk.
+    void stop();
+
+    [[nodiscard]] bool isRecording() const { return recording; }
+
+    /// Appends raw bytes to the trace; used by the wrappers.
+    void append(const void * data, std::size_t size);
+
+private:
+    // Trace bytes handed to the writer at a time.
+    static constexpr std::size_t kBlockSize {1UL << 20UL};
+
+    GLTraceRecorder() = default;
+
+    /// Hands the current block to the writer thread.
+    void flush();
+
+    void writerLoop();
+
+    bool recording {false};
+
+    std::string path;
+    std::uint64_t numBytes {0UL};
+    std::vector<std::uint8_t> block;
+
+    std::ofstream fout;
+    std::thread writer;
+
+    std::mutex mutex;
+    std::condition_variable blockQueued;
+    std::deque<std::vector<std::uint8_t>> queue;
+    bool stopping {false};
+};
+
+
+/// Re-issues a trace of GLTraceRecorder on the current context and times each call.
+///
+/// Objects are expected to get the same names as when the trace was recorded,
+/// which holds for a fresh context of the same driver; mismatches are counted.
+/// Fences are mapped to their replayed counterparts.
+class GLTraceReplayer
+{
+public:
+    struct EntryPointStats
+    {
+        std::string name;
+        std::uint64_t numCalls {0UL};
+        double seconds {0.0};
+        double maxSeconds {0.0};
+    };
+
+    struct FrameStats
+    {
+        std::size_t numCalls {0UL};
+
+        // Time spent in the calls, and the frame from its first call until glFinish returns after its last one.
+        double callSeconds {0.0};
+        double seconds {0.0};
+    };
+
+    /// Set up while replaying the calls before the first frame marker (object creation and uploads).
+    static constexpr std::size_t kSetupFrame {0UL};
+
+public:
+    /// Reads the trace at path. Throws std::runtime_error if it cannot be read or is not a trace.
+    explicit GLTraceReplayer(const std::string & path);
+
+    /// Replays the whole trace once. Throws std::runtime_error if the trace is malformed.
+    void replay();
+
+    /// Setup (kSetupFrame), then one entry per frame of the last replay.
+    [[nodiscard]] const std::vector<FrameStats> & getFrameStats() const { return frameStats; }
+
+    /// Entry points called in the last replay, most time spent first.
+    [[nodiscard]] std::vector<EntryPointStats> getEntryPointStats() const;
+
+    /// Generated names and uniform locations that differed from the recorded ones in the last replay.
+    [[nodiscard]] std::size_t getNumNameMismatches() const { return numNameMismatches; }
+
+    /// Used by the decoders of the calls.
+    struct Cursor
+    {
+        const std::uint8_t * data {nullptr};
+        const std::uint8_t * end {nullptr};
+
+        // Pointer arguments decoded for the current call (outputs, string arrays).
+        std::deque<std::vector<std::uint8_t>> scratch;
+        std::deque<std::vector<const GLchar *>> strings;
+
+        // Generated names of the current call: as recorded, and as replayed.
+        std::vector<std::pair<const std::uint8_t *, const std::vector<std::uint8_t> *>> names;
+
+        std::unordered_map<std::uint64_t, GLsync> syncs;
+        std::size_t numNameMismatches {0UL};
+
+        /// Returns the next size bytes. Throws std::runtime_error past the end.
+        const std::uint8_t * read(std::size_t size);
+    };
+
+private:
+    std::vector<std::uint8_t> trace;
+
+    // Entry point of each opcode of the trace in this build's table; the frame marker maps past its end.
+    std::vector<std::size_t> entryPoints;
+    std::size_t bodyOffset {0UL};
+
+    std::vector<FrameStats> frameStats;
+    std::vector<EntryPointStats> entryPointStats;
+    std::size_t numNameMismatches {0UL};
+};
+
+
+#endif  // GLTRACE_H
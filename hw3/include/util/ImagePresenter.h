@@ -0,0 +1,41 @@
+#ifndef IMAGEPRESENTER_H
+#define IMAGEPRESENTER_H
+
+#include <cstdint>
+#include <vector>
+
+#include <glad/glad.h>
+
+
+class Shader;
+
+
+/// Shows a CPU-rendered RGBA8 image (top row first, e.g. SoftwareRasterizer's color buffer)
+/// by uploading it to a texture and drawing one fullscreen triangle with present.vert.glsl.
+/// The texture is reallocated only when the image size changes.
+class ImagePresenter
+{
+public:
+    explicit ImagePresenter(Shader * pShader);
+
+    ImagePresenter(const ImagePresenter &) = delete;
+    ImagePresenter & operator=(const ImagePresenter &) = delete;
+
+    ~ImagePresenter() noexcept;
+
+    /// Covers the whole viewport with the image. Depth testing is off while it draws.
+    void present(const std::vector<std::uint8_t> & rgba, int width, int height);
+
+private:
+    Shader * pShader {nullptr};
+
+    // Attribute-less: present.vert.glsl derives the triangle from gl_VertexID.
+    GLuint vao {0U};
+    GLuint texture {0U};
+
+    int textureWidth {0};
+    int textureHeight {0};
+};
+
+
+#endif  // IMAGEPRESENTER_H
@@ -0,0 +1,34 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+
+/// Read-only memory mapping of a whole file.
+/// The mapping lives as long as this object;
+/// pointers into data() must not outlive it.
+class MappedFile
+{
+public:
+    MappedFile() = delete;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+
+    explicit MappedFile(const std::string & path);
+
+    MappedFile(MappedFile &&) noexcept;
+    MappedFile & operator=(MappedFile &&) noexcept;
+
+    ~MappedFile() noexcept;
+
+    [[nodiscard]] const char * data() const { return pData; }
+    [[nodiscard]] std::size_t size() const { return numBytes; }
+
+private:
+    const char * pData {nullptr};
+    std::size_t numBytes {0UL};
+};
+
+
+#endif  // MAPPEDFILE_H
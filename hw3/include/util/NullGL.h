@@ -0,0 +1,49 @@
+#ifndef NULLGL_H
+#define NULLGL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/// OpenGL "driver" that accepts every call and does (almost) nothing, for measuring the CPU side of rendering
+/// (uniform lookups, state changes, matrix math) apart from the real driver's.
+/// With the NULL_GL CMake option, Window loads glad's function pointers from here instead of the context.
+///
+/// Reports OpenGL 4.1 plus the ARB extensions the apps use beyond glad's 3.3 core loader.
+/// Generated names (buffers, shaders, ...) and uniform locations count up; compiles and links succeed;
+/// framebuffers are complete; fences are signaled at once; mapped buffers point at scratch memory;
+/// other queries return zeros. Every entry point counts its calls.
+///
+/// Entry points without an implementation of their own share generic stubs that take no arguments and return zero,
+/// called through the entry point's own type. This relies on the caller popping the arguments,
+/// as in the x86-64 and AArch64 calling conventions.
+/// Not thread-safe, like an OpenGL context.
+class NullGL
+{
+public:
+    struct CallCount
+    {
+        std::string name;
+        std::uint64_t numCalls {0UL};
+    };
+
+public:
+    /// A GLADloadproc. Returns nullptr once kMaxEntryPoints are loaded.
+    static void * getProcAddress(const char * name);
+
+    /// Entry points called since the last reset, most called first.
+    static std::vector<CallCount> getCallCounts();
+
+    /// Prints the total calls per frame and per second, and the calls per frame of the most called entry points.
+    static void printCallCounts(std::size_t numFrames, double seconds, std::size_t numEntryPoints = 10UL);
+
+    static void resetCallCounts();
+
+    // More than glad loads for the reported version and extensions.
+    static constexpr std::size_t kMaxEntryPoints {1024UL};
+};
+
+
+#endif  // NULLGL_H
@@ -0,0 +1,105 @@
+#ifndef OCCLUSIONCULLER_H
+#define OCCLUSIONCULLER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "util/Aabb.h"
+
+
+/// Software occlusion culling: occluder triangles are rasterized into a small CPU depth buffer
+/// (SSE, four pixels at a time; scalar elsewhere) on a worker thread, and bounding boxes are then
+/// tested against it. Needs no GPU queries, so nothing waits for the GPU.
+/// The worker is started by the first beginFrame and woken once per frame, so frames neither create threads
+/// nor allocate.
+///
+/// Depth is NDC z mapped to [0, 1] (nearer is smaller). Every kTileSize x kTileSize tile keeps
+/// the nearest and farthest depth in it: most boxes are decided per tile, the rest per pixel.
+/// Pixels are sampled at their centers, so at this resolution an object peeking through a gap
+/// thinner than a pixel may be culled; choose occluders that are solid (e.g. buildings).
+class OcclusionCuller
+{
+public:
+    /// Pixels need not be square; the buffer always covers the whole viewport.
+    static constexpr int kWidth {256};
+    static constexpr int kHeight {128};
+    static constexpr int kTileSize {8};
+
+public:
+    OcclusionCuller() = default;
+    OcclusionCuller(const OcclusionCuller &) = delete;
+    OcclusionCuller & operator=(const OcclusionCuller &) = delete;
+
+    /// Waits for an in-flight frame, then stops the worker.
+    ~OcclusionCuller() noexcept;
+
+    /// Adds static occluder geometry (a triangle list), transformed to world space by model.
+    /// Must not be called between beginFrame and the tests of that frame.
+    void addOccluder(const std::vector<glm::vec3> & positions, const std::vector<std::uint32_t> & indices, const glm::mat4 & model);
+
+    /// Starts rasterizing all occluders as seen through viewProjection on a worker thread. Does not block.
+    void beginFrame(const glm::mat4 & viewProjection);
+
+    /// False if the world-space box is certainly hidden behind the occluders of the current frame.
+    /// The first call after beginFrame waits for the rasterization to finish,
+    /// and rethrows what the rasterization threw.
+    bool isVisible(const Aabb & box);
+
+    [[nodiscard]] std::size_t numOccluderTriangles() const { return occluderIndices.size() / 3UL; }
+
+private:
+    static constexpr int kTilesX {kWidth / kTileSize};
+    static constexpr int kTilesY {kHeight / kTileSize};
+
+    static_assert(kWidth % kTileSize == 0 && kHeight % kTileSize == 0, "tiles must cover the buffer");
+    static_assert(kWidth % 4 == 0, "rows are rasterized four pixels at a time");
+
+    void workerLoop();
+
+    /// Blocks until the frame requested by beginFrame is rasterized.
+    void wait();
+
+    void rasterize();
+
+    /// Clips a clip-space triangle against the near plane and rasterizes the pieces.
+    void clipAndRasterize(const glm::vec4 & a, const glm::vec4 & b, const glm::vec4 & c);
+
+    /// Triangle in screen space: x and y in pixels, z is depth in [0, 1].
+    void rasterizeTriangle(glm::vec3 v0, glm::vec3 v1, glm::vec3 v2);
+
+    void buildTiles();
+
+    // World space.
+    std::vector<glm::vec3> occluderPositions;
+    std::vector<std::uint32_t> occluderIndices;
+
+    glm::mat4 viewProjection {1.0f};
+
+    // Scratch for rasterize(): occluderPositions in clip space.
+    std::vector<glm::vec4> clipPositions;
+
+    // Row-major, kWidth x kHeight, and per tile.
+    std::vector<float> depth;
+    std::vector<float> tileMin;
+    std::vector<float> tileMax;
+
+    std::thread worker;
+
+    std::mutex mutex;
+    std::condition_variable frameRequested;
+    std::condition_variable frameDone;
+
+    // Set by beginFrame, cleared by the worker once the frame is rasterized.
+    bool pending {false};
+    bool stopping {false};
+    std::exception_ptr error {nullptr};
+};
+
+
+#endif  // OCCLUSIONCULLER_H
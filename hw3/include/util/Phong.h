@@ -0,0 +1,43 @@
+#ifndef PHONG_H
+#define PHONG_H
+
+#include <algorithm>
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+
+/// The lighting of phong.frag.glsl, for the CPU renderers.
+class Phong
+{
+public:
+    static constexpr float kAmbientStrength {0.1f};
+    static constexpr float kSpecularStrength {0.5f};
+    static constexpr float kShininess {32.0f};
+
+    /// Lit color of a surface point. visibility scales the diffuse and specular terms (0 in shadow).
+    static glm::vec3 shade(const glm::vec3 & fragPos,
+                           const glm::vec3 & normal,
+                           const glm::vec3 & color,
+                           const glm::vec3 & viewPos,
+                           const glm::vec3 & lightPos,
+                           const glm::vec3 & lightColor,
+                           float visibility = 1.0f)
+    {
+        glm::vec3 ambient = kAmbientStrength * lightColor;
+
+        glm::vec3 norm = glm::normalize(normal);
+        glm::vec3 lightDir = glm::normalize(lightPos - fragPos);
+        glm::vec3 diffuse = std::max(glm::dot(norm, lightDir), 0.0f) * lightColor;
+
+        glm::vec3 viewDir = glm::normalize(viewPos - fragPos);
+        glm::vec3 reflectDir = glm::reflect(-lightDir, norm);
+        float spec = std::pow(std::max(glm::dot(viewDir, reflectDir), 0.0f), kShininess);
+        glm::vec3 specular = kSpecularStrength * spec * lightColor;
+
+        return (ambient + visibility * (diffuse + specular)) * color;
+    }
+};
+
+
+#endif  // PHONG_H
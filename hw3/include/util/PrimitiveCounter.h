@@ -0,0 +1,38 @@
+#ifndef PRIMITIVECOUNTER_H
+#define PRIMITIVECOUNTER_H
+
+#include <glad/glad.h>
+
+
+/// Counts the primitives generated per frame (after tessellation) with GL_PRIMITIVES_GENERATED queries.
+/// Queries rotate through a small ring and are read back kLatency frames later,
+/// and only once available, so reading a result never stalls the pipeline.
+class PrimitiveCounter
+{
+public:
+    PrimitiveCounter();
+
+    PrimitiveCounter(const PrimitiveCounter &) = delete;
+    PrimitiveCounter & operator=(const PrimitiveCounter &) = delete;
+
+    ~PrimitiveCounter() noexcept;
+
+    /// Brackets the draw calls of one frame.
+    void beginFrame();
+    void endFrame();
+
+    /// Primitives generated by the latest frame whose result has been read back (0 before that).
+    [[nodiscard]] GLuint64 getLastFrameCount() const { return lastFrameCount; }
+
+private:
+    static constexpr int kLatency {3};
+
+    GLuint queries[kLatency] {};
+    bool issued[kLatency] {};
+    int current {0};
+
+    GLuint64 lastFrameCount {0UL};
+};
+
+
+#endif  // PRIMITIVECOUNTER_H
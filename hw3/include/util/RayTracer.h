@@ -0,0 +1,223 @@
+#ifndef RAYTRACER_H
+#define RAYTRACER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "util/Aabb.h"
+
+
+/// CPU ray tracer over the same scene as the OpenGL renderer, for reference images and CPU benchmarks.
+/// Triangles (e.g. Mesh) and analytic spheres (Sphere) are shaded with the Phong model of phong.frag.glsl;
+/// with shadows on, the diffuse and specular terms are dropped where the light is blocked.
+///
+/// endFrame builds a bounding volume hierarchy over all primitives with the surface area heuristic,
+/// then traces kTileSize x kTileSize pixel tiles in parallel on the shared ThreadPool.
+/// Rays travel in packets of 2x2 pixels (and their shadow rays): a node is visited once per packet
+/// if any of its rays hits the box, with the four slab tests in SSE2 (scalar elsewhere).
+///
+/// Primary rays start on the near plane and end on the far plane of the projection, as rasterization clips.
+/// The color buffer is RGBA8, top row first. Touches no OpenGL state.
+class RayTracer
+{
+public:
+    static constexpr int kTileSize {16};
+
+    /// Same layout as Mesh::Vertex.
+    struct Vertex
+    {
+        glm::vec3 position;
+        glm::vec3 normal;
+        glm::vec3 color;
+    };
+
+    /// Counts and timings of the latest endFrame.
+    struct Stats
+    {
+        [[nodiscard]] double raysPerSecond() const
+        {
+            return 0.0 < traceSeconds ? static_cast<double>(numRays) / traceSeconds : 0.0;
+        }
+
+        std::size_t numThreads {0UL};
+        std::size_t numPrimitives {0UL};
+        std::size_t numNodes {0UL};
+
+        // Primary and shadow rays.
+        std::size_t numRays {0UL};
+
+        // Zero if the hierarchy was reused from an earlier endFrame.
+        double buildSeconds {0.0};
+        double traceSeconds {0.0};
+    };
+
+public:
+    RayTracer(int width, int height);
+
+    /// Resizes the color buffer; its contents are lost.
+    void resize(int width, int height);
+
+    /// Traces shadow rays towards the light (on by default).
+    void setShadows(bool on) { shadows = on; }
+
+    /// Drops the primitives of the previous frame.
+    void beginFrame(const glm::mat4 & view,
+                    const glm::mat4 & projection,
+                    const glm::vec3 & viewPos,
+                    const glm::vec3 & lightPos,
+                    const glm::vec3 & lightColor,
+                    const glm::vec3 & clearColor);
+
+    /// Every three indices form a triangle, or, without indices, every three vertices.
+    /// V needs position, normal and color members (e.g. Vertex or Mesh::Vertex).
+    template <typename V>
+    void addTriangles(const std::vector<V> & vertices, const std::vector<std::uint32_t> & indices, const glm::mat4 & model)
+    {
+        addTriangles(vertices.data(), vertices.size(), indices.data(), indices.size(), model);
+    }
+
+    /// As above, over arrays (e.g. one mesh in a larger buffer); indices are relative to vertices.
+    template <typename V>
+    void addTriangles(const V * vertices,
+                      std::size_t numVertices,
+                      const std::uint32_t * indices,
+                      std::size_t numIndices,
+                      const glm::mat4 & model)
+    {
+        setModel(model);
+        transformed.clear();
+
+        for (std::size_t i = 0UL; i != numVertices; ++i)
+        {
+            transformed.push_back({glm::vec3(model * glm::vec4(vertices[i].position, 1.0f)),
+                                   normalMatrix * vertices[i].normal,
+                                   vertices[i].color});
+        }
+
+        addTransformedTriangles(indices, numIndices);
+    }
+
+    /// A sphere in object space; model is expected to scale uniformly.
+    void addSphere(const glm::vec3 & center, float radius, const glm::vec3 & color, const glm::mat4 & model);
+
+    /// Traces everything added since beginFrame with numThreads threads (0: all of the ThreadPool).
+    /// May be called again to trace the same primitives, e.g. with another number of threads.
+    void endFrame(std::size_t numThreads = 0UL);
+
+    [[nodiscard]] int getWidth() const { return width; }
+    [[nodiscard]] int getHeight() const { return height; }
+
+    [[nodiscard]] const std::vector<std::uint8_t> & getColorBuffer() const { return color; }
+
+    [[nodiscard]] const Stats & getStats() const { return stats; }
+
+    /// Writes the color buffer as a binary PPM. Returns false if the file cannot be written.
+    bool writePpm(const std::string & path) const;
+
+private:
+    struct Triangle
+    {
+        // Corner 0 and the edges to corners 1 and 2 (Moller-Trumbore).
+        glm::vec3 origin;
+        glm::vec3 edge1;
+        glm::vec3 edge2;
+
+        glm::vec3 normal[3];
+        glm::vec3 color[3];
+    };
+
+    struct Sphere
+    {
+        glm::vec3 center;
+        float radius;
+        glm::vec3 color;
+    };
+
+    /// Flattened in depth-first order: an internal node's left child follows it.
+    struct Node
+    {
+        Aabb bounds;
+
+        // Leaves: index of the first primitive in order. Internal nodes: the right child.
+        std::uint32_t offset {0U};
+
+        // Primitives of a leaf; 0 for internal nodes.
+        std::uint16_t count {0U};
+
+        // Split axis of internal nodes, to visit the nearer child first.
+        std::uint16_t axis {0U};
+    };
+
+    // Primitives that are cheaper to test together than to split further.
+    static constexpr std::size_t kMaxLeafSize {4UL};
+
+    // Buckets along each axis for evaluating splits.
+    static constexpr int kNumBuckets {12};
+
+    // Deeper subtrees become leaves; bounds the traversal stack.
+    static constexpr int kMaxDepth {60};
+
+    // Shadow rays start this far off the surface, to keep it from shadowing itself.
+    static constexpr float kShadowBias {1e-3f};
+
+    struct Packet;
+
+    void setModel(const glm::mat4 & model);
+
+    void addTransformedTriangles(const std::uint32_t * indices, std::size_t numIndices);
+
+    void build();
+
+    /// Builds the subtree over order[first, last) (sorting that range) and returns its node.
+    std::uint32_t build(const std::vector<Aabb> & boxes,
+                        const std::vector<glm::vec3> & centroids,
+                        std::size_t first,
+                        std::size_t last,
+                        int depth);
+
+    /// Closest hits of the packet's active rays; with anyHit, clears the active bit of every ray that hits anything.
+    void intersect(Packet & packet, bool anyHit) const;
+
+    /// Returns the number of rays traced.
+    std::size_t traceTile(std::size_t tile);
+
+    int width {0};
+    int height {0};
+    int tilesX {0};
+    int tilesY {0};
+
+    std::vector<std::uint8_t> color;
+
+    glm::mat4 inverseViewProjection {1.0f};
+    glm::vec3 viewPos {0.0f};
+    glm::vec3 lightPos {0.0f};
+    glm::vec3 lightColor {1.0f};
+    glm::vec3 clearColor {0.0f};
+
+    bool shadows {true};
+
+    // Of the primitives being added.
+    glm::mat3 normalMatrix {1.0f};
+
+    // World-space vertices of the mesh being added.
+    std::vector<Vertex> transformed;
+
+    std::vector<Triangle> triangles;
+    std::vector<Sphere> spheres;
+
+    // Primitives in leaf order: i < triangles.size() is triangles[i], otherwise spheres[i - triangles.size()].
+    std::vector<std::uint32_t> order;
+    std::vector<Node> nodes;
+
+    // Set when primitives were added since the last build.
+    bool dirty {false};
+
+    Stats stats;
+};
+
+
+#endif  // RAYTRACER_H
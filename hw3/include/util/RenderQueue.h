@@ -0,0 +1,79 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "util/FrameArena.h"
+
+
+class Drawable;
+class Shader;
+
+
+/// Collects the draws of one frame as packets, sorts them by a 64-bit key and submits them,
+/// switching programs and vertex arrays only where consecutive packets differ.
+///
+/// Key layout, most significant first: pass (4 bits), program (12 bits), vertex array (16 bits),
+/// depth (32 bits; the distance from the eye as float bits, which order like the floats themselves).
+/// Opaque packets sort front to back within a (program, vertex array) group, transparent ones back to front.
+/// Sorting is an LSD radix sort that skips the bytes all keys share.
+///
+/// Packets live in the calling thread's FrameArena: beginFrame, submit and flush belong to one frame of it.
+class RenderQueue
+{
+public:
+    enum Pass : int
+    {
+        kOpaque,
+        kTransparent
+    };
+
+    struct Packet
+    {
+        std::uint64_t key;
+        Shader * pShader;
+        GLuint vao;
+        Drawable * pDrawable;
+
+        // Passed back to pDrawable, e.g. to tell apart several draws of one object.
+        int tag;
+    };
+
+    /// Counts for the latest flush.
+    struct Stats
+    {
+        std::size_t numPackets {0UL};
+        std::size_t numProgramSwitches {0UL};
+        std::size_t numVaoBinds {0UL};
+    };
+
+public:
+    /// Drops all packets and reserves as many as the last frame had; depth is measured from eye until the next call.
+    void beginFrame(const glm::vec3 & eye);
+
+    /// Queues a draw of pDrawable with pShader and vao; worldCenter is the point its depth is measured at.
+    void submit(Pass pass, Shader * pShader, GLuint vao, const glm::vec3 & worldCenter, Drawable * pDrawable, int tag = 0);
+
+    /// Sorts the packets and calls Drawable::draw for each, with its program and vertex array bound.
+    /// Both stay bound afterwards.
+    void flush();
+
+    [[nodiscard]] const Stats & getStats() const { return stats; }
+
+private:
+    void sort();
+
+    glm::vec3 eye {0.0f};
+
+    FrameVector<Packet> packets;
+
+    Stats stats;
+};
+
+
+#endif  // RENDERQUEUE_H
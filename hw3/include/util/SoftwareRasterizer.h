@@ -0,0 +1,220 @@
+#ifndef SOFTWARERASTERIZER_H
+#define SOFTWARERASTERIZER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+
+/// CPU renderer for triangle meshes and lines, an alternative to drawing through OpenGL.
+/// Triangles are shaded per pixel with the Phong model of phong.frag.glsl,
+/// lines take their vertex colors as in line.frag.glsl.
+///
+/// addTriangles and addLines transform, clip (against the near plane) and set up primitives
+/// on the calling thread. endFrame bins them into kTileSize x kTileSize screen tiles and
+/// rasterizes the tiles in parallel on the shared ThreadPool, each with a depth buffer of its own,
+/// evaluating edge functions four pixels at a time with SSE2 (scalar elsewhere).
+///
+/// The color buffer is RGBA8, top row first. Touches no OpenGL state.
+class SoftwareRasterizer
+{
+public:
+    static constexpr int kTileSize {32};
+
+    /// Same layout as Mesh::Vertex.
+    struct Vertex
+    {
+        glm::vec3 position;
+        glm::vec3 normal;
+        glm::vec3 color;
+    };
+
+    /// Counts and timings of the latest endFrame.
+    struct Stats
+    {
+        /// Set up and rasterized triangles per second, over both stages.
+        [[nodiscard]] double trianglesPerSecond() const
+        {
+            double seconds = setupSeconds + rasterSeconds;
+            return 0.0 < seconds ? static_cast<double>(numTriangles) / seconds : 0.0;
+        }
+
+        /// Fill rate: pixels written per second of rasterization.
+        [[nodiscard]] double fragmentsPerSecond() const
+        {
+            return 0.0 < rasterSeconds ? static_cast<double>(numFragments) / rasterSeconds : 0.0;
+        }
+
+        std::size_t numThreads {0UL};
+
+        // After clipping; lines count two triangles each.
+        std::size_t numTriangles {0UL};
+
+        // Pixels that passed the depth test.
+        std::size_t numFragments {0UL};
+
+        double setupSeconds {0.0};
+        double rasterSeconds {0.0};
+    };
+
+public:
+    SoftwareRasterizer(int width, int height);
+
+    /// Resizes the color buffer; its contents are lost.
+    void resize(int width, int height);
+
+    /// Drops the primitives of the previous frame.
+    void beginFrame(const glm::mat4 & view,
+                    const glm::mat4 & projection,
+                    const glm::vec3 & viewPos,
+                    const glm::vec3 & lightPos,
+                    const glm::vec3 & lightColor,
+                    const glm::vec3 & clearColor);
+
+    /// Lit triangles: every three indices form one, or, without indices, every three vertices.
+    /// V needs position, normal and color members (e.g. Vertex or Mesh::Vertex).
+    template <typename V>
+    void addTriangles(const std::vector<V> & vertices, const std::vector<std::uint32_t> & indices, const glm::mat4 & model)
+    {
+        addTriangles(vertices.data(), vertices.size(), indices.data(), indices.size(), model);
+    }
+
+    /// As above, over arrays (e.g. one mesh in a larger buffer); indices are relative to vertices.
+    template <typename V>
+    void addTriangles(const V * vertices,
+                      std::size_t numVertices,
+                      const std::uint32_t * indices,
+                      std::size_t numIndices,
+                      const glm::mat4 & model)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        setModel(model);
+        transformed.clear();
+
+        for (std::size_t i = 0UL; i != numVertices; ++i)
+        {
+            transformed.emplace_back(transform(vertices[i].position, vertices[i].normal, vertices[i].color));
+        }
+
+        addTransformedTriangles(indices, numIndices);
+
+        stats.setupSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /// Unlit lines between vertices 0 and 1, 2 and 3, and so on. V needs position and color members.
+    template <typename V>
+    void addLines(const std::vector<V> & vertices, const glm::mat4 & model)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        setModel(model);
+
+        for (std::size_t i = 0UL; i + 1UL < vertices.size(); i += 2UL)
+        {
+            addLine(transform(vertices[i].position, glm::vec3(0.0f), vertices[i].color),
+                    transform(vertices[i + 1UL].position, glm::vec3(0.0f), vertices[i + 1UL].color));
+        }
+
+        stats.setupSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /// Rasterizes everything added since beginFrame with numThreads threads (0: all of the ThreadPool).
+    /// May be called again to render the same primitives, e.g. with another number of threads.
+    void endFrame(std::size_t numThreads = 0UL);
+
+    [[nodiscard]] int getWidth() const { return width; }
+    [[nodiscard]] int getHeight() const { return height; }
+
+    [[nodiscard]] const std::vector<std::uint8_t> & getColorBuffer() const { return color; }
+
+    [[nodiscard]] const Stats & getStats() const { return stats; }
+
+    /// Writes the color buffer as a binary PPM. Returns false if the file cannot be written.
+    bool writePpm(const std::string & path) const;
+
+private:
+    struct ClipVertex
+    {
+        glm::vec4 clip;
+        glm::vec3 world;
+        glm::vec3 normal;
+        glm::vec3 color;
+    };
+
+    /// A set-up triangle: screen position and depth per corner, and attributes divided by w
+    /// for perspective-correct interpolation.
+    struct Triangle
+    {
+        glm::vec3 screen[3];
+        float invW[3];
+        glm::vec3 world[3];
+        glm::vec3 normal[3];
+        glm::vec3 color[3];
+
+        // Pixel bounds, clamped to the framebuffer.
+        int minX;
+        int minY;
+        int maxX;
+        int maxY;
+
+        bool lit;
+    };
+
+    // Width of lines in pixels, as glLineWidth in App.
+    static constexpr float kLineWidth {2.0f};
+
+    void setModel(const glm::mat4 & model);
+
+    [[nodiscard]] ClipVertex transform(const glm::vec3 & position, const glm::vec3 & normal, const glm::vec3 & c) const;
+
+    void addTransformedTriangles(const std::uint32_t * indices, std::size_t numIndices);
+
+    /// Clips against the near plane and sets up the pieces.
+    void clipTriangle(const ClipVertex & a, const ClipVertex & b, const ClipVertex & c);
+
+    void setupTriangle(const ClipVertex & a, const ClipVertex & b, const ClipVertex & c, bool lit);
+
+    /// A screen-aligned quad of kLineWidth pixels, as two unlit triangles.
+    void addLine(ClipVertex a, ClipVertex b);
+
+    [[nodiscard]] glm::vec3 toScreen(const glm::vec4 & clip) const;
+
+    /// Returns the number of pixels written.
+    std::size_t rasterizeTile(std::size_t tile, float * depth);
+
+    int width {0};
+    int height {0};
+    int tilesX {0};
+    int tilesY {0};
+
+    std::vector<std::uint8_t> color;
+
+    glm::mat4 viewProjection {1.0f};
+    glm::vec3 viewPos {0.0f};
+    glm::vec3 lightPos {0.0f};
+    glm::vec3 lightColor {1.0f};
+    glm::vec3 clearColor {0.0f};
+
+    // Of the primitives being added.
+    glm::mat4 model {1.0f};
+    glm::mat4 modelViewProjection {1.0f};
+    glm::mat3 normalMatrix {1.0f};
+
+    // Vertices of the mesh being added.
+    std::vector<ClipVertex> transformed;
+
+    std::vector<Triangle> triangles;
+
+    // Per tile, indices into triangles in submission order.
+    std::vector<std::vector<std::uint32_t>> bins;
+
+    Stats stats;
+};
+
+
+#endif  // SOFTWARERASTERIZER_H
@@ -0,0 +1,86 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/// Fixed-size pool of worker threads for data-parallel loops.
+/// The calling thread participates in every loop,
+/// so a pool of size N runs N - 1 workers plus the caller.
+class ThreadPool
+{
+public:
+    static ThreadPool & getInstance();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool(ThreadPool &&) = delete;
+    ThreadPool & operator=(const ThreadPool &) = delete;
+    ThreadPool & operator=(ThreadPool &&) = delete;
+
+    ~ThreadPool() noexcept;
+
+    /// Number of threads (workers plus the caller) that execute a loop.
+    [[nodiscard]] std::size_t size() const { return workers.size() + 1UL; }
+
+    /// Runs task(i) for each i in [0, numTasks) and blocks until all have finished.
+    /// Nested calls (from inside a task) run serially on the calling thread.
+    /// The first exception thrown by a task is rethrown here once the loop has finished.
+    void parallelFor(std::size_t numTasks, const std::function<void (std::size_t)> & task);
+
+    /// Runs fn(i) for each i in [0, n) (i as std::uint32_t, e.g. a vertex or face index),
+    /// itemsPerTask consecutive items per task so that per-item calls stay cheap.
+    template <typename Fn>
+    void parallelRange(std::size_t n, Fn fn, std::size_t itemsPerTask = kItemsPerRangeTask)
+    {
+        std::size_t numTasks = (n + itemsPerTask - 1UL) / itemsPerTask;
+
+        parallelFor(numTasks, [n, itemsPerTask, &fn](std::size_t t)
+        {
+            std::size_t last = std::min(n, (t + 1UL) * itemsPerTask);
+
+            for (std::size_t i = t * itemsPerTask; i < last; ++i)
+            {
+                fn(static_cast<std::uint32_t>(i));
+            }
+        });
+    }
+
+private:
+    static constexpr std::size_t kItemsPerRangeTask {1UL << 14UL};
+
+    explicit ThreadPool(std::size_t numThreads);
+
+    void workerLoop();
+
+    // Pulls task indices of the current job until none are left.
+    void drain();
+
+    std::vector<std::thread> workers;
+
+    // Serializes jobs submitted from different threads.
+    std::mutex submitMutex;
+
+    std::mutex mutex;
+    std::condition_variable jobReady;
+    std::condition_variable jobDone;
+
+    const std::function<void (std::size_t)> * pTask {nullptr};
+    std::size_t numTasks {0UL};
+    std::atomic<std::size_t> nextTask {0UL};
+    std::size_t numFinished {0UL};
+    std::exception_ptr firstError {nullptr};
+    std::size_t generation {0UL};
+    bool stopping {false};
+};
+
+
+#endif  // THREADPOOL_H
@@ -1,44 +1,198 @@
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <utility>
+
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
 #include "app/App.h"
+#include "mesh/MeshImporter.h"
+#include "mesh/NormalGenerator.h"
+#include "shape/InstancedMesh.h"
 #include "shape/Line.h"
 #include "shape/Mesh.h"
+#include "shape/ParametricShape.h"
 #include "shape/Sphere.h"
+#include "shape/StaticMeshPool.h"
+#include "shape/SubdivisionMesh.h"
+#include "shape/Superquadric.h"
 #include "shape/Tetrahedron.h"
+#include "util/AllocationTracker.h"
+#include "util/FrameArena.h"
+#include "util/FrameCounters.h"
+#include "util/GLState.h"
+#include "util/GLTrace.h"
+#include "util/NullGL.h"
 #include "util/Shader.h"
+#include "util/ThreadPool.h"
+#include "util/Timeline.h"
 
 
-App & App::getInstance()
+App & App::getInstance(const Options & options)
 {
-    static App instance;
+    static App instance(options);
     return instance;
 }
 
 
-void App::run()
+bool App::run()
 {
-    while (!glfwWindowShouldClose(pWindow))
+    double startTimeStamp = glfwGetTime();
+
+#ifdef NULL_GL
+    NullGL::resetCallCounts();
+#endif
+
+    while (!glfwWindowShouldClose(pWindow) && (options.numFrames == 0 || numRenderedFrames < options.numFrames))
     {
+        Timeline::Zone frameZone {"frame"};
+        FrameArena::current().beginFrame();
+
         // Per-frame logic
         perFrameTimeLogic(pWindow);
         processKeyInput(pWindow);
 
+        if (configWatcher.poll())
+        {
+            reloadConfig();
+        }
+
         // Send render commands to OpenGL server
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        render();
+        // The query only feeds the [stats] line, so it is skipped unless the counters are reported.
+        if (options.printCounters)
+        {
+            primitiveCounter.beginFrame();
+            render();
+            primitiveCounter.endFrame();
+
+            printStats();
+        }
+        else
+        {
+            render();
+        }
+
+        AllocationTracker::Counts allocations = AllocationTracker::endFrame();
+        FrameCounters::getInstance().add(FrameCounters::kAllocations, allocations.numAllocations);
+        FrameCounters::getInstance().add(FrameCounters::kAllocatedBytes, allocations.numBytes);
+        FrameCounters::getInstance().endFrame(glfwGetTime());
+
+        if (pFrameCapture)
+        {
+            std::ostringstream name;
+            name << std::setw(6) << std::setfill('0') << numRenderedFrames
+                 << (options.ppm || pRegressionCheck ? ".ppm" : ".png");
+            pFrameCapture->capture((std::filesystem::path(options.captureDirectory) / name.str()).string());
+        }
+
+        ++numRenderedFrames;
+
+        if (numRenderedFrames == kWarmupFrames)
+        {
+            AllocationTracker::startSteadyState();
+        }
+
+        if (GLTraceRecorder::getInstance().isRecording())
+        {
+            GLTraceRecorder::getInstance().endFrame();
+
+            if (numRenderedFrames == options.glTraceFrames)
+            {
+                GLTraceRecorder::getInstance().stop();
+            }
+        }
 
         // Check and call events and swap the buffers
-        glfwSwapBuffers(pWindow);
+        // (offscreen, nothing is shown, so there is nothing to swap)
+        if (!options.offscreen)
+        {
+            Timeline::Zone zone {"glfwSwapBuffers"};
+            glfwSwapBuffers(pWindow);
+        }
+
         glfwPollEvents();
     }
+
+    // Frame times include the GPU's work.
+    glFinish();
+    double seconds = glfwGetTime() - startTimeStamp;
+
+    GLTraceRecorder::getInstance().stop();
+
+    if (Timeline::isEnabled())
+    {
+        Timeline::stop();
+
+        if (Timeline::write(options.timelinePath))
+        {
+            std::cout << "[timeline] " << Timeline::size() << " zones written to " << options.timelinePath << '\n';
+        }
+        else
+        {
+            std::cout << "[timeline] failed to write " << options.timelinePath << '\n';
+        }
+    }
+
+#ifdef NULL_GL
+    NullGL::printCallCounts(static_cast<std::size_t>(numRenderedFrames), seconds);
+#endif
+
+    if (options.printCounters)
+    {
+        FrameArena::Stats arena = FrameArena::current().getStats();
+        std::cout << "[arena] high water " << arena.highWaterBytes[FrameArena::kThisFrame] << " bytes this frame, "
+                  << arena.highWaterBytes[FrameArena::kNextFrame] << " bytes next frame; "
+                  << static_cast<double>(arena.capacityBytes) / 1024.0 << " KiB reserved in "
+                  << arena.numChunks << " chunk allocations\n";
+    }
+
+    bool allocationFree = true;
+
+    if (AllocationTracker::isEnabled())
+    {
+        AllocationTracker::printReport(static_cast<std::size_t>(std::max(numRenderedFrames - kWarmupFrames, 0)));
+        allocationFree = !options.checkAllocations || AllocationTracker::getNumChecked() == 0UL;
+    }
+    else if (options.checkAllocations)
+    {
+        std::cout << "[alloc] --check-allocations needs a build with the TRACK_ALLOCATIONS CMake option\n";
+        allocationFree = false;
+    }
+
+    if (pFrameCapture)
+    {
+        pFrameCapture->finish();
+    }
+
+    if (pRegressionCheck)
+    {
+        return pRegressionCheck->finish(static_cast<std::size_t>(numRenderedFrames), seconds) && allocationFree;
+    }
+
+    if (pFrameCapture)
+    {
+        FrameCapture::Stats stats = pFrameCapture->getStats();
+        std::cout << "[capture] " << stats.numHandled << " of " << stats.numCaptured << " frames written to "
+                  << options.captureDirectory << ", " << stats.numStalls << " readback stalls\n";
+    }
+
+    return allocationFree;
 }
 
 
 void App::cursorPosCallback(GLFWwindow * window, double xpos, double ypos)
 {
+    AllocationTracker::CheckedScope allocationScope {"App::cursorPosCallback"};
+
     App & app = *reinterpret_cast<App *>(glfwGetWindowUserPointer(window));
 
     app.mousePos.x = xpos;
@@ -56,13 +210,61 @@ void App::cursorPosCallback(GLFWwindow * window, double xpos, double ypos)
 
 void App::framebufferSizeCallback(GLFWwindow * window, int width, int height)
 {
+    App & app = *reinterpret_cast<App *>(glfwGetWindowUserPointer(window));
+    app.framebufferSize = {width, height};
+
     glViewport(0, 0, width, height);
 }
 
 
 void App::keyCallback(GLFWwindow * window, int key, int scancode, int action, int mods)
 {
+    App & app = *reinterpret_cast<App *>(glfwGetWindowUserPointer(window));
+
+    // Subdivision level: "=" (the "+" key) refines, "-" coarsens.
+    if ((key == GLFW_KEY_EQUAL || key == GLFW_KEY_MINUS) && action == GLFW_PRESS)
+    {
+        app.subdivisionLevel = std::clamp(app.subdivisionLevel + (key == GLFW_KEY_EQUAL ? 1 : -1),
+                                          0,
+                                          LoopSubdivision::kMaxLevel);
+
+        for (SubdivisionMesh * s : app.subdivisionMeshes)
+        {
+            s->setLevel(app.subdivisionLevel);
+        }
+    }
 
+    if (action != GLFW_PRESS)
+    {
+        return;
+    }
+
+    // Software rendering: R toggles it, P saves the last software frame, B benchmarks thread counts.
+    // T ray traces a reference frame.
+    if (key == GLFW_KEY_R)
+    {
+        app.softwareRendering = !app.softwareRendering;
+        std::cout << "[raster] " << (app.softwareRendering ? "software" : "OpenGL") << " rendering\n";
+    }
+    else if (key == GLFW_KEY_P && app.softwareRendering)
+    {
+        if (app.softwareRasterizer.writePpm(kSoftwareFramePath))
+        {
+            std::cout << "[raster] saved " << kSoftwareFramePath << '\n';
+        }
+        else
+        {
+            std::cout << "[raster] failed to write " << kSoftwareFramePath << '\n';
+        }
+    }
+    else if (key == GLFW_KEY_B && app.softwareRendering)
+    {
+        app.benchmarkSoftwareRasterizer();
+    }
+    else if (key == GLFW_KEY_T)
+    {
+        app.traceReferenceFrame();
+    }
 }
 
 
@@ -98,13 +300,16 @@ void App::perFrameTimeLogic(GLFWwindow * window)
     App & app = *reinterpret_cast<App *>(glfwGetWindowUserPointer(window));
 
     double currentFrame = glfwGetTime();
-    app.timeElapsedSinceLastFrame = currentFrame - app.lastFrameTimeStamp;
+    app.timeElapsedSinceLastFrame = app.options.numFrames ? kFixedTimeStep : currentFrame - app.lastFrameTimeStamp;
     app.lastFrameTimeStamp = currentFrame;
 }
 
 
 void App::processKeyInput(GLFWwindow * window)
 {
+    Timeline::Zone zone {"processKeyInput"};
+    AllocationTracker::CheckedScope allocationScope {"App::processKeyInput"};
+
     // Camera control
     App & app = *reinterpret_cast<App *>(glfwGetWindowUserPointer(window));
 
@@ -140,8 +345,69 @@ void App::processKeyInput(GLFWwindow * window)
 }
 
 
-App::App() : Window(kWindowWidth, kWindowHeight, kWindowName, nullptr, nullptr)
+bool App::loadSuperquadricConfig(const std::string & path, std::vector<ParametricSurface::Parameters> & parametersOut)
 {
+    std::ifstream fin(path);
+
+    if (!fin.is_open())
+    {
+        return false;
+    }
+
+    std::vector<ParametricSurface::Parameters> parameters;
+    std::string line;
+
+    while (std::getline(fin, line))
+    {
+        std::istringstream iss(line);
+        std::string first;
+
+        if (!(iss >> first) || first.front() == '#')
+        {
+            continue;
+        }
+
+        iss.clear();
+        iss.seekg(0);
+
+        float a, b, c, e1, e2;
+        std::string rest;
+
+        // Zero or negative values would leave the surface without a defined shape or normals.
+        if (!(iss >> a >> b >> c >> e1 >> e2) || (iss >> rest) ||
+            !(0.0f < a && 0.0f < b && 0.0f < c && 0.0f < e1 && 0.0f < e2))
+        {
+            return false;
+        }
+
+        parameters.emplace_back(ParametricSurface::superquadric(a, b, c, e1, e2));
+    }
+
+    parametersOut = std::move(parameters);
+    return true;
+}
+
+
+App::App(const Options & options)
+        : Window(kWindowWidth, kWindowHeight, kWindowName, nullptr, nullptr, !options.offscreen),
+          options(options),
+          configWatcher(options.configPath)
+{
+    // Before the first OpenGL call, so the trace creates every object it uses.
+    if (!options.glTracePath.empty())
+    {
+        GLTraceRecorder::getInstance().start(options.glTracePath);
+    }
+
+    // Before loading anything, so the timeline shows mesh loads and shader compiles.
+    if (!options.timelinePath.empty())
+    {
+        Timeline::setThreadName("main");
+        Timeline::start();
+    }
+
+    FrameCounters::getInstance().report(options.printCounters, options.countersPath);
+
     // GLFW boilerplate.
     glfwSetWindowUserPointer(pWindow, this);
     glfwSetCursorPosCallback(pWindow, cursorPosCallback);
@@ -151,11 +417,44 @@ App::App() : Window(kWindowWidth, kWindowHeight, kWindowName, nullptr, nullptr)
     glfwSetScrollCallback(pWindow, scrollCallback);
 
     // Global OpenGL pipeline settings
-    glViewport(0, 0, kWindowWidth, kWindowHeight);
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    // (the framebuffer may be larger than the window on high-DPI displays)
+    glfwGetFramebufferSize(pWindow, &framebufferSize.x, &framebufferSize.y);
+    glViewport(0, 0, framebufferSize.x, framebufferSize.y);
+
+    if (options.offscreen)
+    {
+        // The hidden window's framebuffer is never shown; render at full speed into one of our own.
+        pOffscreenFramebuffer = std::make_unique<OffscreenFramebuffer>(kWindowWidth, kWindowHeight);
+        pOffscreenFramebuffer->bind();
+        framebufferSize = {pOffscreenFramebuffer->getWidth(), pOffscreenFramebuffer->getHeight()};
+        glfwSwapInterval(0);
+    }
+
+    if (!options.referenceDirectory.empty())
+    {
+        pRegressionCheck = std::make_unique<RegressionCheck>(options.referenceDirectory, options.budget);
+        pFrameCapture = std::make_unique<FrameCapture>(
+                framebufferSize.x,
+                framebufferSize.y,
+                [check = pRegressionCheck.get()](const std::string & path,
+                                                 const std::vector<std::uint8_t> & rgba,
+                                                 int width,
+                                                 int height)
+                {
+                    return check->compareFrame(path, rgba, width, height);
+                }
+        );
+    }
+    else if (!options.captureDirectory.empty())
+    {
+        std::filesystem::create_directories(options.captureDirectory);
+        pFrameCapture = std::make_unique<FrameCapture>(framebufferSize.x, framebufferSize.y);
+    }
+
+    GLState::getInstance().setPolygonMode(GL_FILL);
     glLineWidth(2.0f);
     glPointSize(1.0f);
-    glEnable(GL_DEPTH_TEST);
+    GLState::getInstance().setDepthTest(true);
 
     initializeShadersAndObjects();
 }
@@ -163,18 +462,28 @@ App::App() : Window(kWindowWidth, kWindowHeight, kWindowName, nullptr, nullptr)
 
 void App::initializeShadersAndObjects()
 {
+    pInstancedShader = std::make_unique<Shader>("src/shader/instanced.vert.glsl",
+                                                "src/shader/phong.frag.glsl");
+
     pLineShader = std::make_unique<Shader>("src/shader/line.vert.glsl",
                                            "src/shader/line.frag.glsl");
 
     pMeshShader = std::make_unique<Shader>("src/shader/mesh.vert.glsl",
                                            "src/shader/phong.frag.glsl");
 
+    pPoolShader = std::make_unique<Shader>("src/shader/pool.vert.glsl",
+                                           "src/shader/phong.frag.glsl");
+
+    pPresentShader = std::make_unique<Shader>("src/shader/present.vert.glsl",
+                                              "src/shader/present.frag.glsl");
+    pImagePresenter = std::make_unique<ImagePresenter>(pPresentShader.get());
+
     pSphereShader = std::make_unique<Shader>("src/shader/sphere.vert.glsl",
                                              "src/shader/sphere.tesc.glsl",
                                              "src/shader/sphere.tese.glsl",
                                              "src/shader/phong.frag.glsl");
 
-    shapes.emplace_back(
+    addShape(
             std::make_unique<Line>(
                     pLineShader.get(),
                     std::vector<Line::Vertex> {
@@ -189,7 +498,7 @@ void App::initializeShadersAndObjects()
             )
     );
 
-    shapes.emplace_back(
+    addShape(
             std::make_unique<Tetrahedron>(
                     pMeshShader.get(),
                     "var/tetrahedron.txt",
@@ -197,7 +506,7 @@ void App::initializeShadersAndObjects()
             )
     );
 
-    shapes.emplace_back(
+    addShape(
             std::make_unique<Mesh>(
                     pMeshShader.get(),
                     std::vector<Mesh::Vertex> {
@@ -212,20 +521,208 @@ void App::initializeShadersAndObjects()
             )
     );
 
-    shapes.emplace_back(
-            std::make_unique<Sphere>(
-                    pSphereShader.get(),
-                    glm::vec3(0.0f, 0.0f, 0.0f),
-                    1.0f,
-                    glm::vec3(1.0f, 0.5f, 0.31f),
-                    glm::mat4(1.0f)
-            )
+    auto icosahedron = std::make_unique<SubdivisionMesh>(
+            pMeshShader.get(),
+            "var/icosahedron.txt",
+            glm::vec3(0.31f, 1.0f, 0.5f),
+            glm::translate(glm::mat4(1.0f), {0.0f, 2.5f, 0.0f})
+    );
+    subdivisionMeshes.emplace_back(addShape(std::move(icosahedron)));
+
+    auto dodecahedron = std::make_unique<SubdivisionMesh>(
+            pMeshShader.get(),
+            "var/dodecahedron.txt",
+            glm::vec3(1.0f, 0.31f, 0.5f),
+            glm::scale(glm::translate(glm::mat4(1.0f), {0.0f, -2.5f, 0.0f}), glm::vec3(0.6f))
     );
+    subdivisionMeshes.emplace_back(addShape(std::move(dodecahedron)));
+
+    // P3 to P6: CPU-tessellated parametric surfaces, laid out around the sphere.
+    const std::pair<ParametricSurface::Parameters, glm::vec3> kSurfaces[] {
+            {ParametricSurface::ellipsoid(1.0f, 0.6f, 0.4f), {-4.0f, 0.0f, -2.0f}},
+            {ParametricSurface::cylinder(0.6f, 1.5f), {-3.0f, 3.0f, 0.0f}},
+            {ParametricSurface::cone(0.7f, 1.5f), {3.0f, 3.0f, 0.0f}},
+            {ParametricSurface::torus(0.8f, 0.25f), {-3.0f, -3.0f, 0.0f}},
+    };
+
+    for (const auto & [parameters, position] : kSurfaces)
+    {
+        ParametricSurface::Stats generated;
+
+        addShape(
+                std::make_unique<ParametricShape>(
+                        pMeshShader.get(),
+                        parameters,
+                        64,
+                        32,
+                        glm::vec3(0.5f, 0.31f, 1.0f),
+                        glm::rotate(glm::translate(glm::mat4(1.0f), position),
+                                    glm::radians(-60.0f), {1.0f, 0.0f, 0.0f}),
+                        &generated
+                )
+        );
+
+        if (0UL < generated.numVertices)
+        {
+            std::cout << "[parametric] " << ParametricSurface::name(parameters.shape) << " 64x32: "
+                      << generated.numVertices << " vertices, " << generated.numTriangles << " triangles in "
+                      << generated.seconds * 1000.0 << " ms (" << generated.megaverticesPerSecond() << " Mvertices/s)\n";
+        }
+    }
+
+    // P6: superquadrics from options.configPath, in a row starting at (3, -3, 0).
+    // Later edits to the file only change their parameters (see reloadConfig).
+    std::vector<ParametricSurface::Parameters> superquadricParameters;
+
+    if (!loadSuperquadricConfig(options.configPath, superquadricParameters) || superquadricParameters.empty())
+    {
+        std::cout << "[config] no superquadrics in " << options.configPath << ", using the default\n";
+        superquadricParameters = {ParametricSurface::superquadric(0.7f, 0.7f, 0.7f, 0.3f, 0.3f)};
+    }
+
+    for (std::size_t i = 0UL; i != superquadricParameters.size(); ++i)
+    {
+        auto superquadric = std::make_unique<Superquadric>(
+                pMeshShader.get(),
+                superquadricParameters[i],
+                64,
+                32,
+                glm::vec3(0.5f, 0.31f, 1.0f),
+                glm::rotate(glm::translate(glm::mat4(1.0f), {3.0f + 2.0f * static_cast<float>(i), -3.0f, 0.0f}),
+                            glm::radians(-60.0f), {1.0f, 0.0f, 0.0f})
+        );
+        superquadricShapes.emplace_back(shapes.size());
+        superquadrics.emplace_back(addShape(std::move(superquadric)));
+    }
+
+    // P7: a city of unit-cube buildings below the other objects.
+    // Each chunk of buildings is one instanced draw call, and chunks are culled as a whole;
+    // the buildings themselves hide what is behind them (see occlusionCuller).
+    constexpr int kCityChunks {4};
+    constexpr int kCityBlocksPerChunk {4};
+    constexpr int kCityBlocks {kCityChunks * kCityBlocksPerChunk};
+    constexpr float kCityGround {-8.0f};
+    constexpr float kCityBlockSize {1.5f};
+
+    MeshData cube = NormalGenerator::generate(MeshImporter::load("var/cube.txt").welded(), NormalGenerator::kFlat);
+    std::vector<std::unique_ptr<InstancedMesh>> cityChunks;
+
+    for (int c = 0; c != kCityChunks * kCityChunks; ++c)
+    {
+        cityChunks.emplace_back(std::make_unique<InstancedMesh>(pInstancedShader.get(), cube));
+        cityChunks.back()->reserve(kCityBlocksPerChunk * kCityBlocksPerChunk);
+    }
+
+    // Fixed seed: the same skyline on every launch.
+    std::mt19937 rng(328U);
+    std::uniform_real_distribution<float> height(0.5f, 4.0f);
+    std::uniform_real_distribution<float> shade(0.4f, 0.8f);
+
+    for (int i = 0; i != kCityBlocks; ++i)
+    {
+        for (int j = 0; j != kCityBlocks; ++j)
+        {
+            float h = height(rng);
+            glm::vec3 position {(static_cast<float>(i) - 0.5f * (kCityBlocks - 1)) * kCityBlockSize,
+                                kCityGround + 0.5f * h,
+                                (static_cast<float>(j) - 0.5f * (kCityBlocks - 1)) * kCityBlockSize};
+
+            glm::mat4 model = glm::scale(glm::translate(glm::mat4(1.0f), position), {1.0f, h, 1.0f});
+
+            InstancedMesh & chunk = *cityChunks[(i / kCityBlocksPerChunk) * kCityChunks + j / kCityBlocksPerChunk];
+            chunk.addInstance(model, glm::vec3(shade(rng)));
+
+            // Buildings are solid boxes: good occluders.
+            occlusionCuller.addOccluder(cube.positions, cube.indices, model);
+        }
+    }
+
+    for (std::unique_ptr<InstancedMesh> & chunk : cityChunks)
+    {
+        addShape(std::move(chunk));
+    }
+
+    // P8: a ring of static polyhedra around the scene, all in one multi-draw call.
+    constexpr int kRingSize {24};
+    constexpr float kRingRadius {8.0f};
+
+    const char * const kPolyhedra[] {
+            "var/tetrahedron.txt",
+            "var/cube.txt",
+            "var/octahedron.txt",
+            "var/dodecahedron.txt",
+            "var/icosahedron.txt",
+    };
+
+    std::vector<MeshData> polyhedra;
+
+    for (const char * file : kPolyhedra)
+    {
+        polyhedra.emplace_back(NormalGenerator::generate(MeshImporter::load(file).welded(), NormalGenerator::kFlat));
+    }
+
+    auto ring = std::make_unique<StaticMeshPool>(pPoolShader.get());
+
+    for (int i = 0; i != kRingSize; ++i)
+    {
+        float angle = glm::radians(360.0f * static_cast<float>(i) / static_cast<float>(kRingSize));
+        glm::vec3 position {kRingRadius * std::cos(angle), 1.5f, kRingRadius * std::sin(angle)};
+
+        ring->add(polyhedra[static_cast<std::size_t>(i) % polyhedra.size()],
+                  glm::vec3(0.3f + 0.7f * static_cast<float>(i) / static_cast<float>(kRingSize), 0.6f, 0.9f),
+                  glm::rotate(glm::translate(glm::mat4(1.0f), position), angle, {0.0f, 1.0f, 0.0f}));
+    }
+
+    addShape(std::move(ring));
+
+    auto sphere = std::make_unique<Sphere>(
+            pSphereShader.get(),
+            glm::vec3(0.0f, 0.0f, 0.0f),
+            1.0f,
+            glm::vec3(1.0f, 0.5f, 0.31f),
+            glm::mat4(1.0f),
+            pMeshShader.get()
+    );
+    spheres.emplace_back(addShape(std::move(sphere)));
+
+    sceneBvh.build(shapeBounds);
+}
+
+
+void App::reloadConfig()
+{
+    std::vector<ParametricSurface::Parameters> parameters;
+
+    // Keep the current surfaces while the file is malformed (e.g. during a typo).
+    if (!loadSuperquadricConfig(options.configPath, parameters))
+    {
+        std::cout << "[config] failed to parse " << options.configPath << ", keeping the current superquadrics\n";
+        return;
+    }
+
+    std::cout << "[config] reloaded " << options.configPath << ": " << parameters.size() << " superquadric(s)\n";
+
+    // Only superquadrics whose parameters differ are regenerated (see Superquadric::setParameters).
+    for (std::size_t i = 0UL; i != std::min(parameters.size(), superquadrics.size()); ++i)
+    {
+        superquadrics[i]->setParameters(parameters[i]);
+
+        shapeBounds[superquadricShapes[i]] = superquadrics[i]->getWorldBounds();
+        sceneBvh.refit(superquadricShapes[i], shapeBounds[superquadricShapes[i]]);
+    }
+
+    if (superquadrics.size() < parameters.size())
+    {
+        std::cout << "[config] superquadrics are created at startup; restart to show the other "
+                  << parameters.size() - superquadrics.size() << '\n';
+    }
 }
 
 
 void App::render()
 {
+    AllocationTracker::CheckedScope allocationScope {"App::render"};
+
     auto t = static_cast<float>(timeElapsedSinceLastFrame);
 
     // Update shader uniforms.
@@ -235,27 +732,218 @@ void App::render()
                                   0.01f,
                                   100.0f);
 
-    pLineShader->use();
-    pLineShader->setMat4("view", view);
-    pLineShader->setMat4("projection", projection);
+    // Occluders rasterize on a worker thread while the uniforms are set and the frustum is culled.
+    occlusionCuller.beginFrame(projection * view);
+
+    {
+        Timeline::Zone zone {"uniforms"};
+
+        pInstancedShader->use();
+        pInstancedShader->setMat4("view", view);
+        pInstancedShader->setMat4("projection", projection);
+        pInstancedShader->setVec3("viewPos", camera.position);
+        pInstancedShader->setVec3("lightPos", lightPos);
+        pInstancedShader->setVec3("lightColor", lightColor);
+
+        pLineShader->use();
+        pLineShader->setMat4("view", view);
+        pLineShader->setMat4("projection", projection);
+
+        pMeshShader->use();
+        pMeshShader->setMat4("view", view);
+        pMeshShader->setMat4("projection", projection);
+        pMeshShader->setVec3("viewPos", camera.position);
+        pMeshShader->setVec3("lightPos", lightPos);
+        pMeshShader->setVec3("lightColor", lightColor);
+
+        pPoolShader->use();
+        pPoolShader->setMat4("view", view);
+        pPoolShader->setMat4("projection", projection);
+        pPoolShader->setVec3("viewPos", camera.position);
+        pPoolShader->setVec3("lightPos", lightPos);
+        pPoolShader->setVec3("lightColor", lightColor);
+        pPoolShader->setInt("transforms", 0);
+
+        pSphereShader->use();
+        pSphereShader->setMat4("view", view);
+        pSphereShader->setMat4("projection", projection);
+        pSphereShader->setVec3("viewPos", camera.position);
+        pSphereShader->setVec3("lightPos", lightPos);
+        pSphereShader->setVec3("lightColor", lightColor);
+
+        for (Sphere * s : spheres)
+        {
+            s->setView(view, projection, framebufferSize.y);
+        }
+    }
+
+    // Cull against the view frustum and the occluders, then draw the rest through the queue.
+    // The indices of the shapes that pass live in the frame arena.
+    FrameVector<std::size_t> visibleShapes;
+    visibleShapes.reserve(shapes.size());
+    sceneBvh.query(Frustum(projection * view), visibleShapes);
+    std::sort(visibleShapes.begin(), visibleShapes.end());
+
+    std::size_t numInFrustum = visibleShapes.size();
+
+    visibleShapes.erase(std::remove_if(visibleShapes.begin(), visibleShapes.end(), [this](std::size_t i)
+    {
+        return !occlusionCuller.isVisible(shapeBounds[i]);
+    }), visibleShapes.end());
+
+    if (softwareRendering)
+    {
+        rasterizeVisibleShapes(visibleShapes);
+        pImagePresenter->present(softwareRasterizer.getColorBuffer(),
+                                 softwareRasterizer.getWidth(),
+                                 softwareRasterizer.getHeight());
+    }
+    else
+    {
+        renderQueue.beginFrame(camera.position);
+
+        for (std::size_t i : visibleShapes)
+        {
+            Timeline::Zone zone {"Drawable::submit"};
+            shapes[i]->submit(renderQueue, t);
+        }
+
+        renderQueue.flush();
+    }
+
+    numDrawnShapes = visibleShapes.size();
+    numCulledShapes = shapes.size() - numInFrustum;
+    numOccludedShapes = numInFrustum - visibleShapes.size();
+}
+
+
+void App::rasterizeVisibleShapes(const FrameVector<std::size_t> & visibleShapes)
+{
+    Timeline::Zone zone {"rasterizeVisibleShapes"};
+
+    if (softwareRasterizer.getWidth() != framebufferSize.x || softwareRasterizer.getHeight() != framebufferSize.y)
+    {
+        softwareRasterizer.resize(framebufferSize.x, framebufferSize.y);
+    }
+
+    // Same clear color as run().
+    softwareRasterizer.beginFrame(view, projection, camera.position, lightPos, lightColor, {0.2f, 0.3f, 0.3f});
+
+    for (std::size_t i : visibleShapes)
+    {
+        shapes[i]->rasterize(softwareRasterizer);
+    }
+
+    softwareRasterizer.endFrame();
+}
+
+
+void App::benchmarkSoftwareRasterizer()
+{
+    std::size_t maxThreads = ThreadPool::getInstance().size();
 
-    pMeshShader->use();
-    pMeshShader->setMat4("view", view);
-    pMeshShader->setMat4("projection", projection);
-    pMeshShader->setVec3("ViewPos", camera.position);
-    pMeshShader->setVec3("lightPos", lightPos);
-    pMeshShader->setVec3("lightColor", lightColor);
+    for (std::size_t numThreads = 1UL; ; numThreads = std::min(2UL * numThreads, maxThreads))
+    {
+        softwareRasterizer.endFrame(numThreads);
+
+        const SoftwareRasterizer::Stats & stats = softwareRasterizer.getStats();
+        std::cout << "[raster] " << stats.numThreads << " threads: "
+                  << stats.trianglesPerSecond() * 1e-6 << " Mtriangles/s, "
+                  << stats.fragmentsPerSecond() * 1e-6 << " Mpixels/s\n";
+
+        if (maxThreads <= numThreads)
+        {
+            break;
+        }
+    }
+}
+
+
+void App::traceReferenceFrame()
+{
+    if (rayTracer.getWidth() != framebufferSize.x || rayTracer.getHeight() != framebufferSize.y)
+    {
+        rayTracer.resize(framebufferSize.x, framebufferSize.y);
+    }
 
-    pSphereShader->use();
-    pSphereShader->setMat4("view", view);
-    pSphereShader->setMat4("projection", projection);
-    pSphereShader->setVec3("ViewPos", camera.position);
-    pSphereShader->setVec3("lightPos", lightPos);
-    pSphereShader->setVec3("lightColor", lightColor);
+    rayTracer.beginFrame(view, projection, camera.position, lightPos, lightColor, {0.2f, 0.3f, 0.3f});
 
-    // Render.
-    for (auto & s : shapes)
+    for (const std::unique_ptr<Drawable> & shape : shapes)
     {
-        s->render(t);
+        shape->trace(rayTracer);
     }
+
+    std::size_t maxThreads = ThreadPool::getInstance().size();
+
+    for (std::size_t numThreads = 1UL; ; numThreads = std::min(2UL * numThreads, maxThreads))
+    {
+        rayTracer.endFrame(numThreads);
+
+        const RayTracer::Stats & stats = rayTracer.getStats();
+
+        if (0.0 < stats.buildSeconds)
+        {
+            std::cout << "[raytrace] " << stats.numPrimitives << " primitives, " << stats.numNodes
+                      << " nodes built in " << stats.buildSeconds * 1e3 << " ms\n";
+        }
+
+        std::cout << "[raytrace] " << stats.numThreads << " threads: " << stats.numRays << " rays, "
+                  << stats.raysPerSecond() * 1e-6 << " Mrays/s\n";
+
+        if (maxThreads <= numThreads)
+        {
+            break;
+        }
+    }
+
+    if (rayTracer.writePpm(kRayTracedFramePath))
+    {
+        std::cout << "[raytrace] saved " << kRayTracedFramePath << '\n';
+    }
+    else
+    {
+        std::cout << "[raytrace] failed to write " << kRayTracedFramePath << '\n';
+    }
+}
+
+
+void App::printStats()
+{
+    ++framesSinceLastStats;
+
+    double now = glfwGetTime();
+
+    if (now - lastStatsTimeStamp < 1.0)
+    {
+        return;
+    }
+
+    std::cout << "[stats] " << static_cast<double>(framesSinceLastStats) / (now - lastStatsTimeStamp) << " fps, "
+              << primitiveCounter.getLastFrameCount() << " primitives/frame, "
+              << numDrawnShapes << " objects drawn, " << numCulledShapes << " outside the frustum, "
+              << numOccludedShapes << " occluded ("
+              << (0UL < numDrawnShapes + numOccludedShapes
+                  ? 100.0 * static_cast<double>(numOccludedShapes) / static_cast<double>(numDrawnShapes + numOccludedShapes)
+                  : 0.0)
+              << "% of those in it), "
+              << GLState::getInstance().getStats().numIssued / static_cast<std::size_t>(framesSinceLastStats) << " state changes issued and "
+              << GLState::getInstance().getStats().numFiltered / static_cast<std::size_t>(framesSinceLastStats) << " filtered per frame";
+
+    for (const Sphere * s : spheres)
+    {
+        std::cout << ", sphere " << s->getTessLevel().x << 'x' << s->getTessLevel().y;
+    }
+
+    if (softwareRendering)
+    {
+        const SoftwareRasterizer::Stats & stats = softwareRasterizer.getStats();
+        std::cout << ", software: " << stats.numTriangles << " triangles, "
+                  << stats.fragmentsPerSecond() * 1e-6 << " Mpixels/s on " << stats.numThreads << " threads";
+    }
+
+    std::cout << '\n';
+
+    GLState::getInstance().resetStats();
+    lastStatsTimeStamp = now;
+    framesSinceLastStats = 0;
 }
@@ -7,14 +7,19 @@
 
 #include "app/Window.h"
 
+#ifdef NULL_GL
+#include "util/NullGL.h"
+#endif
 
-Window::Window(int width, int height, const char * title, GLFWmonitor * monitor, GLFWwindow * share)
+
+Window::Window(int width, int height, const char * title, GLFWmonitor * monitor, GLFWwindow * share, bool visible)
 {
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
+    glfwWindowHint(GLFW_VISIBLE, visible ? GL_TRUE : GL_FALSE);
 
     pWindow = glfwCreateWindow(width, height, title, monitor, share);
 
@@ -26,7 +31,12 @@ Window::Window(int width, int height, const char * title, GLFWmonitor * monitor,
 
     glfwMakeContextCurrent(pWindow);
 
+#ifdef NULL_GL
+    // OpenGL calls go to a driver that only counts them; the context merely keeps GLFW happy.
+    if (!gladLoadGLLoader(NullGL::getProcAddress))
+#else
     if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress)))
+#endif
     {
         glfwDestroyWindow(pWindow);
         glfwTerminate();
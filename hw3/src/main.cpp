@@ -1,14 +1,189 @@
 #include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
 
 #include "app/App.h"
 
 
+namespace
+{
+
+/// Exit status of a --compare run without a reference directory, for CTest's SKIP_RETURN_CODE.
+constexpr int kExitSkipped {77};
+
+
+void printUsage(const char * program)
+{
+    std::cerr << "usage: " << program << " [--offscreen] [--frames N] [--capture DIR] [--ppm] [--config FILE]\n"
+              << "       " << program << " --frames N --compare DIR [--offscreen] [--config FILE] [--tolerance RMS]"
+                                         " [--frame-budget MS] [--memory-budget MB]\n"
+              << "  --offscreen          render into a hidden framebuffer as fast as possible\n"
+              << "  --frames N           quit after N frames, advancing the scene by 1/60 s per frame\n"
+              << "  --capture DIR        save every frame to DIR/000000.png, DIR/000001.png, ...\n"
+              << "  --ppm                save PPM instead of PNG files\n"
+              << "  --config FILE        read and watch the superquadrics in FILE instead of etc/config.txt\n"
+              << "  --compare DIR        compare frames with reference PPMs saved earlier with --capture DIR --ppm,\n"
+              << "                       exit with failure if any frame or budget regresses\n"
+              << "                       (exit status " << kExitSkipped << " without running if DIR does not exist)\n"
+              << "  --tolerance RMS      largest root-mean-square error per frame, in 0..255 (default 1)\n"
+              << "  --frame-budget MS    largest mean frame time in milliseconds\n"
+              << "  --memory-budget MB   largest peak resident memory in megabytes\n"
+              << "  --gl-trace FILE      record the OpenGL calls into FILE, for replaying with " << program << "-replay\n"
+              << "  --gl-trace-frames N  stop recording after N frames\n"
+              << "  --timeline FILE      write a timeline of the frames as Chrome trace JSON to FILE,\n"
+              << "                       for chrome://tracing or https://ui.perfetto.dev\n"
+              << "  --counters           print draw calls, vertices, uploads and shape memory per frame once per second\n"
+              << "  --counters-csv FILE  append them to FILE as CSV\n"
+              << "  --check-allocations  exit with failure if steady-state frames allocate while rendering or handling input\n"
+              << "                       (needs a build with -DTRACK_ALLOCATIONS=ON)\n";
+}
+
+
+/// Parses a non-negative number; returns false if s is anything else.
+bool parseNumber(const char * s, double & numberOut)
+{
+    char * end = nullptr;
+    double number = std::strtod(s, &end);
+
+    if (end == s || *end != '\0' || !(0.0 <= number))
+    {
+        return false;
+    }
+
+    numberOut = number;
+    return true;
+}
+
+
+/// Returns false on unknown, malformed or conflicting arguments.
+bool parseArguments(int argc, char * argv[], App::Options & options)
+{
+    for (int i = 1; i != argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 != argc;
+
+        if (arg == "--offscreen")
+        {
+            options.offscreen = true;
+        }
+        else if (arg == "--ppm")
+        {
+            options.ppm = true;
+        }
+        else if (arg == "--frames" && hasValue)
+        {
+            double numFrames = 0.0;
+
+            if (!parseNumber(argv[++i], numFrames) || numFrames != static_cast<int>(numFrames))
+            {
+                return false;
+            }
+
+            options.numFrames = static_cast<int>(numFrames);
+        }
+        else if (arg == "--capture" && hasValue)
+        {
+            options.captureDirectory = argv[++i];
+        }
+        else if (arg == "--config" && hasValue)
+        {
+            options.configPath = argv[++i];
+        }
+        else if (arg == "--compare" && hasValue)
+        {
+            options.referenceDirectory = argv[++i];
+        }
+        else if (arg == "--tolerance" && hasValue)
+        {
+            if (!parseNumber(argv[++i], options.budget.tolerance))
+            {
+                return false;
+            }
+        }
+        else if (arg == "--frame-budget" && hasValue)
+        {
+            if (!parseNumber(argv[++i], options.budget.frameMilliseconds))
+            {
+                return false;
+            }
+        }
+        else if (arg == "--memory-budget" && hasValue)
+        {
+            if (!parseNumber(argv[++i], options.budget.memoryMegabytes))
+            {
+                return false;
+            }
+        }
+        else if (arg == "--timeline" && hasValue)
+        {
+            options.timelinePath = argv[++i];
+        }
+        else if (arg == "--counters")
+        {
+            options.printCounters = true;
+        }
+        else if (arg == "--counters-csv" && hasValue)
+        {
+            options.countersPath = argv[++i];
+        }
+        else if (arg == "--check-allocations")
+        {
+            options.checkAllocations = true;
+        }
+        else if (arg == "--gl-trace" && hasValue)
+        {
+            options.glTracePath = argv[++i];
+        }
+        else if (arg == "--gl-trace-frames" && hasValue)
+        {
+            double numFrames = 0.0;
+
+            if (!parseNumber(argv[++i], numFrames) || numFrames != static_cast<int>(numFrames))
+            {
+                return false;
+            }
+
+            options.glTraceFrames = static_cast<int>(numFrames);
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    // Comparisons need a reproducible frame sequence, and take the place of saving the frames.
+    return options.referenceDirectory.empty() || (options.numFrames != 0 && options.captureDirectory.empty());
+}
+
+}  // namespace anonymous
+
+
 int main(int argc, char * argv[])
 {
+    App::Options options;
+
+    if (!parseArguments(argc, argv, options))
+    {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (!options.referenceDirectory.empty() && !std::filesystem::is_directory(options.referenceDirectory))
+    {
+        std::cout << "[regression] skipped: no references in " << options.referenceDirectory << '\n';
+        return kExitSkipped;
+    }
+
     try
     {
-        App & app {App::getInstance()};
-        app.run();
+        App & app {App::getInstance(options)};
+
+        if (!app.run())
+        {
+            return EXIT_FAILURE;
+        }
     }
     catch (...)
     {
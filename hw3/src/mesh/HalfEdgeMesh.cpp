@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <utility>
+
+#include "mesh/HalfEdgeMesh.h"
+#include "util/ThreadPool.h"
+
+
+namespace
+{
+
+// Half-edges per task when scanning the index buffer.
+constexpr std::size_t kHalfEdgesPerTask {1UL << 16UL};
+
+
+struct EdgeEntry
+{
+    bool operator<(const EdgeEntry & rhs) const
+    {
+        return key < rhs.key || (key == rhs.key && halfEdge < rhs.halfEdge);
+    }
+
+    std::uint64_t key;
+    std::uint32_t halfEdge;
+};
+
+
+/// Undirected edge key: both half-edges of an edge map to the same value.
+inline std::uint64_t edgeKey(std::uint32_t a, std::uint32_t b)
+{
+    return a < b ? (static_cast<std::uint64_t>(a) << 32UL) | b : (static_cast<std::uint64_t>(b) << 32UL) | a;
+}
+
+
+inline std::size_t bucketOf(std::uint64_t key, std::size_t numBuckets)
+{
+    key ^= key >> 31UL;
+    key *= 0x9e3779b97f4a7c15ULL;
+    return static_cast<std::size_t>(key >> 40UL) % numBuckets;
+}
+
+}  // namespace anonymous
+
+
+HalfEdgeMesh::HalfEdgeMesh(const MeshData & data)
+        : HalfEdgeMesh(std::vector<glm::vec3>(data.positions), std::vector<std::uint32_t>(data.indices))
+{
+
+}
+
+
+HalfEdgeMesh::HalfEdgeMesh(std::vector<glm::vec3> && positions, std::vector<std::uint32_t> && indices)
+        : positions(std::move(positions)), indices(std::move(indices))
+{
+    this->indices.resize(this->indices.size() / 3UL * 3UL);
+
+    buildEdges();
+    buildVertexEdges();
+}
+
+
+MeshData HalfEdgeMesh::toMeshData() const
+{
+    MeshData data;
+    data.positions = positions;
+    data.indices = indices;
+    return data;
+}
+
+
+void HalfEdgeMesh::buildEdges()
+{
+    ThreadPool & pool = ThreadPool::getInstance();
+
+    std::size_t numHalf = indices.size();
+    std::size_t numTasks = std::max(1UL, (numHalf + kHalfEdgesPerTask - 1UL) / kHalfEdgesPerTask);
+    std::size_t numBuckets = 4UL * pool.size();
+
+    twins.assign(numHalf, kInvalid);
+    edgeOfHalfEdge.assign(numHalf, kInvalid);
+
+    // 1. Count half-edges per (task, bucket).
+
+    std::vector<std::size_t> counts(numTasks * numBuckets, 0UL);
+
+    pool.parallelFor(numTasks, [&](std::size_t t)
+    {
+        std::size_t last = std::min(numHalf, (t + 1UL) * kHalfEdgesPerTask);
+
+        for (std::size_t h = t * kHalfEdgesPerTask; h < last; ++h)
+        {
+            auto h32 = static_cast<std::uint32_t>(h);
+            ++counts[t * numBuckets + bucketOf(edgeKey(origin(h32), target(h32)), numBuckets)];
+        }
+    });
+
+    // 2. Bucket-major offsets, so each bucket is one contiguous range.
+
+    std::vector<std::size_t> offsets(numTasks * numBuckets, 0UL);
+    std::vector<std::size_t> bucketBegin(numBuckets + 1UL, 0UL);
+    std::size_t running {0UL};
+
+    for (std::size_t b = 0UL; b != numBuckets; ++b)
+    {
+        bucketBegin[b] = running;
+
+        for (std::size_t t = 0UL; t != numTasks; ++t)
+        {
+            offsets[t * numBuckets + b] = running;
+            running += counts[t * numBuckets + b];
+        }
+    }
+
+    bucketBegin[numBuckets] = running;
+
+    // 3. Scatter.
+
+    std::vector<EdgeEntry> entries(numHalf);
+
+    pool.parallelFor(numTasks, [&](std::size_t t)
+    {
+        std::size_t last = std::min(numHalf, (t + 1UL) * kHalfEdgesPerTask);
+
+        for (std::size_t h = t * kHalfEdgesPerTask; h < last; ++h)
+        {
+            auto h32 = static_cast<std::uint32_t>(h);
+            std::uint64_t key = edgeKey(origin(h32), target(h32));
+            entries[offsets[t * numBuckets + bucketOf(key, numBuckets)]++] = {key, h32};
+        }
+    });
+
+    // 4. Within each bucket, equal keys are adjacent after sorting: pair twins, count edges.
+
+    std::vector<std::size_t> edgesInBucket(numBuckets, 0UL);
+
+    pool.parallelFor(numBuckets, [&](std::size_t b)
+    {
+        auto first = entries.begin() + static_cast<std::ptrdiff_t>(bucketBegin[b]);
+        auto last = entries.begin() + static_cast<std::ptrdiff_t>(bucketBegin[b + 1UL]);
+        std::sort(first, last);
+
+        for (auto run = first; run != last; )
+        {
+            auto runEnd = std::find_if(run, last, [run](const EdgeEntry & e) { return e.key != run->key; });
+
+            if (2 <= runEnd - run)
+            {
+                twins[run[0].halfEdge] = run[1].halfEdge;
+                twins[run[1].halfEdge] = run[0].halfEdge;
+            }
+
+            ++edgesInBucket[b];
+            run = runEnd;
+        }
+    });
+
+    // 5. Global edge ids.
+
+    std::vector<std::size_t> edgeBase(numBuckets + 1UL, 0UL);
+
+    for (std::size_t b = 0UL; b != numBuckets; ++b)
+    {
+        edgeBase[b + 1UL] = edgeBase[b] + edgesInBucket[b];
+    }
+
+    edgeHalfEdge.assign(edgeBase[numBuckets], kInvalid);
+
+    pool.parallelFor(numBuckets, [&](std::size_t b)
+    {
+        auto first = entries.begin() + static_cast<std::ptrdiff_t>(bucketBegin[b]);
+        auto last = entries.begin() + static_cast<std::ptrdiff_t>(bucketBegin[b + 1UL]);
+        auto e = static_cast<std::uint32_t>(edgeBase[b]);
+
+        for (auto it = first; it != last; ++e)
+        {
+            edgeHalfEdge[e] = it->halfEdge;
+            std::uint64_t key = it->key;
+
+            for (; it != last && it->key == key; ++it)
+            {
+                edgeOfHalfEdge[it->halfEdge] = e;
+            }
+        }
+    });
+}
+
+
+void HalfEdgeMesh::buildVertexEdges()
+{
+    std::size_t numVerts = positions.size();
+    std::size_t numE = edgeHalfEdge.size();
+
+    vertexEdgeOffsets.assign(numVerts + 1UL, 0U);
+
+    for (std::size_t e = 0UL; e != numE; ++e)
+    {
+        std::uint32_t h = edgeHalfEdge[e];
+        ++vertexEdgeOffsets[origin(h) + 1U];
+        ++vertexEdgeOffsets[target(h) + 1U];
+    }
+
+    for (std::size_t v = 0UL; v != numVerts; ++v)
+    {
+        vertexEdgeOffsets[v + 1UL] += vertexEdgeOffsets[v];
+    }
+
+    vertexEdges.resize(2UL * numE);
+    std::vector<std::uint32_t> fill(vertexEdgeOffsets.cbegin(), vertexEdgeOffsets.cend() - 1);
+
+    for (std::size_t e = 0UL; e != numE; ++e)
+    {
+        std::uint32_t h = edgeHalfEdge[e];
+        vertexEdges[fill[origin(h)]++] = static_cast<std::uint32_t>(e);
+        vertexEdges[fill[target(h)]++] = static_cast<std::uint32_t>(e);
+    }
+}
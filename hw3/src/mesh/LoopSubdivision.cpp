@@ -0,0 +1,126 @@
+#include <cmath>
+
+#include "mesh/LoopSubdivision.h"
+#include "util/ThreadPool.h"
+
+
+namespace
+{
+
+/// Loop's original weight for an interior vertex of valence n.
+float loopBeta(std::size_t n)
+{
+    constexpr float kTwoPi {6.28318530717958647692f};
+    float c = 0.375f + 0.25f * std::cos(kTwoPi / static_cast<float>(n));
+    return (0.625f - c * c) / static_cast<float>(n);
+}
+
+}  // namespace anonymous
+
+
+LoopSubdivision::LoopSubdivision(HalfEdgeMesh && base)
+{
+    levels.push_back(std::move(base));
+}
+
+
+const HalfEdgeMesh & LoopSubdivision::level(int k)
+{
+    k = std::clamp(k, 0, kMaxLevel);
+
+    while (highestCachedLevel() < k)
+    {
+        levels.push_back(subdivide(levels.back()));
+    }
+
+    return levels[static_cast<std::size_t>(k)];
+}
+
+
+HalfEdgeMesh LoopSubdivision::subdivide(const HalfEdgeMesh & mesh)
+{
+    auto numVerts = static_cast<std::uint32_t>(mesh.numVertices());
+    std::size_t numEdges = mesh.numEdges();
+    std::size_t numFaces = mesh.numFaces();
+
+    std::vector<glm::vec3> positions(numVerts + numEdges);
+    std::vector<std::uint32_t> indices(numFaces * 12UL);
+
+    // Even vertices: each reads only its own one-ring.
+    ThreadPool::getInstance().parallelRange(numVerts, [&mesh, &positions](std::uint32_t v)
+    {
+        const glm::vec3 & p = mesh.positions[v];
+        glm::vec3 sum {0.0f};
+        glm::vec3 boundarySum {0.0f};
+        std::size_t valence {0UL};
+        std::size_t numBoundary {0UL};
+
+        for (const std::uint32_t * e = mesh.beginVertexEdges(v); e != mesh.endVertexEdges(v); ++e)
+        {
+            const glm::vec3 & q = mesh.positions[mesh.otherEnd(*e, v)];
+            sum += q;
+            ++valence;
+
+            if (mesh.isBoundaryEdge(*e))
+            {
+                boundarySum += q;
+                ++numBoundary;
+            }
+        }
+
+        if (numBoundary == 2UL)
+        {
+            positions[v] = 0.75f * p + 0.125f * boundarySum;
+        }
+        else if (numBoundary != 0UL || valence < 3UL)
+        {
+            // Corners and non-manifold vertices stay put.
+            positions[v] = p;
+        }
+        else
+        {
+            float beta = loopBeta(valence);
+            positions[v] = (1.0f - static_cast<float>(valence) * beta) * p + beta * sum;
+        }
+    });
+
+    // Odd vertices: one per edge, looked up through the edge ids of the half-edge table.
+    ThreadPool::getInstance().parallelRange(numEdges, [&mesh, &positions, numVerts](std::uint32_t e)
+    {
+        std::uint32_t h = mesh.halfEdgeOf(e);
+        std::uint32_t t = mesh.twin(h);
+        const glm::vec3 & a = mesh.positions[mesh.origin(h)];
+        const glm::vec3 & b = mesh.positions[mesh.target(h)];
+
+        if (t == HalfEdgeMesh::kInvalid)
+        {
+            positions[numVerts + e] = 0.5f * (a + b);
+        }
+        else
+        {
+            const glm::vec3 & c = mesh.positions[mesh.origin(HalfEdgeMesh::prev(h))];
+            const glm::vec3 & d = mesh.positions[mesh.origin(HalfEdgeMesh::prev(t))];
+            positions[numVerts + e] = 0.375f * (a + b) + 0.125f * (c + d);
+        }
+    });
+
+    // Each face splits into four, keeping its orientation.
+    ThreadPool::getInstance().parallelRange(numFaces, [&mesh, &indices, numVerts](std::uint32_t f)
+    {
+        std::uint32_t h0 = 3U * f;
+        std::uint32_t v0 = mesh.origin(h0);
+        std::uint32_t v1 = mesh.origin(h0 + 1U);
+        std::uint32_t v2 = mesh.origin(h0 + 2U);
+        std::uint32_t m0 = numVerts + mesh.edge(h0);
+        std::uint32_t m1 = numVerts + mesh.edge(h0 + 1U);
+        std::uint32_t m2 = numVerts + mesh.edge(h0 + 2U);
+
+        std::uint32_t * out = indices.data() + 12UL * f;
+        out[0] = v0; out[1] = m0; out[2] = m2;
+        out[3] = m0; out[4] = v1; out[5] = m1;
+        out[6] = m2; out[7] = m1; out[8] = v2;
+        out[9] = m0; out[10] = m1; out[11] = m2;
+    });
+
+    return HalfEdgeMesh(std::move(positions), std::move(indices));
+}
@@ -0,0 +1,318 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+
+#include "mesh/MeshCache.h"
+#include "util/Aabb.h"
+
+
+namespace
+{
+
+static_assert(sizeof(Mesh::Vertex) == 9UL * sizeof(float), "Mesh::Vertex must be tightly packed");
+static_assert(sizeof(MeshCache::PackedVertex) == 20UL, "MeshCache::PackedVertex must be tightly packed");
+static_assert(sizeof(MeshCache::Header) % 16UL == 0UL, "MeshCache::Header must keep the buffers aligned");
+
+constexpr std::uint64_t kAlignment {16UL};
+
+
+std::uint64_t alignUp(std::uint64_t x)
+{
+    return (x + kAlignment - 1UL) / kAlignment * kAlignment;
+}
+
+
+std::uint64_t mix(std::uint64_t h)
+{
+    h ^= h >> 33UL;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33UL;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33UL;
+    return h;
+}
+
+
+/// Word-at-a-time multiplicative hash; fast enough to run on every launch.
+std::uint64_t hashBytes(const char * data, std::size_t size)
+{
+    std::uint64_t h = 0x9e3779b97f4a7c15ULL ^ size;
+    std::size_t i = 0UL;
+
+    for (; i + 8UL <= size; i += 8UL)
+    {
+        std::uint64_t w;
+        std::memcpy(&w, data + i, 8UL);
+        h = (h ^ mix(w)) * 0x9fb21c651e98df25ULL;
+    }
+
+    std::uint64_t tail {0UL};
+
+    if (i < size)
+    {
+        std::memcpy(&tail, data + i, size - i);
+    }
+
+    return mix(h ^ mix(tail));
+}
+
+
+/// Signed normalized 10-bit component for GL_INT_2_10_10_10_REV.
+std::uint32_t packSnorm10(float v)
+{
+    auto q = static_cast<std::int32_t>(std::lround(std::clamp(v, -1.0f, 1.0f) * 511.0f));
+    return static_cast<std::uint32_t>(q) & 0x3FFU;
+}
+
+
+std::uint32_t packUnorm8(float v)
+{
+    return static_cast<std::uint32_t>(std::lround(std::clamp(v, 0.0f, 1.0f) * 255.0f));
+}
+
+
+float unpackSnorm10(std::uint32_t bits)
+{
+    // Sign-extend the 10-bit field.
+    auto q = static_cast<std::int32_t>(bits << 22U) >> 22;
+    return std::max(static_cast<float>(q) / 511.0f, -1.0f);
+}
+
+
+float unpackUnorm8(std::uint32_t bits)
+{
+    return static_cast<float>(bits & 0xFFU) / 255.0f;
+}
+
+
+MeshCache::PackedVertex pack(const Mesh::Vertex & v)
+{
+    MeshCache::PackedVertex p {};
+    p.position = v.position;
+    p.normal = packSnorm10(v.normal.x) | (packSnorm10(v.normal.y) << 10U) | (packSnorm10(v.normal.z) << 20U);
+    p.color = packUnorm8(v.color.x) | (packUnorm8(v.color.y) << 8U) | (packUnorm8(v.color.z) << 16U) | (255U << 24U);
+    return p;
+}
+
+
+Mesh::Vertex unpack(const MeshCache::PackedVertex & p)
+{
+    return {p.position,
+            {unpackSnorm10(p.normal), unpackSnorm10(p.normal >> 10U), unpackSnorm10(p.normal >> 20U)},
+            {unpackUnorm8(p.color), unpackUnorm8(p.color >> 8U), unpackUnorm8(p.color >> 16U)}};
+}
+
+}  // namespace anonymous
+
+
+std::string MeshCache::pathFor(const std::string & sourcePath)
+{
+    return sourcePath + ".mcache";
+}
+
+
+std::uint64_t MeshCache::hashFile(const std::string & path)
+{
+    MappedFile source(path);
+    return hashBytes(source.data(), source.size());
+}
+
+
+bool MeshCache::write(const std::string & path,
+                      std::uint64_t sourceHash,
+                      const std::vector<Mesh::Vertex> & vertices,
+                      const std::vector<GLuint> & indices,
+                      bool quantize)
+{
+    // 1. Weld bitwise-identical vertices if no index buffer was given.
+
+    std::vector<Mesh::Vertex> welded;
+    std::vector<GLuint> weldedIndices;
+    const std::vector<Mesh::Vertex> * pVertices = &vertices;
+    const std::vector<GLuint> * pIndices = &indices;
+
+    if (indices.empty())
+    {
+        std::unordered_map<std::string_view, GLuint> slotOfVertex;
+        slotOfVertex.reserve(vertices.size());
+        weldedIndices.reserve(vertices.size());
+
+        for (const Mesh::Vertex & v : vertices)
+        {
+            std::string_view key(reinterpret_cast<const char *>(&v), sizeof(Mesh::Vertex));
+            auto [it, inserted] = slotOfVertex.try_emplace(key, static_cast<GLuint>(welded.size()));
+
+            if (inserted)
+            {
+                welded.push_back(v);
+            }
+
+            weldedIndices.push_back(it->second);
+        }
+
+        pVertices = &welded;
+        pIndices = &weldedIndices;
+    }
+
+    // 2. Header.
+
+    Aabb box;
+
+    for (const Mesh::Vertex & v : *pVertices)
+    {
+        box.expand(v.position);
+    }
+
+    Header header {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.flags = quantize ? kQuantized : 0U;
+    header.sourceHash = sourceHash;
+    header.numVertices = static_cast<std::uint32_t>(pVertices->size());
+    header.numIndices = static_cast<std::uint32_t>(pIndices->size());
+    header.vertexStride = static_cast<std::uint32_t>(quantize ? sizeof(PackedVertex) : sizeof(Mesh::Vertex));
+
+    for (int k = 0; k != 3; ++k)
+    {
+        header.aabbMin[k] = box.empty() ? 0.0f : box.min[k];
+        header.aabbMax[k] = box.empty() ? 0.0f : box.max[k];
+    }
+
+    header.indexOffset = alignUp(sizeof(Header));
+    header.vertexOffset = alignUp(header.indexOffset + header.numIndices * sizeof(GLuint));
+
+    // 3. Payload. Write to a temporary and rename, so readers never observe a partial file.
+
+    std::string tmpPath = path + ".tmp";
+    std::ofstream fout(tmpPath, std::ios::binary | std::ios::trunc);
+
+    if (!fout)
+    {
+        return false;
+    }
+
+    const char zeros[kAlignment] {};
+
+    fout.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+    fout.write(zeros, static_cast<std::streamsize>(header.indexOffset - sizeof(Header)));
+    fout.write(reinterpret_cast<const char *>(pIndices->data()),
+               static_cast<std::streamsize>(pIndices->size() * sizeof(GLuint)));
+
+    std::uint64_t pos = header.indexOffset + header.numIndices * sizeof(GLuint);
+    fout.write(zeros, static_cast<std::streamsize>(header.vertexOffset - pos));
+
+    if (quantize)
+    {
+        std::vector<PackedVertex> packed;
+        packed.reserve(pVertices->size());
+        std::transform(pVertices->cbegin(), pVertices->cend(), std::back_inserter(packed), pack);
+
+        fout.write(reinterpret_cast<const char *>(packed.data()),
+                   static_cast<std::streamsize>(packed.size() * sizeof(PackedVertex)));
+    }
+    else
+    {
+        fout.write(reinterpret_cast<const char *>(pVertices->data()),
+                   static_cast<std::streamsize>(pVertices->size() * sizeof(Mesh::Vertex)));
+    }
+
+    fout.close();
+
+    if (!fout)
+    {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+
+    return std::rename(tmpPath.c_str(), path.c_str()) == 0;
+}
+
+
+MeshCache::MeshCache(const std::string & path)
+{
+    try
+    {
+        file.emplace(path);
+    }
+    catch (const std::runtime_error &)
+    {
+        file.reset();
+    }
+}
+
+
+bool MeshCache::isValid(std::uint64_t sourceHash) const
+{
+    if (!file || file->size() < sizeof(Header))
+    {
+        return false;
+    }
+
+    const Header & h = header();
+
+    if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0 || h.version != kVersion || h.sourceHash != sourceHash)
+    {
+        return false;
+    }
+
+    std::uint64_t stride = (h.flags & kQuantized) ? sizeof(PackedVertex) : sizeof(Mesh::Vertex);
+
+    return h.vertexStride == stride &&
+           h.indexOffset + h.numIndices * sizeof(GLuint) <= h.vertexOffset &&
+           h.vertexOffset + h.numVertices * stride <= file->size();
+}
+
+
+const MeshCache::Header & MeshCache::header() const
+{
+    return *reinterpret_cast<const Header *>(file->data());
+}
+
+
+const void * MeshCache::indexData() const
+{
+    return file->data() + header().indexOffset;
+}
+
+
+const void * MeshCache::vertexData() const
+{
+    return file->data() + header().vertexOffset;
+}
+
+
+std::vector<Mesh::Vertex> MeshCache::decodeVertices() const
+{
+    const Header & h = header();
+
+    if (!(h.flags & kQuantized))
+    {
+        const auto * first = static_cast<const Mesh::Vertex *>(vertexData());
+        return {first, first + h.numVertices};
+    }
+
+    const auto * packed = static_cast<const PackedVertex *>(vertexData());
+
+    std::vector<Mesh::Vertex> vertices;
+    vertices.reserve(h.numVertices);
+
+    for (std::uint32_t i = 0U; i != h.numVertices; ++i)
+    {
+        vertices.emplace_back(unpack(packed[i]));
+    }
+
+    return vertices;
+}
+
+
+std::vector<GLuint> MeshCache::decodeIndices() const
+{
+    const auto * first = static_cast<const GLuint *>(indexData());
+    return {first, first + header().numIndices};
+}
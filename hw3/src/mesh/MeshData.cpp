@@ -0,0 +1,80 @@
+#include <cstring>
+#include <unordered_map>
+
+#include "mesh/MeshData.h"
+
+
+namespace
+{
+
+struct PositionKey
+{
+    bool operator==(const PositionKey & rhs) const
+    {
+        return bits[0] == rhs.bits[0] && bits[1] == rhs.bits[1] && bits[2] == rhs.bits[2];
+    }
+
+    std::uint32_t bits[3];
+};
+
+
+struct PositionKeyHash
+{
+    std::size_t operator()(const PositionKey & k) const
+    {
+        std::uint64_t h = k.bits[0];
+        h = h * 0x9e3779b97f4a7c15ULL ^ k.bits[1];
+        h = h * 0x9e3779b97f4a7c15ULL ^ k.bits[2];
+        return static_cast<std::size_t>(h ^ (h >> 29UL));
+    }
+};
+
+
+PositionKey keyOf(const glm::vec3 & p)
+{
+    PositionKey key {};
+
+    for (int k = 0; k != 3; ++k)
+    {
+        // +0.0f and -0.0f are the same point.
+        float v = p[k] == 0.0f ? 0.0f : p[k];
+        std::memcpy(&key.bits[k], &v, sizeof(float));
+    }
+
+    return key;
+}
+
+}  // namespace anonymous
+
+
+MeshData MeshData::welded() const
+{
+    MeshData out;
+    out.positions.reserve(positions.size());
+    out.indices.reserve(indices.size());
+
+    std::unordered_map<PositionKey, std::uint32_t, PositionKeyHash> slotOfPosition;
+    slotOfPosition.reserve(positions.size());
+
+    std::vector<std::uint32_t> remap(positions.size());
+
+    for (std::size_t i = 0UL; i != positions.size(); ++i)
+    {
+        auto [it, inserted] = slotOfPosition.try_emplace(keyOf(positions[i]),
+                                                         static_cast<std::uint32_t>(out.positions.size()));
+
+        if (inserted)
+        {
+            out.positions.push_back(positions[i]);
+        }
+
+        remap[i] = it->second;
+    }
+
+    for (std::uint32_t i : indices)
+    {
+        out.indices.push_back(remap[i]);
+    }
+
+    return out;
+}
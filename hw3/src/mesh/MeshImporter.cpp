@@ -0,0 +1,996 @@
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "mesh/MeshImporter.h"
+#include "util/MappedFile.h"
+#include "util/ThreadPool.h"
+#include "util/Timeline.h"
+
+
+namespace
+{
+
+static_assert(sizeof(glm::vec3) == 3UL * sizeof(float), "glm::vec3 must be tightly packed");
+
+// Files smaller than this are parsed on one thread; larger ones are split into pieces of at least this size.
+constexpr std::size_t kMinChunkBytes {1UL << 20UL};
+
+// Relative (negative) OBJ indices are stored with this bias until the owning chunk's offset is known.
+constexpr std::int64_t kRelativeBias {std::int64_t(1) << 62};
+
+
+struct Chunk
+{
+    const char * begin;
+    const char * end;
+};
+
+
+/// Splits [begin, end) into pieces that start at line boundaries.
+std::vector<Chunk> splitLines(const char * begin, const char * end)
+{
+    auto size = static_cast<std::size_t>(end - begin);
+    std::size_t maxChunks = 4UL * ThreadPool::getInstance().size();
+    std::size_t numChunks = std::clamp(size / kMinChunkBytes, 1UL, maxChunks);
+
+    std::vector<Chunk> chunks;
+    chunks.reserve(numChunks);
+
+    const char * p = begin;
+
+    for (std::size_t i = 1UL; i < numChunks; ++i)
+    {
+        const char * cut = std::max(p, begin + size * i / numChunks);
+        auto nl = static_cast<const char *>(std::memchr(cut, '\n', static_cast<std::size_t>(end - cut)));
+        cut = nl ? nl + 1 : end;
+        chunks.push_back({p, cut});
+        p = cut;
+    }
+
+    chunks.push_back({p, end});
+
+    return chunks;
+}
+
+
+inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+
+inline bool isSpace(char c)
+{
+    return isBlank(c) || c == '\n';
+}
+
+
+/// Parses one float at p; returns the position past it, or nullptr if there is no number at p.
+inline const char * parseFloat(const char * p, const char * end, float & out)
+{
+    // std::from_chars does not accept an explicit plus sign.
+    if (p != end && *p == '+')
+    {
+        ++p;
+    }
+
+#if defined(__cpp_lib_to_chars)
+    auto [ptr, ec] = std::from_chars(p, end, out);
+    return ec == std::errc() ? ptr : nullptr;
+#else
+    // Fallback for standard libraries without floating-point from_chars.
+    // The mapped file is not null-terminated, so copy the token first.
+    char buf[64];
+    std::size_t n = 0UL;
+
+    while (p + n != end && n + 1UL < sizeof(buf) && !isSpace(p[n]) && p[n] != '/')
+    {
+        buf[n] = p[n];
+        ++n;
+    }
+
+    buf[n] = '\0';
+    char * last = nullptr;
+    out = std::strtof(buf, &last);
+    return last == buf ? nullptr : p + (last - buf);
+#endif  // __cpp_lib_to_chars
+}
+
+
+inline const char * parseInt(const char * p, const char * end, std::int64_t & out)
+{
+    if (p != end && *p == '+')
+    {
+        ++p;
+    }
+
+    auto [ptr, ec] = std::from_chars(p, end, out);
+    return ec == std::errc() ? ptr : nullptr;
+}
+
+
+inline const char * skipBlanks(const char * p, const char * end)
+{
+    while (p != end && isBlank(*p))
+    {
+        ++p;
+    }
+
+    return p;
+}
+
+
+inline const char * nextLine(const char * p, const char * end)
+{
+    auto nl = static_cast<const char *>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+    return nl ? nl + 1 : end;
+}
+
+
+/// Copies per-chunk arrays into one array, in chunk order, in parallel.
+template <typename T>
+std::vector<T> concatenate(const std::vector<std::vector<T>> & parts)
+{
+    std::vector<std::size_t> offsets(parts.size() + 1UL, 0UL);
+
+    for (std::size_t i = 0UL; i != parts.size(); ++i)
+    {
+        offsets[i + 1UL] = offsets[i] + parts[i].size();
+    }
+
+    std::vector<T> out(offsets.back());
+
+    ThreadPool::getInstance().parallelFor(parts.size(), [&](std::size_t i)
+    {
+        std::copy(parts[i].cbegin(), parts[i].cend(), out.begin() + static_cast<std::ptrdiff_t>(offsets[i]));
+    });
+
+    return out;
+}
+
+
+struct ObjChunk
+{
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+
+    // Triangulated corners; position index and normal index (-1 if absent).
+    std::vector<std::int64_t> cornerPositions;
+    std::vector<std::int64_t> cornerNormals;
+};
+
+
+/// Converts a 1-based (or negative, relative) OBJ index to a 0-based index.
+/// Relative indices are biased and resolved once the chunk's offset is known.
+inline std::int64_t encodeObjIndex(std::int64_t index, std::size_t numSeen)
+{
+    if (0 < index)
+    {
+        return index - 1;
+    }
+
+    if (index < 0)
+    {
+        return static_cast<std::int64_t>(numSeen) + index - kRelativeBias;
+    }
+
+    throw std::runtime_error("OBJ index 0 is invalid");
+}
+
+
+void parseObjChunk(const char * p, const char * end, ObjChunk & out)
+{
+    std::vector<std::int64_t> polyPositions;
+    std::vector<std::int64_t> polyNormals;
+
+    while (p != end)
+    {
+        p = skipBlanks(p, end);
+
+        if (end - p < 2 || (!isBlank(p[1]) && !(p[0] == 'v' && p[1] == 'n')))
+        {
+            p = nextLine(p, end);
+            continue;
+        }
+
+        if (p[0] == 'v')
+        {
+            bool isNormal = (p[1] == 'n');
+            p += isNormal ? 2 : 1;
+
+            glm::vec3 v;
+
+            for (int k = 0; k != 3; ++k)
+            {
+                p = skipBlanks(p, end);
+
+                if (!(p = parseFloat(p, end, v[k])))
+                {
+                    throw std::runtime_error("malformed OBJ vertex record");
+                }
+            }
+
+            (isNormal ? out.normals : out.positions).push_back(v);
+        }
+        else if (p[0] == 'f')
+        {
+            ++p;
+            polyPositions.clear();
+            polyNormals.clear();
+
+            while (true)
+            {
+                p = skipBlanks(p, end);
+
+                if (p == end || *p == '\n' || *p == '#')
+                {
+                    break;
+                }
+
+                std::int64_t v {0};
+                std::int64_t vn {0};
+
+                if (!(p = parseInt(p, end, v)))
+                {
+                    throw std::runtime_error("malformed OBJ face record");
+                }
+
+                // v, v/vt, v//vn or v/vt/vn.
+                if (p != end && *p == '/')
+                {
+                    std::int64_t vt;
+
+                    if (++p != end && *p != '/' && !(p = parseInt(p, end, vt)))
+                    {
+                        throw std::runtime_error("malformed OBJ face record");
+                    }
+
+                    if (p != end && *p == '/' && !(p = parseInt(p + 1, end, vn)))
+                    {
+                        throw std::runtime_error("malformed OBJ face record");
+                    }
+                }
+
+                polyPositions.push_back(encodeObjIndex(v, out.positions.size()));
+                polyNormals.push_back(vn == 0 ? -1 : encodeObjIndex(vn, out.normals.size()));
+            }
+
+            // Fan triangulation.
+            for (std::size_t i = 2UL; i < polyPositions.size(); ++i)
+            {
+                for (std::size_t k : {0UL, i - 1UL, i})
+                {
+                    out.cornerPositions.push_back(polyPositions[k]);
+                    out.cornerNormals.push_back(polyNormals[k]);
+                }
+            }
+        }
+
+        p = nextLine(p, end);
+    }
+}
+
+
+enum PlyType : int
+{
+    kInt8,
+    kUInt8,
+    kInt16,
+    kUInt16,
+    kInt32,
+    kUInt32,
+    kFloat32,
+    kFloat64
+};
+
+
+struct PlyProperty
+{
+    std::string name;
+    PlyType type {kFloat32};
+    bool isList {false};
+    PlyType countType {kUInt8};
+};
+
+
+struct PlyElement
+{
+    std::string name;
+    std::size_t count {0UL};
+    std::vector<PlyProperty> properties;
+};
+
+
+PlyType plyTypeFromName(std::string_view name)
+{
+    if (name == "char" || name == "int8") return kInt8;
+    if (name == "uchar" || name == "uint8") return kUInt8;
+    if (name == "short" || name == "int16") return kInt16;
+    if (name == "ushort" || name == "uint16") return kUInt16;
+    if (name == "int" || name == "int32") return kInt32;
+    if (name == "uint" || name == "uint32") return kUInt32;
+    if (name == "float" || name == "float32") return kFloat32;
+    if (name == "double" || name == "float64") return kFloat64;
+
+    throw std::runtime_error("unknown PLY property type " + std::string(name));
+}
+
+
+std::size_t plyTypeSize(PlyType type)
+{
+    switch (type)
+    {
+    case kInt8:
+    case kUInt8:
+        return 1UL;
+    case kInt16:
+    case kUInt16:
+        return 2UL;
+    case kInt32:
+    case kUInt32:
+    case kFloat32:
+        return 4UL;
+    default:
+        return 8UL;
+    }
+}
+
+
+template <typename T>
+inline T loadScalar(const char * p, bool swap)
+{
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, p, sizeof(T));
+
+    if (swap)
+    {
+        std::reverse(bytes, bytes + sizeof(T));
+    }
+
+    T value;
+    std::memcpy(&value, bytes, sizeof(T));
+    return value;
+}
+
+
+inline double loadPly(const char * p, PlyType type, bool swap)
+{
+    switch (type)
+    {
+    case kInt8:
+        return loadScalar<std::int8_t>(p, swap);
+    case kUInt8:
+        return loadScalar<std::uint8_t>(p, swap);
+    case kInt16:
+        return loadScalar<std::int16_t>(p, swap);
+    case kUInt16:
+        return loadScalar<std::uint16_t>(p, swap);
+    case kInt32:
+        return loadScalar<std::int32_t>(p, swap);
+    case kUInt32:
+        return loadScalar<std::uint32_t>(p, swap);
+    case kFloat32:
+        return loadScalar<float>(p, swap);
+    default:
+        return loadScalar<double>(p, swap);
+    }
+}
+
+
+/// Walks one element record starting at p without decoding it; returns the position past it.
+const char * skipPlyRecord(const char * p, const char * end, const PlyElement & element, bool swap)
+{
+    for (const auto & prop : element.properties)
+    {
+        if (prop.isList)
+        {
+            if (end - p < static_cast<std::ptrdiff_t>(plyTypeSize(prop.countType)))
+            {
+                throw std::runtime_error("truncated PLY file");
+            }
+
+            auto n = static_cast<std::size_t>(loadPly(p, prop.countType, swap));
+            p += plyTypeSize(prop.countType) + n * plyTypeSize(prop.type);
+        }
+        else
+        {
+            p += plyTypeSize(prop.type);
+        }
+
+        if (end < p)
+        {
+            throw std::runtime_error("truncated PLY file");
+        }
+    }
+
+    return p;
+}
+
+
+bool isLittleEndianHost()
+{
+    const std::uint16_t probe {1U};
+    unsigned char first;
+    std::memcpy(&first, &probe, 1UL);
+    return first == 1U;
+}
+
+}  // namespace anonymous
+
+
+MeshData MeshImporter::load(const std::string & path, Format format, Stats * stats)
+{
+    Timeline::Zone zone {"MeshImporter::load"};
+
+    auto start = std::chrono::steady_clock::now();
+
+    if (format == kAuto)
+    {
+        format = formatFromExtension(path);
+    }
+
+    MappedFile file(path);
+    const char * begin = file.data();
+    const char * end = begin + file.size();
+
+    MeshData data;
+
+    try
+    {
+        switch (format)
+        {
+        case kObj:
+        {
+            data = parseObj(begin, end);
+            break;
+        }
+        case kPly:
+        {
+            data = parsePly(begin, end);
+            break;
+        }
+        default:
+        {
+            data = parseVar(begin, end);
+            break;
+        }
+        }
+    }
+    catch (const std::runtime_error & e)
+    {
+        throw std::runtime_error("failed to import " + path + ": " + e.what());
+    }
+
+    Stats s;
+    s.numBytes = file.size();
+    s.numTriangles = data.numTriangles();
+    s.numThreads = ThreadPool::getInstance().size();
+    s.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (stats)
+    {
+        *stats = s;
+    }
+
+    return data;
+}
+
+
+MeshImporter::Format MeshImporter::formatFromExtension(const std::string & path)
+{
+    std::string::size_type dot = path.find_last_of('.');
+
+    if (dot == std::string::npos)
+    {
+        return kVar;
+    }
+
+    std::string ext = path.substr(dot + 1UL);
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+
+    if (ext == "obj")
+    {
+        return kObj;
+    }
+
+    if (ext == "ply")
+    {
+        return kPly;
+    }
+
+    return kVar;
+}
+
+
+MeshData MeshImporter::parseVar(const char * begin, const char * end)
+{
+    std::vector<Chunk> chunks = splitLines(begin, end);
+    std::vector<std::vector<float>> parts(chunks.size());
+
+    ThreadPool::getInstance().parallelFor(chunks.size(), [&chunks, &parts](std::size_t i)
+    {
+        const char * p = chunks[i].begin;
+        const char * e = chunks[i].end;
+        std::vector<float> & out = parts[i];
+        out.reserve(static_cast<std::size_t>(e - p) / 8UL);
+
+        while (true)
+        {
+            while (p != e && isSpace(*p))
+            {
+                ++p;
+            }
+
+            if (p == e)
+            {
+                break;
+            }
+
+            float value;
+
+            if (!(p = parseFloat(p, e, value)))
+            {
+                throw std::runtime_error("malformed number");
+            }
+
+            out.push_back(value);
+        }
+    });
+
+    std::vector<float> floats = concatenate(parts);
+
+    // Like the original stream-based loader, a trailing partial facet is dropped.
+    std::size_t numVertices = floats.size() / 9UL * 3UL;
+
+    MeshData data;
+    data.positions.resize(numVertices);
+    std::memcpy(static_cast<void *>(data.positions.data()), floats.data(), numVertices * sizeof(glm::vec3));
+
+    data.indices.resize(numVertices);
+    std::iota(data.indices.begin(), data.indices.end(), 0U);
+
+    return data;
+}
+
+
+MeshData MeshImporter::parseObj(const char * begin, const char * end)
+{
+    std::vector<Chunk> chunks = splitLines(begin, end);
+    std::vector<ObjChunk> parts(chunks.size());
+
+    ThreadPool::getInstance().parallelFor(chunks.size(), [&chunks, &parts](std::size_t i)
+    {
+        parseObjChunk(chunks[i].begin, chunks[i].end, parts[i]);
+    });
+
+    std::vector<std::vector<glm::vec3>> positionParts(parts.size());
+    std::vector<std::vector<glm::vec3>> normalParts(parts.size());
+    std::vector<std::int64_t> positionOffsets(parts.size() + 1UL, 0);
+    std::vector<std::int64_t> normalOffsets(parts.size() + 1UL, 0);
+
+    for (std::size_t i = 0UL; i != parts.size(); ++i)
+    {
+        positionOffsets[i + 1UL] = positionOffsets[i] + static_cast<std::int64_t>(parts[i].positions.size());
+        normalOffsets[i + 1UL] = normalOffsets[i] + static_cast<std::int64_t>(parts[i].normals.size());
+        positionParts[i] = std::move(parts[i].positions);
+        normalParts[i] = std::move(parts[i].normals);
+    }
+
+    MeshData data;
+    data.positions = concatenate(positionParts);
+    std::vector<glm::vec3> normals = concatenate(normalParts);
+
+    // Resolve relative indices and validate ranges, in parallel per chunk.
+    bool allCornersHaveNormals {true};
+    bool normalsMatchPositions {normals.size() == data.positions.size()};
+
+    std::vector<char> chunkHasAllNormals(parts.size(), 1);
+    std::vector<char> chunkNormalsMatch(parts.size(), 1);
+
+    ThreadPool::getInstance().parallelFor(parts.size(), [&](std::size_t i)
+    {
+        auto numPositions = static_cast<std::int64_t>(data.positions.size());
+        auto numNormals = static_cast<std::int64_t>(normals.size());
+
+        for (std::size_t c = 0UL; c != parts[i].cornerPositions.size(); ++c)
+        {
+            std::int64_t & v = parts[i].cornerPositions[c];
+            std::int64_t & vn = parts[i].cornerNormals[c];
+
+            if (v < 0)
+            {
+                v += kRelativeBias + positionOffsets[i];
+            }
+
+            if (v < 0 || numPositions <= v)
+            {
+                throw std::runtime_error("OBJ position index out of range");
+            }
+
+            if (vn == -1)
+            {
+                chunkHasAllNormals[i] = 0;
+                continue;
+            }
+
+            if (vn < 0)
+            {
+                vn += kRelativeBias + normalOffsets[i];
+            }
+
+            if (vn < 0 || numNormals <= vn)
+            {
+                throw std::runtime_error("OBJ normal index out of range");
+            }
+
+            if (vn != v)
+            {
+                chunkNormalsMatch[i] = 0;
+            }
+        }
+    });
+
+    for (std::size_t i = 0UL; i != parts.size(); ++i)
+    {
+        allCornersHaveNormals = allCornersHaveNormals && chunkHasAllNormals[i];
+        normalsMatchPositions = normalsMatchPositions && chunkNormalsMatch[i];
+    }
+
+    std::vector<std::vector<std::int64_t>> cornerParts(parts.size());
+
+    for (std::size_t i = 0UL; i != parts.size(); ++i)
+    {
+        cornerParts[i] = std::move(parts[i].cornerPositions);
+    }
+
+    std::vector<std::int64_t> corners = concatenate(cornerParts);
+
+    if (!allCornersHaveNormals || normals.empty() || normalsMatchPositions)
+    {
+        // Positions can be indexed directly (normals, if any, are paired one to one).
+        if (allCornersHaveNormals && normalsMatchPositions)
+        {
+            data.normals = std::move(normals);
+        }
+
+        data.indices.assign(corners.cbegin(), corners.cend());
+        return data;
+    }
+
+    // Distinct (position, normal) pairs become distinct vertices.
+    std::vector<std::vector<std::int64_t>> normalCornerParts(parts.size());
+
+    for (std::size_t i = 0UL; i != parts.size(); ++i)
+    {
+        normalCornerParts[i] = std::move(parts[i].cornerNormals);
+    }
+
+    std::vector<std::int64_t> normalCorners = concatenate(normalCornerParts);
+
+    std::vector<glm::vec3> positions = std::move(data.positions);
+    data.positions.clear();
+    data.positions.reserve(positions.size());
+    data.normals.reserve(positions.size());
+    data.indices.reserve(corners.size());
+
+    std::unordered_map<std::uint64_t, std::uint32_t> vertexOfPair;
+    vertexOfPair.reserve(positions.size());
+
+    for (std::size_t c = 0UL; c != corners.size(); ++c)
+    {
+        std::uint64_t key = (static_cast<std::uint64_t>(corners[c]) << 32UL) |
+                            static_cast<std::uint64_t>(normalCorners[c]);
+        auto [it, inserted] = vertexOfPair.try_emplace(key, static_cast<std::uint32_t>(data.positions.size()));
+
+        if (inserted)
+        {
+            data.positions.push_back(positions[static_cast<std::size_t>(corners[c])]);
+            data.normals.push_back(normals[static_cast<std::size_t>(normalCorners[c])]);
+        }
+
+        data.indices.push_back(it->second);
+    }
+
+    return data;
+}
+
+
+MeshData MeshImporter::parsePly(const char * begin, const char * end)
+{
+    // 1. Header (ASCII, terminated by "end_header").
+
+    const char * p = begin;
+    bool swap {false};
+    bool sawFormat {false};
+    std::vector<PlyElement> elements;
+
+    auto readLine = [&p, end]() -> std::string_view
+    {
+        const char * lineEnd = static_cast<const char *>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+
+        if (!lineEnd)
+        {
+            throw std::runtime_error("truncated PLY header");
+        }
+
+        std::string_view line(p, static_cast<std::size_t>(lineEnd - p));
+        p = lineEnd + 1;
+
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.remove_suffix(1UL);
+        }
+
+        return line;
+    };
+
+    auto split = [](std::string_view line)
+    {
+        std::vector<std::string_view> tokens;
+        std::size_t i = 0UL;
+
+        while (i < line.size())
+        {
+            while (i < line.size() && isBlank(line[i])) ++i;
+            std::size_t j = i;
+            while (j < line.size() && !isBlank(line[j])) ++j;
+            if (i < j) tokens.push_back(line.substr(i, j - i));
+            i = j;
+        }
+
+        return tokens;
+    };
+
+    if (readLine() != "ply")
+    {
+        throw std::runtime_error("missing PLY magic number");
+    }
+
+    for (std::string_view line = readLine(); line != "end_header"; line = readLine())
+    {
+        std::vector<std::string_view> tokens = split(line);
+
+        if (tokens.empty() || tokens[0] == "comment" || tokens[0] == "obj_info")
+        {
+            continue;
+        }
+
+        if (tokens[0] == "format" && 2UL <= tokens.size())
+        {
+            if (tokens[1] == "binary_little_endian")
+            {
+                swap = !isLittleEndianHost();
+            }
+            else if (tokens[1] == "binary_big_endian")
+            {
+                swap = isLittleEndianHost();
+            }
+            else
+            {
+                throw std::runtime_error("only binary PLY files are supported");
+            }
+
+            sawFormat = true;
+        }
+        else if (tokens[0] == "element" && tokens.size() == 3UL)
+        {
+            PlyElement element;
+            element.name = tokens[1];
+
+            std::int64_t count {0};
+
+            if (!parseInt(tokens[2].data(), tokens[2].data() + tokens[2].size(), count) || count < 0)
+            {
+                throw std::runtime_error("malformed PLY element count");
+            }
+
+            element.count = static_cast<std::size_t>(count);
+            elements.push_back(std::move(element));
+        }
+        else if (tokens[0] == "property" && !elements.empty())
+        {
+            PlyProperty prop;
+
+            if (tokens.size() == 5UL && tokens[1] == "list")
+            {
+                prop.isList = true;
+                prop.countType = plyTypeFromName(tokens[2]);
+                prop.type = plyTypeFromName(tokens[3]);
+                prop.name = tokens[4];
+            }
+            else if (tokens.size() == 3UL)
+            {
+                prop.type = plyTypeFromName(tokens[1]);
+                prop.name = tokens[2];
+            }
+            else
+            {
+                throw std::runtime_error("malformed PLY property");
+            }
+
+            elements.back().properties.push_back(std::move(prop));
+        }
+    }
+
+    if (!sawFormat)
+    {
+        throw std::runtime_error("missing PLY format line");
+    }
+
+    // 2. Body, element by element.
+
+    MeshData data;
+
+    for (const PlyElement & element : elements)
+    {
+        bool fixedSize = std::none_of(element.properties.cbegin(), element.properties.cend(),
+                                      [](const PlyProperty & prop) { return prop.isList; });
+
+        if (element.name == "vertex")
+        {
+            if (!fixedSize)
+            {
+                throw std::runtime_error("PLY vertex element with list properties");
+            }
+
+            std::size_t stride {0UL};
+            std::ptrdiff_t offsets[6] {-1, -1, -1, -1, -1, -1};
+            PlyType types[6] {kFloat32, kFloat32, kFloat32, kFloat32, kFloat32, kFloat32};
+            static constexpr const char * kNames[6] {"x", "y", "z", "nx", "ny", "nz"};
+
+            for (const PlyProperty & prop : element.properties)
+            {
+                for (int k = 0; k != 6; ++k)
+                {
+                    if (prop.name == kNames[k])
+                    {
+                        offsets[k] = static_cast<std::ptrdiff_t>(stride);
+                        types[k] = prop.type;
+                    }
+                }
+
+                stride += plyTypeSize(prop.type);
+            }
+
+            if (offsets[0] < 0 || offsets[1] < 0 || offsets[2] < 0)
+            {
+                throw std::runtime_error("PLY vertex element without x/y/z");
+            }
+
+            if (static_cast<std::size_t>(end - p) < element.count * stride)
+            {
+                throw std::runtime_error("truncated PLY vertex data");
+            }
+
+            bool hasNormals = 0 <= offsets[3] && 0 <= offsets[4] && 0 <= offsets[5];
+            data.positions.resize(element.count);
+            data.normals.resize(hasNormals ? element.count : 0UL);
+
+            // Fixed stride: vertex ranges decode independently.
+            constexpr std::size_t kVerticesPerTask {1UL << 16UL};
+            std::size_t numTasks = (element.count + kVerticesPerTask - 1UL) / kVerticesPerTask;
+            const char * base = p;
+
+            ThreadPool::getInstance().parallelFor(numTasks, [&, base](std::size_t t)
+            {
+                std::size_t last = std::min(element.count, (t + 1UL) * kVerticesPerTask);
+
+                for (std::size_t i = t * kVerticesPerTask; i != last; ++i)
+                {
+                    const char * record = base + i * stride;
+
+                    for (int k = 0; k != 3; ++k)
+                    {
+                        data.positions[i][k] = static_cast<float>(loadPly(record + offsets[k], types[k], swap));
+                    }
+
+                    if (hasNormals)
+                    {
+                        for (int k = 0; k != 3; ++k)
+                        {
+                            data.normals[i][k] = static_cast<float>(loadPly(record + offsets[k + 3], types[k + 3], swap));
+                        }
+                    }
+                }
+            });
+
+            p += element.count * stride;
+        }
+        else if (element.name == "face")
+        {
+            data.indices.reserve(element.count * 3UL);
+
+            // Variable-length records; decode sequentially.
+            for (std::size_t i = 0UL; i != element.count; ++i)
+            {
+                for (const PlyProperty & prop : element.properties)
+                {
+                    if (!prop.isList)
+                    {
+                        p += plyTypeSize(prop.type);
+                        continue;
+                    }
+
+                    std::size_t countSize = plyTypeSize(prop.countType);
+                    std::size_t indexSize = plyTypeSize(prop.type);
+
+                    if (end - p < static_cast<std::ptrdiff_t>(countSize))
+                    {
+                        throw std::runtime_error("truncated PLY face data");
+                    }
+
+                    auto n = static_cast<std::size_t>(loadPly(p, prop.countType, swap));
+                    p += countSize;
+
+                    if (static_cast<std::size_t>(end - p) < n * indexSize)
+                    {
+                        throw std::runtime_error("truncated PLY face data");
+                    }
+
+                    if (prop.name == "vertex_indices" || prop.name == "vertex_index")
+                    {
+                        auto first = static_cast<std::uint32_t>(loadPly(p, prop.type, swap));
+
+                        // Fan triangulation.
+                        for (std::size_t k = 2UL; k < n; ++k)
+                        {
+                            data.indices.push_back(first);
+                            data.indices.push_back(static_cast<std::uint32_t>(loadPly(p + (k - 1UL) * indexSize, prop.type, swap)));
+                            data.indices.push_back(static_cast<std::uint32_t>(loadPly(p + k * indexSize, prop.type, swap)));
+                        }
+                    }
+
+                    p += n * indexSize;
+                }
+
+                if (end < p)
+                {
+                    throw std::runtime_error("truncated PLY face data");
+                }
+            }
+        }
+        else if (fixedSize)
+        {
+            std::size_t stride {0UL};
+
+            for (const PlyProperty & prop : element.properties)
+            {
+                stride += plyTypeSize(prop.type);
+            }
+
+            p += element.count * stride;
+        }
+        else
+        {
+            for (std::size_t i = 0UL; i != element.count; ++i)
+            {
+                p = skipPlyRecord(p, end, element, swap);
+            }
+        }
+
+        if (end < p)
+        {
+            throw std::runtime_error("truncated PLY file");
+        }
+    }
+
+    auto numPositions = static_cast<std::uint32_t>(data.positions.size());
+
+    if (std::any_of(data.indices.cbegin(), data.indices.cend(), [numPositions](std::uint32_t i) { return numPositions <= i; }))
+    {
+        throw std::runtime_error("PLY vertex index out of range");
+    }
+
+    return data;
+}
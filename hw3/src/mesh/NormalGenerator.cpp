@@ -0,0 +1,256 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "mesh/NormalGenerator.h"
+#include "util/ThreadPool.h"
+
+
+namespace
+{
+
+// Faces per accumulation buffer are at least this many, so small meshes use a single buffer.
+constexpr std::size_t kMinFacesPerBuffer {1UL << 15UL};
+
+
+/// atan2(y, x) for y >= 0, within 1e-5 radians; std::atan2 would dominate the angle-weighted pass.
+float fastAtan2(float y, float x)
+{
+    constexpr float kPi {3.14159265358979323846f};
+
+    float ax = std::abs(x);
+    bool steep = ax < y;
+    float z = steep ? ax / y : y / ax;
+    float z2 = z * z;
+
+    float a = z * (0.99997726f + z2 * (-0.33262347f + z2 * (0.19354346f + z2 * (-0.11643287f +
+              z2 * (0.05265332f + z2 * -0.01172120f)))));
+
+    a = steep ? 0.5f * kPi - a : a;
+    return x < 0.0f ? kPi - a : a;
+}
+
+
+/// Unit normal of face f and the weight of each of its corners.
+/// Degenerate faces get a zero normal and zero weights.
+void faceNormal(const MeshData & mesh,
+                std::size_t f,
+                NormalGenerator::Weighting weighting,
+                glm::vec3 & normal,
+                float weights[3])
+{
+    const glm::vec3 & p0 = mesh.positions[mesh.indices[3UL * f]];
+    const glm::vec3 & p1 = mesh.positions[mesh.indices[3UL * f + 1UL]];
+    const glm::vec3 & p2 = mesh.positions[mesh.indices[3UL * f + 2UL]];
+
+    glm::vec3 c = glm::cross(p1 - p0, p2 - p0);
+    float len = glm::length(c);
+
+    if (!(0.0f < len))
+    {
+        normal = glm::vec3(0.0f);
+        weights[0] = weights[1] = weights[2] = 0.0f;
+        return;
+    }
+
+    normal = c / len;
+
+    if (weighting == NormalGenerator::kArea)
+    {
+        weights[0] = weights[1] = weights[2] = 0.5f * len;
+        return;
+    }
+
+    // |a x b| is twice the facet area at every corner, so the interior angle is atan2(len, a . b).
+    weights[0] = fastAtan2(len, glm::dot(p1 - p0, p2 - p0));
+    weights[1] = fastAtan2(len, glm::dot(p2 - p1, p0 - p1));
+    weights[2] = fastAtan2(len, glm::dot(p0 - p2, p1 - p2));
+}
+
+
+glm::vec3 normalizeOrZ(const glm::vec3 & n)
+{
+    float len = glm::length(n);
+    return 0.0f < len ? n / len : glm::vec3(0.0f, 0.0f, 1.0f);
+}
+
+
+bool sameBits(const glm::vec3 & a, const glm::vec3 & b)
+{
+    return std::memcmp(&a, &b, sizeof(glm::vec3)) == 0;
+}
+
+}  // namespace anonymous
+
+
+std::vector<glm::vec3> NormalGenerator::vertexNormals(const MeshData & mesh, Weighting weighting)
+{
+    std::size_t numVerts = mesh.positions.size();
+    std::size_t numFaces = mesh.numTriangles();
+
+    ThreadPool & pool = ThreadPool::getInstance();
+    std::size_t numBuffers = std::clamp((numFaces + kMinFacesPerBuffer - 1UL) / kMinFacesPerBuffer, 1UL, pool.size());
+
+    // 1. Scatter: buffer b accumulates its own contiguous range of faces.
+    //    Each buffer is allocated (and first touched) by the thread that fills it.
+
+    std::vector<std::vector<glm::vec3>> partial(numBuffers);
+
+    pool.parallelFor(numBuffers, [&](std::size_t b)
+    {
+        std::vector<glm::vec3> & sum = partial[b];
+        sum.assign(numVerts, glm::vec3(0.0f));
+
+        std::size_t first = numFaces * b / numBuffers;
+        std::size_t last = numFaces * (b + 1UL) / numBuffers;
+
+        for (std::size_t f = first; f != last; ++f)
+        {
+            glm::vec3 n;
+            float w[3];
+            faceNormal(mesh, f, weighting, n, w);
+
+            sum[mesh.indices[3UL * f]] += w[0] * n;
+            sum[mesh.indices[3UL * f + 1UL]] += w[1] * n;
+            sum[mesh.indices[3UL * f + 2UL]] += w[2] * n;
+        }
+    });
+
+    // 2. Reduce per vertex. Buffer 0 becomes the result.
+
+    std::vector<glm::vec3> & normals = partial[0];
+
+    ThreadPool::getInstance().parallelRange(numVerts, [&partial, &normals, numBuffers](std::uint32_t v)
+    {
+        glm::vec3 n = normals[v];
+
+        for (std::size_t b = 1UL; b != numBuffers; ++b)
+        {
+            n += partial[b][v];
+        }
+
+        normals[v] = normalizeOrZ(n);
+    });
+
+    return std::move(normals);
+}
+
+
+MeshData NormalGenerator::generate(const MeshData & mesh, float creaseAngleDegrees, Weighting weighting)
+{
+    if (kSmooth <= creaseAngleDegrees)
+    {
+        MeshData out;
+        out.positions = mesh.positions;
+        out.indices = mesh.indices;
+        out.normals = vertexNormals(mesh, weighting);
+        return out;
+    }
+
+    std::size_t numVerts = mesh.positions.size();
+    std::size_t numFaces = mesh.numTriangles();
+    std::size_t numCorners = 3UL * numFaces;
+    float cosCrease = std::cos(glm::radians(std::max(creaseAngleDegrees, 0.0f)));
+
+    // 1. Face normals and corner weights.
+
+    std::vector<glm::vec3> faceNormals(numFaces);
+    std::vector<float> cornerWeights(numCorners);
+
+    ThreadPool::getInstance().parallelRange(numFaces, [&](std::uint32_t f)
+    {
+        faceNormal(mesh, f, weighting, faceNormals[f], &cornerWeights[3UL * f]);
+    });
+
+    // 2. Corners around each vertex, as CSR.
+
+    std::vector<std::uint32_t> cornerOffsets(numVerts + 1UL, 0U);
+
+    for (std::size_t c = 0UL; c != numCorners; ++c)
+    {
+        ++cornerOffsets[mesh.indices[c] + 1UL];
+    }
+
+    for (std::size_t v = 0UL; v != numVerts; ++v)
+    {
+        cornerOffsets[v + 1UL] += cornerOffsets[v];
+    }
+
+    std::vector<std::uint32_t> vertexCorners(numCorners);
+    std::vector<std::uint32_t> fill(cornerOffsets.cbegin(), cornerOffsets.cend() - 1);
+
+    for (std::size_t c = 0UL; c != numCorners; ++c)
+    {
+        vertexCorners[fill[mesh.indices[c]]++] = static_cast<std::uint32_t>(c);
+    }
+
+    // 3. Per corner, gather the faces around its vertex that are within the crease angle
+    //    of its own face. Corners that end up with the same normal share an output vertex.
+
+    std::vector<glm::vec3> cornerNormals(numCorners);
+    std::vector<std::uint32_t> cornerSlots(numCorners);
+    std::vector<std::uint32_t> vertexBase(numVerts + 1UL, 0U);
+
+    ThreadPool::getInstance().parallelRange(numVerts, [&](std::uint32_t v)
+    {
+        const std::uint32_t * first = vertexCorners.data() + cornerOffsets[v];
+        const std::uint32_t * last = vertexCorners.data() + cornerOffsets[v + 1UL];
+        std::uint32_t numSlots {0U};
+
+        for (const std::uint32_t * c = first; c != last; ++c)
+        {
+            const glm::vec3 & fn = faceNormals[*c / 3U];
+            bool degenerate = glm::dot(fn, fn) == 0.0f;
+            glm::vec3 n {0.0f};
+
+            for (const std::uint32_t * d = first; d != last; ++d)
+            {
+                const glm::vec3 & dn = faceNormals[*d / 3U];
+
+                // Degenerate faces have no orientation of their own and take the smooth normal.
+                if (degenerate || *d / 3U == *c / 3U || cosCrease <= glm::dot(fn, dn))
+                {
+                    n += cornerWeights[*d] * dn;
+                }
+            }
+
+            cornerNormals[*c] = normalizeOrZ(n);
+
+            const std::uint32_t * same = std::find_if(first, c, [&](std::uint32_t d)
+            {
+                return sameBits(cornerNormals[d], cornerNormals[*c]);
+            });
+
+            cornerSlots[*c] = same == c ? numSlots++ : cornerSlots[*same];
+        }
+
+        vertexBase[v + 1UL] = numSlots;
+    });
+
+    for (std::size_t v = 0UL; v != numVerts; ++v)
+    {
+        vertexBase[v + 1UL] += vertexBase[v];
+    }
+
+    // 4. Emit split vertices and reindex.
+
+    MeshData out;
+    out.positions.resize(vertexBase[numVerts]);
+    out.normals.resize(vertexBase[numVerts]);
+    out.indices.resize(numCorners);
+
+    ThreadPool::getInstance().parallelRange(numVerts, [&](std::uint32_t v)
+    {
+        for (std::uint32_t i = cornerOffsets[v]; i != cornerOffsets[v + 1UL]; ++i)
+        {
+            std::uint32_t c = vertexCorners[i];
+            std::uint32_t slot = vertexBase[v] + cornerSlots[c];
+
+            out.positions[slot] = mesh.positions[v];
+            out.normals[slot] = cornerNormals[c];
+            out.indices[c] = slot;
+        }
+    });
+
+    return out;
+}
@@ -0,0 +1,391 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif  // __SSE2__
+
+#include "mesh/ParametricSurface.h"
+#include "util/ThreadPool.h"
+
+
+namespace
+{
+
+constexpr float kPi {3.14159265358979323846f};
+
+constexpr const char * kShapeNames[] {"ellipsoid", "cylinder", "cone", "torus", "superquadric"};
+
+// Rows per task; a row is slices + 1 vertices.
+constexpr std::size_t kRowsPerTask {16UL};
+
+
+/// Per-column terms: P.xy = rv * (px, py), N.xy = nr * (nx, ny).
+/// Padded to a multiple of 4 so that the SSE loop never reads past the end.
+struct Columns
+{
+    std::vector<float> px;
+    std::vector<float> py;
+    std::vector<float> nx;
+    std::vector<float> ny;
+};
+
+
+/// Per-row terms: P = (rv * px, rv * py, zv), N = normalize(nr * nx, nr * ny, nz).
+struct Row
+{
+    float rv;
+    float zv;
+    float nr;
+    float nz;
+};
+
+
+/// sign(x) |x|^e, the building block of superquadrics.
+float signedPow(float x, float e)
+{
+    if (e == 1.0f || x == 0.0f)
+    {
+        return x;
+    }
+
+    return std::copysign(std::pow(std::abs(x), e), x);
+}
+
+
+void evaluateRow(const Columns & columns, const Row & row, std::size_t n, glm::vec3 * positions, glm::vec3 * normals)
+{
+    std::size_t i = 0UL;
+
+#if defined(__SSE2__)
+    const __m128 rv = _mm_set1_ps(row.rv);
+    const __m128 nr = _mm_set1_ps(row.nr);
+    const __m128 nz = _mm_set1_ps(row.nz);
+    const __m128 nz2 = _mm_mul_ps(nz, nz);
+    const __m128 tiny = _mm_set1_ps(1e-30f);
+
+    alignas(16) float x[4], y[4], nxs[4], nys[4], nzs[4];
+
+    for (; i + 4UL <= n; i += 4UL)
+    {
+        __m128 px = _mm_mul_ps(rv, _mm_loadu_ps(columns.px.data() + i));
+        __m128 py = _mm_mul_ps(rv, _mm_loadu_ps(columns.py.data() + i));
+        __m128 nx = _mm_mul_ps(nr, _mm_loadu_ps(columns.nx.data() + i));
+        __m128 ny = _mm_mul_ps(nr, _mm_loadu_ps(columns.ny.data() + i));
+
+        __m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)), nz2);
+        __m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(_mm_max_ps(len2, tiny)));
+
+        _mm_store_ps(x, px);
+        _mm_store_ps(y, py);
+        _mm_store_ps(nxs, _mm_mul_ps(nx, inv));
+        _mm_store_ps(nys, _mm_mul_ps(ny, inv));
+        _mm_store_ps(nzs, _mm_mul_ps(nz, inv));
+
+        // glm::vec3 is 12 bytes, so the interleaving store stays scalar.
+        for (std::size_t k = 0UL; k != 4UL; ++k)
+        {
+            positions[i + k] = {x[k], y[k], row.zv};
+            normals[i + k] = {nxs[k], nys[k], nzs[k]};
+        }
+    }
+#endif  // __SSE2__
+
+    for (; i != n; ++i)
+    {
+        glm::vec3 normal(row.nr * columns.nx[i], row.nr * columns.ny[i], row.nz);
+        float len = glm::length(normal);
+
+        positions[i] = {row.rv * columns.px[i], row.rv * columns.py[i], row.zv};
+        normals[i] = 0.0f < len ? normal / len : normal;
+    }
+}
+
+
+/// Flat cap at height z, facing up (sign > 0) or down, as a band of two rows.
+void appendCap(std::vector<Row> & rows, float z, float sign)
+{
+    // Rows run inwards on top and outwards at the bottom, so both caps wind counterclockwise from outside.
+    float first = 0.0f < sign ? 1.0f : 0.0f;
+    rows.push_back({first, z, 0.0f, sign});
+    rows.push_back({1.0f - first, z, 0.0f, sign});
+}
+
+}  // namespace anonymous
+
+
+const char * ParametricSurface::name(Shape shape)
+{
+    return kShapeNames[shape];
+}
+
+
+ParametricSurface::Parameters ParametricSurface::ellipsoid(float a, float b, float c)
+{
+    return {kEllipsoid, a, b, c, 1.0f, 1.0f};
+}
+
+
+ParametricSurface::Parameters ParametricSurface::cylinder(float radius, float height)
+{
+    return {kCylinder, radius, radius, height, 1.0f, 1.0f};
+}
+
+
+ParametricSurface::Parameters ParametricSurface::cone(float radius, float height)
+{
+    return {kCone, radius, radius, height, 1.0f, 1.0f};
+}
+
+
+ParametricSurface::Parameters ParametricSurface::torus(float majorRadius, float minorRadius)
+{
+    return {kTorus, majorRadius, minorRadius, minorRadius, 1.0f, 1.0f};
+}
+
+
+ParametricSurface::Parameters ParametricSurface::superquadric(float a, float b, float c, float e1, float e2)
+{
+    return {kSuperquadric, a, b, c, e1, e2};
+}
+
+
+MeshData ParametricSurface::generate(const Parameters & parameters, int slices, int stacks, Stats * stats)
+{
+    if (slices < 3 || stacks < 1)
+    {
+        throw std::invalid_argument("ParametricSurface::generate: need at least 3 slices and 1 stack");
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    const Parameters & p = parameters;
+    auto numColumns = static_cast<std::size_t>(slices) + 1UL;
+
+    // 1. Per-column terms (around z).
+
+    std::shared_ptr<const TrigTable> around = trigTable(slices, 0.0f, 2.0f * kPi);
+
+    Columns columns;
+    std::size_t padded = (numColumns + 3UL) / 4UL * 4UL;
+    columns.px.assign(padded, 0.0f);
+    columns.py.assign(padded, 0.0f);
+    columns.nx.assign(padded, 0.0f);
+    columns.ny.assign(padded, 0.0f);
+
+    for (std::size_t i = 0UL; i != numColumns; ++i)
+    {
+        float cu = around->cos[i];
+        float su = around->sin[i];
+
+        switch (p.shape)
+        {
+        case kEllipsoid:
+        case kSuperquadric:
+        {
+            columns.px[i] = p.a * signedPow(cu, p.e2);
+            columns.py[i] = p.b * signedPow(su, p.e2);
+            columns.nx[i] = signedPow(cu, 2.0f - p.e2) / p.a;
+            columns.ny[i] = signedPow(su, 2.0f - p.e2) / p.b;
+            break;
+        }
+        case kCylinder:
+        case kCone:
+        {
+            columns.px[i] = p.a * cu;
+            columns.py[i] = p.a * su;
+            columns.nx[i] = cu;
+            columns.ny[i] = su;
+            break;
+        }
+        case kTorus:
+        {
+            columns.px[i] = cu;
+            columns.py[i] = su;
+            columns.nx[i] = cu;
+            columns.ny[i] = su;
+            break;
+        }
+        }
+    }
+
+    // 2. Per-row terms (along the profile), grouped into bands of connected rows.
+
+    std::vector<Row> rows;
+    std::vector<std::size_t> bandBegin {0UL};
+
+    switch (p.shape)
+    {
+    case kEllipsoid:
+    case kSuperquadric:
+    {
+        std::shared_ptr<const TrigTable> profile = trigTable(stacks, -0.5f * kPi, 0.5f * kPi);
+
+        for (int j = 0; j <= stacks; ++j)
+        {
+            float cv = profile->cos[j];
+            float sv = profile->sin[j];
+            rows.push_back({signedPow(cv, p.e1),
+                            p.c * signedPow(sv, p.e1),
+                            signedPow(cv, 2.0f - p.e1),
+                            signedPow(sv, 2.0f - p.e1) / p.c});
+        }
+
+        break;
+    }
+    case kCylinder:
+    {
+        appendCap(rows, -0.5f * p.c, -1.0f);
+        bandBegin.push_back(rows.size());
+
+        for (int j = 0; j <= stacks; ++j)
+        {
+            float t = static_cast<float>(j) / static_cast<float>(stacks);
+            rows.push_back({1.0f, p.c * (t - 0.5f), 1.0f, 0.0f});
+        }
+
+        bandBegin.push_back(rows.size());
+        appendCap(rows, 0.5f * p.c, 1.0f);
+        break;
+    }
+    case kCone:
+    {
+        appendCap(rows, -0.5f * p.c, -1.0f);
+        bandBegin.push_back(rows.size());
+
+        // The side normal is (height cos u, height sin u, radius), normalized.
+        float slant = std::sqrt(p.a * p.a + p.c * p.c);
+
+        for (int j = 0; j <= stacks; ++j)
+        {
+            float t = static_cast<float>(j) / static_cast<float>(stacks);
+            rows.push_back({1.0f - t, p.c * (t - 0.5f), p.c / slant, p.a / slant});
+        }
+
+        break;
+    }
+    case kTorus:
+    {
+        std::shared_ptr<const TrigTable> tube = trigTable(stacks, 0.0f, 2.0f * kPi);
+
+        for (int j = 0; j <= stacks; ++j)
+        {
+            float cv = tube->cos[j];
+            float sv = tube->sin[j];
+            rows.push_back({p.a + p.b * cv, p.b * sv, cv, sv});
+        }
+
+        break;
+    }
+    }
+
+    bandBegin.push_back(rows.size());
+
+    // 3. Vertices, one task per block of rows.
+
+    MeshData data;
+    data.positions.resize(rows.size() * numColumns);
+    data.normals.resize(rows.size() * numColumns);
+
+    std::size_t numRowTasks = (rows.size() + kRowsPerTask - 1UL) / kRowsPerTask;
+
+    ThreadPool::getInstance().parallelFor(numRowTasks, [&](std::size_t t)
+    {
+        std::size_t last = std::min(rows.size(), (t + 1UL) * kRowsPerTask);
+
+        for (std::size_t j = t * kRowsPerTask; j < last; ++j)
+        {
+            evaluateRow(columns,
+                        rows[j],
+                        numColumns,
+                        data.positions.data() + j * numColumns,
+                        data.normals.data() + j * numColumns);
+        }
+    });
+
+    // 4. Two counterclockwise triangles per grid cell; bands are not connected to each other.
+
+    std::vector<std::size_t> quadRows;
+
+    for (std::size_t b = 0UL; b + 1UL < bandBegin.size(); ++b)
+    {
+        for (std::size_t j = bandBegin[b]; j + 1UL < bandBegin[b + 1UL]; ++j)
+        {
+            quadRows.push_back(j);
+        }
+    }
+
+    auto numSlices = static_cast<std::size_t>(slices);
+    data.indices.resize(quadRows.size() * numSlices * 6UL);
+
+    ThreadPool::getInstance().parallelFor((quadRows.size() + kRowsPerTask - 1UL) / kRowsPerTask, [&](std::size_t t)
+    {
+        std::size_t last = std::min(quadRows.size(), (t + 1UL) * kRowsPerTask);
+
+        for (std::size_t q = t * kRowsPerTask; q < last; ++q)
+        {
+            auto lower = static_cast<std::uint32_t>(quadRows[q] * numColumns);
+            auto upper = static_cast<std::uint32_t>(lower + numColumns);
+            std::uint32_t * out = data.indices.data() + q * numSlices * 6UL;
+
+            for (std::uint32_t i = 0U; i != static_cast<std::uint32_t>(numSlices); ++i, out += 6)
+            {
+                out[0] = lower + i;
+                out[1] = lower + i + 1U;
+                out[2] = upper + i + 1U;
+                out[3] = lower + i;
+                out[4] = upper + i + 1U;
+                out[5] = upper + i;
+            }
+        }
+    });
+
+    Stats s;
+    s.numVertices = data.positions.size();
+    s.numTriangles = data.numTriangles();
+    s.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (stats)
+    {
+        *stats = s;
+    }
+
+    return data;
+}
+
+
+std::shared_ptr<const ParametricSurface::TrigTable> ParametricSurface::trigTable(int count, float begin, float end)
+{
+    static std::mutex mutex;
+    static std::map<std::tuple<int, float, float>, std::shared_ptr<const TrigTable>> tables;
+
+    std::lock_guard lock(mutex);
+    std::shared_ptr<const TrigTable> & table = tables[{count, begin, end}];
+
+    if (!table)
+    {
+        auto t = std::make_shared<TrigTable>();
+        t->sin.resize(static_cast<std::size_t>(count) + 1UL);
+        t->cos.resize(static_cast<std::size_t>(count) + 1UL);
+
+        for (int i = 0; i <= count; ++i)
+        {
+            double angle = begin + (static_cast<double>(end) - begin) * i / count;
+            t->sin[i] = static_cast<float>(std::sin(angle));
+            t->cos[i] = static_cast<float>(std::cos(angle));
+
+            // Snap the rounding residue at multiples of pi / 2, so that poles and seams are exact.
+            t->sin[i] = std::abs(t->sin[i]) < 1e-7f ? 0.0f : t->sin[i];
+            t->cos[i] = std::abs(t->cos[i]) < 1e-7f ? 0.0f : t->cos[i];
+        }
+
+        table = std::move(t);
+    }
+
+    return table;
+}
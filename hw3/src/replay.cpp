@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "app/Window.h"
+#include "util/GLTrace.h"
+
+
+namespace
+{
+
+constexpr int kWindowWidth {1000};
+constexpr int kWindowHeight {1000};
+
+// Entry points listed by time spent.
+constexpr std::size_t kNumEntryPoints {15UL};
+
+
+/// A hidden window for the context to replay on, the size of the app's.
+class ReplayWindow : private Window
+{
+public:
+    ReplayWindow()
+            : Window(kWindowWidth, kWindowHeight, "replay", nullptr, nullptr, false)
+    {
+
+    }
+};
+
+
+void printStats(const GLTraceReplayer & replayer)
+{
+    const std::vector<GLTraceReplayer::FrameStats> & frames = replayer.getFrameStats();
+
+    std::cout << std::fixed << std::setprecision(3);
+
+    for (std::size_t i = 0UL; i != frames.size(); ++i)
+    {
+        if (i == GLTraceReplayer::kSetupFrame)
+        {
+            std::cout << "[replay] setup    ";
+        }
+        else
+        {
+            std::cout << "[replay] frame " << std::setw(3) << i;
+        }
+
+        std::cout << std::setw(10) << frames[i].seconds * 1000.0 << " ms, "
+                  << frames[i].numCalls << " calls taking " << frames[i].callSeconds * 1000.0 << " ms\n";
+    }
+
+    if (GLTraceReplayer::kSetupFrame + 1UL < frames.size())
+    {
+        auto slowest = std::max_element(frames.begin() + 1, frames.end(),
+                                        [](const GLTraceReplayer::FrameStats & a, const GLTraceReplayer::FrameStats & b)
+                                        {
+                                            return a.seconds < b.seconds;
+                                        });
+
+        double seconds = 0.0;
+
+        for (auto it = frames.begin() + 1; it != frames.end(); ++it)
+        {
+            seconds += it->seconds;
+        }
+
+        std::cout << "[replay] " << frames.size() - 1UL << " frames, mean "
+                  << seconds * 1000.0 / static_cast<double>(frames.size() - 1UL) << " ms, slowest frame "
+                  << slowest - frames.begin() << " (" << slowest->seconds * 1000.0 << " ms)\n";
+    }
+
+    std::vector<GLTraceReplayer::EntryPointStats> entryPoints = replayer.getEntryPointStats();
+
+    for (std::size_t i = 0UL; i != std::min(kNumEntryPoints, entryPoints.size()); ++i)
+    {
+        const GLTraceReplayer::EntryPointStats & stats = entryPoints[i];
+        std::cout << "[replay]   " << std::left << std::setw(32) << stats.name << std::right
+                  << std::setw(9) << stats.seconds * 1000.0 << " ms in " << stats.numCalls << " calls, longest "
+                  << stats.maxSeconds * 1000.0 << " ms\n";
+    }
+
+    if (replayer.getNumNameMismatches())
+    {
+        std::cout << "[replay] " << replayer.getNumNameMismatches()
+                  << " generated names differ from the recorded ones; objects may not match the recording\n";
+    }
+
+    std::cout << std::defaultfloat;
+}
+
+}  // namespace anonymous
+
+
+int main(int argc, char * argv[])
+{
+    if (argc != 2)
+    {
+        std::cerr << "usage: " << argv[0] << " TRACE\n"
+                  << "  replays an OpenGL trace recorded with --gl-trace and prints the time of every frame\n"
+                  << "  and of the entry points that took longest\n";
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        ReplayWindow window;
+        GLTraceReplayer replayer(argv[1]);
+        replayer.replay();
+        printStats(replayer);
+    }
+    catch (const std::exception & e)
+    {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
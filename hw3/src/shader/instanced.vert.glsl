@@ -0,0 +1,26 @@
+#version 410 core
+
+// Shared geometry.
+layout (location = 0) in vec3 aPosition;
+layout (location = 1) in vec3 aNormal;
+
+// Per instance (glVertexAttribDivisor 1); a mat4 takes 4 locations, a mat3 takes 3.
+layout (location = 2) in vec3 aColor;
+layout (location = 3) in mat4 aModel;
+layout (location = 7) in mat3 aNormalMatrix;
+
+out vec3 ourFragPos;
+out vec3 ourNormal;
+out vec3 ourColor;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    vec4 worldPos = aModel * vec4(aPosition, 1.0f);
+    gl_Position = projection * view * worldPos;
+    ourFragPos = vec3(worldPos);
+    ourNormal = aNormalMatrix * aNormal;
+    ourColor = aColor;
+}
@@ -13,6 +13,7 @@ out vec3 ourNormal;
 out vec3 ourColor;
 
 uniform mat4 model;
+uniform mat3 normalMatrix;
 uniform mat4 view;
 uniform mat4 projection;
 
@@ -22,6 +23,6 @@ void main()
 {
     gl_Position = projection * view * model * vec4(aPosition, 1.0f);
     ourFragPos = vec3(model * vec4(aPosition, 1.0f));
-    ourNormal = vec3(transpose(inverse(model)) * vec4(aNormal, 1.0f));
+    ourNormal = normalMatrix * aNormal;
     ourColor = aColor;
 }
@@ -0,0 +1,38 @@
+#version 410 core
+
+layout (location = 0) in vec3 aPosition;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec3 aColor;
+
+// Index of the vertex's mesh in its StaticMeshPool.
+layout (location = 3) in uint aMesh;
+
+out vec3 ourFragPos;
+out vec3 ourNormal;
+out vec3 ourColor;
+
+// Seven texels per mesh: the columns of its model matrix, then those of its normal matrix.
+uniform samplerBuffer transforms;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    int base = 7 * int(aMesh);
+
+    mat4 model = mat4(texelFetch(transforms, base),
+                      texelFetch(transforms, base + 1),
+                      texelFetch(transforms, base + 2),
+                      texelFetch(transforms, base + 3));
+
+    mat3 normalMatrix = mat3(texelFetch(transforms, base + 4).xyz,
+                             texelFetch(transforms, base + 5).xyz,
+                             texelFetch(transforms, base + 6).xyz);
+
+    vec4 worldPos = model * vec4(aPosition, 1.0f);
+    gl_Position = projection * view * worldPos;
+    ourFragPos = vec3(worldPos);
+    ourNormal = normalMatrix * aNormal;
+    ourColor = aColor;
+}
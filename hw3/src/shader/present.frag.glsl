@@ -0,0 +1,11 @@
+#version 410 core
+
+in vec2 ourTexCoord;
+out vec4 fragColor;
+
+uniform sampler2D image;
+
+void main()
+{
+    fragColor = texture(image, ourTexCoord);
+}
@@ -0,0 +1,13 @@
+#version 410 core
+
+out vec2 ourTexCoord;
+
+void main()
+{
+    // One triangle covering the viewport: (-1, -1), (3, -1) and (-1, 3).
+    vec2 corner = vec2(float((gl_VertexID & 1) << 2), float((gl_VertexID & 2) << 1));
+    gl_Position = vec4(corner - 1.0f, 0.0f, 1.0f);
+
+    // The image's first row is its top row, texture row 0 is the bottom one.
+    ourTexCoord = vec2(0.5f * corner.x, 1.0f - 0.5f * corner.y);
+}
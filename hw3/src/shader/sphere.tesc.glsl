@@ -2,18 +2,21 @@
 
 layout (vertices = 1) out;
 
+// Segments around the equator (x) and from pole to pole (y), chosen per frame
+// from the sphere's projected size (see Sphere::setView).
+uniform vec2 tessLevel;
+
 void main()
 {
-    gl_TessLevelOuter[0] = 64;
-    gl_TessLevelOuter[1] = 64;
-    gl_TessLevelOuter[2] = 64;
-    gl_TessLevelOuter[3] = 64;
+    // In sphere.tese.glsl, u runs along longitude and v along latitude.
+    // Edges u = 0 and u = 1 are the same meridian; edges v = 0 and v = 1 collapse into the poles.
+    gl_TessLevelOuter[0] = tessLevel.y;
+    gl_TessLevelOuter[1] = 1.0f;
+    gl_TessLevelOuter[2] = tessLevel.y;
+    gl_TessLevelOuter[3] = 1.0f;
 
-    gl_TessLevelInner[0] = 64;
-    gl_TessLevelInner[1] = 64;
+    gl_TessLevelInner[0] = tessLevel.x;
+    gl_TessLevelInner[1] = tessLevel.y;
 
     gl_out[gl_InvocationID].gl_Position = gl_in[gl_InvocationID].gl_Position;
 }
-
-
-
@@ -8,6 +8,7 @@ out vec3 ourFragPos;
 out vec3 ourColor;
 
 uniform mat4 model;
+uniform mat3 normalMatrix;
 uniform mat4 view;
 uniform mat4 projection;
 
@@ -32,6 +33,7 @@ void main()
     gl_Position = projection * view * model * vec4(pos, 1.0f);
 
     ourFragPos = vec3(model * vec4(pos, 1.0f));
-    ourNormal = vec3(transpose(inverse(model)) * vec4(pos, 1.0f));
+    // The sphere's object-space normal is the direction from its center.
+    ourNormal = normalMatrix * (pos - center);
     ourColor = color;
 }
\ No newline at end of file
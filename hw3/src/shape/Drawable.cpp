@@ -0,0 +1,22 @@
+#include "shape/Drawable.h"
+
+
+void Drawable::render(float timeElapsedSinceLastFrame)
+{
+    RenderQueue queue;
+    queue.beginFrame(glm::vec3(0.0f));
+    submit(queue, timeElapsedSinceLastFrame);
+    queue.flush();
+}
+
+
+void Drawable::rasterize(SoftwareRasterizer &)
+{
+
+}
+
+
+void Drawable::trace(RayTracer &)
+{
+
+}
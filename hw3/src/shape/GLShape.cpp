@@ -1,20 +1,27 @@
 /// STOP. You should not modify this file unless you KNOW what you are doing.
 
 #include "shape/GLShape.h"
+#include "util/FrameCounters.h"
+#include "util/GLState.h"
 
 
 GLShape::~GLShape() noexcept
 {
-    glDeleteVertexArrays(1, &vao);
+    FrameCounters::getInstance().removeShape(this);
+
+    GLState::getInstance().deleteVertexArray(vao);
     vao = 0U;
 
-    glDeleteBuffers(1, &vbo);
+    GLState::getInstance().deleteBuffer(vbo);
     vbo = 0U;
 }
 
 
-GLShape::GLShape(Shader * pShader, const glm::mat4 & model) : pShader(pShader), model(model)
+GLShape::GLShape(Shader * pShader, const glm::mat4 & model) : pShader(pShader)
 {
+    setModel(model);
+    FrameCounters::getInstance().addShape(this);
+
     glGenVertexArrays(1, &vao);
     glGenBuffers(1, &vbo);
 }
@@ -22,6 +29,7 @@ GLShape::GLShape(Shader * pShader, const glm::mat4 & model) : pShader(pShader),
 
 GLShape::GLShape(GLShape && rhs) noexcept
 {
+    FrameCounters::getInstance().addShape(this);
     *this = std::move(rhs);
 }
 
@@ -43,6 +51,14 @@ GLShape & GLShape::operator=(GLShape && rhs) noexcept
     rhs.vbo = 0U;
 
     model = rhs.model;
+    normalMatrix = rhs.normalMatrix;
 
     return *this;
 }
+
+
+void GLShape::setModel(const glm::mat4 & m)
+{
+    model = m;
+    normalMatrix = glm::transpose(glm::inverse(glm::mat3(m)));
+}
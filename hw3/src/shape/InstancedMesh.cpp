@@ -0,0 +1,321 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "mesh/MeshData.h"
+#include "mesh/NormalGenerator.h"
+#include "shape/InstancedMesh.h"
+#include "util/FrameCounters.h"
+#include "util/GLState.h"
+#include "util/RayTracer.h"
+#include "util/Shader.h"
+#include "util/SoftwareRasterizer.h"
+
+
+InstancedMesh::InstancedMesh(Shader * pShader, const MeshData & data)
+        : GLShape(pShader, glm::mat4(1.0f)),
+          indices(data.indices.cbegin(), data.indices.cend())
+{
+    std::vector<glm::vec3> normals = data.normals.size() == data.positions.size()
+                                     ? data.normals
+                                     : NormalGenerator::vertexNormals(data);
+
+    vertices.reserve(data.positions.size());
+
+    for (std::size_t i = 0UL; i != data.positions.size(); ++i)
+    {
+        vertices.push_back({data.positions[i], normals[i]});
+        bounds.expand(data.positions[i]);
+    }
+
+    vertexCount = static_cast<GLsizei>(vertices.size());
+    indexCount = static_cast<GLsizei>(data.indices.size());
+
+    glGenBuffers(1, &ebo);
+    glGenBuffers(1, &instanceVbo);
+
+    GLState::getInstance().bindVertexArray(vao);
+
+    // Shared geometry: "layout (location = 0) in vec3 aPosition" and "layout (location = 1) in vec3 aNormal".
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER,
+                 static_cast<GLsizeiptr>(vertices.size() * sizeof(Vertex)),
+                 vertices.data(),
+                 GL_STATIC_DRAW);
+    FrameCounters::getInstance().countUpload(vertices.size() * sizeof(Vertex));
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void *>(0));
+
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                          reinterpret_cast<void *>(sizeof(Vertex::position)));
+
+    // The element array binding is VAO state, so ebo stays bound to vao.
+    GLState::getInstance().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                 static_cast<GLsizeiptr>(data.indices.size() * sizeof(GLuint)),
+                 data.indices.data(),
+                 GL_STATIC_DRAW);
+    FrameCounters::getInstance().countUpload(data.indices.size() * sizeof(GLuint));
+
+    // Per instance (divisor 1), from the instance buffer:
+    // "layout (location = 2) in vec3 aColor",
+    // "layout (location = 3) in mat4 aModel" (locations 3 to 6, one per column) and
+    // "layout (location = 7) in mat3 aNormalMatrix" (locations 7 to 9).
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                          reinterpret_cast<void *>(sizeof(Instance::model) + sizeof(Instance::normalMatrix)));
+    glVertexAttribDivisor(2, 1);
+
+    for (GLuint column = 0U; column != 4U; ++column)
+    {
+        glEnableVertexAttribArray(3U + column);
+        glVertexAttribPointer(3U + column, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                              reinterpret_cast<void *>(column * sizeof(glm::vec4)));
+        glVertexAttribDivisor(3U + column, 1);
+    }
+
+    for (GLuint column = 0U; column != 3U; ++column)
+    {
+        glEnableVertexAttribArray(7U + column);
+        glVertexAttribPointer(7U + column, 3, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                              reinterpret_cast<void *>(sizeof(Instance::model) + column * sizeof(glm::vec3)));
+        glVertexAttribDivisor(7U + column, 1);
+    }
+
+    GLState::getInstance().bindVertexArray(0U);
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0U);
+}
+
+
+InstancedMesh::~InstancedMesh() noexcept
+{
+    GLState::getInstance().deleteBuffer(ebo);
+    ebo = 0U;
+
+    GLState::getInstance().deleteBuffer(instanceVbo);
+    instanceVbo = 0U;
+}
+
+
+void InstancedMesh::submit(RenderQueue & queue, float timeElapsedSinceLastFrame)
+{
+    if (instances.empty())
+    {
+        return;
+    }
+
+    upload();
+
+    if (worldBoundsChanged)
+    {
+        worldCenter = getWorldBounds().center();
+        worldBoundsChanged = false;
+    }
+
+    queue.submit(RenderQueue::kOpaque, pShader, vao, worldCenter, this);
+}
+
+
+void InstancedMesh::draw(const RenderQueue::Packet & packet)
+{
+    auto numInstances = static_cast<GLsizei>(instances.size());
+
+    if (indexCount == 0)
+    {
+        glDrawArraysInstanced(GL_TRIANGLES, 0, vertexCount, numInstances);
+        FrameCounters::getInstance().countDraw(GL_TRIANGLES, static_cast<std::size_t>(vertexCount), instances.size());
+    }
+    else
+    {
+        glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, reinterpret_cast<void *>(0), numInstances);
+        FrameCounters::getInstance().countDraw(GL_TRIANGLES, static_cast<std::size_t>(indexCount), instances.size());
+    }
+}
+
+
+void InstancedMesh::rasterize(SoftwareRasterizer & rasterizer)
+{
+    forEachInstance([&rasterizer](const std::vector<SoftwareRasterizer::Vertex> & v, const std::vector<GLuint> & i, const glm::mat4 & m)
+    {
+        rasterizer.addTriangles(v, i, m);
+    });
+}
+
+
+void InstancedMesh::trace(RayTracer & tracer)
+{
+    forEachInstance([&tracer](const std::vector<SoftwareRasterizer::Vertex> & v, const std::vector<GLuint> & i, const glm::mat4 & m)
+    {
+        tracer.addTriangles(v, i, m);
+    });
+}
+
+
+GLShape::Memory InstancedMesh::getMemory() const
+{
+    return {vertices.capacity() * sizeof(Vertex)
+            + indices.capacity() * sizeof(GLuint)
+            + instances.capacity() * sizeof(Instance)
+            + (handleOfSlot.capacity() + freeHandles.capacity()) * sizeof(Handle)
+            + slotOfHandle.capacity() * sizeof(std::uint32_t)
+            + coloredVertices.capacity() * sizeof(SoftwareRasterizer::Vertex),
+            static_cast<std::size_t>(vertexCount) * sizeof(Vertex)
+            + static_cast<std::size_t>(indexCount) * sizeof(GLuint)
+            + capacity * sizeof(Instance)};
+}
+
+
+InstancedMesh::Handle InstancedMesh::addInstance(const glm::mat4 & model, const glm::vec3 & color)
+{
+    Handle handle;
+
+    if (freeHandles.empty())
+    {
+        handle = static_cast<Handle>(slotOfHandle.size());
+        slotOfHandle.emplace_back(kNoSlot);
+    }
+    else
+    {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+    }
+
+    std::size_t slot = instances.size();
+    slotOfHandle[handle] = static_cast<std::uint32_t>(slot);
+    handleOfSlot.emplace_back(handle);
+    instances.emplace_back(makeInstance(model, color));
+    markDirty(slot);
+    worldBoundsChanged = true;
+
+    return handle;
+}
+
+
+void InstancedMesh::updateInstance(Handle handle, const glm::mat4 & model, const glm::vec3 & color)
+{
+    std::uint32_t slot = slotOf(handle);
+    instances[slot] = makeInstance(model, color);
+    markDirty(slot);
+    worldBoundsChanged = true;
+}
+
+
+void InstancedMesh::removeInstance(Handle handle)
+{
+    std::uint32_t slot = slotOf(handle);
+    std::size_t last = instances.size() - 1UL;
+
+    // Fill the hole with the last instance, so the buffer stays dense.
+    if (slot != last)
+    {
+        instances[slot] = instances[last];
+        handleOfSlot[slot] = handleOfSlot[last];
+        slotOfHandle[handleOfSlot[slot]] = slot;
+        markDirty(slot);
+    }
+
+    instances.pop_back();
+    handleOfSlot.pop_back();
+    slotOfHandle[handle] = kNoSlot;
+    freeHandles.emplace_back(handle);
+    worldBoundsChanged = true;
+}
+
+
+void InstancedMesh::reserve(std::size_t numInstances)
+{
+    instances.reserve(numInstances);
+    handleOfSlot.reserve(numInstances);
+    slotOfHandle.reserve(numInstances);
+
+    if (capacity < numInstances)
+    {
+        reallocate(numInstances);
+    }
+}
+
+
+Aabb InstancedMesh::getWorldBounds() const
+{
+    Aabb box;
+
+    for (const Instance & instance : instances)
+    {
+        box.expand(bounds.transformed(instance.model));
+    }
+
+    return box;
+}
+
+
+InstancedMesh::Instance InstancedMesh::makeInstance(const glm::mat4 & model, const glm::vec3 & color)
+{
+    return {model, glm::transpose(glm::inverse(glm::mat3(model))), color};
+}
+
+
+std::uint32_t InstancedMesh::slotOf(Handle handle) const
+{
+    if (slotOfHandle.size() <= handle || slotOfHandle[handle] == kNoSlot)
+    {
+        throw std::out_of_range("InstancedMesh: invalid instance handle " + std::to_string(handle));
+    }
+
+    return slotOfHandle[handle];
+}
+
+
+void InstancedMesh::markDirty(std::size_t slot)
+{
+    if (dirtyBegin == dirtyEnd)
+    {
+        dirtyBegin = slot;
+        dirtyEnd = slot + 1UL;
+        return;
+    }
+
+    dirtyBegin = std::min(dirtyBegin, slot);
+    dirtyEnd = std::max(dirtyEnd, slot + 1UL);
+}
+
+
+void InstancedMesh::reallocate(std::size_t numInstances)
+{
+    // Orphans the old storage; everything is re-sent on the next upload.
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(numInstances * sizeof(Instance)), nullptr, GL_DYNAMIC_DRAW);
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0U);
+
+    capacity = numInstances;
+    dirtyBegin = 0UL;
+    dirtyEnd = instances.size();
+}
+
+
+void InstancedMesh::upload()
+{
+    if (capacity < instances.size())
+    {
+        reallocate(std::max(instances.size(), 2UL * capacity));
+    }
+
+    // Removals may have shrunk the instances below the dirty range.
+    dirtyEnd = std::min(dirtyEnd, instances.size());
+
+    if (dirtyBegin < dirtyEnd)
+    {
+        GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+        glBufferSubData(GL_ARRAY_BUFFER,
+                        static_cast<GLintptr>(dirtyBegin * sizeof(Instance)),
+                        static_cast<GLsizeiptr>((dirtyEnd - dirtyBegin) * sizeof(Instance)),
+                        instances.data() + dirtyBegin);
+        FrameCounters::getInstance().countUpload((dirtyEnd - dirtyBegin) * sizeof(Instance));
+        GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0U);
+    }
+
+    dirtyBegin = dirtyEnd = 0UL;
+}
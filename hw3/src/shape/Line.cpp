@@ -1,12 +1,15 @@
 #include "shape/Line.h"
+#include "util/FrameCounters.h"
+#include "util/GLState.h"
 #include "util/Shader.h"
+#include "util/SoftwareRasterizer.h"
 
 
 Line::Line(Shader * pShader, const std::vector<Vertex> & vertices, const glm::mat4 & model)
         : GLShape(pShader, model), vertices(vertices)
 {
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    GLState::getInstance().bindVertexArray(vao);
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, vbo);
 
     // Vertex coordinate attribute array "layout (position = 0) in vec3 aPosition"
     glEnableVertexAttribArray(0);
@@ -30,24 +33,50 @@ Line::Line(Shader * pShader, const std::vector<Vertex> & vertices, const glm::ma
                  static_cast<GLsizei>(vertices.size() * sizeof(Vertex)),
                  vertices.data(),
                  GL_STATIC_DRAW);
+    FrameCounters::getInstance().countUpload(vertices.size() * sizeof(Vertex));
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::getInstance().bindVertexArray(0);
 }
 
 
-void Line::render(float timeElapsedSinceLastFrame)
+void Line::submit(RenderQueue & queue, float timeElapsedSinceLastFrame)
 {
-    pShader->use();
-    pShader->setMat4("model", model);
+    queue.submit(RenderQueue::kOpaque, pShader, vao, getWorldBounds().center(), this);
+}
+
 
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+void Line::draw(const RenderQueue::Packet & packet)
+{
+    pShader->setMat4("model", model);
 
     glDrawArrays(GL_LINES,
                  0,                                       // start from index 0 in current VBO
                  static_cast<GLsizei>(vertices.size()));  // draw these number of elements
+    FrameCounters::getInstance().countDraw(GL_LINES, vertices.size());
+}
+
+
+GLShape::Memory Line::getMemory() const
+{
+    return {vertices.capacity() * sizeof(Vertex), vertices.size() * sizeof(Vertex)};
+}
+
+
+void Line::rasterize(SoftwareRasterizer & rasterizer)
+{
+    rasterizer.addLines(vertices, model);
+}
+
+
+Aabb Line::getWorldBounds() const
+{
+    Aabb box;
+
+    for (const Vertex & v : vertices)
+    {
+        box.expand(v.position);
+    }
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    return box.transformed(model);
 }
@@ -1,5 +1,14 @@
+#include <stdexcept>
+
+#include "mesh/MeshCache.h"
+#include "mesh/MeshData.h"
+#include "mesh/NormalGenerator.h"
 #include "shape/Mesh.h"
+#include "util/FrameCounters.h"
+#include "util/GLState.h"
+#include "util/RayTracer.h"
 #include "util/Shader.h"
+#include "util/SoftwareRasterizer.h"
 
 
 Mesh::Mesh(
@@ -10,39 +19,276 @@ Mesh::Mesh(
         : Mesh(shader, model)
 {
     this->vertices = vertices;
+    upload();
+}
 
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
 
-    glBufferData(GL_ARRAY_BUFFER,
-                 static_cast<GLsizei>(vertices.size() * sizeof(Vertex)),
-                 vertices.data(),
-                 GL_STATIC_DRAW);
+Mesh::Mesh(
+        Shader * shader,
+        const MeshData & data,
+        const glm::vec3 & color,
+        const glm::mat4 & model
+)
+        : Mesh(shader, model)
+{
+    vertices = makeVertices(data, color);
+    indices.assign(data.indices.cbegin(), data.indices.cend());
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0U);
+    upload();
 }
 
 
-void Mesh::render(float timeElapsedSinceLastFrame)
+Mesh::~Mesh() noexcept
+{
+    GLState::getInstance().deleteBuffer(ebo);
+    ebo = 0U;
+}
+
+
+void Mesh::submit(RenderQueue & queue, float timeElapsedSinceLastFrame)
+{
+    queue.submit(RenderQueue::kOpaque, pShader, vao, getWorldBounds().center(), this);
+}
+
+
+void Mesh::draw(const RenderQueue::Packet & packet)
 {
-    pShader->use();
     pShader->setMat4("model", model);
+    pShader->setMat3("normalMatrix", normalMatrix);
+
+    if (indexCount == 0)
+    {
+        glDrawArrays(GL_TRIANGLES,
+                     0,             // start from index 0 in current VBO
+                     vertexCount);  // draw these number of elements
+        FrameCounters::getInstance().countDraw(GL_TRIANGLES, static_cast<std::size_t>(vertexCount));
+    }
+    else
+    {
+        glDrawElements(GL_TRIANGLES,
+                       indexCount,                     // draw these number of indices
+                       GL_UNSIGNED_INT,
+                       reinterpret_cast<void *>(0));  // offset into the element array buffer
+        FrameCounters::getInstance().countDraw(GL_TRIANGLES, static_cast<std::size_t>(indexCount));
+    }
+}
+
+
+GLShape::Memory Mesh::getMemory() const
+{
+    return {vertices.capacity() * sizeof(Vertex) + indices.capacity() * sizeof(GLuint),
+            static_cast<std::size_t>(vboCapacity + eboCapacity)};
+}
+
 
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+void Mesh::rasterize(SoftwareRasterizer & rasterizer)
+{
+    loadCpuGeometry();
+    rasterizer.addTriangles(vertices, indices, model);
+}
 
-    glDrawArrays(GL_TRIANGLES,
-                 0,                                       // start from index 0 in current VBO
-                 static_cast<GLsizei>(vertices.size()));  // draw these number of elements
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0U);
-    glBindVertexArray(0U);
+void Mesh::trace(RayTracer & tracer)
+{
+    loadCpuGeometry();
+    tracer.addTriangles(vertices, indices, model);
 }
 
 
 Mesh::Mesh(Shader * shader, const glm::mat4 & model) : GLShape(shader, model)
 {
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glGenBuffers(1, &ebo);
+
+    GLState::getInstance().bindVertexArray(vao);
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    setVertexLayout(false);
+
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::getInstance().bindVertexArray(0);
+}
+
+
+std::vector<Mesh::Vertex> Mesh::makeVertices(const MeshData & data, const glm::vec3 & color)
+{
+    std::vector<glm::vec3> normals = data.normals.size() == data.positions.size()
+                                     ? data.normals
+                                     : NormalGenerator::vertexNormals(data);
+
+    std::vector<Vertex> vertices;
+    vertices.reserve(data.positions.size());
+
+    for (std::size_t i = 0UL; i != data.positions.size(); ++i)
+    {
+        vertices.emplace_back(data.positions[i], normals[i], color);
+    }
+
+    return vertices;
+}
+
+
+void Mesh::upload(bool uploadIndices)
+{
+    bounds = Aabb();
+
+    for (const Vertex & v : vertices)
+    {
+        bounds.expand(v.position);
+    }
+
+    vertexCount = static_cast<GLsizei>(vertices.size());
+    indexCount = static_cast<GLsizei>(indices.size());
+
+    auto vertexBytes = static_cast<GLsizeiptr>(vertices.size() * sizeof(Vertex));
+    auto indexBytes = static_cast<GLsizeiptr>(indices.size() * sizeof(GLuint));
+
+    GLState::getInstance().bindVertexArray(vao);
+
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    if (vertexBytes <= vboCapacity)
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, vertexBytes, vertices.data());
+    }
+    else
+    {
+        glBufferData(GL_ARRAY_BUFFER, vertexBytes, vertices.data(), GL_STATIC_DRAW);
+        vboCapacity = vertexBytes;
+    }
+
+    FrameCounters::getInstance().countUpload(static_cast<std::size_t>(vertexBytes));
+
+    // The element array binding is VAO state, so ebo stays bound to vao.
+    if (uploadIndices)
+    {
+        GLState::getInstance().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+
+        if (indexBytes <= eboCapacity)
+        {
+            glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indexBytes, indices.data());
+        }
+        else
+        {
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, indices.data(), GL_STATIC_DRAW);
+            eboCapacity = indexBytes;
+        }
+
+        FrameCounters::getInstance().countUpload(static_cast<std::size_t>(indexBytes));
+    }
+
+    GLState::getInstance().bindVertexArray(0U);
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0U);
+}
+
+
+bool Mesh::uploadFromCache(const std::string & cachePath, std::uint64_t sourceHash)
+{
+    MeshCache cache(cachePath);
+
+    if (!cache.isValid(sourceHash))
+    {
+        return false;
+    }
+
+    const MeshCache::Header & header = cache.header();
+
+    GLState::getInstance().bindVertexArray(vao);
+
+    // Straight from the mapping: the driver copies the pages, nothing is parsed.
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER,
+                 static_cast<GLsizeiptr>(header.numVertices) * header.vertexStride,
+                 cache.vertexData(),
+                 GL_STATIC_DRAW);
+
+    GLState::getInstance().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                 static_cast<GLsizeiptr>(header.numIndices * sizeof(GLuint)),
+                 cache.indexData(),
+                 GL_STATIC_DRAW);
+
+    setVertexLayout(header.flags & MeshCache::kQuantized);
+
+    vboCapacity = static_cast<GLsizeiptr>(header.numVertices) * header.vertexStride;
+    eboCapacity = static_cast<GLsizeiptr>(header.numIndices * sizeof(GLuint));
+    FrameCounters::getInstance().countUpload(static_cast<std::size_t>(vboCapacity));
+    FrameCounters::getInstance().countUpload(static_cast<std::size_t>(eboCapacity));
+
+    GLState::getInstance().bindVertexArray(0U);
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0U);
+
+    vertices.clear();
+    indices.clear();
+    vertexCount = static_cast<GLsizei>(header.numVertices);
+    indexCount = static_cast<GLsizei>(header.numIndices);
+    bounds.min = {header.aabbMin[0], header.aabbMin[1], header.aabbMin[2]};
+    bounds.max = {header.aabbMax[0], header.aabbMax[1], header.aabbMax[2]};
+    this->cachePath = cachePath;
+    cacheHash = sourceHash;
+
+    return true;
+}
+
+
+void Mesh::loadCpuGeometry()
+{
+    if (!vertices.empty() || cachePath.empty())
+    {
+        return;
+    }
+
+    // The file may have been deleted, truncated or rewritten by another run since the upload.
+    MeshCache cache(cachePath);
+
+    if (cache.isValid(cacheHash))
+    {
+        vertices = cache.decodeVertices();
+        indices = cache.decodeIndices();
+    }
+    else
+    {
+        // Rebuild from the source and upload it too, so the CPU and GPU frames show the same geometry.
+        loadSourceGeometry();
+        upload();
+
+        GLState::getInstance().bindVertexArray(vao);
+        GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, vbo);
+        setVertexLayout(false);
+        GLState::getInstance().bindVertexArray(0U);
+        GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0U);
+    }
+
+    cachePath.clear();
+}
+
+
+void Mesh::loadSourceGeometry()
+{
+    throw std::runtime_error("Mesh: " + cachePath + " is no longer valid and the mesh has no source to reload");
+}
+
+
+void Mesh::setVertexLayout(bool packed)
+{
+    if (packed)
+    {
+        auto stride = static_cast<GLsizei>(sizeof(MeshCache::PackedVertex));
+
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(0));
+
+        // Signed normalized 10:10:10:2 normal; "in vec3 aNormal" ignores the w component.
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride,
+                              reinterpret_cast<void *>(sizeof(glm::vec3)));
+
+        // Unsigned normalized RGBA8 color.
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+                              reinterpret_cast<void *>(sizeof(glm::vec3) + sizeof(std::uint32_t)));
+
+        return;
+    }
 
     // Vertex coordinate attribute array "layout (position = 0) in vec3 aPosition"
     glEnableVertexAttribArray(0);
@@ -70,7 +316,4 @@ Mesh::Mesh(Shader * shader, const glm::mat4 & model) : GLShape(shader, model)
                           GL_FALSE,
                           sizeof(Vertex),
                           reinterpret_cast<void *>(sizeof(Vertex::position) + sizeof(Vertex::normal)));
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
 }
@@ -0,0 +1,234 @@
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "shape/ParametricShape.h"
+#include "util/FrameCounters.h"
+#include "util/GLState.h"
+#include "util/RayTracer.h"
+#include "util/Shader.h"
+#include "util/SoftwareRasterizer.h"
+
+
+struct ParametricShape::Buffers
+{
+    Buffers() = default;
+    Buffers(const Buffers &) = delete;
+    Buffers & operator=(const Buffers &) = delete;
+
+    ~Buffers() noexcept
+    {
+        GLState::getInstance().deleteBuffer(vbo);
+        GLState::getInstance().deleteBuffer(ebo);
+    }
+
+    // Positions, then normals (not interleaved).
+    GLuint vbo {0U};
+    GLuint ebo {0U};
+
+    GLsizeiptr normalOffset {0};
+    GLsizei indexCount {0};
+
+    // Size of vbo and ebo together.
+    std::size_t numBytes {0UL};
+
+    // The surface on the CPU, for trace.
+    MeshData data;
+
+    Aabb bounds;
+};
+
+
+namespace
+{
+
+/// Parameters and resolution; plain 4-byte fields, so it orders with memcmp.
+struct Key
+{
+    bool operator<(const Key & rhs) const
+    {
+        return std::memcmp(this, &rhs, sizeof(Key)) < 0;
+    }
+
+    ParametricSurface::Parameters parameters;
+    int slices;
+    int stacks;
+};
+
+static_assert(sizeof(Key) == sizeof(ParametricSurface::Parameters) + 2UL * sizeof(int), "Key must not have padding");
+
+}  // namespace anonymous
+
+
+ParametricShape::ParametricShape(
+        Shader * pShader,
+        const ParametricSurface::Parameters & parameters,
+        int slices,
+        int stacks,
+        const glm::vec3 & color,
+        const glm::mat4 & model,
+        ParametricSurface::Stats * generated
+)
+        : GLShape(pShader, model),
+          buffers(acquire(parameters, slices, stacks, generated)),
+          color(color)
+{
+    // GLShape's own vbo stays unused: the (shared) buffers live in this->buffers.
+    GLState::getInstance().bindVertexArray(vao);
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, buffers->vbo);
+
+    // "layout (location = 0) in vec3 aPosition" and "layout (location = 1) in vec3 aNormal"
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), reinterpret_cast<void *>(0));
+
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3),
+                          reinterpret_cast<void *>(buffers->normalOffset));
+
+    // "layout (location = 2) in vec3 aColor" is left disabled and set per draw with glVertexAttrib3fv.
+
+    GLState::getInstance().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers->ebo);
+
+    GLState::getInstance().bindVertexArray(0);
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+
+void ParametricShape::submit(RenderQueue & queue, float timeElapsedSinceLastFrame)
+{
+    queue.submit(RenderQueue::kOpaque, pShader, vao, getWorldBounds().center(), this);
+}
+
+
+void ParametricShape::draw(const RenderQueue::Packet & packet)
+{
+    pShader->setMat4("model", model);
+    pShader->setMat3("normalMatrix", normalMatrix);
+
+    // Constant attributes are context state, not vertex array state.
+    glVertexAttrib3fv(2, &color[0]);
+
+    glDrawElements(GL_TRIANGLES, buffers->indexCount, GL_UNSIGNED_INT, reinterpret_cast<void *>(0));
+    FrameCounters::getInstance().countDraw(GL_TRIANGLES, static_cast<std::size_t>(buffers->indexCount));
+}
+
+
+void ParametricShape::rasterize(SoftwareRasterizer & rasterizer)
+{
+    rasterizer.addTriangles(getCpuVertices(), buffers->data.indices, model);
+}
+
+
+void ParametricShape::trace(RayTracer & tracer)
+{
+    tracer.addTriangles(getCpuVertices(), buffers->data.indices, model);
+}
+
+
+GLShape::Memory ParametricShape::getMemory() const
+{
+    const MeshData & data = buffers->data;
+    std::size_t cpuBytes = (data.positions.capacity() + data.normals.capacity()) * sizeof(glm::vec3)
+                           + data.indices.capacity() * sizeof(std::uint32_t);
+    auto numShapes = static_cast<std::size_t>(buffers.use_count());
+
+    return {cpuBytes / numShapes + cpuVertices.capacity() * sizeof(SoftwareRasterizer::Vertex),
+            buffers->numBytes / numShapes};
+}
+
+
+const std::vector<SoftwareRasterizer::Vertex> & ParametricShape::getCpuVertices()
+{
+    if (cpuVertices.empty())
+    {
+        const MeshData & data = buffers->data;
+        cpuVertices.reserve(data.positions.size());
+
+        for (std::size_t i = 0UL; i != data.positions.size(); ++i)
+        {
+            cpuVertices.push_back({data.positions[i], data.normals[i], color});
+        }
+    }
+
+    return cpuVertices;
+}
+
+
+const Aabb & ParametricShape::getBounds() const
+{
+    return buffers->bounds;
+}
+
+
+std::shared_ptr<const ParametricShape::Buffers> ParametricShape::acquire(
+        const ParametricSurface::Parameters & parameters,
+        int slices,
+        int stacks,
+        ParametricSurface::Stats * generated
+)
+{
+    // Only the thread owning the OpenGL context gets here, so no locking.
+    // Entries expire with the last shape using them, and are erased on the next miss.
+    static std::map<Key, std::weak_ptr<const Buffers>> cache;
+
+    Key key {};
+    key.parameters = parameters;
+    key.slices = slices;
+    key.stacks = stacks;
+
+    if (auto it = cache.find(key); it != cache.end())
+    {
+        if (std::shared_ptr<const Buffers> cached = it->second.lock())
+        {
+            if (generated)
+            {
+                *generated = ParametricSurface::Stats();
+            }
+
+            return cached;
+        }
+    }
+
+    for (auto it = cache.begin(); it != cache.end(); )
+    {
+        it = it->second.expired() ? cache.erase(it) : std::next(it);
+    }
+
+    MeshData data = ParametricSurface::generate(parameters, slices, stacks, generated);
+
+    auto buffers = std::make_shared<Buffers>();
+    auto positionBytes = static_cast<GLsizeiptr>(data.positions.size() * sizeof(glm::vec3));
+    auto indexBytes = static_cast<GLsizeiptr>(data.indices.size() * sizeof(GLuint));
+
+    glGenBuffers(1, &buffers->vbo);
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, buffers->vbo);
+    glBufferData(GL_ARRAY_BUFFER, 2 * positionBytes, nullptr, GL_STATIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, positionBytes, data.positions.data());
+    glBufferSubData(GL_ARRAY_BUFFER, positionBytes, positionBytes, data.normals.data());
+    FrameCounters::getInstance().countUpload(static_cast<std::size_t>(positionBytes));
+    FrameCounters::getInstance().countUpload(static_cast<std::size_t>(positionBytes));
+
+    // Element array bindings are VAO state, so fill the index buffer through GL_ARRAY_BUFFER instead.
+    glGenBuffers(1, &buffers->ebo);
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, buffers->ebo);
+    glBufferData(GL_ARRAY_BUFFER, indexBytes, data.indices.data(), GL_STATIC_DRAW);
+    FrameCounters::getInstance().countUpload(static_cast<std::size_t>(indexBytes));
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0);
+
+    buffers->normalOffset = positionBytes;
+    buffers->indexCount = static_cast<GLsizei>(data.indices.size());
+    buffers->numBytes = static_cast<std::size_t>(2 * positionBytes + indexBytes);
+
+    for (const glm::vec3 & p : data.positions)
+    {
+        buffers->bounds.expand(p);
+    }
+
+    buffers->data = std::move(data);
+
+    cache[key] = buffers;
+    return buffers;
+}
@@ -1,4 +1,14 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+#include "mesh/MeshData.h"
+#include "mesh/ParametricSurface.h"
 #include "shape/Sphere.h"
+#include "util/FrameCounters.h"
+#include "util/GLState.h"
+#include "util/RayTracer.h"
 #include "util/Shader.h"
 
 
@@ -7,15 +17,17 @@ Sphere::Sphere(
         const glm::vec3 & center,
         float radius,
         const glm::vec3 & color,
-        const glm::mat4 & model
+        const glm::mat4 & model,
+        Shader * pReplayShader
 )
         : GLShape(pShader, model),
           center(center),
           radius(radius),
-          color(color)
+          color(color),
+          pReplayShader(pReplayShader)
 {
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    GLState::getInstance().bindVertexArray(vao);
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, vbo);
 
     // Placeholder attribute array "layout (position = 0) in float null"
     glEnableVertexAttribArray(0);
@@ -30,26 +42,230 @@ Sphere::Sphere(
                  static_cast<GLsizei>(sizeof(float)),
                  &kNull,
                  GL_STATIC_DRAW);
+    FrameCounters::getInstance().countUpload(sizeof(float));
+
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::getInstance().bindVertexArray(0);
+
+    GLint maxLevel {64};
+    glGetIntegerv(GL_MAX_TESS_GEN_LEVEL, &maxLevel);
+    maxTessLevel = static_cast<float>(maxLevel);
+    tessLevel = {maxTessLevel, 0.5f * maxTessLevel};
+
+    if (!pReplayShader)
+    {
+        return;
+    }
+
+    pShader->setTransformFeedbackVaryings({"ourFragPos", "ourNormal", "ourColor"});
+
+    glGenBuffers(1, &captureVbo);
+
+    // The capture buffer stays attached to the transform feedback object,
+    // which also remembers how many vertices were written (see glDrawTransformFeedback).
+    glGenTransformFeedbacks(1, &feedback);
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, feedback);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, captureVbo);
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
+
+    // Same attribute layout as Mesh::Vertex: "layout (location = 0, 1, 2) in vec3" in mesh.vert.glsl.
+    glGenVertexArrays(1, &captureVao);
+    GLState::getInstance().bindVertexArray(captureVao);
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, captureVbo);
+
+    for (GLuint i = 0U; i != 3U; ++i)
+    {
+        glEnableVertexAttribArray(i);
+        glVertexAttribPointer(i,
+                              3,
+                              GL_FLOAT,
+                              GL_FALSE,
+                              static_cast<GLsizei>(kCapturedVertexSize),
+                              reinterpret_cast<void *>(i * sizeof(glm::vec3)));
+    }
+
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::getInstance().bindVertexArray(0);
+}
+
+
+Sphere::~Sphere() noexcept
+{
+    glDeleteTransformFeedbacks(1, &feedback);
+    GLState::getInstance().deleteVertexArray(captureVao);
+    GLState::getInstance().deleteBuffer(captureVbo);
+}
+
+
+void Sphere::submit(RenderQueue & queue, float timeElapsedSinceLastFrame)
+{
+    glm::vec3 worldCenter(model * glm::vec4(center, 1.0f));
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    if (!pReplayShader)
+    {
+        queue.submit(RenderQueue::kOpaque, pShader, vao, worldCenter, this, kPatch);
+        return;
+    }
+
+    CaptureKey key {model, center, radius, color, tessLevel};
+
+    if (captured && std::memcmp(&key, &capturedKey, sizeof(CaptureKey)) == 0)
+    {
+        queue.submit(RenderQueue::kOpaque, pReplayShader, captureVao, worldCenter, this, kReplay);
+        return;
+    }
+
+    // The capture itself happens when the queue is flushed.
+    capturedKey = key;
+    captured = true;
+    queue.submit(RenderQueue::kOpaque, pShader, vao, worldCenter, this, kCapture);
+}
+
+
+void Sphere::draw(const RenderQueue::Packet & packet)
+{
+    switch (packet.tag)
+    {
+        case kCapture:
+            capture();
+            break;
+
+        case kReplay:
+            replay();
+            break;
+
+        default:
+            drawPatch();
+            break;
+    }
 }
 
 
-void Sphere::render(float timeElapsedSinceLastFrame)
+void Sphere::rasterize(SoftwareRasterizer & rasterizer)
+{
+    if (cpuTessLevel != tessLevel)
+    {
+        // Same parametrization as sphere.tese.glsl: u around the z axis, v from pole to pole.
+        MeshData data = ParametricSurface::generate(ParametricSurface::ellipsoid(radius, radius, radius),
+                                                    static_cast<int>(tessLevel.x),
+                                                    static_cast<int>(tessLevel.y));
+
+        cpuVertices.clear();
+        cpuVertices.reserve(data.positions.size());
+
+        for (std::size_t i = 0UL; i != data.positions.size(); ++i)
+        {
+            cpuVertices.push_back({center + data.positions[i], data.normals[i], color});
+        }
+
+        cpuIndices.assign(data.indices.cbegin(), data.indices.cend());
+        cpuTessLevel = tessLevel;
+    }
+
+    rasterizer.addTriangles(cpuVertices, cpuIndices, model);
+}
+
+
+void Sphere::trace(RayTracer & tracer)
+{
+    tracer.addSphere(center, radius, color, model);
+}
+
+
+void Sphere::setView(const glm::mat4 & view, const glm::mat4 & projection, int viewportHeight)
+{
+    constexpr float kTwoPi {6.28318530717958647692f};
+
+    // World-space radius: model may scale (not necessarily uniformly).
+    glm::mat3 linear(model);
+    float scale = std::max({glm::length(linear[0]), glm::length(linear[1]), glm::length(linear[2])});
+    float r = radius * scale;
+
+    glm::vec3 eyeCenter(view * model * glm::vec4(center, 1.0f));
+    float d = glm::length(eyeCenter);
+
+    float pixels = maxTessLevel * kPixelsPerSegment;
+
+    if (r < d)
+    {
+        // The silhouette subtends asin(r / d); projection[1][1] is cot(fovy / 2).
+        float tanHalfAngle = r / std::sqrt(d * d - r * r);
+        pixels = tanHalfAngle * projection[1][1] * 0.5f * static_cast<float>(viewportHeight);
+    }
+
+    // The equator is 2 pi R pixels long, a meridian from pole to pole pi R.
+    // equal_spacing rounds levels up to integers anyway; doing it here keeps
+    // small camera moves from invalidating a captured surface.
+    float segments = kTwoPi * pixels / kPixelsPerSegment;
+    tessLevel = {std::ceil(std::clamp(segments, 2.0f * kMinTessLevel, maxTessLevel)),
+                 std::ceil(std::clamp(0.5f * segments, kMinTessLevel, maxTessLevel))};
+}
+
+
+GLShape::Memory Sphere::getMemory() const
+{
+    return {cpuVertices.capacity() * sizeof(SoftwareRasterizer::Vertex) + cpuIndices.capacity() * sizeof(std::uint32_t),
+            sizeof(float) + static_cast<std::size_t>(captureCapacity)};
+}
+
+
+Aabb Sphere::getBounds() const
+{
+    Aabb box;
+    box.min = center - glm::vec3(radius);
+    box.max = center + glm::vec3(radius);
+    return box;
+}
+
+
+void Sphere::drawPatch()
 {
-    pShader->use();
     pShader->setMat4("model", model);
+    pShader->setMat3("normalMatrix", normalMatrix);
     pShader->setVec3("center", center);
     pShader->setFloat("radius", radius);
     pShader->setVec3("color", color);
+    pShader->setVec2("tessLevel", tessLevel);
 
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-
-    glPatchParameteri(GL_PATCH_VERTICES, 1);
+    GLState::getInstance().setPatchVertices(1);
     glDrawArrays(GL_PATCHES, 0, 1);
+    FrameCounters::getInstance().countDraw(GL_PATCHES, 1UL);
+}
+
+
+void Sphere::capture()
+{
+    // Upper bound on the triangles of a quad patch with these (integer) levels.
+    auto nx = static_cast<GLsizeiptr>(tessLevel.x) + 2;
+    auto ny = static_cast<GLsizeiptr>(tessLevel.y) + 2;
+    GLsizeiptr bytes = 2 * nx * ny * 3 * kCapturedVertexSize;
+
+    if (captureCapacity < bytes)
+    {
+        GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, captureVbo);
+        glBufferData(GL_ARRAY_BUFFER, bytes, nullptr, GL_STATIC_DRAW);
+        GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0);
+        captureCapacity = bytes;
+    }
+
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, feedback);
+    glBeginTransformFeedback(GL_TRIANGLES);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-}
\ No newline at end of file
+    drawPatch();
+
+    glEndTransformFeedback();
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
+}
+
+
+void Sphere::replay()
+{
+    // The captured attributes are already in world space.
+    pReplayShader->setMat4("model", glm::mat4(1.0f));
+    pReplayShader->setMat3("normalMatrix", glm::mat3(1.0f));
+
+    glDrawTransformFeedback(GL_TRIANGLES, feedback);
+
+    // The vertex count stays on the GPU.
+    FrameCounters::getInstance().countDraw(GL_TRIANGLES, 0UL);
+}
@@ -0,0 +1,304 @@
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+#include "mesh/MeshData.h"
+#include "mesh/NormalGenerator.h"
+#include "shape/StaticMeshPool.h"
+#include "util/FrameCounters.h"
+#include "util/GLState.h"
+#include "util/RayTracer.h"
+#include "util/Shader.h"
+#include "util/SoftwareRasterizer.h"
+
+
+StaticMeshPool::StaticMeshPool(Shader * pShader)
+        : GLShape(pShader, glm::mat4(1.0f)),
+          indirect(GLAD_GL_ARB_draw_indirect && GLAD_GL_ARB_multi_draw_indirect)
+{
+    glGenBuffers(1, &ebo);
+    glGenBuffers(1, &transformBuffer);
+    glGenTextures(1, &transformTexture);
+
+    if (indirect)
+    {
+        glGenBuffers(1, &indirectBuffer);
+    }
+
+    GLState::getInstance().bindVertexArray(vao);
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    // "layout (location = 0, 1, 2) in vec3" as in mesh.vert.glsl, and "layout (location = 3) in uint aMesh".
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                          reinterpret_cast<void *>(offsetof(Vertex, position)));
+
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                          reinterpret_cast<void *>(offsetof(Vertex, normal)));
+
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                          reinterpret_cast<void *>(offsetof(Vertex, color)));
+
+    glEnableVertexAttribArray(3);
+    glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(Vertex),
+                           reinterpret_cast<void *>(offsetof(Vertex, mesh)));
+
+    // The element array binding is VAO state, so ebo stays bound to vao.
+    GLState::getInstance().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+
+    GLState::getInstance().bindVertexArray(0U);
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0U);
+}
+
+
+StaticMeshPool::~StaticMeshPool() noexcept
+{
+    glDeleteTextures(1, &transformTexture);
+    transformTexture = 0U;
+
+    GLState::getInstance().deleteBuffer(transformBuffer);
+    transformBuffer = 0U;
+
+    GLState::getInstance().deleteBuffer(indirectBuffer);
+    indirectBuffer = 0U;
+
+    GLState::getInstance().deleteBuffer(ebo);
+    ebo = 0U;
+}
+
+
+void StaticMeshPool::submit(RenderQueue & queue, float timeElapsedSinceLastFrame)
+{
+    if (models.empty())
+    {
+        return;
+    }
+
+    if (geometryDirty)
+    {
+        uploadGeometry();
+    }
+
+    if (transformsDirty)
+    {
+        uploadTransforms();
+    }
+
+    if (worldBoundsChanged)
+    {
+        worldCenter = getWorldBounds().center();
+        worldBoundsChanged = false;
+    }
+
+    queue.submit(RenderQueue::kOpaque, pShader, vao, worldCenter, this);
+}
+
+
+void StaticMeshPool::draw(const RenderQueue::Packet & packet)
+{
+    // "uniform samplerBuffer transforms" in pool.vert.glsl reads texture unit 0.
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, transformTexture);
+
+    auto numMeshes = static_cast<GLsizei>(commands.size());
+
+    if (indirect)
+    {
+        GLState::getInstance().bindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, reinterpret_cast<void *>(0), numMeshes, 0);
+    }
+    else
+    {
+        glMultiDrawElementsBaseVertex(GL_TRIANGLES,
+                                      counts.data(),
+                                      GL_UNSIGNED_INT,
+                                      offsets.data(),
+                                      numMeshes,
+                                      baseVertices.data());
+    }
+
+    // One call, however many meshes it draws.
+    FrameCounters::getInstance().countDraw(GL_TRIANGLES, indices.size());
+}
+
+
+GLShape::Memory StaticMeshPool::getMemory() const
+{
+    std::size_t geometryBytes = vertices.size() * sizeof(Vertex) + indices.size() * sizeof(GLuint);
+
+    return {vertices.capacity() * sizeof(Vertex) + indices.capacity() * sizeof(GLuint)
+            + commands.capacity() * sizeof(DrawCommand)
+            + counts.capacity() * sizeof(GLsizei) + offsets.capacity() * sizeof(const void *)
+            + baseVertices.capacity() * sizeof(GLint)
+            + models.capacity() * sizeof(glm::mat4) + bounds.capacity() * sizeof(Aabb),
+            geometryBytes
+            + (indirect ? commands.size() * sizeof(DrawCommand) : 0UL)
+            + models.size() * kTexelsPerMesh * sizeof(glm::vec4)};
+}
+
+
+void StaticMeshPool::rasterize(SoftwareRasterizer & rasterizer)
+{
+    forEachMesh([&rasterizer](const Vertex * v, std::size_t numVertices, const GLuint * i, std::size_t numIndices, const glm::mat4 & m)
+    {
+        rasterizer.addTriangles(v, numVertices, i, numIndices, m);
+    });
+}
+
+
+void StaticMeshPool::trace(RayTracer & tracer)
+{
+    forEachMesh([&tracer](const Vertex * v, std::size_t numVertices, const GLuint * i, std::size_t numIndices, const glm::mat4 & m)
+    {
+        tracer.addTriangles(v, numVertices, i, numIndices, m);
+    });
+}
+
+
+StaticMeshPool::Handle StaticMeshPool::add(const MeshData & data, const glm::vec3 & color, const glm::mat4 & model)
+{
+    auto handle = static_cast<Handle>(models.size());
+
+    std::vector<glm::vec3> normals = data.normals.size() == data.positions.size()
+                                     ? data.normals
+                                     : NormalGenerator::vertexNormals(data);
+
+    // Indices stay relative to the mesh's first vertex; the draw adds baseVertex.
+    commands.push_back({static_cast<GLuint>(data.indices.size()),
+                        1U,
+                        static_cast<GLuint>(indices.size()),
+                        static_cast<GLint>(vertices.size()),
+                        0U});
+
+    Aabb box;
+
+    for (std::size_t i = 0UL; i != data.positions.size(); ++i)
+    {
+        vertices.push_back({data.positions[i], normals[i], color, handle});
+        box.expand(data.positions[i]);
+    }
+
+    indices.insert(indices.end(), data.indices.cbegin(), data.indices.cend());
+
+    models.emplace_back(model);
+    bounds.emplace_back(box);
+
+    geometryDirty = true;
+    transformsDirty = true;
+    worldBoundsChanged = true;
+
+    return handle;
+}
+
+
+void StaticMeshPool::setModel(Handle handle, const glm::mat4 & model)
+{
+    if (models.size() <= handle)
+    {
+        throw std::out_of_range("StaticMeshPool: invalid mesh handle " + std::to_string(handle));
+    }
+
+    models[handle] = model;
+    transformsDirty = true;
+    worldBoundsChanged = true;
+}
+
+
+Aabb StaticMeshPool::getWorldBounds() const
+{
+    Aabb box;
+
+    for (std::size_t i = 0UL; i != models.size(); ++i)
+    {
+        box.expand(bounds[i].transformed(models[i]));
+    }
+
+    return box;
+}
+
+
+void StaticMeshPool::uploadGeometry()
+{
+    GLState::getInstance().bindVertexArray(vao);
+
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER,
+                 static_cast<GLsizeiptr>(vertices.size() * sizeof(Vertex)),
+                 vertices.data(),
+                 GL_STATIC_DRAW);
+
+    GLState::getInstance().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                 static_cast<GLsizeiptr>(indices.size() * sizeof(GLuint)),
+                 indices.data(),
+                 GL_STATIC_DRAW);
+    FrameCounters::getInstance().countUpload(vertices.size() * sizeof(Vertex));
+    FrameCounters::getInstance().countUpload(indices.size() * sizeof(GLuint));
+
+    GLState::getInstance().bindVertexArray(0U);
+    GLState::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0U);
+
+    if (indirect)
+    {
+        GLState::getInstance().bindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER,
+                     static_cast<GLsizeiptr>(commands.size() * sizeof(DrawCommand)),
+                     commands.data(),
+                     GL_STATIC_DRAW);
+        FrameCounters::getInstance().countUpload(commands.size() * sizeof(DrawCommand));
+        GLState::getInstance().bindBuffer(GL_DRAW_INDIRECT_BUFFER, 0U);
+    }
+    else
+    {
+        counts.clear();
+        offsets.clear();
+        baseVertices.clear();
+
+        for (const DrawCommand & command : commands)
+        {
+            counts.emplace_back(static_cast<GLsizei>(command.count));
+            offsets.emplace_back(reinterpret_cast<void *>(command.firstIndex * sizeof(GLuint)));
+            baseVertices.emplace_back(command.baseVertex);
+        }
+    }
+
+    geometryDirty = false;
+}
+
+
+void StaticMeshPool::uploadTransforms()
+{
+    std::vector<glm::vec4> texels;
+    texels.reserve(models.size() * kTexelsPerMesh);
+
+    for (const glm::mat4 & model : models)
+    {
+        glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+
+        for (int column = 0; column != 4; ++column)
+        {
+            texels.emplace_back(model[column]);
+        }
+
+        for (int column = 0; column != 3; ++column)
+        {
+            texels.emplace_back(normalMatrix[column], 0.0f);
+        }
+    }
+
+    GLState::getInstance().bindBuffer(GL_TEXTURE_BUFFER, transformBuffer);
+    glBufferData(GL_TEXTURE_BUFFER,
+                 static_cast<GLsizeiptr>(texels.size() * sizeof(glm::vec4)),
+                 texels.data(),
+                 GL_STATIC_DRAW);
+    FrameCounters::getInstance().countUpload(texels.size() * sizeof(glm::vec4));
+    GLState::getInstance().bindBuffer(GL_TEXTURE_BUFFER, 0U);
+
+    glBindTexture(GL_TEXTURE_BUFFER, transformTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, transformBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0U);
+
+    transformsDirty = false;
+}
@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include "mesh/MeshImporter.h"
+#include "shape/SubdivisionMesh.h"
+
+
+SubdivisionMesh::SubdivisionMesh(
+        Shader * pShader,
+        const std::string & vertexFile,
+        const glm::vec3 & color,
+        const glm::mat4 & model
+)
+        : Mesh(pShader, model),
+          color(color),
+          subdivision(HalfEdgeMesh(MeshImporter::load(vertexFile).welded()))
+{
+    const HalfEdgeMesh & base = subdivision.level(0);
+    vertices = makeVertices(base.toMeshData(), color);
+    indices.assign(base.indices.cbegin(), base.indices.cend());
+    upload();
+}
+
+
+void SubdivisionMesh::submit(RenderQueue & queue, float timeElapsedSinceLastFrame)
+{
+    poll();
+    Mesh::submit(queue, timeElapsedSinceLastFrame);
+}
+
+
+void SubdivisionMesh::rasterize(SoftwareRasterizer & rasterizer)
+{
+    poll();
+    Mesh::rasterize(rasterizer);
+}
+
+
+void SubdivisionMesh::trace(RayTracer & tracer)
+{
+    poll();
+    Mesh::trace(tracer);
+}
+
+
+void SubdivisionMesh::setLevel(int level)
+{
+    requestedLevel = std::clamp(level, 0, LoopSubdivision::kMaxLevel);
+
+    if (!pending.valid() && requestedLevel != displayedLevel)
+    {
+        launch(requestedLevel);
+    }
+}
+
+
+void SubdivisionMesh::launch(int level)
+{
+    pending = std::async(std::launch::async, [this, level]()
+    {
+        const HalfEdgeMesh & mesh = subdivision.level(level);
+
+        Level result;
+        result.level = level;
+        result.vertices = makeVertices(mesh.toMeshData(), color);
+        result.indices.assign(mesh.indices.cbegin(), mesh.indices.cend());
+
+        return result;
+    });
+}
+
+
+void SubdivisionMesh::poll()
+{
+    using namespace std::chrono_literals;
+
+    if (pending.valid() && pending.wait_for(0s) == std::future_status::ready)
+    {
+        Level result = pending.get();
+        vertices = std::move(result.vertices);
+        indices = std::move(result.indices);
+        upload();
+        displayedLevel = result.level;
+
+        std::cout << "[subdivision] level " << displayedLevel << ": "
+                  << indices.size() / 3UL << " triangles\n";
+
+        if (requestedLevel != displayedLevel)
+        {
+            launch(requestedLevel);
+        }
+    }
+}
@@ -0,0 +1,110 @@
+#include <chrono>
+#include <utility>
+
+#include "shape/Superquadric.h"
+
+
+Superquadric::Superquadric(
+        Shader * pShader,
+        const ParametricSurface::Parameters & parameters,
+        int slices,
+        int stacks,
+        const glm::vec3 & color,
+        const glm::mat4 & model
+)
+        : Mesh(pShader, model),
+          color(color),
+          slices(slices),
+          stacks(stacks),
+          requested(parameters),
+          displayed(parameters)
+{
+    MeshData data = ParametricSurface::generate(parameters, slices, stacks);
+    vertices = makeVertices(data, color);
+    indices.assign(data.indices.cbegin(), data.indices.cend());
+    upload();
+}
+
+
+void Superquadric::submit(RenderQueue & queue, float timeElapsedSinceLastFrame)
+{
+    poll();
+    Mesh::submit(queue, timeElapsedSinceLastFrame);
+}
+
+
+void Superquadric::rasterize(SoftwareRasterizer & rasterizer)
+{
+    poll();
+    Mesh::rasterize(rasterizer);
+}
+
+
+void Superquadric::trace(RayTracer & tracer)
+{
+    poll();
+    Mesh::trace(tracer);
+}
+
+
+void Superquadric::setParameters(const ParametricSurface::Parameters & parameters)
+{
+    requested = parameters;
+
+    // An in-flight surface relaunches itself with the latest request once it is displayed.
+    if (!pending.valid() && !sameParameters(requested, displayed))
+    {
+        launch(requested);
+    }
+}
+
+
+Aabb Superquadric::getWorldBounds() const
+{
+    // |x| <= a, |y| <= b and |z| <= c for every superquadric.
+    Aabb box = bounds;
+    box.expand(glm::vec3(-requested.a, -requested.b, -requested.c));
+    box.expand(glm::vec3(requested.a, requested.b, requested.c));
+
+    return box.transformed(model);
+}
+
+
+bool Superquadric::sameParameters(const ParametricSurface::Parameters & a, const ParametricSurface::Parameters & b)
+{
+    return a.shape == b.shape && a.a == b.a && a.b == b.b && a.c == b.c && a.e1 == b.e1 && a.e2 == b.e2;
+}
+
+
+void Superquadric::launch(const ParametricSurface::Parameters & parameters)
+{
+    pending = std::async(std::launch::async, [this, parameters]()
+    {
+        Surface result;
+        result.parameters = parameters;
+        result.vertices = makeVertices(ParametricSurface::generate(parameters, slices, stacks), color);
+
+        return result;
+    });
+}
+
+
+void Superquadric::poll()
+{
+    using namespace std::chrono_literals;
+
+    if (pending.valid() && pending.wait_for(0s) == std::future_status::ready)
+    {
+        Surface result = pending.get();
+        vertices = std::move(result.vertices);
+        displayed = result.parameters;
+
+        // Same slices and stacks, hence the same topology: only the vertices changed.
+        upload(false);
+
+        if (!sameParameters(requested, displayed))
+        {
+            launch(requested);
+        }
+    }
+}
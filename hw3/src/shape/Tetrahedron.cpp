@@ -1,60 +1,55 @@
+#include <cstring>
+#include <iostream>
+
 #include <glm/glm.hpp>
 
+#include "mesh/MeshCache.h"
+#include "mesh/MeshImporter.h"
+#include "mesh/NormalGenerator.h"
 #include "shape/Tetrahedron.h"
 #include "util/Shader.h"
+#include "util/Timeline.h"
 
 
 Tetrahedron::Tetrahedron(
         Shader * pShader,
         const std::string & vertexFile,
-        const glm::mat4 & model
+        const glm::mat4 & model,
+        float creaseAngleDegrees
 )
-        : Mesh(pShader, model)
+        : Mesh(pShader, model), vertexFile(vertexFile), creaseAngleDegrees(creaseAngleDegrees)
 {
-    // Initialize vertex data
-    if (std::ifstream fin {vertexFile})
-    {
-        glm::vec3 v1;
-        glm::vec3 v2;
-        glm::vec3 v3;
-
-        while (fin >> v1.x >> v1.y >> v1.z >> v2.x >> v2.y >> v2.z >> v3.x >> v3.y >> v3.z)
-        {
-            glm::vec3 fn = glm::normalize(glm::cross(v2 - v1, v3 - v2));
-            vertices.emplace_back(v1, fn, kColor);
-            vertices.emplace_back(v2, fn, kColor);
-            vertices.emplace_back(v3, fn, kColor);
-        }
-    }
-    else
+    Timeline::Zone zone {"Tetrahedron::Tetrahedron"};
+
+    // The normals depend on the crease angle too, so it is part of the cache key.
+    std::uint32_t creaseBits;
+    std::memcpy(&creaseBits, &creaseAngleDegrees, sizeof(float));
+
+    std::string cachePath = MeshCache::pathFor(vertexFile);
+    std::uint64_t sourceHash = MeshCache::hashFile(vertexFile) ^ (creaseBits * 0x9e3779b97f4a7c15ULL);
+
+    if (uploadFromCache(cachePath, sourceHash))
     {
-        throw std::runtime_error("failed to open " + vertexFile);
+        std::cout << "[cache] " << vertexFile << ": loaded " << cachePath << '\n';
+        return;
     }
 
-    // OpenGL pipeline configuration
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    loadSourceGeometry();
 
-    glBufferData(GL_ARRAY_BUFFER,
-                 static_cast<GLsizei>(this->vertices.size() * sizeof(Vertex)),
-                 vertices.data(),
-                 GL_STATIC_DRAW);
+    // OpenGL pipeline configuration
+    upload();
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (!MeshCache::write(cachePath, sourceHash, vertices, indices, kQuantizeCache))
+    {
+        std::cout << "[cache] " << vertexFile << ": failed to write " << cachePath << '\n';
+    }
 }
 
 
-void Tetrahedron::render(float timeElapsedSinceLastFrame)
+void Tetrahedron::loadSourceGeometry()
 {
-    pShader->use();
-    pShader->setMat4("model", model);
-
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-
-    glDrawArrays(GL_TRIANGLES,
-                 0,                                       // start from index 0 in current VBO
-                 static_cast<GLsizei>(vertices.size()));  // draw these number of elements
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-}
\ No newline at end of file
+    // The facets in ./var/ are unconnected, weld them before smoothing.
+    MeshData data = NormalGenerator::generate(MeshImporter::load(vertexFile).welded(), creaseAngleDegrees);
+    vertices = makeVertices(data, kColor);
+    indices.assign(data.indices.cbegin(), data.indices.cend());
+}
@@ -0,0 +1,140 @@
+#include <algorithm>
+
+#include "util/Bvh.h"
+
+
+void Bvh::build(const std::vector<Aabb> & boxes)
+{
+    nodes.clear();
+    leafOfObject.assign(boxes.size(), kNone);
+
+    if (boxes.empty())
+    {
+        return;
+    }
+
+    // n leaves and n - 1 internal nodes.
+    nodes.reserve(2UL * boxes.size() - 1UL);
+
+    std::vector<int> objects(boxes.size());
+
+    for (std::size_t i = 0UL; i != boxes.size(); ++i)
+    {
+        objects[i] = static_cast<int>(i);
+    }
+
+    build(boxes, objects, 0UL, objects.size(), kNone);
+}
+
+
+void Bvh::refit(std::size_t object, const Aabb & box)
+{
+    int node = leafOfObject.at(object);
+    nodes[node].bounds = box;
+
+    for (node = nodes[node].parent; node != kNone; node = nodes[node].parent)
+    {
+        Aabb bounds = nodes[nodes[node].left].bounds;
+        bounds.expand(nodes[nodes[node].right].bounds);
+        nodes[node].bounds = bounds;
+    }
+}
+
+
+void Bvh::query(const Frustum & frustum, FrameVector<std::size_t> & visible) const
+{
+    if (nodes.empty())
+    {
+        return;
+    }
+
+    // The root is nodes[0] (built first).
+    // Called every frame: the stack lives in the frame arena. It holds at most one node per level plus one,
+    // so 64 entries cover the scenes without regrowing.
+    FrameVector<int> stack;
+    stack.reserve(64UL);
+    stack.emplace_back(0);
+
+    while (!stack.empty())
+    {
+        int node = stack.back();
+        stack.pop_back();
+
+        Frustum::Result result = frustum.test(nodes[node].bounds);
+
+        if (result == Frustum::kOutside)
+        {
+            continue;
+        }
+
+        if (result == Frustum::kInside || nodes[node].right == kNone)
+        {
+            collect(node, visible);
+            continue;
+        }
+
+        stack.emplace_back(nodes[node].left);
+        stack.emplace_back(nodes[node].right);
+    }
+}
+
+
+int Bvh::build(const std::vector<Aabb> & boxes, std::vector<int> & objects, std::size_t first, std::size_t last, int parent)
+{
+    int node = static_cast<int>(nodes.size());
+    nodes.emplace_back();
+    nodes[node].parent = parent;
+
+    if (last - first == 1UL)
+    {
+        nodes[node].bounds = boxes[objects[first]];
+        nodes[node].left = objects[first];
+        leafOfObject[objects[first]] = node;
+        return node;
+    }
+
+    Aabb centers;
+
+    for (std::size_t i = first; i != last; ++i)
+    {
+        centers.expand(boxes[objects[i]].center());
+    }
+
+    glm::vec3 extent = centers.extent();
+    int axis = extent.x < extent.y ? (extent.y < extent.z ? 2 : 1) : (extent.x < extent.z ? 2 : 0);
+
+    std::size_t middle = first + (last - first) / 2UL;
+
+    std::nth_element(objects.begin() + static_cast<std::ptrdiff_t>(first),
+                     objects.begin() + static_cast<std::ptrdiff_t>(middle),
+                     objects.begin() + static_cast<std::ptrdiff_t>(last),
+                     [&boxes, axis](int a, int b)
+                     {
+                         return boxes[a].center()[axis] < boxes[b].center()[axis];
+                     });
+
+    int left = build(boxes, objects, first, middle, node);
+    int right = build(boxes, objects, middle, last, node);
+
+    Aabb bounds = nodes[left].bounds;
+    bounds.expand(nodes[right].bounds);
+
+    nodes[node].bounds = bounds;
+    nodes[node].left = left;
+    nodes[node].right = right;
+
+    return node;
+}
+
+
+void Bvh::collect(int node, FrameVector<std::size_t> & visible) const
+{
+    if (nodes[node].right == kNone)
+    {
+        visible.emplace_back(static_cast<std::size_t>(nodes[node].left));
+        return;
+    }
+
+    collect(nodes[node].left, visible);
+    collect(nodes[node].right, visible);
+}
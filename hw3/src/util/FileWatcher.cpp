@@ -0,0 +1,110 @@
+#include <stdexcept>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+#include "util/FileWatcher.h"
+
+
+namespace
+{
+
+#ifndef __linux__
+std::timespec modificationTime(const std::string & path)
+{
+    struct stat st {};
+
+    if (stat(path.c_str(), &st) != 0)
+    {
+        return {};
+    }
+
+#ifdef __APPLE__
+    return st.st_mtimespec;
+#else
+    return st.st_mtim;
+#endif
+}
+#endif
+
+}  // namespace anonymous
+
+
+#ifdef __linux__
+
+FileWatcher::FileWatcher(const std::string & path) : path(path)
+{
+    std::string::size_type slash = path.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : path.substr(0UL, slash);
+    fileName = slash == std::string::npos ? path : path.substr(slash + 1UL);
+
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if (fd < 0)
+    {
+        throw std::runtime_error("failed to initialize inotify for " + path);
+    }
+
+    if (inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        close(fd);
+        throw std::runtime_error("failed to watch " + directory);
+    }
+}
+
+
+FileWatcher::~FileWatcher() noexcept
+{
+    close(fd);
+}
+
+
+bool FileWatcher::poll()
+{
+    // Aligned for the struct inotify_event headers inside.
+    alignas(inotify_event) char buffer[4096];
+    bool changed {false};
+
+    // Drain everything queued; one save often produces several events.
+    for (ssize_t n; 0 < (n = read(fd, buffer, sizeof(buffer)));)
+    {
+        for (ssize_t i = 0; i < n;)
+        {
+            const auto * event = reinterpret_cast<const inotify_event *>(buffer + i);
+            changed |= 0U < event->len && fileName == event->name;
+            i += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+        }
+    }
+
+    return changed;
+}
+
+#else
+
+FileWatcher::FileWatcher(const std::string & path) : path(path), lastModified(modificationTime(path))
+{
+
+}
+
+
+FileWatcher::~FileWatcher() noexcept = default;
+
+
+bool FileWatcher::poll()
+{
+    std::timespec t = modificationTime(path);
+
+    if (t.tv_sec == lastModified.tv_sec && t.tv_nsec == lastModified.tv_nsec)
+    {
+        return false;
+    }
+
+    lastModified = t;
+    return true;
+}
+
+#endif
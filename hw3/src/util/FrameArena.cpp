@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <cstdint>
+
+#include "util/FrameArena.h"
+
+
+FrameArena & FrameArena::current()
+{
+    static thread_local FrameArena tArena;
+    return tArena;
+}
+
+
+void FrameArena::beginFrame()
+{
+    thisFrame.reset(numChunks);
+
+    // The half filled last frame stays valid for this one; the other one's data has been consumed.
+    next ^= 1UL;
+    nextFrame[next].reset(numChunks);
+}
+
+
+void * FrameArena::allocate(std::size_t size, std::size_t alignment, Lifetime lifetime)
+{
+    Buffer & buffer = lifetime == kThisFrame ? thisFrame : nextFrame[next];
+    return buffer.allocate(size, alignment, numChunks);
+}
+
+
+FrameArena::Stats FrameArena::getStats() const
+{
+    Stats stats;
+    stats.highWaterBytes[kThisFrame] = thisFrame.getHighWaterBytes();
+    stats.highWaterBytes[kNextFrame] = std::max(nextFrame[0].getHighWaterBytes(), nextFrame[1].getHighWaterBytes());
+    stats.capacityBytes = thisFrame.getCapacityBytes()
+                          + nextFrame[0].getCapacityBytes()
+                          + nextFrame[1].getCapacityBytes();
+    stats.numChunks = numChunks;
+    return stats;
+}
+
+
+void * FrameArena::Buffer::allocate(std::size_t size, std::size_t alignment, std::size_t & numChunks)
+{
+    auto padding = [alignment](const Chunk & chunk, std::size_t offset) -> std::size_t
+    {
+        auto address = reinterpret_cast<std::uintptr_t>(chunk.data.get()) + offset;
+        return (alignment - address % alignment) % alignment;
+    };
+
+    if (chunks.empty() || chunks.back().size < used + padding(chunks.back(), used) + size)
+    {
+        // Doubling keeps the number of chunks logarithmic in a frame's bytes until reset() merges them.
+        std::size_t chunkSize = chunks.empty() ? kMinChunkSize : 2UL * chunks.back().size;
+        chunkSize = std::max(chunkSize, size + alignment);
+
+        chunks.push_back({std::make_unique<std::byte[]>(chunkSize), chunkSize});
+        frameBytes += chunks.size() == 1UL ? 0UL : chunks[chunks.size() - 2UL].size - used;
+        used = 0UL;
+        ++numChunks;
+    }
+
+    Chunk & chunk = chunks.back();
+    std::size_t offset = used + padding(chunk, used);
+
+    frameBytes += offset + size - used;
+    highWaterBytes = std::max(highWaterBytes, frameBytes);
+    used = offset + size;
+
+    return chunk.data.get() + offset;
+}
+
+
+void FrameArena::Buffer::reset(std::size_t & numChunks)
+{
+    // The high water counts padding and the unused ends of full chunks, so the largest frame so far fits in one chunk.
+    if (1UL < chunks.size())
+    {
+        std::size_t capacity = std::max(highWaterBytes, kMinChunkSize);
+        chunks.clear();
+        chunks.push_back({std::make_unique<std::byte[]>(capacity), capacity});
+        ++numChunks;
+    }
+
+    used = 0UL;
+    frameBytes = 0UL;
+}
+
+
+std::size_t FrameArena::Buffer::getCapacityBytes() const
+{
+    std::size_t capacity = 0UL;
+
+    for (const Chunk & chunk : chunks)
+    {
+        capacity += chunk.size;
+    }
+
+    return capacity;
+}
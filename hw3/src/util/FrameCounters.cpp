@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+#include "shape/GLShape.h"
+#include "util/FrameCounters.h"
+#include "util/GLState.h"
+
+
+namespace
+{
+
+constexpr std::array<const char *, FrameCounters::kNumCounters> kNames
+{
+    "draw_calls",
+    "vertices",
+    "primitives",
+    "patches",
+    "program_switches",
+    "vertex_array_binds",
+    "uploads",
+    "uploaded_bytes",
+    "allocations",
+    "allocated_bytes",
+};
+
+}  // namespace anonymous
+
+
+FrameCounters & FrameCounters::getInstance()
+{
+    static FrameCounters instance;
+    return instance;
+}
+
+
+const char * FrameCounters::getName(Counter counter)
+{
+    return kNames[counter];
+}
+
+
+void FrameCounters::countDraw(GLenum mode, std::size_t numVertices, std::size_t numInstances)
+{
+    std::size_t n = numVertices;
+    std::size_t numPrimitives = 0UL;
+
+    switch (mode)
+    {
+        case GL_POINTS:
+            numPrimitives = n;
+            break;
+
+        case GL_LINES:
+            numPrimitives = n / 2UL;
+            break;
+
+        case GL_LINE_STRIP:
+            numPrimitives = 1UL < n ? n - 1UL : 0UL;
+            break;
+
+        case GL_LINE_LOOP:
+            numPrimitives = 1UL < n ? n : 0UL;
+            break;
+
+        case GL_TRIANGLES:
+            numPrimitives = n / 3UL;
+            break;
+
+        case GL_TRIANGLE_STRIP:
+        case GL_TRIANGLE_FAN:
+            numPrimitives = 2UL < n ? n - 2UL : 0UL;
+            break;
+
+        case GL_PATCHES:
+            current[kPatches] += n / static_cast<std::size_t>(GLState::getInstance().getPatchVertices()) * numInstances;
+            break;
+
+        default:
+            break;
+    }
+
+    ++current[kDrawCalls];
+    current[kVertices] += n * numInstances;
+    current[kPrimitives] += numPrimitives * numInstances;
+}
+
+
+void FrameCounters::countUpload(std::size_t numBytes)
+{
+    ++current[kUploads];
+    current[kUploadedBytes] += numBytes;
+}
+
+
+void FrameCounters::report(bool toStdout, const std::string & csvPath)
+{
+    print = toStdout;
+
+    if (csvPath.empty())
+    {
+        return;
+    }
+
+    csv.open(csvPath);
+
+    if (!csv)
+    {
+        throw std::runtime_error("FrameCounters: failed to open " + csvPath);
+    }
+
+    csv << "seconds,frames";
+
+    for (const char * name : kNames)
+    {
+        csv << ',' << name;
+    }
+
+    csv << ",shapes,shape_cpu_bytes,shape_gpu_bytes\n";
+}
+
+
+void FrameCounters::endFrame(double now)
+{
+    lastFrame = current;
+    current.fill(0UL);
+
+    if (!print && !csv.is_open())
+    {
+        return;
+    }
+
+    for (std::size_t i = 0UL; i != kNumCounters; ++i)
+    {
+        sinceReport[i] += lastFrame[i];
+    }
+
+    ++framesSinceReport;
+
+    if (lastReportTimeStamp < 0.0)
+    {
+        startTimeStamp = now;
+        lastReportTimeStamp = now;
+    }
+
+    if (now - lastReportTimeStamp < 1.0)
+    {
+        return;
+    }
+
+    writeReport(now - startTimeStamp);
+
+    sinceReport.fill(0UL);
+    framesSinceReport = 0UL;
+    lastReportTimeStamp = now;
+}
+
+
+FrameCounters::ShapeMemory FrameCounters::getShapeMemory() const
+{
+    ShapeMemory memory;
+    memory.numShapes = shapes.size();
+
+    for (const GLShape * pShape : shapes)
+    {
+        GLShape::Memory m = pShape->getMemory();
+        memory.cpuBytes += m.cpuBytes;
+        memory.gpuBytes += m.gpuBytes;
+    }
+
+    return memory;
+}
+
+
+void FrameCounters::addShape(const GLShape * shape)
+{
+    shapes.push_back(shape);
+}
+
+
+void FrameCounters::removeShape(const GLShape * shape)
+{
+    if (auto it = std::find(shapes.begin(), shapes.end(), shape); it != shapes.end())
+    {
+        *it = shapes.back();
+        shapes.pop_back();
+    }
+}
+
+
+void FrameCounters::writeReport(double seconds)
+{
+    auto frames = static_cast<double>(framesSinceReport);
+    ShapeMemory memory = getShapeMemory();
+
+    if (print)
+    {
+        std::cout << "[counters] per frame: "
+                  << static_cast<double>(sinceReport[kDrawCalls]) / frames << " draw calls, "
+                  << static_cast<double>(sinceReport[kVertices]) / frames << " vertices, "
+                  << static_cast<double>(sinceReport[kPrimitives]) / frames << " primitives, "
+                  << static_cast<double>(sinceReport[kPatches]) / frames << " patches, "
+                  << static_cast<double>(sinceReport[kProgramSwitches]) / frames << " program switches, "
+                  << static_cast<double>(sinceReport[kVertexArrayBinds]) / frames << " vertex array binds, "
+                  << static_cast<double>(sinceReport[kUploads]) / frames << " uploads of "
+                  << static_cast<double>(sinceReport[kUploadedBytes]) / frames << " bytes, "
+                  << static_cast<double>(sinceReport[kAllocations]) / frames << " heap allocations of "
+                  << static_cast<double>(sinceReport[kAllocatedBytes]) / frames << " bytes; "
+                  << memory.numShapes << " shapes hold "
+                  << static_cast<double>(memory.cpuBytes) / 1024.0 << " KiB CPU, "
+                  << static_cast<double>(memory.gpuBytes) / 1024.0 << " KiB GPU\n";
+    }
+
+    if (csv.is_open())
+    {
+        csv << seconds << ',' << framesSinceReport;
+
+        for (std::uint64_t sum : sinceReport)
+        {
+            csv << ',' << static_cast<double>(sum) / frames;
+        }
+
+        csv << ',' << memory.numShapes << ',' << memory.cpuBytes << ',' << memory.gpuBytes << '\n';
+    }
+}
@@ -0,0 +1,1147 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "util/GLTrace.h"
+
+
+namespace
+{
+
+constexpr char kMagic[8] {'G', 'L', 'T', 'R', 'A', 'C', 'E', '\0'};
+constexpr std::uint32_t kVersion {3U};
+
+// glad's pointers of the entry points this program calls; an entry point's index is its opcode.
+constexpr std::tuple kEntryPoints {
+        &glad_glActiveTexture,
+        &glad_glAttachShader,
+        &glad_glBeginQuery,
+        &glad_glBeginTransformFeedback,
+        &glad_glBindBuffer,
+        &glad_glBindBufferBase,
+        &glad_glBindFramebuffer,
+        &glad_glBindRenderbuffer,
+        &glad_glBindTexture,
+        &glad_glBindTransformFeedback,
+        &glad_glBindVertexArray,
+        &glad_glBufferData,
+        &glad_glBufferSubData,
+        &glad_glCheckFramebufferStatus,
+        &glad_glClear,
+        &glad_glClearColor,
+        &glad_glClientWaitSync,
+        &glad_glCompileShader,
+        &glad_glCreateProgram,
+        &glad_glCreateShader,
+        &glad_glDeleteBuffers,
+        &glad_glDeleteFramebuffers,
+        &glad_glDeleteProgram,
+        &glad_glDeleteQueries,
+        &glad_glDeleteRenderbuffers,
+        &glad_glDeleteShader,
+        &glad_glDeleteSync,
+        &glad_glDeleteTextures,
+        &glad_glDeleteTransformFeedbacks,
+        &glad_glDeleteVertexArrays,
+        &glad_glDepthFunc,
+        &glad_glDepthMask,
+        &glad_glDisable,
+        &glad_glDrawArrays,
+        &glad_glDrawArraysInstanced,
+        &glad_glDrawElements,
+        &glad_glDrawElementsInstanced,
+        &glad_glDrawTransformFeedback,
+        &glad_glEnable,
+        &glad_glEnableVertexAttribArray,
+        &glad_glEndQuery,
+        &glad_glEndTransformFeedback,
+        &glad_glFenceSync,
+        &glad_glFinish,
+        &glad_glFlush,
+        &glad_glFramebufferRenderbuffer,
+        &glad_glGenBuffers,
+        &glad_glGenFramebuffers,
+        &glad_glGenQueries,
+        &glad_glGenRenderbuffers,
+        &glad_glGenTextures,
+        &glad_glGenTransformFeedbacks,
+        &glad_glGenVertexArrays,
+        &glad_glGetIntegerv,
+        &glad_glGetProgramInfoLog,
+        &glad_glGetProgramiv,
+        &glad_glGetQueryObjectui64v,
+        &glad_glGetQueryObjectuiv,
+        &glad_glGetShaderInfoLog,
+        &glad_glGetShaderiv,
+        &glad_glGetUniformLocation,
+        &glad_glLineWidth,
+        &glad_glLinkProgram,
+        &glad_glMapBufferRange,
+        &glad_glMultiDrawElementsBaseVertex,
+        &glad_glMultiDrawElementsIndirect,
+        &glad_glPatchParameteri,
+        &glad_glPixelStorei,
+        &glad_glPointSize,
+        &glad_glPolygonMode,
+        &glad_glPopDebugGroup,
+        &glad_glPushDebugGroup,
+        &glad_glReadPixels,
+        &glad_glRenderbufferStorage,
+        &glad_glShaderSource,
+        &glad_glTexBuffer,
+        &glad_glTexImage2D,
+        &glad_glTexParameteri,
+        &glad_glTexSubImage2D,
+        &glad_glTransformFeedbackVaryings,
+        &glad_glUniform1f,
+        &glad_glUniform1i,
+        &glad_glUniform2f,
+        &glad_glUniform2fv,
+        &glad_glUniform3f,
+        &glad_glUniform3fv,
+        &glad_glUniform4f,
+        &glad_glUniform4fv,
+        &glad_glUniformMatrix2fv,
+        &glad_glUniformMatrix2x3fv,
+        &glad_glUniformMatrix3fv,
+        &glad_glUniformMatrix4fv,
+        &glad_glUnmapBuffer,
+        &glad_glUseProgram,
+        &glad_glVertexAttrib3fv,
+        &glad_glVertexAttribDivisor,
+        &glad_glVertexAttribIPointer,
+        &glad_glVertexAttribPointer,
+        &glad_glViewport
+};
+
+constexpr std::array kEntryPointNames {
+        "glActiveTexture",
+        "glAttachShader",
+        "glBeginQuery",
+        "glBeginTransformFeedback",
+        "glBindBuffer",
+        "glBindBufferBase",
+        "glBindFramebuffer",
+        "glBindRenderbuffer",
+        "glBindTexture",
+        "glBindTransformFeedback",
+        "glBindVertexArray",
+        "glBufferData",
+        "glBufferSubData",
+        "glCheckFramebufferStatus",
+        "glClear",
+        "glClearColor",
+        "glClientWaitSync",
+        "glCompileShader",
+        "glCreateProgram",
+        "glCreateShader",
+        "glDeleteBuffers",
+        "glDeleteFramebuffers",
+        "glDeleteProgram",
+        "glDeleteQueries",
+        "glDeleteRenderbuffers",
+        "glDeleteShader",
+        "glDeleteSync",
+        "glDeleteTextures",
+        "glDeleteTransformFeedbacks",
+        "glDeleteVertexArrays",
+        "glDepthFunc",
+        "glDepthMask",
+        "glDisable",
+        "glDrawArrays",
+        "glDrawArraysInstanced",
+        "glDrawElements",
+        "glDrawElementsInstanced",
+        "glDrawTransformFeedback",
+        "glEnable",
+        "glEnableVertexAttribArray",
+        "glEndQuery",
+        "glEndTransformFeedback",
+        "glFenceSync",
+        "glFinish",
+        "glFlush",
+        "glFramebufferRenderbuffer",
+        "glGenBuffers",
+        "glGenFramebuffers",
+        "glGenQueries",
+        "glGenRenderbuffers",
+        "glGenTextures",
+        "glGenTransformFeedbacks",
+        "glGenVertexArrays",
+        "glGetIntegerv",
+        "glGetProgramInfoLog",
+        "glGetProgramiv",
+        "glGetQueryObjectui64v",
+        "glGetQueryObjectuiv",
+        "glGetShaderInfoLog",
+        "glGetShaderiv",
+        "glGetUniformLocation",
+        "glLineWidth",
+        "glLinkProgram",
+        "glMapBufferRange",
+        "glMultiDrawElementsBaseVertex",
+        "glMultiDrawElementsIndirect",
+        "glPatchParameteri",
+        "glPixelStorei",
+        "glPointSize",
+        "glPolygonMode",
+        "glPopDebugGroup",
+        "glPushDebugGroup",
+        "glReadPixels",
+        "glRenderbufferStorage",
+        "glShaderSource",
+        "glTexBuffer",
+        "glTexImage2D",
+        "glTexParameteri",
+        "glTexSubImage2D",
+        "glTransformFeedbackVaryings",
+        "glUniform1f",
+        "glUniform1i",
+        "glUniform2f",
+        "glUniform2fv",
+        "glUniform3f",
+        "glUniform3fv",
+        "glUniform4f",
+        "glUniform4fv",
+        "glUniformMatrix2fv",
+        "glUniformMatrix2x3fv",
+        "glUniformMatrix3fv",
+        "glUniformMatrix4fv",
+        "glUnmapBuffer",
+        "glUseProgram",
+        "glVertexAttrib3fv",
+        "glVertexAttribDivisor",
+        "glVertexAttribIPointer",
+        "glVertexAttribPointer",
+        "glViewport"
+};
+
+constexpr std::size_t kNumEntryPoints {kEntryPointNames.size()};
+static_assert(std::tuple_size_v<decltype(kEntryPoints)> == kNumEntryPoints);
+
+// Opcode of the frame marker.
+constexpr std::uint16_t kFrameMarker {static_cast<std::uint16_t>(kNumEntryPoints)};
+
+
+// How a pointer argument is recorded.
+enum class PointerKind : std::uint8_t
+{
+    kOffset,   // The pointer itself: an offset into a bound buffer, or null.
+    kInput,    // The size bytes the call reads.
+    kOutput,   // The size bytes the call writes.
+    kNames,    // Like kOutput, checked on replay.
+    kStrings   // size strings, with optional lengths (glShaderSource).
+};
+
+
+struct PointerArg
+{
+    PointerKind kind {PointerKind::kOffset};
+    std::size_t size {0UL};
+    const GLint * lengths {nullptr};
+};
+
+
+PointerArg input(const void * p, std::size_t size)
+{
+    return p ? PointerArg {PointerKind::kInput, size} : PointerArg {};
+}
+
+
+PointerArg output(const void * p, std::size_t size, PointerKind kind = PointerKind::kOutput)
+{
+    return p ? PointerArg {kind, size} : PointerArg {};
+}
+
+
+std::size_t count(GLsizei n, std::size_t size)
+{
+    return 0 < n ? static_cast<std::size_t>(n) * size : 0UL;
+}
+
+
+/// Bytes of a tightly packed image; the uploads here leave GL_UNPACK_ALIGNMENT no padding to add.
+std::size_t imageSize(GLsizei width, GLsizei height, GLenum format, GLenum type)
+{
+    std::size_t numComponents = 4UL;
+
+    switch (format)
+    {
+        case GL_RED:
+        case GL_RED_INTEGER:
+        case GL_DEPTH_COMPONENT:
+            numComponents = 1UL;
+            break;
+        case GL_RG:
+        case GL_RG_INTEGER:
+            numComponents = 2UL;
+            break;
+        case GL_RGB:
+        case GL_BGR:
+        case GL_RGB_INTEGER:
+            numComponents = 3UL;
+            break;
+        default:
+            break;
+    }
+
+    std::size_t componentSize = 4UL;
+
+    switch (type)
+    {
+        case GL_UNSIGNED_BYTE:
+        case GL_BYTE:
+            componentSize = 1UL;
+            break;
+        case GL_UNSIGNED_SHORT:
+        case GL_SHORT:
+        case GL_HALF_FLOAT:
+            componentSize = 2UL;
+            break;
+        default:
+            break;
+    }
+
+    return count(width, 1UL) * count(height, numComponents * componentSize);
+}
+
+
+/// What the pointer arguments of the entry point at Slot point to; by default, nothing to record.
+template <auto * Slot>
+struct Pointers
+{
+    template <typename ... Args>
+    static std::array<PointerArg, sizeof...(Args)> of(Args ...)
+    {
+        return {};
+    }
+};
+
+
+template <>
+struct Pointers<&glad_glBufferData>
+{
+    static std::array<PointerArg, 4> of(GLenum, GLsizeiptr size, const void * data, GLenum)
+    {
+        return {{{}, {}, input(data, static_cast<std::size_t>(size)), {}}};
+    }
+};
+
+
+template <>
+struct Pointers<&glad_glBufferSubData>
+{
+    static std::array<PointerArg, 4> of(GLenum, GLintptr, GLsizeiptr size, const void * data)
+    {
+        return {{{}, {}, {}, input(data, static_cast<std::size_t>(size))}};
+    }
+};
+
+
+template <auto * Slot>
+struct DeleteNames
+{
+    static std::array<PointerArg, 2> of(GLsizei n, const GLuint * names)
+    {
+        return {{{}, input(names, count(n, sizeof(GLuint)))}};
+    }
+};
+
+
+template <> struct Pointers<&glad_glDeleteBuffers> : DeleteNames<&glad_glDeleteBuffers> {};
+template <> struct Pointers<&glad_glDeleteFramebuffers> : DeleteNames<&glad_glDeleteFramebuffers> {};
+template <> struct Pointers<&glad_glDeleteQueries> : DeleteNames<&glad_glDeleteQueries> {};
+template <> struct Pointers<&glad_glDeleteRenderbuffers> : DeleteNames<&glad_glDeleteRenderbuffers> {};
+template <> struct Pointers<&glad_glDeleteTextures> : DeleteNames<&glad_glDeleteTextures> {};
+template <> struct Pointers<&glad_glDeleteTransformFeedbacks> : DeleteNames<&glad_glDeleteTransformFeedbacks> {};
+template <> struct Pointers<&glad_glDeleteVertexArrays> : DeleteNames<&glad_glDeleteVertexArrays> {};
+
+
+template <auto * Slot>
+struct GenNames
+{
+    static std::array<PointerArg, 2> of(GLsizei n, const GLuint * names)
+    {
+        return {{{}, output(names, count(n, sizeof(GLuint)), PointerKind::kNames)}};
+    }
+};
+
+
+template <> struct Pointers<&glad_glGenBuffers> : GenNames<&glad_glGenBuffers> {};
+template <> struct Pointers<&glad_glGenFramebuffers> : GenNames<&glad_glGenFramebuffers> {};
+template <> struct Pointers<&glad_glGenQueries> : GenNames<&glad_glGenQueries> {};
+template <> struct Pointers<&glad_glGenRenderbuffers> : GenNames<&glad_glGenRenderbuffers> {};
+template <> struct Pointers<&glad_glGenTextures> : GenNames<&glad_glGenTextures> {};
+template <> struct Pointers<&glad_glGenTransformFeedbacks> : GenNames<&glad_glGenTransformFeedbacks> {};
+template <> struct Pointers<&glad_glGenVertexArrays> : GenNames<&glad_glGenVertexArrays> {};
+
+
+template <>
+struct Pointers<&glad_glGetIntegerv>
+{
+    static std::array<PointerArg, 2> of(GLenum, const GLint * data)
+    {
+        return {{{}, output(data, sizeof(GLint))}};
+    }
+};
+
+
+template <auto * Slot>
+struct GetObjectiv
+{
+    static std::array<PointerArg, 3> of(GLuint, GLenum, const GLint * params)
+    {
+        return {{{}, {}, output(params, sizeof(GLint))}};
+    }
+};
+
+
+template <> struct Pointers<&glad_glGetProgramiv> : GetObjectiv<&glad_glGetProgramiv> {};
+template <> struct Pointers<&glad_glGetShaderiv> : GetObjectiv<&glad_glGetShaderiv> {};
+
+
+template <auto * Slot>
+struct GetInfoLog
+{
+    static std::array<PointerArg, 4> of(GLuint, GLsizei bufSize, const GLsizei * length, const GLchar * infoLog)
+    {
+        return {{{}, {}, output(length, sizeof(GLsizei)), output(infoLog, count(bufSize, 1UL))}};
+    }
+};
+
+
+template <> struct Pointers<&glad_glGetProgramInfoLog> : GetInfoLog<&glad_glGetProgramInfoLog> {};
+template <> struct Pointers<&glad_glGetShaderInfoLog> : GetInfoLog<&glad_glGetShaderInfoLog> {};
+
+
+template <>
+struct Pointers<&glad_glGetQueryObjectui64v>
+{
+    static std::array<PointerArg, 3> of(GLuint, GLenum, const GLuint64 * params)
+    {
+        return {{{}, {}, output(params, sizeof(GLuint64))}};
+    }
+};
+
+
+template <>
+struct Pointers<&glad_glGetQueryObjectuiv>
+{
+    static std::array<PointerArg, 3> of(GLuint, GLenum, const GLuint * params)
+    {
+        return {{{}, {}, output(params, sizeof(GLuint))}};
+    }
+};
+
+
+template <>
+struct Pointers<&glad_glGetUniformLocation>
+{
+    static std::array<PointerArg, 2> of(GLuint, const GLchar * name)
+    {
+        return {{{}, input(name, name ? std::strlen(name) + 1UL : 0UL)}};
+    }
+};
+
+
+template <>
+struct Pointers<&glad_glMultiDrawElementsBaseVertex>
+{
+    static std::array<PointerArg, 6> of(GLenum,
+                                        const GLsizei * counts,
+                                        GLenum,
+                                        const void * const * indices,
+                                        GLsizei drawcount,
+                                        const GLint * basevertex)
+    {
+        return {{{},
+                 input(counts, count(drawcount, sizeof(GLsizei))),
+                 {},
+                 input(indices, count(drawcount, sizeof(void *))),
+                 {},
+                 input(basevertex, count(drawcount, sizeof(GLint)))}};
+    }
+};
+
+
+template <>
+struct Pointers<&glad_glPushDebugGroup>
+{
+    static std::array<PointerArg, 4> of(GLenum, GLuint, GLsizei length, const GLchar * message)
+    {
+        std::size_t size = message ? (length < 0 ? std::strlen(message) + 1UL : static_cast<std::size_t>(length)) : 0UL;
+        return {{{}, {}, {}, input(message, size)}};
+    }
+};
+
+
+template <>
+struct Pointers<&glad_glShaderSource>
+{
+    static std::array<PointerArg, 4> of(GLuint, GLsizei n, const GLchar * const *, const GLint * lengths)
+    {
+        return {{{}, {}, {PointerKind::kStrings, count(n, 1UL), lengths}, input(lengths, count(n, sizeof(GLint)))}};
+    }
+};
+
+
+template <>
+struct Pointers<&glad_glTexImage2D>
+{
+    static std::array<PointerArg, 9> of(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLint,
+                                        GLenum format, GLenum type, const void * pixels)
+    {
+        return {{{}, {}, {}, {}, {}, {}, {}, {}, input(pixels, imageSize(width, height, format, type))}};
+    }
+};
+
+
+template <>
+struct Pointers<&glad_glTexSubImage2D>
+{
+    static std::array<PointerArg, 9> of(GLenum, GLint, GLint, GLint, GLsizei width, GLsizei height,
+                                        GLenum format, GLenum type, const void * pixels)
+    {
+        return {{{}, {}, {}, {}, {}, {}, {}, {}, input(pixels, imageSize(width, height, format, type))}};
+    }
+};
+
+
+template <>
+struct Pointers<&glad_glTransformFeedbackVaryings>
+{
+    static std::array<PointerArg, 4> of(GLuint, GLsizei n, const GLchar * const *, GLenum)
+    {
+        return {{{}, {}, {PointerKind::kStrings, count(n, 1UL)}, {}}};
+    }
+};
+
+
+template <auto * Slot, std::size_t N>
+struct UniformVector
+{
+    static std::array<PointerArg, 3> of(GLint, GLsizei n, const GLfloat * value)
+    {
+        return {{{}, {}, input(value, count(n, N * sizeof(GLfloat)))}};
+    }
+};
+
+
+template <> struct Pointers<&glad_glUniform2fv> : UniformVector<&glad_glUniform2fv, 2UL> {};
+template <> struct Pointers<&glad_glUniform3fv> : UniformVector<&glad_glUniform3fv, 3UL> {};
+template <> struct Pointers<&glad_glUniform4fv> : UniformVector<&glad_glUniform4fv, 4UL> {};
+
+
+template <auto * Slot, std::size_t N>
+struct UniformMatrix
+{
+    static std::array<PointerArg, 4> of(GLint, GLsizei n, GLboolean, const GLfloat * value)
+    {
+        return {{{}, {}, {}, input(value, count(n, N * sizeof(GLfloat)))}};
+    }
+};
+
+
+template <> struct Pointers<&glad_glUniformMatrix2fv> : UniformMatrix<&glad_glUniformMatrix2fv, 4UL> {};
+template <> struct Pointers<&glad_glUniformMatrix2x3fv> : UniformMatrix<&glad_glUniformMatrix2x3fv, 6UL> {};
+template <> struct Pointers<&glad_glUniformMatrix3fv> : UniformMatrix<&glad_glUniformMatrix3fv, 9UL> {};
+template <> struct Pointers<&glad_glUniformMatrix4fv> : UniformMatrix<&glad_glUniformMatrix4fv, 16UL> {};
+
+
+template <>
+struct Pointers<&glad_glVertexAttrib3fv>
+{
+    static std::array<PointerArg, 2> of(GLuint, const GLfloat * v)
+    {
+        return {{{}, input(v, 3UL * sizeof(GLfloat))}};
+    }
+};
+
+
+/// Entry points whose return value is a name or location chosen by the driver, checked on replay.
+template <auto * Slot>
+constexpr bool kReturnsName {false};
+
+template <> constexpr bool kReturnsName<&glad_glCreateProgram> {true};
+template <> constexpr bool kReturnsName<&glad_glCreateShader> {true};
+template <> constexpr bool kReturnsName<&glad_glGetUniformLocation> {true};
+
+
+void appendU8(std::uint8_t value)
+{
+    GLTraceRecorder::getInstance().append(&value, sizeof(value));
+}
+
+
+void appendU32(std::size_t value)
+{
+    auto u32 = static_cast<std::uint32_t>(value);
+    GLTraceRecorder::getInstance().append(&u32, sizeof(u32));
+}
+
+
+void appendU64(std::uint64_t value)
+{
+    GLTraceRecorder::getInstance().append(&value, sizeof(value));
+}
+
+
+template <typename T>
+void encode(T value, const PointerArg & pointer)
+{
+    GLTraceRecorder & recorder = GLTraceRecorder::getInstance();
+
+    if constexpr (std::is_same_v<T, GLsync>)
+    {
+        appendU64(reinterpret_cast<std::uintptr_t>(value));
+    }
+    else if constexpr (std::is_pointer_v<T>)
+    {
+        appendU8(static_cast<std::uint8_t>(pointer.kind));
+
+        if (pointer.kind == PointerKind::kOffset)
+        {
+            appendU64(reinterpret_cast<std::uintptr_t>(value));
+        }
+        else if (pointer.kind == PointerKind::kStrings)
+        {
+            auto strings = reinterpret_cast<const GLchar * const *>(value);
+            appendU32(pointer.size);
+
+            for (std::size_t i = 0UL; i != pointer.size; ++i)
+            {
+                std::size_t length = pointer.lengths && 0 <= pointer.lengths[i]
+                                     ? static_cast<std::size_t>(pointer.lengths[i])
+                                     : std::strlen(strings[i]);
+                appendU32(length);
+                recorder.append(strings[i], length);
+            }
+        }
+        else
+        {
+            appendU32(pointer.size);
+            recorder.append(value, pointer.size);
+        }
+    }
+    else
+    {
+        static_assert(std::is_arithmetic_v<T>);
+        recorder.append(&value, sizeof(value));
+    }
+}
+
+
+/// The function pointer type of the entry point at Slot.
+template <auto * Slot>
+using EntryPoint = std::remove_pointer_t<std::decay_t<decltype(Slot)>>;
+
+
+template <std::size_t Op, auto * Slot, typename F = EntryPoint<Slot>>
+struct Hook;
+
+
+/// Stands in for the entry point at Slot while recording.
+template <std::size_t Op, auto * Slot, typename R, typename ... Args>
+struct Hook<Op, Slot, R (APIENTRYP)(Args ...)>
+{
+    static inline R (APIENTRYP real)(Args ...) {nullptr};
+
+    static R APIENTRY call(Args ... args)
+    {
+        // Outputs are recorded once the driver has written them.
+        if constexpr (std::is_void_v<R>)
+        {
+            real(args ...);
+            record(args ...);
+        }
+        else
+        {
+            R result = real(args ...);
+            record(args ...);
+            encode(result, PointerArg {});
+            return result;
+        }
+    }
+
+    static void record(Args ... args)
+    {
+        auto op = static_cast<std::uint16_t>(Op);
+        GLTraceRecorder::getInstance().append(&op, sizeof(op));
+
+        [[maybe_unused]] std::array<PointerArg, sizeof...(Args)> pointers = Pointers<Slot>::of(args ...);
+        [[maybe_unused]] std::size_t i = 0UL;
+        (encode(args, pointers[i++]), ...);
+    }
+};
+
+
+template <std::size_t ... Is>
+void installHooks(std::index_sequence<Is ...>)
+{
+    auto install = [](auto * slot, auto & real, auto call)
+    {
+        // Extensions the context lacks stay unloaded.
+        if (*slot)
+        {
+            real = *slot;
+            *slot = call;
+        }
+    };
+
+    (install(std::get<Is>(kEntryPoints),
+             Hook<Is, std::get<Is>(kEntryPoints)>::real,
+             &Hook<Is, std::get<Is>(kEntryPoints)>::call), ...);
+}
+
+
+template <std::size_t ... Is>
+void uninstallHooks(std::index_sequence<Is ...>)
+{
+    auto uninstall = [](auto * slot, auto & real)
+    {
+        if (real)
+        {
+            *slot = real;
+            real = nullptr;
+        }
+    };
+
+    (uninstall(std::get<Is>(kEntryPoints), Hook<Is, std::get<Is>(kEntryPoints)>::real), ...);
+}
+
+
+using Cursor = GLTraceReplayer::Cursor;
+
+
+template <typename T>
+T readValue(Cursor & cursor)
+{
+    T value;
+    std::memcpy(&value, cursor.read(sizeof(T)), sizeof(T));
+    return value;
+}
+
+
+template <typename T>
+T decode(Cursor & cursor)
+{
+    if constexpr (std::is_same_v<T, GLsync>)
+    {
+        auto it = cursor.syncs.find(readValue<std::uint64_t>(cursor));
+        return it != cursor.syncs.end() ? it->second : nullptr;
+    }
+    else if constexpr (std::is_pointer_v<T>)
+    {
+        auto kind = static_cast<PointerKind>(readValue<std::uint8_t>(cursor));
+
+        if (kind == PointerKind::kOffset)
+        {
+            return reinterpret_cast<T>(static_cast<std::uintptr_t>(readValue<std::uint64_t>(cursor)));
+        }
+
+        auto size = static_cast<std::size_t>(readValue<std::uint32_t>(cursor));
+
+        if (kind == PointerKind::kInput)
+        {
+            return reinterpret_cast<T>(const_cast<std::uint8_t *>(cursor.read(size)));
+        }
+
+        if (kind == PointerKind::kOutput || kind == PointerKind::kNames)
+        {
+            const std::uint8_t * recorded = cursor.read(size);
+            cursor.scratch.emplace_back(size);
+
+            if (kind == PointerKind::kNames)
+            {
+                cursor.names.emplace_back(recorded, &cursor.scratch.back());
+            }
+
+            return reinterpret_cast<T>(cursor.scratch.back().data());
+        }
+
+        if (kind == PointerKind::kStrings)
+        {
+            std::vector<const GLchar *> & strings = cursor.strings.emplace_back();
+
+            for (std::size_t i = 0UL; i != size; ++i)
+            {
+                auto length = static_cast<std::size_t>(readValue<std::uint32_t>(cursor));
+                const std::uint8_t * bytes = cursor.read(length);
+
+                std::vector<std::uint8_t> & string = cursor.scratch.emplace_back(bytes, bytes + length);
+                string.push_back('\0');
+                strings.push_back(reinterpret_cast<const GLchar *>(string.data()));
+            }
+
+            return reinterpret_cast<T>(strings.data());
+        }
+
+        throw std::runtime_error("GLTraceReplayer: malformed pointer argument");
+    }
+    else
+    {
+        return readValue<T>(cursor);
+    }
+}
+
+
+template <std::size_t Op, auto * Slot, typename F = EntryPoint<Slot>>
+struct Replay;
+
+
+/// Decodes and re-issues a call to the entry point at Slot; returns the seconds spent in the driver.
+template <std::size_t Op, auto * Slot, typename R, typename ... Args>
+struct Replay<Op, Slot, R (APIENTRYP)(Args ...)>
+{
+    static double call(Cursor & cursor)
+    {
+        if (!*Slot)
+        {
+            throw std::runtime_error(std::string("GLTraceReplayer: ") + kEntryPointNames[Op] + " is not available");
+        }
+
+        // Braced initialization decodes the arguments in order.
+        std::tuple<Args ...> args {decode<Args>(cursor) ...};
+
+        auto begin = std::chrono::steady_clock::now();
+
+        if constexpr (std::is_void_v<R>)
+        {
+            std::apply(*Slot, args);
+        }
+        else
+        {
+            R result = std::apply(*Slot, args);
+
+            if constexpr (std::is_same_v<R, GLsync>)
+            {
+                cursor.syncs[readValue<std::uint64_t>(cursor)] = result;
+            }
+            else if constexpr (std::is_pointer_v<R>)
+            {
+                decode<R>(cursor);
+            }
+            else if (readValue<R>(cursor) != result && kReturnsName<Slot>)
+            {
+                ++cursor.numNameMismatches;
+            }
+        }
+
+        auto end = std::chrono::steady_clock::now();
+
+        for (const auto & [recorded, replayed] : cursor.names)
+        {
+            if (std::memcmp(recorded, replayed->data(), replayed->size()) != 0)
+            {
+                ++cursor.numNameMismatches;
+            }
+        }
+
+        return std::chrono::duration<double>(end - begin).count();
+    }
+};
+
+
+template <std::size_t ... Is>
+constexpr std::array<double (*)(Cursor &), sizeof...(Is)> makeReplays(std::index_sequence<Is ...>)
+{
+    return {&Replay<Is, std::get<Is>(kEntryPoints)>::call ...};
+}
+
+
+constexpr std::array<double (*)(Cursor &), kNumEntryPoints> kReplays =
+        makeReplays(std::make_index_sequence<kNumEntryPoints>());
+
+}  // namespace anonymous
+
+
+GLTraceRecorder & GLTraceRecorder::getInstance()
+{
+    static GLTraceRecorder instance;
+    return instance;
+}
+
+
+GLTraceRecorder::~GLTraceRecorder() noexcept
+{
+    stop();
+}
+
+
+void GLTraceRecorder::start(const std::string & tracePath)
+{
+    if (recording)
+    {
+        return;
+    }
+
+    fout.open(tracePath, std::ios::binary | std::ios::trunc);
+
+    if (!fout)
+    {
+        throw std::runtime_error("GLTraceRecorder: failed to open " + tracePath);
+    }
+
+    path = tracePath;
+    numBytes = 0UL;
+    block.reserve(kBlockSize);
+    stopping = false;
+
+    append(kMagic, sizeof(kMagic));
+    appendU32(kVersion);
+    appendU32(kNumEntryPoints);
+
+    for (const char * name : kEntryPointNames)
+    {
+        appendU8(static_cast<std::uint8_t>(std::strlen(name)));
+        append(name, std::strlen(name));
+    }
+
+    writer = std::thread(&GLTraceRecorder::writerLoop, this);
+    installHooks(std::make_index_sequence<kNumEntryPoints>());
+    recording = true;
+}
+
+
+void GLTraceRecorder::endFrame()
+{
+    if (recording)
+    {
+        append(&kFrameMarker, sizeof(kFrameMarker));
+    }
+}
+
+
+void GLTraceRecorder::stop()
+{
+    if (!recording)
+    {
+        return;
+    }
+
+    uninstallHooks(std::make_index_sequence<kNumEntryPoints>());
+    recording = false;
+    flush();
+
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+
+    blockQueued.notify_one();
+    writer.join();
+    fout.close();
+
+    std::cout << "[gltrace] " << numBytes << " bytes written to " << path << '\n';
+}
+
+
+void GLTraceRecorder::append(const void * data, std::size_t size)
+{
+    auto bytes = static_cast<const std::uint8_t *>(data);
+    block.insert(block.end(), bytes, bytes + size);
+    numBytes += size;
+
+    if (kBlockSize <= block.size())
+    {
+        flush();
+    }
+}
+
+
+void GLTraceRecorder::flush()
+{
+    if (block.empty())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        queue.push_back(std::move(block));
+    }
+
+    blockQueued.notify_one();
+
+    block = {};
+    block.reserve(kBlockSize);
+}
+
+
+void GLTraceRecorder::writerLoop()
+{
+    while (true)
+    {
+        std::vector<std::uint8_t> bytes;
+
+        {
+            std::unique_lock lock(mutex);
+            blockQueued.wait(lock, [this] { return stopping || !queue.empty(); });
+
+            if (queue.empty())
+            {
+                return;
+            }
+
+            bytes = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        fout.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+}
+
+
+GLTraceReplayer::GLTraceReplayer(const std::string & path)
+{
+    std::ifstream fin(path, std::ios::binary);
+
+    if (!fin)
+    {
+        throw std::runtime_error("GLTraceReplayer: failed to open " + path);
+    }
+
+    trace.assign(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+
+    Cursor cursor;
+    cursor.data = trace.data();
+    cursor.end = trace.data() + trace.size();
+
+    if (trace.size() < sizeof(kMagic) || std::memcmp(cursor.read(sizeof(kMagic)), kMagic, sizeof(kMagic)) != 0)
+    {
+        throw std::runtime_error("GLTraceReplayer: " + path + " is not a trace");
+    }
+
+    if (readValue<std::uint32_t>(cursor) != kVersion)
+    {
+        throw std::runtime_error("GLTraceReplayer: unsupported trace version in " + path);
+    }
+
+    // Opcodes of traces recorded by other builds map by name; unknown ones fail when replayed.
+    auto numOps = static_cast<std::size_t>(readValue<std::uint32_t>(cursor));
+
+    for (std::size_t op = 0UL; op != numOps; ++op)
+    {
+        auto length = static_cast<std::size_t>(readValue<std::uint8_t>(cursor));
+        std::string name(reinterpret_cast<const char *>(cursor.read(length)), length);
+
+        auto it = std::find(kEntryPointNames.begin(), kEntryPointNames.end(), name);
+        entryPoints.push_back(static_cast<std::size_t>(it - kEntryPointNames.begin()));
+    }
+
+    entryPoints.push_back(kNumEntryPoints + 1UL);
+    bodyOffset = static_cast<std::size_t>(cursor.data - trace.data());
+}
+
+
+void GLTraceReplayer::replay()
+{
+    Cursor cursor;
+    cursor.data = trace.data() + bodyOffset;
+    cursor.end = trace.data() + trace.size();
+
+    frameStats.assign(1UL, {});
+    entryPointStats.assign(kNumEntryPoints, {});
+
+    for (std::size_t i = 0UL; i != kNumEntryPoints; ++i)
+    {
+        entryPointStats[i].name = kEntryPointNames[i];
+    }
+
+    auto frameBegin = std::chrono::steady_clock::now();
+
+    auto endFrame = [&frameBegin, this]()
+    {
+        glFinish();
+
+        auto now = std::chrono::steady_clock::now();
+        frameStats.back().seconds = std::chrono::duration<double>(now - frameBegin).count();
+        frameBegin = now;
+    };
+
+    while (cursor.data != cursor.end)
+    {
+        auto op = static_cast<std::size_t>(readValue<std::uint16_t>(cursor));
+
+        if (entryPoints.size() <= op)
+        {
+            throw std::runtime_error("GLTraceReplayer: malformed trace");
+        }
+
+        std::size_t entryPoint = entryPoints[op];
+
+        if (entryPoint == kNumEntryPoints + 1UL)
+        {
+            endFrame();
+            frameStats.emplace_back();
+            continue;
+        }
+
+        if (entryPoint == kNumEntryPoints)
+        {
+            throw std::runtime_error("GLTraceReplayer: the trace calls an entry point this build does not know");
+        }
+
+        cursor.scratch.clear();
+        cursor.strings.clear();
+        cursor.names.clear();
+
+        double seconds = kReplays[entryPoint](cursor);
+
+        EntryPointStats & stats = entryPointStats[entryPoint];
+        ++stats.numCalls;
+        stats.seconds += seconds;
+        stats.maxSeconds = std::max(stats.maxSeconds, seconds);
+
+        ++frameStats.back().numCalls;
+        frameStats.back().callSeconds += seconds;
+    }
+
+    // Calls after the last frame marker (recording stopped mid-frame).
+    if (frameStats.back().numCalls == 0UL && kSetupFrame + 1UL < frameStats.size())
+    {
+        frameStats.pop_back();
+    }
+    else
+    {
+        endFrame();
+    }
+
+    numNameMismatches = cursor.numNameMismatches;
+}
+
+
+std::vector<GLTraceReplayer::EntryPointStats> GLTraceReplayer::getEntryPointStats() const
+{
+    std::vector<EntryPointStats> called;
+
+    std::copy_if(entryPointStats.begin(), entryPointStats.end(), std::back_inserter(called),
+                 [](const EntryPointStats & stats) { return stats.numCalls != 0UL; });
+
+    std::sort(called.begin(), called.end(), [](const EntryPointStats & a, const EntryPointStats & b)
+    {
+        return a.seconds > b.seconds;
+    });
+
+    return called;
+}
+
+
+const std::uint8_t * GLTraceReplayer::Cursor::read(std::size_t size)
+{
+    if (static_cast<std::size_t>(end - data) < size)
+    {
+        throw std::runtime_error("GLTraceReplayer: truncated trace");
+    }
+
+    const std::uint8_t * bytes = data;
+    data += size;
+    return bytes;
+}
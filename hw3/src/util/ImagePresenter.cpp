@@ -0,0 +1,62 @@
+#include "util/FrameCounters.h"
+#include "util/GLState.h"
+#include "util/ImagePresenter.h"
+#include "util/Shader.h"
+
+
+ImagePresenter::ImagePresenter(Shader * pShader) : pShader(pShader)
+{
+    glGenVertexArrays(1, &vao);
+    glGenTextures(1, &texture);
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0U);
+}
+
+
+ImagePresenter::~ImagePresenter() noexcept
+{
+    glDeleteTextures(1, &texture);
+    texture = 0U;
+
+    GLState::getInstance().deleteVertexArray(vao);
+    vao = 0U;
+}
+
+
+void ImagePresenter::present(const std::vector<std::uint8_t> & rgba, int width, int height)
+{
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texture);
+
+    // Rows are tightly packed.
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    if (width != textureWidth || height != textureHeight)
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+        textureWidth = width;
+        textureHeight = height;
+    }
+    else
+    {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+    }
+
+    FrameCounters::getInstance().countUpload(rgba.size());
+
+    pShader->use();
+    pShader->setInt("image", 0);
+
+    GLState::getInstance().setDepthTest(false);
+    GLState::getInstance().bindVertexArray(vao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    FrameCounters::getInstance().countDraw(GL_TRIANGLES, 3UL);
+    GLState::getInstance().setDepthTest(true);
+
+    glBindTexture(GL_TEXTURE_2D, 0U);
+}
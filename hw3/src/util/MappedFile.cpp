@@ -0,0 +1,82 @@
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "util/MappedFile.h"
+
+
+MappedFile::MappedFile(const std::string & path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        throw std::runtime_error("failed to open " + path);
+    }
+
+    struct stat st {};
+
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        throw std::runtime_error("failed to stat " + path);
+    }
+
+    numBytes = static_cast<std::size_t>(st.st_size);
+
+    // mmap rejects zero-length mappings; an empty file is simply an empty view.
+    if (0UL < numBytes)
+    {
+        void * p = mmap(nullptr, numBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (p == MAP_FAILED)
+        {
+            close(fd);
+            throw std::runtime_error("failed to mmap " + path);
+        }
+
+        // Parsers stream through the file front to back.
+        madvise(p, numBytes, MADV_SEQUENTIAL);
+        pData = static_cast<const char *>(p);
+    }
+
+    close(fd);
+}
+
+
+MappedFile::MappedFile(MappedFile && rhs) noexcept
+{
+    *this = std::move(rhs);
+}
+
+
+MappedFile & MappedFile::operator=(MappedFile && rhs) noexcept
+{
+    if (this == &rhs)
+    {
+        return *this;
+    }
+
+    if (pData)
+    {
+        munmap(const_cast<char *>(pData), numBytes);
+    }
+
+    pData = std::exchange(rhs.pData, nullptr);
+    numBytes = std::exchange(rhs.numBytes, 0UL);
+
+    return *this;
+}
+
+
+MappedFile::~MappedFile() noexcept
+{
+    if (pData)
+    {
+        munmap(const_cast<char *>(pData), numBytes);
+    }
+}
@@ -0,0 +1,409 @@
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif  // __SSE2__
+
+#include "util/OcclusionCuller.h"
+
+
+namespace
+{
+
+/// Coefficients of e(x, y) = a x + b y + c, positive to the left of the edge from p to q.
+struct Edge
+{
+    Edge(const glm::vec3 & p, const glm::vec3 & q) : a(p.y - q.y), b(q.x - p.x), c(-(a * p.x + b * p.y)) {}
+
+    [[nodiscard]] float operator()(float x, float y) const { return a * x + b * y + c; }
+
+    float a;
+    float b;
+    float c;
+};
+
+
+glm::vec3 toScreen(const glm::vec4 & clip)
+{
+    glm::vec3 ndc = glm::vec3(clip) / clip.w;
+
+    return {(0.5f * ndc.x + 0.5f) * static_cast<float>(OcclusionCuller::kWidth),
+            (0.5f * ndc.y + 0.5f) * static_cast<float>(OcclusionCuller::kHeight),
+            0.5f * ndc.z + 0.5f};
+}
+
+}  // namespace anonymous
+
+
+OcclusionCuller::~OcclusionCuller() noexcept
+{
+    if (!worker.joinable())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+
+    frameRequested.notify_one();
+    worker.join();
+}
+
+
+void OcclusionCuller::addOccluder(const std::vector<glm::vec3> & positions,
+                                  const std::vector<std::uint32_t> & indices,
+                                  const glm::mat4 & model)
+{
+    auto base = static_cast<std::uint32_t>(occluderPositions.size());
+
+    for (const glm::vec3 & p : positions)
+    {
+        occluderPositions.emplace_back(model * glm::vec4(p, 1.0f));
+    }
+
+    for (std::uint32_t i : indices)
+    {
+        occluderIndices.emplace_back(base + i);
+    }
+}
+
+
+void OcclusionCuller::beginFrame(const glm::mat4 & vp)
+{
+    // A frame nobody tested still has to finish before its buffers are reused.
+    wait();
+
+    if (!worker.joinable())
+    {
+        worker = std::thread(&OcclusionCuller::workerLoop, this);
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        viewProjection = vp;
+        pending = true;
+    }
+
+    frameRequested.notify_one();
+}
+
+
+bool OcclusionCuller::isVisible(const Aabb & box)
+{
+    wait();
+
+    if (depth.empty() || box.empty())
+    {
+        return true;
+    }
+
+    glm::vec2 lo {std::numeric_limits<float>::max()};
+    glm::vec2 hi {std::numeric_limits<float>::lowest()};
+    float nearest = std::numeric_limits<float>::max();
+
+    for (int k = 0; k != 8; ++k)
+    {
+        glm::vec4 clip = viewProjection * glm::vec4((k & 1) ? box.max.x : box.min.x,
+                                                    (k & 2) ? box.max.y : box.min.y,
+                                                    (k & 4) ? box.max.z : box.min.z,
+                                                    1.0f);
+
+        // A corner in front of the near plane: the box reaches the camera.
+        if (clip.z < -clip.w)
+        {
+            return true;
+        }
+
+        glm::vec3 s = toScreen(clip);
+        lo = glm::min(lo, glm::vec2(s));
+        hi = glm::max(hi, glm::vec2(s));
+        nearest = std::min(nearest, s.z);
+    }
+
+    // Off screen; frustum culling decides.
+    if (hi.x < 0.0f || hi.y < 0.0f || kWidth <= lo.x || kHeight <= lo.y)
+    {
+        return true;
+    }
+
+    // Every pixel whose area the projected box touches.
+    int x0 = static_cast<int>(std::max(lo.x, 0.0f));
+    int y0 = static_cast<int>(std::max(lo.y, 0.0f));
+    int x1 = static_cast<int>(std::min(hi.x, kWidth - 1.0f));
+    int y1 = static_cast<int>(std::min(hi.y, kHeight - 1.0f));
+
+    for (int ty = y0 / kTileSize; ty <= y1 / kTileSize; ++ty)
+    {
+        for (int tx = x0 / kTileSize; tx <= x1 / kTileSize; ++tx)
+        {
+            std::size_t tile = static_cast<std::size_t>(ty) * kTilesX + static_cast<std::size_t>(tx);
+
+            // In front of everything in the tile, or behind everything in it.
+            if (nearest < tileMin[tile])
+            {
+                return true;
+            }
+
+            if (tileMax[tile] <= nearest)
+            {
+                continue;
+            }
+
+            int px0 = std::max(x0, tx * kTileSize);
+            int px1 = std::min(x1, tx * kTileSize + kTileSize - 1);
+            int py0 = std::max(y0, ty * kTileSize);
+            int py1 = std::min(y1, ty * kTileSize + kTileSize - 1);
+
+            for (int y = py0; y <= py1; ++y)
+            {
+                const float * row = depth.data() + static_cast<std::size_t>(y) * kWidth;
+
+                for (int x = px0; x <= px1; ++x)
+                {
+                    if (nearest < row[x])
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+
+void OcclusionCuller::workerLoop()
+{
+    while (true)
+    {
+        {
+            std::unique_lock lock(mutex);
+            frameRequested.wait(lock, [this] { return stopping || pending; });
+
+            // A frame in progress has finished by now; one not yet started is dropped.
+            if (stopping)
+            {
+                return;
+            }
+        }
+
+        std::exception_ptr frameError {nullptr};
+
+        try
+        {
+            rasterize();
+        }
+        catch (...)
+        {
+            frameError = std::current_exception();
+        }
+
+        {
+            std::lock_guard lock(mutex);
+            error = frameError;
+            pending = false;
+        }
+
+        frameDone.notify_one();
+    }
+}
+
+
+void OcclusionCuller::wait()
+{
+    std::unique_lock lock(mutex);
+    frameDone.wait(lock, [this] { return !pending; });
+
+    if (error)
+    {
+        std::rethrow_exception(std::exchange(error, nullptr));
+    }
+}
+
+
+void OcclusionCuller::rasterize()
+{
+    depth.assign(static_cast<std::size_t>(kWidth) * kHeight, 1.0f);
+
+    clipPositions.resize(occluderPositions.size());
+
+    for (std::size_t i = 0UL; i != occluderPositions.size(); ++i)
+    {
+        clipPositions[i] = viewProjection * glm::vec4(occluderPositions[i], 1.0f);
+    }
+
+    for (std::size_t i = 0UL; i + 2UL < occluderIndices.size(); i += 3UL)
+    {
+        clipAndRasterize(clipPositions[occluderIndices[i]],
+                         clipPositions[occluderIndices[i + 1UL]],
+                         clipPositions[occluderIndices[i + 2UL]]);
+    }
+
+    buildTiles();
+}
+
+
+void OcclusionCuller::clipAndRasterize(const glm::vec4 & a, const glm::vec4 & b, const glm::vec4 & c)
+{
+    const glm::vec4 in[3] {a, b, c};
+
+    // Entirely outside one of the side or far planes.
+    for (int axis = 0; axis != 3; ++axis)
+    {
+        if (in[0][axis] > in[0].w && in[1][axis] > in[1].w && in[2][axis] > in[2].w)
+        {
+            return;
+        }
+
+        if (axis != 2 && in[0][axis] < -in[0].w && in[1][axis] < -in[1].w && in[2][axis] < -in[2].w)
+        {
+            return;
+        }
+    }
+
+    // Signed distances to the near plane z = -w.
+    const float d[3] {a.z + a.w, b.z + b.w, c.z + c.w};
+
+    if (0.0f <= d[0] && 0.0f <= d[1] && 0.0f <= d[2])
+    {
+        rasterizeTriangle(toScreen(a), toScreen(b), toScreen(c));
+        return;
+    }
+
+    // Sutherland-Hodgman against the near plane: a triangle becomes at most a quad.
+    glm::vec4 out[4];
+    int n {0};
+
+    for (int i = 0; i != 3; ++i)
+    {
+        int j = (i + 1) % 3;
+
+        if (0.0f <= d[i])
+        {
+            out[n++] = in[i];
+        }
+
+        if ((0.0f <= d[i]) != (0.0f <= d[j]))
+        {
+            out[n++] = in[i] + (d[i] / (d[i] - d[j])) * (in[j] - in[i]);
+        }
+    }
+
+    for (int i = 2; i < n; ++i)
+    {
+        rasterizeTriangle(toScreen(out[0]), toScreen(out[i - 1]), toScreen(out[i]));
+    }
+}
+
+
+void OcclusionCuller::rasterizeTriangle(glm::vec3 v0, glm::vec3 v1, glm::vec3 v2)
+{
+    float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+
+    // Occluders are not back-face culled: either winding is fine.
+    if (area < 0.0f)
+    {
+        std::swap(v1, v2);
+        area = -area;
+    }
+
+    if (!(1e-8f < area))
+    {
+        return;
+    }
+
+    glm::vec2 lo = glm::min(glm::min(glm::vec2(v0), glm::vec2(v1)), glm::vec2(v2));
+    glm::vec2 hi = glm::max(glm::max(glm::vec2(v0), glm::vec2(v1)), glm::vec2(v2));
+
+    if (hi.x < 0.0f || hi.y < 0.0f || kWidth <= lo.x || kHeight <= lo.y)
+    {
+        return;
+    }
+
+    // Clamped before the conversion: vertices close to the near plane can land far off screen.
+    int minX = static_cast<int>(std::max(lo.x, 0.0f));
+    int minY = static_cast<int>(std::max(lo.y, 0.0f));
+    int maxX = static_cast<int>(std::min(hi.x, kWidth - 1.0f));
+    int maxY = static_cast<int>(std::min(hi.y, kHeight - 1.0f));
+
+    // Rows are processed in aligned groups of four pixels.
+    minX &= ~3;
+
+    // e0, e1 and e2 are the barycentric weights of v0, v1 and v2 times area.
+    Edge e0(v1, v2);
+    Edge e1(v2, v0);
+    Edge e2(v0, v1);
+
+    // Depth is affine in screen space: z(x, y) = za x + zb y + zc.
+    float za = (e1.a * (v1.z - v0.z) + e2.a * (v2.z - v0.z)) / area;
+    float zb = (e1.b * (v1.z - v0.z) + e2.b * (v2.z - v0.z)) / area;
+    float zc = v0.z + (e1.c * (v1.z - v0.z) + e2.c * (v2.z - v0.z)) / area;
+
+    for (int y = minY; y <= maxY; ++y)
+    {
+        float py = static_cast<float>(y) + 0.5f;
+        float * row = depth.data() + static_cast<std::size_t>(y) * kWidth;
+        int x = minX;
+
+#if defined(__SSE2__)
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 steps = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+
+        const __m128 a0 = _mm_set1_ps(e0.a), a1 = _mm_set1_ps(e1.a), a2 = _mm_set1_ps(e2.a), az = _mm_set1_ps(za);
+        const __m128 r0 = _mm_set1_ps(e0.b * py + e0.c);
+        const __m128 r1 = _mm_set1_ps(e1.b * py + e1.c);
+        const __m128 r2 = _mm_set1_ps(e2.b * py + e2.c);
+        const __m128 rz = _mm_set1_ps(zb * py + zc);
+
+        for (; x <= maxX; x += 4)
+        {
+            __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), steps);
+
+            __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a0, px), r0), zero),
+                                                  _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a1, px), r1), zero)),
+                                       _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a2, px), r2), zero));
+
+            __m128 z = _mm_add_ps(_mm_mul_ps(az, px), rz);
+            __m128 old = _mm_loadu_ps(row + x);
+
+            // Outside pixels keep their depth; inside ones take the nearer depth.
+            __m128 candidate = _mm_or_ps(_mm_and_ps(inside, z), _mm_andnot_ps(inside, old));
+            _mm_storeu_ps(row + x, _mm_min_ps(old, candidate));
+        }
+#endif  // __SSE2__
+
+        for (; x <= maxX; ++x)
+        {
+            float px = static_cast<float>(x) + 0.5f;
+
+            if (0.0f <= e0(px, py) && 0.0f <= e1(px, py) && 0.0f <= e2(px, py))
+            {
+                row[x] = std::min(row[x], za * px + zb * py + zc);
+            }
+        }
+    }
+}
+
+
+void OcclusionCuller::buildTiles()
+{
+    tileMin.assign(static_cast<std::size_t>(kTilesX) * kTilesY, 1.0f);
+    tileMax.assign(static_cast<std::size_t>(kTilesX) * kTilesY, 0.0f);
+
+    for (int y = 0; y != kHeight; ++y)
+    {
+        const float * row = depth.data() + static_cast<std::size_t>(y) * kWidth;
+
+        for (int x = 0; x != kWidth; ++x)
+        {
+            std::size_t tile = static_cast<std::size_t>(y / kTileSize) * kTilesX + static_cast<std::size_t>(x / kTileSize);
+            tileMin[tile] = std::min(tileMin[tile], row[x]);
+            tileMax[tile] = std::max(tileMax[tile], row[x]);
+        }
+    }
+}
@@ -0,0 +1,41 @@
+#include "util/PrimitiveCounter.h"
+
+
+PrimitiveCounter::PrimitiveCounter()
+{
+    glGenQueries(kLatency, queries);
+}
+
+
+PrimitiveCounter::~PrimitiveCounter() noexcept
+{
+    glDeleteQueries(kLatency, queries);
+}
+
+
+void PrimitiveCounter::beginFrame()
+{
+    // This query was ended kLatency frames ago; its result is almost always ready by now.
+    // If not, the previous count stands rather than waiting for the GPU, and the query is reissued.
+    if (issued[current])
+    {
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(queries[current], GL_QUERY_RESULT_AVAILABLE, &available);
+
+        if (available)
+        {
+            glGetQueryObjectui64v(queries[current], GL_QUERY_RESULT, &lastFrameCount);
+        }
+    }
+
+    glBeginQuery(GL_PRIMITIVES_GENERATED, queries[current]);
+}
+
+
+void PrimitiveCounter::endFrame()
+{
+    glEndQuery(GL_PRIMITIVES_GENERATED);
+
+    issued[current] = true;
+    current = (current + 1) % kLatency;
+}
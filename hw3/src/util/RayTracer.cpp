@@ -0,0 +1,718 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif  // __SSE2__
+
+#include "util/ImageFile.h"
+#include "util/Phong.h"
+#include "util/RayTracer.h"
+#include "util/ThreadPool.h"
+
+
+/// Four rays, one per lane, in structure-of-arrays form. A ray is traced iff its bit in active is set.
+struct RayTracer::Packet
+{
+    static constexpr std::uint32_t kNoHit {0xFFFFFFFFU};
+
+    alignas(16) float originX[4] {};
+    alignas(16) float originY[4] {};
+    alignas(16) float originZ[4] {};
+
+    alignas(16) float directionX[4] {};
+    alignas(16) float directionY[4] {};
+    alignas(16) float directionZ[4] {};
+
+    alignas(16) float inverseX[4] {};
+    alignas(16) float inverseY[4] {};
+    alignas(16) float inverseZ[4] {};
+
+    // Farthest distance still of interest, lowered to the closest hit so far.
+    alignas(16) float tMax[4] {};
+
+    // Index into order of the closest hit, and the hit's barycentric coordinates on triangles.
+    std::uint32_t primitive[4] {kNoHit, kNoHit, kNoHit, kNoHit};
+    float u[4] {};
+    float v[4] {};
+
+    int active {0};
+
+    void set(int lane, const glm::vec3 & origin, const glm::vec3 & direction, float t)
+    {
+        originX[lane] = origin.x;
+        originY[lane] = origin.y;
+        originZ[lane] = origin.z;
+
+        directionX[lane] = direction.x;
+        directionY[lane] = direction.y;
+        directionZ[lane] = direction.z;
+
+        inverseX[lane] = 1.0f / direction.x;
+        inverseY[lane] = 1.0f / direction.y;
+        inverseZ[lane] = 1.0f / direction.z;
+
+        tMax[lane] = t;
+        active |= 1 << lane;
+    }
+
+    [[nodiscard]] glm::vec3 origin(int lane) const
+    {
+        return {originX[lane], originY[lane], originZ[lane]};
+    }
+
+    [[nodiscard]] glm::vec3 direction(int lane) const
+    {
+        return {directionX[lane], directionY[lane], directionZ[lane]};
+    }
+};
+
+
+namespace
+{
+
+float surfaceArea(const Aabb & box)
+{
+    glm::vec3 e = box.extent();
+    return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+}
+
+
+std::uint8_t toByte(float v)
+{
+    // Also maps NaN to 0.
+    return static_cast<std::uint8_t>(std::lround((0.0f < v ? std::min(v, 1.0f) : 0.0f) * 255.0f));
+}
+
+
+int popcount(int mask)
+{
+    return (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1);
+}
+
+}  // namespace anonymous
+
+
+RayTracer::RayTracer(int width, int height)
+{
+    resize(width, height);
+}
+
+
+void RayTracer::resize(int w, int h)
+{
+    width = std::max(w, 1);
+    height = std::max(h, 1);
+    tilesX = (width + kTileSize - 1) / kTileSize;
+    tilesY = (height + kTileSize - 1) / kTileSize;
+
+    color.assign(static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 4UL, 0U);
+}
+
+
+void RayTracer::beginFrame(const glm::mat4 & view,
+                           const glm::mat4 & projection,
+                           const glm::vec3 & eye,
+                           const glm::vec3 & light,
+                           const glm::vec3 & lightRgb,
+                           const glm::vec3 & clearRgb)
+{
+    inverseViewProjection = glm::inverse(projection * view);
+    viewPos = eye;
+    lightPos = light;
+    lightColor = lightRgb;
+    clearColor = clearRgb;
+
+    triangles.clear();
+    spheres.clear();
+    dirty = true;
+    stats = Stats();
+}
+
+
+void RayTracer::addSphere(const glm::vec3 & center, float radius, const glm::vec3 & c, const glm::mat4 & model)
+{
+    spheres.push_back({glm::vec3(model * glm::vec4(center, 1.0f)), radius * glm::length(glm::vec3(model[0])), c});
+    dirty = true;
+}
+
+
+void RayTracer::endFrame(std::size_t numThreads)
+{
+    ThreadPool & pool = ThreadPool::getInstance();
+    numThreads = numThreads == 0UL ? pool.size() : std::min(numThreads, pool.size());
+
+    stats.buildSeconds = 0.0;
+
+    if (dirty)
+    {
+        auto start = std::chrono::steady_clock::now();
+        build();
+        stats.buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Each of numThreads tasks takes tiles until none are left, so at most numThreads run at once.
+    auto numTiles = static_cast<std::size_t>(tilesX) * static_cast<std::size_t>(tilesY);
+    std::atomic<std::size_t> nextTile {0UL};
+    std::atomic<std::size_t> numRays {0UL};
+
+    pool.parallelFor(numThreads, [this, numTiles, &nextTile, &numRays](std::size_t)
+    {
+        std::size_t traced {0UL};
+
+        for (std::size_t tile = nextTile++; tile < numTiles; tile = nextTile++)
+        {
+            traced += traceTile(tile);
+        }
+
+        numRays += traced;
+    });
+
+    stats.numThreads = numThreads;
+    stats.numPrimitives = order.size();
+    stats.numNodes = nodes.size();
+    stats.numRays = numRays;
+    stats.traceSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+bool RayTracer::writePpm(const std::string & path) const
+{
+    return ImageFile::writePpm(path, color, width, height);
+}
+
+
+void RayTracer::setModel(const glm::mat4 & model)
+{
+    normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+}
+
+
+void RayTracer::addTransformedTriangles(const std::uint32_t * indices, std::size_t numIndices)
+{
+    auto add = [this](const Vertex & a, const Vertex & b, const Vertex & c)
+    {
+        triangles.push_back({a.position,
+                             b.position - a.position,
+                             c.position - a.position,
+                             {a.normal, b.normal, c.normal},
+                             {a.color, b.color, c.color}});
+    };
+
+    if (numIndices == 0UL)
+    {
+        for (std::size_t i = 0UL; i + 2UL < transformed.size(); i += 3UL)
+        {
+            add(transformed[i], transformed[i + 1UL], transformed[i + 2UL]);
+        }
+    }
+    else
+    {
+        for (std::size_t i = 0UL; i + 2UL < numIndices; i += 3UL)
+        {
+            // Index buffers can come from files; skip triangles that point past the vertices.
+            if (transformed.size() <= std::max({indices[i], indices[i + 1UL], indices[i + 2UL]}))
+            {
+                continue;
+            }
+
+            add(transformed[indices[i]], transformed[indices[i + 1UL]], transformed[indices[i + 2UL]]);
+        }
+    }
+
+    dirty = true;
+}
+
+
+void RayTracer::build()
+{
+    std::size_t numPrimitives = triangles.size() + spheres.size();
+
+    std::vector<Aabb> boxes(numPrimitives);
+    std::vector<glm::vec3> centroids(numPrimitives);
+
+    for (std::size_t i = 0UL; i != triangles.size(); ++i)
+    {
+        const Triangle & t = triangles[i];
+        boxes[i].expand(t.origin);
+        boxes[i].expand(t.origin + t.edge1);
+        boxes[i].expand(t.origin + t.edge2);
+        centroids[i] = boxes[i].center();
+    }
+
+    for (std::size_t i = 0UL; i != spheres.size(); ++i)
+    {
+        const Sphere & s = spheres[i];
+        boxes[triangles.size() + i].min = s.center - glm::vec3(s.radius);
+        boxes[triangles.size() + i].max = s.center + glm::vec3(s.radius);
+        centroids[triangles.size() + i] = s.center;
+    }
+
+    order.resize(numPrimitives);
+    std::iota(order.begin(), order.end(), 0U);
+
+    nodes.clear();
+    nodes.reserve(2UL * numPrimitives);
+
+    if (numPrimitives != 0UL)
+    {
+        build(boxes, centroids, 0UL, numPrimitives, 0);
+    }
+
+    dirty = false;
+}
+
+
+std::uint32_t RayTracer::build(const std::vector<Aabb> & boxes,
+                               const std::vector<glm::vec3> & centroids,
+                               std::size_t first,
+                               std::size_t last,
+                               int depth)
+{
+    // nodes may reallocate below, so the node is addressed by index.
+    auto index = static_cast<std::uint32_t>(nodes.size());
+    nodes.emplace_back();
+
+    Aabb bounds;
+    Aabb centroidBounds;
+
+    for (std::size_t i = first; i != last; ++i)
+    {
+        bounds.expand(boxes[order[i]]);
+        centroidBounds.expand(centroids[order[i]]);
+    }
+
+    nodes[index].bounds = bounds;
+
+    std::size_t count = last - first;
+
+    // Binned surface area heuristic: per axis, bucket the centroids and try the split after each bucket.
+    // Traversing a node costs 1, testing a primitive costs 1, and a child is hit as often as its area allows.
+    int bestAxis = -1;
+    int bestBucket = 0;
+    float bestCost = static_cast<float>(count);
+    glm::vec3 extent = centroidBounds.extent();
+
+    auto bucketOf = [&centroidBounds, &extent](const glm::vec3 & c, int axis)
+    {
+        auto b = static_cast<int>(static_cast<float>(kNumBuckets) * (c[axis] - centroidBounds.min[axis]) / extent[axis]);
+        return std::clamp(b, 0, kNumBuckets - 1);
+    };
+
+    if (1UL < count && depth < kMaxDepth)
+    {
+        float parentArea = surfaceArea(bounds);
+
+        for (int axis = 0; axis != 3; ++axis)
+        {
+            if (!(0.0f < extent[axis]))
+            {
+                continue;
+            }
+
+            Aabb bucketBounds[kNumBuckets];
+            std::size_t bucketCounts[kNumBuckets] {};
+
+            for (std::size_t i = first; i != last; ++i)
+            {
+                int b = bucketOf(centroids[order[i]], axis);
+                bucketBounds[b].expand(boxes[order[i]]);
+                ++bucketCounts[b];
+            }
+
+            // rightCosts[b]: area times count of everything after bucket b.
+            float rightCosts[kNumBuckets] {};
+            Aabb right;
+            std::size_t rightCount {0UL};
+
+            for (int b = kNumBuckets - 1; 0 < b; --b)
+            {
+                right.expand(bucketBounds[b]);
+                rightCount += bucketCounts[b];
+                rightCosts[b - 1] = 0UL < rightCount ? surfaceArea(right) * static_cast<float>(rightCount) : 0.0f;
+            }
+
+            Aabb left;
+            std::size_t leftCount {0UL};
+
+            for (int b = 0; b != kNumBuckets - 1; ++b)
+            {
+                left.expand(bucketBounds[b]);
+                leftCount += bucketCounts[b];
+
+                if (leftCount == 0UL || leftCount == count)
+                {
+                    continue;
+                }
+
+                float cost = 1.0f + (surfaceArea(left) * static_cast<float>(leftCount) + rightCosts[b]) / parentArea;
+
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestBucket = b;
+                }
+            }
+        }
+    }
+
+    if (bestAxis == -1 && (count <= kMaxLeafSize || kMaxDepth <= depth))
+    {
+        nodes[index].offset = static_cast<std::uint32_t>(first);
+        nodes[index].count = static_cast<std::uint16_t>(count);
+        return index;
+    }
+
+    std::size_t middle;
+
+    if (bestAxis == -1)
+    {
+        // Too many primitives for a leaf, but no split pays off (e.g. all centroids coincide): halve them.
+        bestAxis = extent.y < extent.x ? (extent.z < extent.x ? 0 : 2) : (extent.z < extent.y ? 1 : 2);
+        middle = first + count / 2UL;
+        std::nth_element(order.begin() + static_cast<std::ptrdiff_t>(first),
+                         order.begin() + static_cast<std::ptrdiff_t>(middle),
+                         order.begin() + static_cast<std::ptrdiff_t>(last),
+                         [&centroids, bestAxis](std::uint32_t a, std::uint32_t b)
+                         {
+                             return centroids[a][bestAxis] < centroids[b][bestAxis];
+                         });
+    }
+    else
+    {
+        auto split = std::partition(order.begin() + static_cast<std::ptrdiff_t>(first),
+                                    order.begin() + static_cast<std::ptrdiff_t>(last),
+                                    [&](std::uint32_t i)
+                                    {
+                                        return bucketOf(centroids[i], bestAxis) <= bestBucket;
+                                    });
+        middle = static_cast<std::size_t>(split - order.begin());
+    }
+
+    nodes[index].axis = static_cast<std::uint16_t>(bestAxis);
+    build(boxes, centroids, first, middle, depth + 1);
+    std::uint32_t right = build(boxes, centroids, middle, last, depth + 1);
+    nodes[index].offset = right;
+
+    return index;
+}
+
+
+void RayTracer::intersect(Packet & packet, bool anyHit) const
+{
+    if (nodes.empty() || packet.active == 0)
+    {
+        return;
+    }
+
+#if defined(__SSE2__)
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 originX = _mm_load_ps(packet.originX);
+    const __m128 originY = _mm_load_ps(packet.originY);
+    const __m128 originZ = _mm_load_ps(packet.originZ);
+    const __m128 inverseX = _mm_load_ps(packet.inverseX);
+    const __m128 inverseY = _mm_load_ps(packet.inverseY);
+    const __m128 inverseZ = _mm_load_ps(packet.inverseZ);
+
+    // Slab test of all four rays; bit i is set iff ray i enters the box before its tMax.
+    auto hitBox = [&](const Aabb & box)
+    {
+        __m128 x0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.min.x), originX), inverseX);
+        __m128 x1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.max.x), originX), inverseX);
+        __m128 y0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.min.y), originY), inverseY);
+        __m128 y1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.max.y), originY), inverseY);
+        __m128 z0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.min.z), originZ), inverseZ);
+        __m128 z1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.max.z), originZ), inverseZ);
+
+        __m128 tNear = _mm_max_ps(_mm_max_ps(_mm_min_ps(x0, x1), _mm_min_ps(y0, y1)),
+                                  _mm_max_ps(_mm_min_ps(z0, z1), zero));
+        __m128 tFar = _mm_min_ps(_mm_min_ps(_mm_max_ps(x0, x1), _mm_max_ps(y0, y1)),
+                                 _mm_min_ps(_mm_max_ps(z0, z1), _mm_load_ps(packet.tMax)));
+
+        return _mm_movemask_ps(_mm_cmple_ps(tNear, tFar));
+    };
+#else
+    auto hitBox = [&packet](const Aabb & box)
+    {
+        int mask {0};
+
+        for (int lane = 0; lane != 4; ++lane)
+        {
+            float x0 = (box.min.x - packet.originX[lane]) * packet.inverseX[lane];
+            float x1 = (box.max.x - packet.originX[lane]) * packet.inverseX[lane];
+            float y0 = (box.min.y - packet.originY[lane]) * packet.inverseY[lane];
+            float y1 = (box.max.y - packet.originY[lane]) * packet.inverseY[lane];
+            float z0 = (box.min.z - packet.originZ[lane]) * packet.inverseZ[lane];
+            float z1 = (box.max.z - packet.originZ[lane]) * packet.inverseZ[lane];
+
+            float tNear = std::max(std::max(std::min(x0, x1), std::min(y0, y1)), std::max(std::min(z0, z1), 0.0f));
+            float tFar = std::min(std::min(std::max(x0, x1), std::max(y0, y1)), std::min(std::max(z0, z1), packet.tMax[lane]));
+
+            mask |= (tNear <= tFar) << lane;
+        }
+
+        return mask;
+    };
+#endif  // __SSE2__
+
+    // Returns the distance along the ray to the primitive, or +inf.
+    auto hitPrimitive = [this, &packet](std::uint32_t primitive, int lane, float & u, float & v)
+    {
+        constexpr float kMiss = std::numeric_limits<float>::infinity();
+
+        glm::vec3 o = packet.origin(lane);
+        glm::vec3 d = packet.direction(lane);
+
+        if (primitive < triangles.size())
+        {
+            // Moller-Trumbore, both sides.
+            const Triangle & t = triangles[primitive];
+            glm::vec3 p = glm::cross(d, t.edge2);
+            float det = glm::dot(t.edge1, p);
+
+            if (std::abs(det) < 1e-12f)
+            {
+                return kMiss;
+            }
+
+            float invDet = 1.0f / det;
+            glm::vec3 s = o - t.origin;
+            u = glm::dot(s, p) * invDet;
+
+            if (u < 0.0f || 1.0f < u)
+            {
+                return kMiss;
+            }
+
+            glm::vec3 q = glm::cross(s, t.edge1);
+            v = glm::dot(d, q) * invDet;
+
+            if (v < 0.0f || 1.0f < u + v)
+            {
+                return kMiss;
+            }
+
+            float distance = glm::dot(t.edge2, q) * invDet;
+            return 0.0f < distance ? distance : kMiss;
+        }
+
+        // Directions are unit length, so the quadratic's leading coefficient is 1.
+        const Sphere & s = spheres[primitive - triangles.size()];
+        glm::vec3 oc = o - s.center;
+        float b = glm::dot(oc, d);
+        float discriminant = b * b - (glm::dot(oc, oc) - s.radius * s.radius);
+
+        if (discriminant < 0.0f)
+        {
+            return kMiss;
+        }
+
+        float root = std::sqrt(discriminant);
+        float distance = 0.0f < -b - root ? -b - root : -b + root;
+        return 0.0f < distance ? distance : kMiss;
+    };
+
+    // Every push is preceded by a pop, so the stack holds at most one node per level.
+    std::uint32_t stack[kMaxDepth + 2];
+    int top {0};
+    stack[top++] = 0U;
+
+    const float * direction[3] {packet.directionX, packet.directionY, packet.directionZ};
+
+    while (0 < top)
+    {
+        std::uint32_t index = stack[--top];
+        const Node & node = nodes[index];
+
+        int mask = hitBox(node.bounds) & packet.active;
+
+        if (mask == 0)
+        {
+            continue;
+        }
+
+        if (node.count == 0U)
+        {
+            // Nearer child first, as seen by the first ray that hit this node.
+            int lane = 0;
+
+            while (!(mask & (1 << lane)))
+            {
+                ++lane;
+            }
+
+            bool rightFirst = direction[node.axis][lane] < 0.0f;
+            stack[top++] = rightFirst ? index + 1U : node.offset;
+            stack[top++] = rightFirst ? node.offset : index + 1U;
+            continue;
+        }
+
+        for (std::uint32_t i = node.offset; i != node.offset + node.count; ++i)
+        {
+            for (int lane = 0; lane != 4; ++lane)
+            {
+                if (!(mask & packet.active & (1 << lane)))
+                {
+                    continue;
+                }
+
+                float u {0.0f};
+                float v {0.0f};
+                float distance = hitPrimitive(order[i], lane, u, v);
+
+                if (!(distance < packet.tMax[lane]))
+                {
+                    continue;
+                }
+
+                if (anyHit)
+                {
+                    packet.active &= ~(1 << lane);
+                    continue;
+                }
+
+                packet.tMax[lane] = distance;
+                packet.primitive[lane] = i;
+                packet.u[lane] = u;
+                packet.v[lane] = v;
+            }
+        }
+
+        if (packet.active == 0)
+        {
+            return;
+        }
+    }
+}
+
+
+std::size_t RayTracer::traceTile(std::size_t tile)
+{
+    int x0 = static_cast<int>(tile % static_cast<std::size_t>(tilesX)) * kTileSize;
+    int y0 = static_cast<int>(tile / static_cast<std::size_t>(tilesX)) * kTileSize;
+    int x1 = std::min(x0 + kTileSize, width);
+    int y1 = std::min(y0 + kTileSize, height);
+
+    std::size_t numRays {0UL};
+
+    for (int y = y0; y < y1; y += 2)
+    {
+        for (int x = x0; x < x1; x += 2)
+        {
+            // Lane 2 * dy + dx traces pixel (x + dx, y + dy), from the near plane to the far plane.
+            Packet primary;
+
+            for (int lane = 0; lane != 4; ++lane)
+            {
+                int px = x + (lane & 1);
+                int py = y + (lane >> 1);
+
+                if (x1 <= px || y1 <= py)
+                {
+                    continue;
+                }
+
+                float ndcX = 2.0f * (static_cast<float>(px) + 0.5f) / static_cast<float>(width) - 1.0f;
+                float ndcY = 1.0f - 2.0f * (static_cast<float>(py) + 0.5f) / static_cast<float>(height);
+
+                glm::vec4 near = inverseViewProjection * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+                glm::vec4 far = inverseViewProjection * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+                glm::vec3 origin = glm::vec3(near) / near.w;
+                glm::vec3 toFar = glm::vec3(far) / far.w - origin;
+                float length = glm::length(toFar);
+
+                primary.set(lane, origin, toFar / length, length);
+            }
+
+            int traced = primary.active;
+            numRays += static_cast<std::size_t>(popcount(traced));
+            intersect(primary, false);
+
+            glm::vec3 fragPos[4];
+            glm::vec3 normal[4];
+            glm::vec3 albedo[4];
+            Packet shadow;
+
+            for (int lane = 0; lane != 4; ++lane)
+            {
+                if (!(traced & (1 << lane)) || primary.primitive[lane] == Packet::kNoHit)
+                {
+                    continue;
+                }
+
+                std::uint32_t primitive = order[primary.primitive[lane]];
+                glm::vec3 d = primary.direction(lane);
+                fragPos[lane] = primary.origin(lane) + primary.tMax[lane] * d;
+
+                if (primitive < triangles.size())
+                {
+                    const Triangle & t = triangles[primitive];
+                    float u = primary.u[lane];
+                    float v = primary.v[lane];
+                    normal[lane] = (1.0f - u - v) * t.normal[0] + u * t.normal[1] + v * t.normal[2];
+                    albedo[lane] = (1.0f - u - v) * t.color[0] + u * t.color[1] + v * t.color[2];
+                }
+                else
+                {
+                    const Sphere & s = spheres[primitive - triangles.size()];
+                    normal[lane] = fragPos[lane] - s.center;
+                    albedo[lane] = s.color;
+                }
+
+                if (!shadows)
+                {
+                    continue;
+                }
+
+                // Towards the light from the side the ray came from; a light behind the surface leaves it unlit.
+                glm::vec3 facing = glm::normalize(glm::dot(normal[lane], d) < 0.0f ? normal[lane] : -normal[lane]);
+                glm::vec3 toLight = lightPos - fragPos[lane];
+
+                if (0.0f < glm::dot(facing, toLight))
+                {
+                    float distance = glm::length(toLight);
+                    shadow.set(lane, fragPos[lane] + kShadowBias * facing, toLight / distance, distance);
+                }
+            }
+
+            // Rays that hit nothing on their way to the light stay active.
+            numRays += static_cast<std::size_t>(popcount(shadow.active));
+            intersect(shadow, true);
+            int lit = shadow.active;
+
+            for (int lane = 0; lane != 4; ++lane)
+            {
+                if (!(traced & (1 << lane)))
+                {
+                    continue;
+                }
+
+                glm::vec3 c = clearColor;
+
+                if (primary.primitive[lane] != Packet::kNoHit)
+                {
+                    float visibility = !shadows || (lit & (1 << lane)) ? 1.0f : 0.0f;
+                    c = Phong::shade(fragPos[lane], normal[lane], albedo[lane], viewPos, lightPos, lightColor, visibility);
+                }
+
+                int px = x + (lane & 1);
+                int py = y + (lane >> 1);
+
+                std::uint8_t * pixel = color.data() + (static_cast<std::size_t>(py) * width + px) * 4UL;
+                pixel[0] = toByte(c.x);
+                pixel[1] = toByte(c.y);
+                pixel[2] = toByte(c.z);
+                pixel[3] = 255U;
+            }
+        }
+    }
+
+    return numRays;
+}
@@ -0,0 +1,121 @@
+#include <cstring>
+
+#include "shape/Drawable.h"
+#include "util/GLState.h"
+#include "util/RenderQueue.h"
+#include "util/Shader.h"
+#include "util/Timeline.h"
+
+
+void RenderQueue::beginFrame(const glm::vec3 & e)
+{
+    eye = e;
+
+    // The last frame's storage went back to the arena with its beginFrame().
+    std::size_t numExpected = packets.size();
+    packets = FrameVector<Packet>();
+    packets.reserve(numExpected);
+}
+
+
+void RenderQueue::submit(Pass pass, Shader * pShader, GLuint vao, const glm::vec3 & worldCenter, Drawable * pDrawable, int tag)
+{
+    float distance = glm::length(worldCenter - eye);
+    std::uint32_t depth;
+    std::memcpy(&depth, &distance, sizeof(depth));
+
+    if (pass == kTransparent)
+    {
+        depth = ~depth;
+    }
+
+    std::uint64_t key = static_cast<std::uint64_t>(pass & 0xf) << 60U |
+                        static_cast<std::uint64_t>(pShader->getProgram() & 0xfffU) << 48U |
+                        static_cast<std::uint64_t>(vao & 0xffffU) << 32U |
+                        depth;
+
+    packets.push_back({key, pShader, vao, pDrawable, tag});
+}
+
+
+void RenderQueue::flush()
+{
+    Timeline::Zone zone {"RenderQueue::flush"};
+
+    sort();
+
+    stats = Stats();
+    stats.numPackets = packets.size();
+
+    // Drawables may have bound anything while preparing their packets; GLState drops the binds that turn out redundant.
+    const Shader * pCurrentShader {nullptr};
+    GLuint currentVao {0U};
+    bool vaoKnown {false};
+
+    for (const Packet & packet : packets)
+    {
+        if (packet.pShader != pCurrentShader)
+        {
+            packet.pShader->use();
+            pCurrentShader = packet.pShader;
+            ++stats.numProgramSwitches;
+        }
+
+        if (!vaoKnown || packet.vao != currentVao)
+        {
+            GLState::getInstance().bindVertexArray(packet.vao);
+            currentVao = packet.vao;
+            vaoKnown = true;
+            ++stats.numVaoBinds;
+        }
+
+        Timeline::Zone zone {"Drawable::draw"};
+        packet.pDrawable->draw(packet);
+    }
+}
+
+
+void RenderQueue::sort()
+{
+    constexpr std::size_t kRadix {256UL};
+
+    if (packets.size() < 2UL)
+    {
+        return;
+    }
+
+    // Ping-pong buffer, in the frame arena too.
+    FrameVector<Packet> scratch(packets.size());
+
+    for (unsigned shift = 0U; shift != 64U; shift += 8U)
+    {
+        std::size_t counts[kRadix] {};
+
+        for (const Packet & packet : packets)
+        {
+            ++counts[(packet.key >> shift) & 0xffU];
+        }
+
+        // All keys share this byte: the pass would not move anything.
+        if (counts[(packets.front().key >> shift) & 0xffU] == packets.size())
+        {
+            continue;
+        }
+
+        std::size_t offset {0UL};
+
+        for (std::size_t & count : counts)
+        {
+            std::size_t c = count;
+            count = offset;
+            offset += c;
+        }
+
+        for (const Packet & packet : packets)
+        {
+            scratch[counts[(packet.key >> shift) & 0xffU]++] = packet;
+        }
+
+        packets.swap(scratch);
+    }
+}
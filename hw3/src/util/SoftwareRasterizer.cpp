@@ -0,0 +1,473 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif  // __SSE2__
+
+#include "util/ImageFile.h"
+#include "util/Phong.h"
+#include "util/SoftwareRasterizer.h"
+#include "util/ThreadPool.h"
+
+
+namespace
+{
+
+/// Coefficients of e(x, y) = a x + b y + c, positive to the left of the edge from p to q.
+struct Edge
+{
+    Edge(const glm::vec3 & p, const glm::vec3 & q) : a(p.y - q.y), b(q.x - p.x), c(-(a * p.x + b * p.y)) {}
+
+    [[nodiscard]] float operator()(float x, float y) const { return a * x + b * y + c; }
+
+    float a;
+    float b;
+    float c;
+};
+
+
+std::uint8_t toByte(float v)
+{
+    // Also maps NaN to 0.
+    return static_cast<std::uint8_t>(std::lround((0.0f < v ? std::min(v, 1.0f) : 0.0f) * 255.0f));
+}
+
+}  // namespace anonymous
+
+
+SoftwareRasterizer::SoftwareRasterizer(int width, int height)
+{
+    resize(width, height);
+}
+
+
+void SoftwareRasterizer::resize(int w, int h)
+{
+    width = std::max(w, 1);
+    height = std::max(h, 1);
+    tilesX = (width + kTileSize - 1) / kTileSize;
+    tilesY = (height + kTileSize - 1) / kTileSize;
+
+    color.assign(static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 4UL, 0U);
+    bins.resize(static_cast<std::size_t>(tilesX) * static_cast<std::size_t>(tilesY));
+}
+
+
+void SoftwareRasterizer::beginFrame(const glm::mat4 & view,
+                                    const glm::mat4 & projection,
+                                    const glm::vec3 & eye,
+                                    const glm::vec3 & light,
+                                    const glm::vec3 & lightRgb,
+                                    const glm::vec3 & clearRgb)
+{
+    viewProjection = projection * view;
+    viewPos = eye;
+    lightPos = light;
+    lightColor = lightRgb;
+    clearColor = clearRgb;
+
+    triangles.clear();
+    stats = Stats();
+}
+
+
+void SoftwareRasterizer::endFrame(std::size_t numThreads)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    ThreadPool & pool = ThreadPool::getInstance();
+    numThreads = numThreads == 0UL ? pool.size() : std::min(numThreads, pool.size());
+
+    for (std::vector<std::uint32_t> & bin : bins)
+    {
+        bin.clear();
+    }
+
+    for (std::size_t i = 0UL; i != triangles.size(); ++i)
+    {
+        const Triangle & t = triangles[i];
+
+        for (int ty = t.minY / kTileSize; ty <= t.maxY / kTileSize; ++ty)
+        {
+            for (int tx = t.minX / kTileSize; tx <= t.maxX / kTileSize; ++tx)
+            {
+                bins[static_cast<std::size_t>(ty) * tilesX + static_cast<std::size_t>(tx)].emplace_back(i);
+            }
+        }
+    }
+
+    // Each of numThreads tasks takes tiles until none are left, so at most numThreads run at once.
+    std::atomic<std::size_t> nextTile {0UL};
+    std::atomic<std::size_t> numFragments {0UL};
+
+    pool.parallelFor(numThreads, [this, &nextTile, &numFragments](std::size_t)
+    {
+        float depth[kTileSize * kTileSize];
+        std::size_t written {0UL};
+
+        for (std::size_t tile = nextTile++; tile < bins.size(); tile = nextTile++)
+        {
+            written += rasterizeTile(tile, depth);
+        }
+
+        numFragments += written;
+    });
+
+    stats.numThreads = numThreads;
+    stats.numTriangles = triangles.size();
+    stats.numFragments = numFragments;
+    stats.rasterSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+bool SoftwareRasterizer::writePpm(const std::string & path) const
+{
+    return ImageFile::writePpm(path, color, width, height);
+}
+
+
+void SoftwareRasterizer::setModel(const glm::mat4 & m)
+{
+    model = m;
+    modelViewProjection = viewProjection * m;
+    normalMatrix = glm::transpose(glm::inverse(glm::mat3(m)));
+}
+
+
+SoftwareRasterizer::ClipVertex SoftwareRasterizer::transform(const glm::vec3 & position,
+                                                             const glm::vec3 & normal,
+                                                             const glm::vec3 & c) const
+{
+    return {modelViewProjection * glm::vec4(position, 1.0f), glm::vec3(model * glm::vec4(position, 1.0f)), normalMatrix * normal, c};
+}
+
+
+void SoftwareRasterizer::addTransformedTriangles(const std::uint32_t * indices, std::size_t numIndices)
+{
+    if (numIndices == 0UL)
+    {
+        for (std::size_t i = 0UL; i + 2UL < transformed.size(); i += 3UL)
+        {
+            clipTriangle(transformed[i], transformed[i + 1UL], transformed[i + 2UL]);
+        }
+
+        return;
+    }
+
+    for (std::size_t i = 0UL; i + 2UL < numIndices; i += 3UL)
+    {
+        // Index buffers can come from files; skip triangles that point past the vertices.
+        if (transformed.size() <= std::max({indices[i], indices[i + 1UL], indices[i + 2UL]}))
+        {
+            continue;
+        }
+
+        clipTriangle(transformed[indices[i]], transformed[indices[i + 1UL]], transformed[indices[i + 2UL]]);
+    }
+}
+
+
+void SoftwareRasterizer::clipTriangle(const ClipVertex & a, const ClipVertex & b, const ClipVertex & c)
+{
+    const ClipVertex * in[3] {&a, &b, &c};
+
+    // Entirely outside one of the side or far planes.
+    for (int axis = 0; axis != 3; ++axis)
+    {
+        if (a.clip[axis] > a.clip.w && b.clip[axis] > b.clip.w && c.clip[axis] > c.clip.w)
+        {
+            return;
+        }
+
+        if (axis != 2 && a.clip[axis] < -a.clip.w && b.clip[axis] < -b.clip.w && c.clip[axis] < -c.clip.w)
+        {
+            return;
+        }
+    }
+
+    // Signed distances to the near plane z = -w.
+    const float d[3] {a.clip.z + a.clip.w, b.clip.z + b.clip.w, c.clip.z + c.clip.w};
+
+    if (0.0f <= d[0] && 0.0f <= d[1] && 0.0f <= d[2])
+    {
+        setupTriangle(a, b, c, true);
+        return;
+    }
+
+    // Sutherland-Hodgman against the near plane: a triangle becomes at most a quad.
+    ClipVertex out[4];
+    int n {0};
+
+    for (int i = 0; i != 3; ++i)
+    {
+        int j = (i + 1) % 3;
+
+        if (0.0f <= d[i])
+        {
+            out[n++] = *in[i];
+        }
+
+        if ((0.0f <= d[i]) != (0.0f <= d[j]))
+        {
+            float t = d[i] / (d[i] - d[j]);
+            out[n++] = {glm::mix(in[i]->clip, in[j]->clip, t),
+                        glm::mix(in[i]->world, in[j]->world, t),
+                        glm::mix(in[i]->normal, in[j]->normal, t),
+                        glm::mix(in[i]->color, in[j]->color, t)};
+        }
+    }
+
+    for (int i = 2; i < n; ++i)
+    {
+        setupTriangle(out[0], out[i - 1], out[i], true);
+    }
+}
+
+
+void SoftwareRasterizer::setupTriangle(const ClipVertex & a, const ClipVertex & b, const ClipVertex & c, bool lit)
+{
+    const ClipVertex * v[3] {&a, &b, &c};
+    glm::vec3 s[3] {toScreen(a.clip), toScreen(b.clip), toScreen(c.clip)};
+
+    float area = (s[1].x - s[0].x) * (s[2].y - s[0].y) - (s[1].y - s[0].y) * (s[2].x - s[0].x);
+
+    // No face culling, as in App: either winding is drawn.
+    if (area < 0.0f)
+    {
+        std::swap(v[1], v[2]);
+        std::swap(s[1], s[2]);
+        area = -area;
+    }
+
+    if (!(1e-8f < area))
+    {
+        return;
+    }
+
+    glm::vec2 lo = glm::min(glm::min(glm::vec2(s[0]), glm::vec2(s[1])), glm::vec2(s[2]));
+    glm::vec2 hi = glm::max(glm::max(glm::vec2(s[0]), glm::vec2(s[1])), glm::vec2(s[2]));
+
+    if (hi.x < 0.0f || hi.y < 0.0f || static_cast<float>(width) <= lo.x || static_cast<float>(height) <= lo.y)
+    {
+        return;
+    }
+
+    Triangle t;
+
+    // Clamped before the conversion: vertices close to the near plane can land far off screen.
+    t.minX = static_cast<int>(std::max(lo.x, 0.0f));
+    t.minY = static_cast<int>(std::max(lo.y, 0.0f));
+    t.maxX = static_cast<int>(std::min(hi.x, static_cast<float>(width - 1)));
+    t.maxY = static_cast<int>(std::min(hi.y, static_cast<float>(height - 1)));
+    t.lit = lit;
+
+    for (int i = 0; i != 3; ++i)
+    {
+        float invW = 1.0f / v[i]->clip.w;
+        t.screen[i] = s[i];
+        t.invW[i] = invW;
+        t.world[i] = v[i]->world * invW;
+        t.normal[i] = v[i]->normal * invW;
+        t.color[i] = v[i]->color * invW;
+    }
+
+    triangles.emplace_back(t);
+}
+
+
+void SoftwareRasterizer::addLine(ClipVertex a, ClipVertex b)
+{
+    float da = a.clip.z + a.clip.w;
+    float db = b.clip.z + b.clip.w;
+
+    if (da < 0.0f && db < 0.0f)
+    {
+        return;
+    }
+
+    if (da < 0.0f)
+    {
+        a.clip = glm::mix(a.clip, b.clip, da / (da - db));
+        a.color = glm::mix(a.color, b.color, da / (da - db));
+    }
+    else if (db < 0.0f)
+    {
+        b.clip = glm::mix(b.clip, a.clip, db / (db - da));
+        b.color = glm::mix(b.color, a.color, db / (db - da));
+    }
+
+    glm::vec2 direction = glm::vec2(toScreen(b.clip)) - glm::vec2(toScreen(a.clip));
+    float length = glm::length(direction);
+
+    if (!(1e-6f < length))
+    {
+        return;
+    }
+
+    // Half the line width across the line, in pixels, then in clip space (screen y points down).
+    glm::vec2 offset = glm::vec2(-direction.y, direction.x) * (0.5f * kLineWidth / length);
+    glm::vec2 perW = offset * glm::vec2(2.0f / static_cast<float>(width), -2.0f / static_cast<float>(height));
+
+    glm::vec4 shiftA(perW.x * a.clip.w, perW.y * a.clip.w, 0.0f, 0.0f);
+    glm::vec4 shiftB(perW.x * b.clip.w, perW.y * b.clip.w, 0.0f, 0.0f);
+
+    ClipVertex corners[4] {a, a, b, b};
+    corners[0].clip += shiftA;
+    corners[1].clip -= shiftA;
+    corners[2].clip += shiftB;
+    corners[3].clip -= shiftB;
+
+    setupTriangle(corners[0], corners[1], corners[2], false);
+    setupTriangle(corners[1], corners[3], corners[2], false);
+}
+
+
+glm::vec3 SoftwareRasterizer::toScreen(const glm::vec4 & clip) const
+{
+    glm::vec3 ndc = glm::vec3(clip) / clip.w;
+
+    return {(0.5f * ndc.x + 0.5f) * static_cast<float>(width),
+            (0.5f - 0.5f * ndc.y) * static_cast<float>(height),
+            0.5f * ndc.z + 0.5f};
+}
+
+
+std::size_t SoftwareRasterizer::rasterizeTile(std::size_t tile, float * depth)
+{
+    int x0 = static_cast<int>(tile % static_cast<std::size_t>(tilesX)) * kTileSize;
+    int y0 = static_cast<int>(tile / static_cast<std::size_t>(tilesX)) * kTileSize;
+    int x1 = std::min(x0 + kTileSize, width) - 1;
+    int y1 = std::min(y0 + kTileSize, height) - 1;
+
+    const std::uint8_t clear[4] {toByte(clearColor.x), toByte(clearColor.y), toByte(clearColor.z), 255U};
+
+    for (int y = y0; y <= y1; ++y)
+    {
+        std::uint8_t * row = color.data() + (static_cast<std::size_t>(y) * width + x0) * 4UL;
+
+        for (int x = x0; x <= x1; ++x, row += 4)
+        {
+            std::copy(clear, clear + 4, row);
+        }
+    }
+
+    std::fill(depth, depth + kTileSize * kTileSize, 1.0f);
+
+    std::size_t written {0UL};
+
+    for (std::uint32_t index : bins[tile])
+    {
+        const Triangle & t = triangles[index];
+
+        int minX = std::max(t.minX, x0);
+        int minY = std::max(t.minY, y0);
+        int maxX = std::min(t.maxX, x1);
+        int maxY = std::min(t.maxY, y1);
+
+        // e0, e1 and e2 are the barycentric weights of corners 0, 1 and 2 times the doubled area.
+        Edge e0(t.screen[1], t.screen[2]);
+        Edge e1(t.screen[2], t.screen[0]);
+        Edge e2(t.screen[0], t.screen[1]);
+        float invArea = 1.0f / e0(t.screen[0].x, t.screen[0].y);
+
+        // Depth test, then perspective-correct attributes and the Phong model of phong.frag.glsl.
+        auto fragment = [&](int x, int y, float w0, float w1, float w2)
+        {
+            float b0 = w0 * invArea;
+            float b1 = w1 * invArea;
+            float b2 = w2 * invArea;
+
+            float z = b0 * t.screen[0].z + b1 * t.screen[1].z + b2 * t.screen[2].z;
+            float & stored = depth[(y - y0) * kTileSize + (x - x0)];
+
+            if (!(z < stored))
+            {
+                return;
+            }
+
+            stored = z;
+            ++written;
+
+            float invW = 1.0f / (b0 * t.invW[0] + b1 * t.invW[1] + b2 * t.invW[2]);
+            glm::vec3 c = (b0 * t.color[0] + b1 * t.color[1] + b2 * t.color[2]) * invW;
+
+            if (t.lit)
+            {
+                glm::vec3 fragPos = (b0 * t.world[0] + b1 * t.world[1] + b2 * t.world[2]) * invW;
+                glm::vec3 normal = (b0 * t.normal[0] + b1 * t.normal[1] + b2 * t.normal[2]) * invW;
+
+                c = Phong::shade(fragPos, normal, c, viewPos, lightPos, lightColor);
+            }
+
+            std::uint8_t * pixel = color.data() + (static_cast<std::size_t>(y) * width + x) * 4UL;
+            pixel[0] = toByte(c.x);
+            pixel[1] = toByte(c.y);
+            pixel[2] = toByte(c.z);
+            pixel[3] = 255U;
+        };
+
+        for (int y = minY; y <= maxY; ++y)
+        {
+            float py = static_cast<float>(y) + 0.5f;
+            int x = minX;
+
+#if defined(__SSE2__)
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 steps = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+
+            const __m128 a0 = _mm_set1_ps(e0.a), a1 = _mm_set1_ps(e1.a), a2 = _mm_set1_ps(e2.a);
+            const __m128 r0 = _mm_set1_ps(e0.b * py + e0.c);
+            const __m128 r1 = _mm_set1_ps(e1.b * py + e1.c);
+            const __m128 r2 = _mm_set1_ps(e2.b * py + e2.c);
+
+            for (; x + 3 <= maxX; x += 4)
+            {
+                __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), steps);
+                __m128 w0 = _mm_add_ps(_mm_mul_ps(a0, px), r0);
+                __m128 w1 = _mm_add_ps(_mm_mul_ps(a1, px), r1);
+                __m128 w2 = _mm_add_ps(_mm_mul_ps(a2, px), r2);
+
+                int inside = _mm_movemask_ps(_mm_and_ps(_mm_and_ps(_mm_cmpge_ps(w0, zero), _mm_cmpge_ps(w1, zero)),
+                                                        _mm_cmpge_ps(w2, zero)));
+
+                if (inside == 0)
+                {
+                    continue;
+                }
+
+                alignas(16) float l0[4];
+                alignas(16) float l1[4];
+                alignas(16) float l2[4];
+                _mm_store_ps(l0, w0);
+                _mm_store_ps(l1, w1);
+                _mm_store_ps(l2, w2);
+
+                for (int lane = 0; lane != 4; ++lane)
+                {
+                    if (inside & (1 << lane))
+                    {
+                        fragment(x + lane, y, l0[lane], l1[lane], l2[lane]);
+                    }
+                }
+            }
+#endif  // __SSE2__
+
+            for (; x <= maxX; ++x)
+            {
+                float px = static_cast<float>(x) + 0.5f;
+                float w0 = e0(px, py);
+                float w1 = e1(px, py);
+                float w2 = e2(px, py);
+
+                if (0.0f <= w0 && 0.0f <= w1 && 0.0f <= w2)
+                {
+                    fragment(x, y, w0, w1, w2);
+                }
+            }
+        }
+    }
+
+    return written;
+}
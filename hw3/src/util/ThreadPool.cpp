@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <utility>
+
+#include "util/ThreadPool.h"
+#include "util/Timeline.h"
+
+
+namespace
+{
+
+thread_local bool tInsideTask {false};
+
+}  // namespace anonymous
+
+
+ThreadPool & ThreadPool::getInstance()
+{
+    static ThreadPool instance {std::max(1U, std::thread::hardware_concurrency())};
+    return instance;
+}
+
+
+ThreadPool::~ThreadPool() noexcept
+{
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+
+    jobReady.notify_all();
+
+    for (auto & t : workers)
+    {
+        t.join();
+    }
+}
+
+
+void ThreadPool::parallelFor(std::size_t n, const std::function<void (std::size_t)> & task)
+{
+    if (n == 0UL)
+    {
+        return;
+    }
+
+    if (tInsideTask || n == 1UL || workers.empty())
+    {
+        for (std::size_t i = 0UL; i != n; ++i)
+        {
+            task(i);
+        }
+
+        return;
+    }
+
+    std::lock_guard submitLock(submitMutex);
+
+    {
+        std::lock_guard lock(mutex);
+        pTask = &task;
+        numTasks = n;
+        nextTask.store(0UL, std::memory_order_relaxed);
+        numFinished = 0UL;
+        firstError = nullptr;
+        ++generation;
+    }
+
+    jobReady.notify_all();
+    drain();
+
+    std::unique_lock lock(mutex);
+    jobDone.wait(lock, [this] { return numFinished == workers.size() + 1UL; });
+    pTask = nullptr;
+
+    if (firstError)
+    {
+        std::rethrow_exception(std::exchange(firstError, nullptr));
+    }
+}
+
+
+ThreadPool::ThreadPool(std::size_t numThreads)
+{
+    workers.reserve(numThreads - 1UL);
+
+    for (std::size_t i = 1UL; i < numThreads; ++i)
+    {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+
+void ThreadPool::workerLoop()
+{
+    Timeline::setThreadName("worker");
+
+    std::size_t seenGeneration {0UL};
+
+    while (true)
+    {
+        {
+            std::unique_lock lock(mutex);
+            jobReady.wait(lock, [this, seenGeneration] { return stopping || generation != seenGeneration; });
+
+            if (stopping)
+            {
+                return;
+            }
+
+            seenGeneration = generation;
+        }
+
+        drain();
+    }
+}
+
+
+void ThreadPool::drain()
+{
+    Timeline::Zone zone {"ThreadPool::drain"};
+
+    tInsideTask = true;
+
+    for (std::size_t i = nextTask.fetch_add(1UL); i < numTasks; i = nextTask.fetch_add(1UL))
+    {
+        try
+        {
+            (*pTask)(i);
+        }
+        catch (...)
+        {
+            std::lock_guard lock(mutex);
+
+            if (!firstError)
+            {
+                firstError = std::current_exception();
+            }
+        }
+    }
+
+    tInsideTask = false;
+
+    bool last;
+
+    {
+        std::lock_guard lock(mutex);
+        last = (++numFinished == workers.size() + 1UL);
+    }
+
+    if (last)
+    {
+        jobDone.notify_one();
+    }
+}
@@ -0,0 +1,272 @@
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "util/Timeline.h"
+
+
+namespace
+{
+
+struct Event
+{
+    const char * name;
+    std::uint64_t beginNanoseconds;
+    std::uint64_t endNanoseconds;
+};
+
+
+// Events per allocation of a thread's buffer.
+constexpr std::size_t kChunkSize {4096UL};
+
+
+/// Part of a thread's buffer. Only that thread appends; size and next publish its events to write().
+struct Chunk
+{
+    std::array<Event, kChunkSize> events;
+    std::atomic<std::size_t> size {0UL};
+    std::atomic<Chunk *> next {nullptr};
+};
+
+
+struct ThreadBuffer
+{
+    void append(const Event & event)
+    {
+        std::size_t n = pTail->size.load(std::memory_order_relaxed);
+
+        if (n == kChunkSize)
+        {
+            auto * pChunk = new Chunk;
+            pTail->next.store(pChunk, std::memory_order_release);
+            pTail = pChunk;
+            n = 0UL;
+        }
+
+        pTail->events[n] = event;
+        pTail->size.store(n + 1UL, std::memory_order_release);
+    }
+
+    std::size_t id {0UL};
+    std::atomic<const char *> name {nullptr};
+
+    // Whether this thread called Timeline::start(), and so owns the OpenGL context.
+    bool ownsContext {false};
+
+    Chunk head;
+    Chunk * pTail {&head};
+};
+
+
+// Buffers of all threads that recorded a zone, created with their first one.
+// Never destroyed (nor are their chunks): write() may run after the threads have exited,
+// and threads may still end zones during static destruction.
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<ThreadBuffer *> buffers;
+};
+
+
+Registry & registry()
+{
+    static auto * pRegistry = new Registry;
+    return *pRegistry;
+}
+
+
+thread_local ThreadBuffer * tBuffer {nullptr};
+
+// Set by Timeline::setThreadName; the buffer takes it when the thread records its first zone.
+thread_local const char * tThreadName {nullptr};
+
+bool debugGroups {false};
+std::atomic<std::uint64_t> originNanoseconds {0UL};
+
+
+ThreadBuffer & threadBuffer()
+{
+    if (!tBuffer)
+    {
+        Registry & r = registry();
+        std::lock_guard lock(r.mutex);
+
+        tBuffer = new ThreadBuffer;
+        tBuffer->id = r.buffers.size();
+        tBuffer->name.store(tThreadName, std::memory_order_relaxed);
+        r.buffers.push_back(tBuffer);
+    }
+
+    return *tBuffer;
+}
+
+
+std::uint64_t now()
+{
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+
+void writeString(std::ostream & out, const char * s)
+{
+    out << '"';
+
+    for (; *s; ++s)
+    {
+        if (*s == '"' || *s == '\\')
+        {
+            out << '\\';
+        }
+
+        out << *s;
+    }
+
+    out << '"';
+}
+
+
+/// Visits the events of buffer published so far.
+template <typename F>
+void forEachEvent(const ThreadBuffer & buffer, F f)
+{
+    for (const Chunk * pChunk = &buffer.head; pChunk; pChunk = pChunk->next.load(std::memory_order_acquire))
+    {
+        std::size_t size = pChunk->size.load(std::memory_order_acquire);
+
+        for (std::size_t i = 0UL; i != size; ++i)
+        {
+            f(pChunk->events[i]);
+        }
+    }
+}
+
+}  // namespace anonymous
+
+
+void Timeline::Zone::begin(const char * name)
+{
+    ThreadBuffer & buffer = threadBuffer();
+
+    if (buffer.ownsContext && debugGroups)
+    {
+        glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0U, -1, name);
+        debugGroup = true;
+    }
+
+    pName = name;
+    beginNanoseconds = now();
+}
+
+
+void Timeline::Zone::end() noexcept
+{
+    std::uint64_t endNanoseconds = now();
+
+    if (debugGroup)
+    {
+        glPopDebugGroup();
+    }
+
+    tBuffer->append({pName, beginNanoseconds, endNanoseconds});
+}
+
+
+void Timeline::start()
+{
+    threadBuffer().ownsContext = true;
+
+    // Core since OpenGL 4.3; glad loads the unsuffixed entry points with the extension.
+    debugGroups = GLAD_GL_KHR_debug && glad_glPushDebugGroup && glad_glPopDebugGroup;
+
+    // Timestamps count from the first start.
+    std::uint64_t zero {0UL};
+    originNanoseconds.compare_exchange_strong(zero, now());
+
+    enabled.store(true, std::memory_order_relaxed);
+}
+
+
+void Timeline::stop()
+{
+    enabled.store(false, std::memory_order_relaxed);
+}
+
+
+void Timeline::setThreadName(const char * name)
+{
+    // Threads that never record a zone (e.g. while the timeline is off) get no buffer.
+    tThreadName = name;
+
+    if (tBuffer)
+    {
+        tBuffer->name.store(name, std::memory_order_relaxed);
+    }
+}
+
+
+bool Timeline::write(const std::string & path)
+{
+    std::ofstream fout(path);
+
+    if (!fout)
+    {
+        return false;
+    }
+
+    auto origin = static_cast<double>(originNanoseconds.load());
+    const char * separator = "";
+
+    fout << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+
+    Registry & r = registry();
+    std::lock_guard lock(r.mutex);
+
+    for (const ThreadBuffer * pBuffer : r.buffers)
+    {
+        if (const char * name = pBuffer->name.load(std::memory_order_relaxed))
+        {
+            fout << separator << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << pBuffer->id
+                 << ",\"args\":{\"name\":";
+            writeString(fout, name);
+            fout << "}}";
+            separator = ",";
+        }
+
+        // Complete events, in microseconds.
+        forEachEvent(*pBuffer, [&fout, &separator, pBuffer, origin](const Event & event)
+        {
+            fout << separator << "\n{\"name\":";
+            writeString(fout, event.name);
+            fout << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << pBuffer->id
+                 << ",\"ts\":" << (static_cast<double>(event.beginNanoseconds) - origin) * 1e-3
+                 << ",\"dur\":" << static_cast<double>(event.endNanoseconds - event.beginNanoseconds) * 1e-3 << '}';
+            separator = ",";
+        });
+    }
+
+    fout << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    return static_cast<bool>(fout);
+}
+
+
+std::size_t Timeline::size()
+{
+    std::size_t numEvents = 0UL;
+
+    Registry & r = registry();
+    std::lock_guard lock(r.mutex);
+
+    for (const ThreadBuffer * pBuffer : r.buffers)
+    {
+        forEachEvent(*pBuffer, [&numEvents](const Event &) { ++numEvents; });
+    }
+
+    return numEvents;
+}